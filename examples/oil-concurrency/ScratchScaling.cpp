@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures how the per-call setup of generated introspection code scales with
+ * the number of threads. Each call sets up a pointer set and records a few
+ * pointers, as introspecting a small object would.
+ *
+ *   fresh:  a new PointerHashSet per call, allocated and zero-filled
+ *   pooled: a PointerHashSet reused from the ScratchPool, cleared by bumping
+ *           its generation
+ */
+
+#include "oi/OITraceCode.cpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kPointersPerCall = 32;
+constexpr auto kDuration = std::chrono::milliseconds(500);
+
+template <typename Setup>
+double callsPerSecond(unsigned threads, Setup setup) {
+  std::atomic<bool> stop = false;
+  std::atomic<size_t> calls = 0;
+
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&]() {
+      std::array<uintptr_t, kPointersPerCall> objects;
+      size_t local = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto pointers = setup();
+        for (auto& o : objects)
+          pointers->add(&o);
+        ++local;
+      }
+      calls += local;
+    });
+  }
+
+  std::this_thread::sleep_for(kDuration);
+  stop = true;
+  for (auto& w : workers)
+    w.join();
+
+  return calls / std::chrono::duration<double>(kDuration).count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  unsigned maxThreads = std::thread::hardware_concurrency();
+  if (argc > 1)
+    maxThreads = std::atoi(argv[1]);
+
+  std::cout << "threads\tfresh calls/s\tpooled calls/s\tspeedup\n";
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+    double fresh = callsPerSecond(threads, []() {
+      auto p = std::make_unique<PointerHashSet<>>();
+      p->initialize();
+      return p;
+    });
+    double pooled = callsPerSecond(threads, []() {
+      auto p = ScratchPool<PointerHashSet<>>::acquire();
+      p->initialize();
+      return p;
+    });
+    std::cout << threads << '\t' << static_cast<size_t>(fresh) << '\t'
+              << static_cast<size_t>(pooled) << '\t' << pooled / fresh
+              << "x\n";
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDED_OI_BATCHINTROSPECTIONRESULT_H
+#define INCLUDED_OI_BATCHINTROSPECTIONRESULT_H 1
+
+#include <oi/IntrospectionResult.h>
+#include <oi/exporters/inst.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace oi {
+
+/*
+ * BatchIntrospectionResult
+ *
+ * The result of introspecting many roots in a single traversal with a shared
+ * pointer set. Data reachable from several roots is only present below the
+ * first root that reached it. Each root can be iterated on its own, exactly
+ * like an IntrospectionResult.
+ */
+class BatchIntrospectionResult {
+ public:
+  class RootView {
+    friend class BatchIntrospectionResult;
+
+   public:
+    IntrospectionResult::const_iterator begin() const;
+    IntrospectionResult::const_iterator cbegin() const;
+
+    IntrospectionResult::const_iterator end() const;
+    IntrospectionResult::const_iterator cend() const;
+
+   private:
+    RootView(std::vector<uint8_t>::const_iterator begin,
+             std::vector<uint8_t>::const_iterator end,
+             exporters::inst::Inst inst);
+
+    std::vector<uint8_t>::const_iterator begin_;
+    std::vector<uint8_t>::const_iterator end_;
+    exporters::inst::Inst inst_;
+  };
+
+  /*
+   * Totals
+   *
+   * `roots[i]` holds the bytes reachable only from root `i`. `shared` holds
+   * the bytes of pointed-to data reachable from more than one root, which is
+   * counted once in total rather than once per root.
+   */
+  struct Totals {
+    std::vector<size_t> roots;
+    size_t shared = 0;
+  };
+
+  BatchIntrospectionResult(std::vector<uint8_t> buf,
+                           std::vector<size_t> rootOffsets,
+                           exporters::inst::Inst inst);
+
+  size_t size() const;
+  RootView operator[](size_t i) const;
+
+  // Walks every root, so prefer calling this once.
+  Totals totals() const;
+
+ private:
+  std::vector<uint8_t> buf_;
+  std::vector<size_t> rootOffsets_;
+  exporters::inst::Inst inst_;
+};
+
+}  // namespace oi
+
+#endif
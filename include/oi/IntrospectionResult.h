@@ -30,10 +30,13 @@
 
 namespace oi {
 
+class BatchIntrospectionResult;
+
 class IntrospectionResult {
  public:
   class const_iterator {
     friend class IntrospectionResult;
+    friend class BatchIntrospectionResult;
 
    public:
     bool operator==(const const_iterator& that) const;
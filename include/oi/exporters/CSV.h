@@ -19,10 +19,18 @@
 #include <oi/IntrospectionResult.h>
 
 #include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace oi::exporters {
 
 // CSV exporter following [RFC 4180](https://www.rfc-editor.org/rfc/rfc4180).
+//
+// Rows are formatted into a buffer which is written to the stream when it
+// fills and at the end of print(), without allocating per row.
 class CSV {
  public:
   CSV(std::ostream& out) : out_(out) {
@@ -31,6 +39,23 @@ class CSV {
   void print(const IntrospectionResult&);
   void print(IntrospectionResult::const_iterator& begin,
              IntrospectionResult::const_iterator end);
+  // Prints any range of result::Elements in pre-order
+  template <typename It>
+  void print(It& it, const It& end) {
+    beginPrint();
+    for (/* it */; it != end; ++it) {
+      printRow(*it);
+    }
+    flush();
+  }
+
+  // Write each distinct type path and list of type names once, to `dict`,
+  // and refer to them by ID in the typePath and typeNames columns. The
+  // dictionary has the columns "id,parent_id,value". A type path entry holds
+  // the last component of the path and the ID of the path leading to it, or 0
+  // at the root. A type names entry holds the joined names and a parent_id of
+  // 0. Entries are written before the first row using them.
+  void setDictionary(std::ostream& dict);
 
  private:
   static constexpr std::string_view kCRLF = "\r\n";
@@ -38,6 +63,7 @@ class CSV {
   static constexpr std::string_view kQuote = "\"";
   static constexpr std::string_view kEscapedQuote = "\\\"";
   static constexpr std::string_view kListDelimiter = ";";
+  static constexpr size_t kBufferSize = 1 << 20;
 
   static constexpr std::string_view kColumns[] = {"id",
                                                   "name",
@@ -50,19 +76,39 @@ class CSV {
                                                   "capacity",
                                                   "is_set",
                                                   "parent_id"};
+  static constexpr std::string_view kDictionaryColumns[] = {
+      "id", "parent_id", "value"};
 
   size_t id_ = 0;
   std::vector<size_t> parentIdStack_ = {0};
 
   std::ostream& out_;
+  std::string buf_;
+
+  // Dictionary state, kept across calls to print() so that IDs stay valid
+  std::ostream* dict_ = nullptr;
+  std::string dictBuf_;
+  std::unordered_map<std::string, size_t> dictIds_;
+  std::vector<size_t> pathIdStack_;  // Path ID of the latest row by depth
+  std::string key_;
+  std::string joinedNames_;
+  size_t nextDictId_ = 1;
 
-  void printHeader();
+  void printHeader(std::span<const std::string_view> columns,
+                   std::string& buf);
+  void beginPrint();
+  void printRow(const result::Element&);
+  void flush();
 
-  template <typename Seq>
-  static std::string escapeField(const Seq&);
+  static void appendEscaped(std::string& buf, std::string_view field);
+  static void appendEscaped(std::string& buf,
+                            std::span<const std::string_view> list);
+  static void appendEscapedBody(std::string& buf, std::string_view field);
+  static void appendUnsigned(std::string& buf, uint64_t value);
 
-  static std::string escapeField(std::string_view);
-  static std::string escapeField(std::string);
+  size_t internPath(std::span<const std::string_view> typePath);
+  size_t internNames(std::span<const std::string_view> typeNames);
+  size_t intern(std::string_view value, size_t parentId);
 };
 
 }  // namespace oi::exporters
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDED_OI_EXPORTERS_CONTAINER_WASTE_H
+#define INCLUDED_OI_EXPORTERS_CONTAINER_WASTE_H 1
+
+#include <oi/IntrospectionResult.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace oi::exporters {
+
+/*
+ * Finds the containers which hold on to the most memory they don't use.
+ *
+ * A container wastes (capacity - length) * element size bytes of reserved
+ * but unused space, plus the whole bucket array for hash tables. Waste is
+ * summed per type path, e.g. every "foo/bar/std::vector<int>" in the tree,
+ * and the setTopInstances() most wasteful single containers are kept.
+ *
+ * Memory use is one entry per type path plus the kept instances.
+ */
+class ContainerWaste {
+ public:
+  struct Container {
+    size_t length = 0;
+    size_t capacity = 0;
+    size_t elementSize = 0;
+    // Hash tables only. Buckets are assumed to be a pointer each, as they
+    // are in libstdc++ and libc++.
+    size_t bucketCount = 0;
+
+    uint64_t unusedBytes() const {
+      return capacity > length ? uint64_t{capacity - length} * elementSize : 0;
+    }
+    uint64_t bucketBytes() const {
+      return uint64_t{bucketCount} * sizeof(void*);
+    }
+    uint64_t wastedBytes() const {
+      return unusedBytes() + bucketBytes();
+    }
+    // Elements per bucket for hash tables, otherwise the fraction of the
+    // capacity in use. An empty container with no storage counts as full.
+    double loadFactor() const {
+      size_t slots = bucketCount != 0 ? bucketCount : capacity;
+      return slots == 0 ? 1.0 : static_cast<double>(length) / slots;
+    }
+  };
+
+  struct PathStats {
+    std::string typeName;
+    uint64_t instances = 0;
+    uint64_t length = 0;
+    uint64_t capacity = 0;
+    uint64_t bucketCount = 0;
+    uint64_t unusedBytes = 0;
+    uint64_t bucketBytes = 0;
+
+    uint64_t wastedBytes() const {
+      return unusedBytes + bucketBytes;
+    }
+  };
+
+  struct Instance {
+    std::string path;
+    std::string typeName;
+    Container container;
+  };
+
+  // How many of the most wasteful containers to keep, 0 for none
+  void setTopInstances(size_t n) {
+    topInstances_ = n;
+    while (instances_.size() > topInstances_)
+      instances_.pop();
+  }
+
+  void add(const IntrospectionResult& result) {
+    auto begin = result.cbegin();
+    add(begin, result.cend());
+  }
+
+  /*
+   * Adds the containers of one result, in pre-order. Elements don't carry
+   * their container's element size, so it is taken from the static size of
+   * the first element. The bytes of an empty container are all unused,
+   * which is what its exclusive size less its static size counts.
+   *
+   * A hash table's bucket array is included in its exclusive size but can't
+   * be told apart from the rest, so bucketBytes() is only known to producers
+   * calling add(path, ...), except for empty tables.
+   */
+  template <typename It>
+  void add(It& it, const It& end) {
+    pathEnds_.clear();
+    path_.clear();
+    pending_.reset();
+
+    for (; it != end; ++it) {
+      const result::Element& el = *it;
+      const size_t depth = el.type_path.size();
+
+      if (pending_.has_value()) {
+        if (depth == pending_->depth + 1)
+          pending_->container.elementSize = el.static_size;
+        flushPending();
+      }
+
+      if (depth == 0)
+        continue;
+      pathEnds_.resize(std::min(pathEnds_.size(), depth - 1));
+      path_.resize(pathEnds_.empty() ? 0 : pathEnds_.back());
+      if (!path_.empty())
+        path_ += '/';
+      path_ += el.type_path.back();
+      pathEnds_.push_back(path_.size());
+
+      const auto& cs = el.container_stats;
+      if (!cs.has_value())
+        continue;
+      pending_ = Pending{
+          .depth = depth,
+          .typeName = el.type_names.empty() ? std::string_view{}
+                                            : el.type_names.front(),
+          .container = {.length = cs->length, .capacity = cs->capacity},
+          .emptyBytes = el.exclusive_size > el.static_size
+                            ? el.exclusive_size - el.static_size
+                            : 0,
+      };
+    }
+    if (pending_.has_value())
+      flushPending();
+  }
+
+  // Adds one container, for producers which don't have result::Elements
+  void add(std::string_view path,
+           std::string_view typeName,
+           const Container& container) {
+    auto it = paths_.find(path);
+    if (it == paths_.end()) {
+      it = paths_.emplace(std::string{path}, PathStats{}).first;
+      it->second.typeName = typeName;
+    }
+    PathStats& s = it->second;
+    s.instances++;
+    s.length += container.length;
+    s.capacity += container.capacity;
+    s.bucketCount += container.bucketCount;
+    s.unusedBytes += container.unusedBytes();
+    s.bucketBytes += container.bucketBytes();
+    totalWasted_ += container.wastedBytes();
+
+    const uint64_t wasted = container.wastedBytes();
+    if (topInstances_ == 0 || wasted == 0)
+      return;
+    if (instances_.size() == topInstances_) {
+      if (wasted <= instances_.top().container.wastedBytes())
+        return;
+      instances_.pop();
+    }
+    instances_.push(Instance{
+        .path = std::string{path},
+        .typeName = std::string{typeName},
+        .container = container,
+    });
+  }
+
+  const PathStats* find(std::string_view path) const {
+    auto it = paths_.find(path);
+    return it == paths_.end() ? nullptr : &it->second;
+  }
+
+  uint64_t totalWasted() const {
+    return totalWasted_;
+  }
+
+  // The kept instances, most wasteful first
+  std::vector<Instance> topInstances() const {
+    auto heap = instances_;
+    std::vector<Instance> result;
+    result.reserve(heap.size());
+    for (; !heap.empty(); heap.pop())
+      result.push_back(heap.top());
+    std::reverse(result.begin(), result.end());
+    return result;
+  }
+
+  void clear() {
+    paths_.clear();
+    instances_ = {};
+    totalWasted_ = 0;
+  }
+
+  /*
+   * Writes the `top` most wasteful type paths, or all of those which waste
+   * anything, then the kept instances, as two tab-separated tables:
+   *
+   *   wasted unused buckets instances length capacity load path type
+   *   wasted unused buckets length capacity element_size load path type
+   *
+   * where a path's load is its total length over its total capacity, or
+   * bucket count for hash tables.
+   */
+  void print(std::ostream& out, size_t top = SIZE_MAX) const {
+    std::vector<const std::pair<const std::string, PathStats>*> rows;
+    for (const auto& entry : paths_) {
+      if (entry.second.wastedBytes() != 0)
+        rows.push_back(&entry);
+    }
+    size_t n = std::min(top, rows.size());
+    std::partial_sort(
+        rows.begin(), rows.begin() + n, rows.end(), [](auto* a, auto* b) {
+          auto wa = a->second.wastedBytes();
+          auto wb = b->second.wastedBytes();
+          return wa > wb || (wa == wb && a->first < b->first);
+        });
+
+    out << "wasted\tunused\tbuckets\tinstances\tlength\tcapacity\tload\tpath"
+           "\ttype\n";
+    for (size_t i = 0; i < n; i++) {
+      const auto& [path, s] = *rows[i];
+      uint64_t slots = s.bucketCount != 0 ? s.bucketCount : s.capacity;
+      out << s.wastedBytes() << '\t' << s.unusedBytes << '\t' << s.bucketBytes
+          << '\t' << s.instances << '\t' << s.length << '\t' << s.capacity
+          << '\t' << loadString(s.length, slots) << '\t' << path << '\t'
+          << s.typeName << '\n';
+    }
+
+    if (topInstances_ == 0)
+      return;
+    out << "\nwasted\tunused\tbuckets\tlength\tcapacity\telement_size\tload"
+           "\tpath\ttype\n";
+    for (const auto& [path, typeName, c] : topInstances()) {
+      size_t slots = c.bucketCount != 0 ? c.bucketCount : c.capacity;
+      out << c.wastedBytes() << '\t' << c.unusedBytes() << '\t'
+          << c.bucketBytes() << '\t' << c.length << '\t' << c.capacity << '\t'
+          << c.elementSize << '\t' << loadString(c.length, slots) << '\t'
+          << path << '\t' << typeName << '\n';
+    }
+  }
+
+ private:
+  struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+
+  struct MoreWasteful {
+    bool operator()(const Instance& a, const Instance& b) const {
+      return a.container.wastedBytes() > b.container.wastedBytes();
+    }
+  };
+
+  // A container whose element size is known once the next element is read
+  struct Pending {
+    size_t depth;
+    std::string_view typeName;
+    Container container;
+    size_t emptyBytes;  // Exclusive size less static size
+  };
+
+  size_t topInstances_ = 100;
+  uint64_t totalWasted_ = 0;
+  std::unordered_map<std::string, PathStats, NameHash, std::equal_to<>> paths_;
+  // Min-heap, so the least wasteful kept instance is the one replaced
+  std::priority_queue<Instance, std::vector<Instance>, MoreWasteful>
+      instances_;
+
+  std::string path_;
+  std::vector<size_t> pathEnds_;  // End of each component in path_
+  std::optional<Pending> pending_;
+
+  // Called before path_ moves on from the pending container
+  void flushPending() {
+    Pending p = *pending_;
+    pending_.reset();
+
+    Container& c = p.container;
+    if (c.length == 0 && c.capacity != 0) {
+      c.elementSize = p.emptyBytes / c.capacity;
+    } else if (c.length == 0) {
+      // Only a hash table's buckets are allocated while it has no capacity
+      c.bucketCount = p.emptyBytes / sizeof(void*);
+    }
+    add(path_, p.typeName, c);
+  }
+
+  static std::string loadString(uint64_t length, uint64_t slots) {
+    if (slots == 0)
+      return "-";
+    auto load = static_cast<double>(length) / static_cast<double>(slots);
+    std::string s = std::to_string(load);
+    return s.substr(0, s.find('.') + 3);
+  }
+};
+
+}  // namespace oi::exporters
+
+#endif
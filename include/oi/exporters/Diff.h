@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDED_OI_EXPORTERS_DIFF_H
+#define INCLUDED_OI_EXPORTERS_DIFF_H 1
+
+#include <oi/result/Element.h>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace oi::exporters {
+
+/*
+ * A node as seen by Diff: its depth in the tree (1 for a root), what
+ * identifies it among its siblings, and the bytes it adds to the tree.
+ *
+ * Captured container keys are already part of the name, e.g. "[abc]". The
+ * key is kept to order entries by. Pointer keys are addresses, which don't
+ * carry over between snapshots, so they're left out.
+ */
+struct DiffNode {
+  using Key = std::variant<std::monostate, uint64_t, std::string_view>;
+
+  size_t depth;
+  std::string_view name;
+  std::string_view typeName;
+  Key key;
+  size_t exclusiveSize;
+};
+
+/*
+ * Adapts an iterator over result::Element, e.g. an IntrospectionResult's, to
+ * the cursor interface Diff reads:
+ *
+ *   const DiffNode* peek();  // The current node, or nullptr at the end
+ *   void advance();
+ *
+ * The DiffNode is valid until the next call to advance().
+ */
+template <typename It>
+class ElementCursor {
+ public:
+  ElementCursor(It& it, It end) : it_(it), end_(std::move(end)) {
+  }
+
+  const DiffNode* peek() {
+    if (it_ == end_)
+      return nullptr;
+    if (!loaded_) {
+      const result::Element& el = *it_;
+      node_ = DiffNode{
+          .depth = el.type_path.size(),
+          .name = el.name,
+          .typeName = el.type_names.empty() ? "" : el.type_names.front(),
+          .key = std::monostate{},
+          .exclusiveSize = el.exclusive_size,
+      };
+      // Primitives hold their own value in `data`, everything else holds a
+      // captured key
+      if (!el.is_primitive) {
+        if (const auto* s = std::get_if<result::Element::Scalar>(&el.data))
+          node_.key = s->n;
+        else if (const auto* str = std::get_if<std::string>(&el.data))
+          node_.key = std::string_view{*str};
+      }
+      loaded_ = true;
+    }
+    return &node_;
+  }
+
+  void advance() {
+    ++it_;
+    loaded_ = false;
+  }
+
+ private:
+  It& it_;
+  It end_;
+  DiffNode node_{};
+  bool loaded_ = false;
+};
+
+/*
+ * Compares two introspection results of the same object, e.g. snapshots
+ * taken some time apart, and writes the subtrees which were added, removed,
+ * or whose size changed.
+ *
+ * Both inputs are read once, in pre-order, side by side. Siblings are
+ * aligned by name, which includes any captured key. Entries with the same
+ * name, such as the elements of a vector, are aligned by position. Where both
+ * unaligned siblings have keys of the same kind the smaller one is taken to
+ * be missing from the other side, which lines up ordered containers. Other
+ * unaligned pairs are reported as one removed and one added node, so entries
+ * of unordered containers only line up if they're iterated in the same
+ * order.
+ *
+ * Memory use is bounded by the depth of the trees: a node's sizes are
+ * summed from its descendants' exclusive sizes as they're read, and it is
+ * written once its subtree ends. Output is children first, one line per
+ * node:
+ *
+ *   kind<TAB>delta<TAB>oldSize<TAB>newSize<TAB>path<TAB>typeName
+ *
+ * where kind is one of added, removed, grown, shrunk, and the path is the
+ * node's name and those of its parents joined with '/'. Entries with a
+ * captured key are named [key], other container entries [index].
+ */
+class Diff {
+ public:
+  Diff(std::ostream& out) : out_(out) {
+  }
+
+  // Skip nodes whose size changed by fewer than `bytes`
+  void setMinDelta(size_t bytes) {
+    minDelta_ = bytes;
+  }
+
+  template <typename OldIt, typename NewIt>
+  void print(OldIt& oldIt, OldIt oldEnd, NewIt& newIt, NewIt newEnd) {
+    ElementCursor<OldIt> oldCursor{oldIt, std::move(oldEnd)};
+    ElementCursor<NewIt> newCursor{newIt, std::move(newEnd)};
+    print(oldCursor, newCursor);
+  }
+
+  template <typename OldCursor, typename NewCursor>
+  void print(OldCursor& oldCursor, NewCursor& newCursor);
+
+  // Total sizes of everything compared so far
+  size_t oldTotal() const {
+    return oldTotal_;
+  }
+  size_t newTotal() const {
+    return newTotal_;
+  }
+
+ private:
+  struct Frame {
+    size_t depth;
+    size_t pathSize;  // Length of path_ before this node
+    std::string typeName{};
+    size_t oldSize = 0;
+    size_t newSize = 0;
+    size_t oldChildren = 0;
+    size_t newChildren = 0;
+  };
+
+  std::ostream& out_;
+  size_t minDelta_ = 0;
+  size_t oldTotal_ = 0;
+  size_t newTotal_ = 0;
+  std::vector<Frame> frames_;
+  std::string path_;
+
+  static bool sameNode(const DiffNode& a, const DiffNode& b) {
+    return a.name == b.name;
+  }
+
+  static bool keysOrdered(const DiffNode& a, const DiffNode& b) {
+    return a.key.index() == b.key.index() &&
+           !std::holds_alternative<std::monostate>(a.key);
+  }
+
+  void pushComponent(const DiffNode& node, size_t index) {
+    if (!path_.empty())
+      path_ += '/';
+
+    if (node.name.empty() || node.name == "[]") {
+      path_ += '[';
+      path_ += std::to_string(index);
+      path_ += ']';
+    } else {
+      path_ += node.name;
+    }
+  }
+
+  void write(std::string_view kind,
+             size_t oldSize,
+             size_t newSize,
+             std::string_view typeName) {
+    size_t change = oldSize > newSize ? oldSize - newSize : newSize - oldSize;
+    if (change == 0 || change < minDelta_)
+      return;
+
+    out_ << kind << '\t' << (newSize >= oldSize ? '+' : '-') << change << '\t'
+         << oldSize << '\t' << newSize << '\t' << path_ << '\t' << typeName
+         << '\n';
+  }
+
+  // Consumes the subtree at the cursor and returns its total size
+  template <typename Cursor>
+  static size_t skipSubtree(Cursor& cursor) {
+    const DiffNode* node = cursor.peek();
+    const size_t depth = node->depth;
+    size_t size = node->exclusiveSize;
+    cursor.advance();
+    while ((node = cursor.peek()) != nullptr && node->depth > depth) {
+      size += node->exclusiveSize;
+      cursor.advance();
+    }
+    return size;
+  }
+
+  template <typename Cursor>
+  void skipRemoved(Cursor& cursor) {
+    const size_t pathSize = path_.size();
+    auto& parent = frames_.back();
+    pushComponent(*cursor.peek(), parent.oldChildren++);
+    std::string typeName{cursor.peek()->typeName};
+    size_t size = skipSubtree(cursor);
+    parent.oldSize += size;
+    write("removed", size, 0, typeName);
+    path_.resize(pathSize);
+  }
+
+  template <typename Cursor>
+  void skipAdded(Cursor& cursor) {
+    const size_t pathSize = path_.size();
+    auto& parent = frames_.back();
+    pushComponent(*cursor.peek(), parent.newChildren++);
+    std::string typeName{cursor.peek()->typeName};
+    size_t size = skipSubtree(cursor);
+    parent.newSize += size;
+    write("added", 0, size, typeName);
+    path_.resize(pathSize);
+  }
+
+  void closeFrame() {
+    Frame frame = std::move(frames_.back());
+    frames_.pop_back();
+
+    write(frame.newSize >= frame.oldSize ? "grown" : "shrunk",
+          frame.oldSize,
+          frame.newSize,
+          frame.typeName);
+    path_.resize(frame.pathSize);
+
+    auto& parent = frames_.back();
+    parent.oldSize += frame.oldSize;
+    parent.newSize += frame.newSize;
+  }
+};
+
+template <typename OldCursor, typename NewCursor>
+void Diff::print(OldCursor& oldCursor, NewCursor& newCursor) {
+  // The bottom frame is the parent of the roots and is never written
+  frames_.clear();
+  frames_.push_back(Frame{.depth = 0, .pathSize = 0});
+  path_.clear();
+
+  while (true) {
+    const DiffNode* oldNode = oldCursor.peek();
+    const DiffNode* newNode = newCursor.peek();
+    auto& parent = frames_.back();
+    const size_t depth = parent.depth + 1;
+
+    const bool oldHere = oldNode != nullptr && oldNode->depth == depth;
+    const bool newHere = newNode != nullptr && newNode->depth == depth;
+    if (!oldHere && !newHere) {
+      if (frames_.size() == 1)
+        break;
+      closeFrame();
+      continue;
+    }
+
+    if (oldHere && newHere && sameNode(*oldNode, *newNode)) {
+      const size_t pathSize = path_.size();
+      pushComponent(*newNode, parent.newChildren);
+      parent.oldChildren++;
+      parent.newChildren++;
+      frames_.push_back(Frame{
+          .depth = depth,
+          .pathSize = pathSize,
+          .typeName = std::string{newNode->typeName},
+          .oldSize = oldNode->exclusiveSize,
+          .newSize = newNode->exclusiveSize,
+      });
+      oldCursor.advance();
+      newCursor.advance();
+    } else if (oldHere && newHere && !keysOrdered(*oldNode, *newNode)) {
+      // Without keys there's no telling which side is missing a node. Take
+      // it as a replacement so that the following siblings stay aligned.
+      skipRemoved(oldCursor);
+      skipAdded(newCursor);
+    } else if (oldHere && (!newHere || oldNode->key < newNode->key)) {
+      skipRemoved(oldCursor);
+    } else {
+      skipAdded(newCursor);
+    }
+  }
+
+  oldTotal_ += frames_.back().oldSize;
+  newTotal_ += frames_.back().newSize;
+  out_.flush();
+}
+
+}  // namespace oi::exporters
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDED_OI_EXPORTERS_FLAME_GRAPH_H
+#define INCLUDED_OI_EXPORTERS_FLAME_GRAPH_H 1
+
+#include <oi/IntrospectionResult.h>
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace oi::exporters {
+
+/*
+ * Writes memory use in the folded stack format read by flamegraph.pl and
+ * most flame graph viewers, one line per type path:
+ *
+ *   a;b;c 1234
+ *
+ * where the frames are the node's type path and the count is the sum of the
+ * exclusive sizes of every node with that path.
+ *
+ * Sizes are summed in a table of at most setMaxStacks() paths, which is
+ * written out and cleared when full. A path may then appear on several
+ * lines; flame graph tools add them up.
+ *
+ * The elements of a container share the path "...;[]" and fold into one
+ * frame. Captured keys name each entry, e.g. "[abc]", and are folded into
+ * "[]" too unless setFoldKeys(false) is called.
+ */
+class FlameGraph {
+ public:
+  FlameGraph(std::ostream& out) : out_(out) {
+  }
+  ~FlameGraph() {
+    flush();
+  }
+
+  void setFoldKeys(bool foldKeys) {
+    foldKeys_ = foldKeys;
+  }
+  void setMaxStacks(size_t maxStacks) {
+    maxStacks_ = maxStacks;
+  }
+
+  void print(const IntrospectionResult& result) {
+    auto begin = result.cbegin();
+    print(begin, result.cend());
+  }
+
+  template <typename It>
+  void print(It& it, const It& end) {
+    for (; it != end; ++it) {
+      const result::Element& el = *it;
+      if (el.type_path.empty())
+        continue;
+      enter(el.type_path.size(), el.type_path.back());
+      add(el.exclusive_size);
+    }
+    flush();
+  }
+
+  /*
+   * Lower level interface for producers which don't have result::Elements.
+   * Makes `frame` the innermost frame of the current stack, at `depth` (1 for
+   * a root), dropping any frames deeper than its parent.
+   */
+  void enter(size_t depth, std::string_view frame) {
+    if (depth <= frameEnds_.size()) {
+      frameEnds_.resize(depth - 1);
+      stack_.resize(frameEnds_.empty() ? 0 : frameEnds_.back());
+    }
+    if (!frameEnds_.empty())
+      stack_ += ';';
+    appendFrame(frame);
+    frameEnds_.push_back(stack_.size());
+  }
+
+  // Counts `bytes` against the current stack
+  void add(size_t bytes) {
+    if (bytes == 0 || stack_.empty())
+      return;
+
+    auto [it, inserted] = sizes_.try_emplace(stack_, 0);
+    if (inserted)
+      order_.push_back(&*it);
+    it->second += bytes;
+
+    if (sizes_.size() >= maxStacks_)
+      flush();
+  }
+
+  // Writes and clears the stacks summed so far
+  void flush() {
+    std::string line;
+    for (const auto* entry : order_) {
+      line.assign(entry->first);
+      line += ' ';
+      line += std::to_string(entry->second);
+      line += '\n';
+      out_.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    order_.clear();
+    sizes_.clear();
+    out_.flush();
+  }
+
+ private:
+  std::ostream& out_;
+  bool foldKeys_ = true;
+  size_t maxStacks_ = 1 << 16;
+
+  std::string stack_;
+  std::vector<size_t> frameEnds_;  // End of each frame in stack_
+
+  // Entries in order of first use, so output follows the tree
+  std::unordered_map<std::string, size_t> sizes_;
+  std::vector<const std::pair<const std::string, size_t>*> order_;
+
+  void appendFrame(std::string_view frame) {
+    if (frame.empty()) {
+      stack_ += "[]";
+      return;
+    }
+    if (foldKeys_ && frame.size() > 2 && frame.front() == '[' &&
+        frame.back() == ']') {
+      stack_ += "[]";
+      return;
+    }
+
+    // ';' separates frames and a space the count, which is taken from the
+    // last one, so only ';' needs replacing
+    for (char c : frame)
+      stack_ += c == ';' ? ':' : c;
+  }
+};
+
+}  // namespace oi::exporters
+
+#endif
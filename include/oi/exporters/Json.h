@@ -19,14 +19,87 @@
 #include <oi/IntrospectionResult.h>
 #include <oi/result/SizedResult.h>
 
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <ostream>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace oi::exporters {
 
+namespace detail {
+
+/*
+ * Returns the index of the first character of `str` which can't appear
+ * unescaped in a JSON string (a quote, a backslash or a control character),
+ * or `str.size()` if there is none. Checks 16 bytes at a time with SSE2, or
+ * 8 bytes at a time in a 64-bit word elsewhere.
+ */
+inline size_t findJsonEscape(std::string_view str) {
+  const char* data = str.data();
+  const size_t size = str.size();
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i lastControl = _mm_set1_epi8(0x1f);
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    // v <= 0x1f (unsigned) iff max(v, 0x1f) == 0x1f
+    __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(v, lastControl), lastControl);
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+        control);
+    if (int mask = _mm_movemask_epi8(special); mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+#else
+  constexpr uint64_t ones = 0x0101010101010101ULL;
+  constexpr uint64_t highs = 0x8080808080808080ULL;
+  auto hasZero = [](uint64_t w) { return (w - ones) & ~w & highs; };
+  for (; i + 8 <= size; i += 8) {
+    uint64_t w;
+    std::memcpy(&w, data + i, sizeof(w));
+    uint64_t special = hasZero(w ^ (ones * '"')) |
+                       hasZero(w ^ (ones * '\\')) |
+                       ((w - ones * 0x20) & ~w & highs);  // any byte < 0x20
+    if (special != 0)
+      break;  // Find which byte in the scalar loop below
+  }
+#endif
+
+  for (; i < size; ++i) {
+    auto c = static_cast<unsigned char>(data[i]);
+    if (c == '"' || c == '\\' || c < 0x20)
+      return i;
+  }
+  return size;
+}
+
+}  // namespace detail
+
+/*
+ * Writes introspection results as JSON. Output is built up in a buffer which
+ * is written to the stream when it fills and at the end of each print().
+ *
+ * With setPathTable(true), the output is instead an object:
+ *   {"tree":[...],"pathTable":[[-1,"a"],[0,"b"],...]}
+ * where each element's "typePath" is an index into "pathTable". Each entry
+ * is a parent index (-1 for none) and the last component of the path, so a
+ * prefix shared by many elements is written only once.
+ */
 class Json {
  public:
   Json(std::ostream& out);
+  ~Json();
 
   template <typename Res>
   void print(const Res& r) {
@@ -40,13 +113,29 @@ class Json {
   void setPretty(bool pretty) {
     pretty_ = pretty;
   }
+  void setPathTable(bool pathTable) {
+    pathTable_ = pathTable;
+  }
+
+  // Writes any buffered output to the stream
+  void flush();
 
  private:
+  static constexpr size_t kBufferSize = 1 << 20;
+
   std::string_view tab() const;
   std::string_view space() const;
   std::string_view endl() const;
   static std::string makeIndent(size_t depth);
 
+  void write(std::string_view str);
+  void write(char c);
+  void writeUnsigned(uint64_t value);
+  void writeHex(uint64_t value);
+  static void appendEscaped(std::string& out, std::string_view str);
+  void writeEscaped(std::string_view str);
+  void writeQuoted(std::string_view str);
+
   void printStringField(std::string_view name,
                         std::string_view value,
                         std::string_view indent);
@@ -63,16 +152,41 @@ class Json {
   void printListField(std::string_view name,
                       const Rng& range,
                       std::string_view indent);
+  void printPathField(std::span<const std::string_view> typePath,
+                      std::string_view indent);
+  void printPathTable();
 
   void printFields(const result::Element&, std::string_view indent);
   template <typename El>
   void printFields(const result::SizedElement<El>&, std::string_view indent);
 
+  template <typename It>
+  void printTree(It& it, const It& end);
+
   bool pretty_ = false;
+  bool pathTable_ = false;
   std::ostream& out_;
+  std::string buf_;
+
+  // Path table state, reset by each print()
+  std::unordered_map<std::string, int64_t> pathIds_;
+  std::vector<int64_t> pathStack_;  // Path index of the latest element by depth
+  std::string pathKey_;
+  std::string pathTableJson_;
+  int64_t numPaths_ = 0;
 };
 
 inline Json::Json(std::ostream& out) : out_(out) {
+  buf_.reserve(kBufferSize);
+}
+
+inline Json::~Json() {
+  flush();
+}
+
+inline void Json::flush() {
+  out_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+  buf_.clear();
 }
 
 inline std::string_view Json::tab() const {
@@ -89,42 +203,198 @@ inline std::string Json::makeIndent(size_t depth) {
   return std::string((depth - 1) * 4, ' ');
 }
 
+inline void Json::write(std::string_view str) {
+  buf_.append(str);
+  if (buf_.size() >= kBufferSize)
+    flush();
+}
+inline void Json::write(char c) {
+  buf_.push_back(c);
+  if (buf_.size() >= kBufferSize)
+    flush();
+}
+inline void Json::writeUnsigned(uint64_t value) {
+  char digits[20];
+  auto res = std::to_chars(std::begin(digits), std::end(digits), value);
+  write(std::string_view(digits, res.ptr - digits));
+}
+inline void Json::writeHex(uint64_t value) {
+  char digits[16];
+  auto res = std::to_chars(std::begin(digits), std::end(digits), value, 16);
+  write(std::string_view(digits, res.ptr - digits));
+}
+inline void Json::appendEscaped(std::string& out, std::string_view str) {
+  while (!str.empty()) {
+    size_t pos = detail::findJsonEscape(str);
+    out.append(str.data(), pos);
+    if (pos == str.size())
+      break;
+
+    char c = str[pos];
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\r':
+        out.append("\\r");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default: {
+        constexpr char hex[] = "0123456789abcdef";
+        char escaped[] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xf], hex[c & 0xf]};
+        out.append(escaped, sizeof(escaped));
+      }
+    }
+    str.remove_prefix(pos + 1);
+  }
+}
+inline void Json::writeEscaped(std::string_view str) {
+  appendEscaped(buf_, str);
+  if (buf_.size() >= kBufferSize)
+    flush();
+}
+inline void Json::writeQuoted(std::string_view str) {
+  write('"');
+  writeEscaped(str);
+  write('"');
+}
+
 inline void Json::printStringField(std::string_view name,
                                    std::string_view value,
                                    std::string_view indent) {
-  out_ << tab() << '"' << name << '"' << ':' << space() << "\"" << value
-       << "\"," << endl() << indent;
+  write(tab());
+  writeQuoted(name);
+  write(':');
+  write(space());
+  writeQuoted(value);
+  write(',');
+  write(endl());
+  write(indent);
 }
 inline void Json::printBoolField(std::string_view name,
                                  bool value,
                                  std::string_view indent) {
-  out_ << tab() << '"' << name << "\":" << space() << (value ? "true" : "false")
-       << ',' << endl() << indent;
+  write(tab());
+  writeQuoted(name);
+  write(':');
+  write(space());
+  write(value ? "true" : "false");
+  write(',');
+  write(endl());
+  write(indent);
 }
 inline void Json::printUnsignedField(std::string_view name,
                                      uint64_t value,
                                      std::string_view indent) {
-  out_ << tab() << '"' << name << "\":" << space() << value << ',' << endl()
-       << indent;
+  write(tab());
+  writeQuoted(name);
+  write(':');
+  write(space());
+  writeUnsigned(value);
+  write(',');
+  write(endl());
+  write(indent);
 }
 inline void Json::printPointerField(std::string_view name,
                                     uintptr_t value,
                                     std::string_view indent) {
-  out_ << tab() << '"' << name << "\":" << space() << "\"0x" << std::hex
-       << value << std::dec << "\"," << endl() << indent;
+  write(tab());
+  writeQuoted(name);
+  write(':');
+  write(space());
+  write("\"0x");
+  writeHex(value);
+  write("\",");
+  write(endl());
+  write(indent);
 }
 template <typename Rng>
 void Json::printListField(std::string_view name,
                           const Rng& range,
                           std::string_view indent) {
-  out_ << tab() << '"' << name << '"' << ':' << space() << '[';
+  write(tab());
+  writeQuoted(name);
+  write(':');
+  write(space());
+  write('[');
   bool first = true;
   for (const auto& el : range) {
-    if (!std::exchange(first, false))
-      out_ << ',' << space();
-    out_ << '"' << el << '"';
+    if (!std::exchange(first, false)) {
+      write(',');
+      write(space());
+    }
+    writeQuoted(el);
   }
-  out_ << "]," << endl() << indent;
+  write("],");
+  write(endl());
+  write(indent);
+}
+
+inline void Json::printPathField(std::span<const std::string_view> typePath,
+                                 std::string_view indent) {
+  if (typePath.empty()) {
+    printListField("typePath", typePath, indent);
+    return;
+  }
+
+  // Elements come in pre-order, so the parent of an element at depth N is the
+  // latest element seen at depth N-1
+  const size_t depth = typePath.size();
+  const int64_t parent = depth >= 2 && depth - 2 < pathStack_.size()
+                             ? pathStack_[depth - 2]
+                             : -1;
+
+  pathKey_.assign(reinterpret_cast<const char*>(&parent), sizeof(parent));
+  pathKey_.append(typePath.back());
+
+  int64_t id;
+  if (auto it = pathIds_.find(pathKey_); it != pathIds_.end()) {
+    id = it->second;
+  } else {
+    id = numPaths_++;
+    pathIds_.emplace(pathKey_, id);
+
+    if (id != 0)
+      pathTableJson_ += ',';
+    pathTableJson_ += '[';
+    if (parent < 0) {
+      pathTableJson_ += "-1";
+    } else {
+      char digits[20];
+      auto res = std::to_chars(std::begin(digits), std::end(digits), parent);
+      pathTableJson_.append(digits, res.ptr);
+    }
+    pathTableJson_ += ",\"";
+    appendEscaped(pathTableJson_, typePath.back());
+    pathTableJson_ += "\"]";
+  }
+
+  pathStack_.resize(depth);
+  pathStack_[depth - 1] = id;
+
+  write(tab());
+  write("\"typePath\":");
+  write(space());
+  writeUnsigned(static_cast<uint64_t>(id));
+  write(',');
+  write(endl());
+  write(indent);
+}
+
+inline void Json::printPathTable() {
+  write("\"pathTable\":");
+  write(space());
+  write('[');
+  write(pathTableJson_);
+  write(']');
 }
 
 template <typename El>
@@ -138,7 +408,10 @@ void Json::printFields(const result::SizedElement<El>& el,
 inline void Json::printFields(const result::Element& el,
                               std::string_view indent) {
   printStringField("name", el.name, indent);
-  printListField("typePath", el.type_path, indent);
+  if (pathTable_)
+    printPathField(el.type_path, indent);
+  else
+    printListField("typePath", el.type_path, indent);
   printListField("typeNames", el.type_names, indent);
   printUnsignedField("staticSize", el.static_size, indent);
   printUnsignedField("exclusiveSize", el.exclusive_size, indent);
@@ -159,40 +432,89 @@ inline void Json::printFields(const result::Element& el,
   }
   if (el.is_set_stats.has_value())
     printBoolField("is_set", el.is_set_stats->is_set, indent);
+  if (const auto& h = el.hash_table_stats; h.has_value()) {
+    printUnsignedField("buckets", h->buckets, indent);
+    printUnsignedField("emptyBuckets", h->empty_buckets, indent);
+    printUnsignedField("longestChain", h->longest_chain, indent);
+    printUnsignedField("overflowedBuckets", h->overflowed_buckets, indent);
+  }
+  if (el.allocated_size.has_value())
+    printUnsignedField("allocatedSize", *el.allocated_size, indent);
   printBoolField("is_primitive", el.is_primitive, indent);
 }
 
 template <typename It>
 void Json::print(It& it, const It& end) {
+  if (pathTable_) {
+    pathIds_.clear();
+    pathStack_.clear();
+    pathTableJson_.clear();
+    numPaths_ = 0;
+
+    write("{\"tree\":");
+    write(space());
+  }
+
+  printTree(it, end);
+
+  if (pathTable_) {
+    write(',');
+    write(space());
+    printPathTable();
+    write('}');
+    write(endl());
+  }
+  flush();
+}
+
+template <typename It>
+void Json::printTree(It& it, const It& end) {
   const auto depth = it->type_path.size();
 
   const auto thisIndent = pretty_ ? makeIndent(depth) : "";
   const auto lastIndent = pretty_ ? makeIndent(depth - 1) : "";
 
-  out_ << '[' << endl() << thisIndent;
+  write('[');
+  write(endl());
+  write(thisIndent);
 
   bool first = true;
   while (it != end && it->type_path.size() >= depth) {
-    if (!std::exchange(first, false))
-      out_ << ',' << endl() << thisIndent;
+    if (!std::exchange(first, false)) {
+      write(',');
+      write(endl());
+      write(thisIndent);
+    }
 
-    out_ << '{' << endl() << thisIndent;
+    write('{');
+    write(endl());
+    write(thisIndent);
 
     printFields(*it, thisIndent);
 
-    out_ << tab() << "\"members\":" << space();
+    write(tab());
+    write("\"members\":");
+    write(space());
     if (++it != end && it->type_path.size() > depth) {
-      print(it, end);
+      printTree(it, end);
     } else {
-      out_ << "[]" << endl();
+      write("[]");
+      write(endl());
     }
 
-    out_ << thisIndent << "}";
+    write(thisIndent);
+    write('}');
   }
   if (depth == 1) {
-    out_ << endl() << ']' << endl();
+    write(endl());
+    write(']');
+    write(endl());
   } else {
-    out_ << endl() << lastIndent << tab() << ']' << endl();
+    write(endl());
+    write(lastIndent);
+    write(tab());
+    write(']');
+    write(endl());
   }
 }
 
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDED_OI_EXPORTERS_TYPE_HISTOGRAM_H
+#define INCLUDED_OI_EXPORTERS_TYPE_HISTOGRAM_H 1
+
+#include <oi/IntrospectionResult.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace oi::exporters {
+
+/*
+ * Aggregates introspection results by type name: instance count, summed
+ * inclusive and exclusive sizes, and log2 histograms of the inclusive size
+ * and of containers' length and capacity.
+ *
+ * Each result is read once. Inclusive sizes are summed on a stack of the
+ * current node's ancestors, so memory is one entry per type plus the depth
+ * of the tree. Results can be added repeatedly, e.g. from a periodic
+ * exporter, and the totals accumulate until clear().
+ *
+ * Nodes are counted under the first of their type names, which is the type
+ * as written in the code.
+ */
+class TypeHistogram {
+ public:
+  // Bucket i counts values v with std::bit_width(v) == i, i.e. bucket 0
+  // holds 0 and bucket i > 0 holds [2^(i-1), 2^i)
+  static constexpr size_t kBuckets = 65;
+  using Buckets = std::array<uint64_t, kBuckets>;
+
+  struct Stats {
+    uint64_t count = 0;
+    uint64_t inclusiveSize = 0;
+    uint64_t exclusiveSize = 0;
+    Buckets sizes{};
+
+    // Only nodes with container stats are counted here
+    uint64_t containers = 0;
+    uint64_t length = 0;
+    uint64_t capacity = 0;
+    Buckets lengths{};
+    Buckets capacities{};
+  };
+
+  enum class SortBy { Inclusive, Exclusive, Count };
+
+  void add(const IntrospectionResult& result) {
+    auto begin = result.cbegin();
+    add(begin, result.cend());
+  }
+
+  /*
+   * Adds the elements of one result, in pre-order. Type names are looked up
+   * by address first, so the views must stay valid until this returns, as
+   * those of an IntrospectionResult do.
+   */
+  template <typename It>
+  void add(It& it, const It& end) {
+    byAddress_.clear();
+    for (; it != end; ++it) {
+      const result::Element& el = *it;
+      const size_t depth = el.type_path.size();
+      while (!frames_.empty() && frames_.back().depth >= depth)
+        popFrame();
+
+      std::string_view name =
+          el.type_names.empty() ? std::string_view{} : el.type_names.front();
+      auto [cached, inserted] =
+          byAddress_.try_emplace(Address{name.data(), name.size()}, nullptr);
+      if (inserted)
+        cached->second = &stats(name);
+
+      Stats& s = *cached->second;
+      s.count++;
+      s.exclusiveSize += el.exclusive_size;
+      if (const auto& cs = el.container_stats; cs.has_value())
+        addContainer(s, cs->length, cs->capacity);
+
+      frames_.push_back(Frame{depth, &s, el.exclusive_size});
+    }
+    while (!frames_.empty())
+      popFrame();
+  }
+
+  /*
+   * Adds a single node whose inclusive size is already known, for producers
+   * which don't have result::Elements, e.g. TreeBuilder.
+   */
+  void add(std::string_view typeName,
+           size_t inclusiveSize,
+           size_t exclusiveSize,
+           const result::Element::ContainerStats* containerStats = nullptr) {
+    Stats& s = stats(typeName);
+    s.count++;
+    s.exclusiveSize += exclusiveSize;
+    s.inclusiveSize += inclusiveSize;
+    s.sizes[std::bit_width(inclusiveSize)]++;
+    if (containerStats != nullptr)
+      addContainer(s, containerStats->length, containerStats->capacity);
+  }
+
+  const Stats* find(std::string_view typeName) const {
+    auto it = stats_.find(typeName);
+    return it == stats_.end() ? nullptr : &it->second;
+  }
+
+  void clear() {
+    stats_.clear();
+    byAddress_.clear();
+  }
+
+  /*
+   * Writes the `top` largest types, or all of them, as tab-separated columns:
+   *
+   *   count inclusive exclusive sizes lengths capacities type
+   *
+   * Each histogram is written as space-separated "low:count" pairs for its
+   * non-empty buckets, where low is the smallest value in the bucket.
+   */
+  void print(std::ostream& out,
+             SortBy sortBy = SortBy::Inclusive,
+             size_t top = SIZE_MAX) const {
+    std::vector<const std::pair<const std::string, Stats>*> rows;
+    rows.reserve(stats_.size());
+    for (const auto& entry : stats_)
+      rows.push_back(&entry);
+
+    auto key = [sortBy](const Stats& s) {
+      switch (sortBy) {
+        case SortBy::Exclusive:
+          return s.exclusiveSize;
+        case SortBy::Count:
+          return s.count;
+        case SortBy::Inclusive:
+          break;
+      }
+      return s.inclusiveSize;
+    };
+    size_t n = std::min(top, rows.size());
+    std::partial_sort(
+        rows.begin(), rows.begin() + n, rows.end(), [&](auto* a, auto* b) {
+          auto ka = key(a->second);
+          auto kb = key(b->second);
+          return ka > kb || (ka == kb && a->first < b->first);
+        });
+
+    out << "count\tinclusive\texclusive\tsizes\tlengths\tcapacities\ttype\n";
+    std::string line;
+    for (size_t i = 0; i < n; i++) {
+      const auto& [name, s] = *rows[i];
+      line += std::to_string(s.count);
+      line += '\t';
+      line += std::to_string(s.inclusiveSize);
+      line += '\t';
+      line += std::to_string(s.exclusiveSize);
+      line += '\t';
+      appendBuckets(line, s.sizes);
+      line += '\t';
+      appendBuckets(line, s.lengths);
+      line += '\t';
+      appendBuckets(line, s.capacities);
+      line += '\t';
+      line += name;
+      line += '\n';
+      out.write(line.data(), static_cast<std::streamsize>(line.size()));
+      line.clear();
+    }
+  }
+
+ private:
+  struct Frame {
+    size_t depth;
+    Stats* stats;
+    size_t inclusiveSize;
+  };
+
+  using Address = std::pair<const char*, size_t>;
+  struct AddressHash {
+    size_t operator()(const Address& a) const {
+      return std::hash<const char*>{}(a.first) ^ a.second;
+    }
+  };
+
+  struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const {
+      return std::hash<std::string_view>{}(name);
+    }
+  };
+
+  std::unordered_map<std::string, Stats, NameHash, std::equal_to<>> stats_;
+  // Skips hashing the name when it's seen again at the same address
+  std::unordered_map<Address, Stats*, AddressHash> byAddress_;
+  std::vector<Frame> frames_;
+
+  Stats& stats(std::string_view name) {
+    auto it = stats_.find(name);
+    if (it == stats_.end())
+      it = stats_.emplace(std::string{name}, Stats{}).first;
+    return it->second;
+  }
+
+  static void addContainer(Stats& s, size_t length, size_t capacity) {
+    s.containers++;
+    s.length += length;
+    s.capacity += capacity;
+    s.lengths[std::bit_width(length)]++;
+    s.capacities[std::bit_width(capacity)]++;
+  }
+
+  void popFrame() {
+    Frame frame = frames_.back();
+    frames_.pop_back();
+    frame.stats->inclusiveSize += frame.inclusiveSize;
+    frame.stats->sizes[std::bit_width(frame.inclusiveSize)]++;
+    if (!frames_.empty())
+      frames_.back().inclusiveSize += frame.inclusiveSize;
+  }
+
+  static void appendBuckets(std::string& line, const Buckets& buckets) {
+    bool first = true;
+    for (size_t i = 0; i < buckets.size(); i++) {
+      if (buckets[i] == 0)
+        continue;
+      if (!first)
+        line += ' ';
+      first = false;
+      line += std::to_string(i == 0 ? 0 : uint64_t{1} << (i - 1));
+      line += ':';
+      line += std::to_string(buckets[i]);
+    }
+    if (first)
+      line += '-';
+  }
+};
+
+}  // namespace oi::exporters
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef INCLUDED_OI_EXPORTERS_ZSTDSTREAM_H
+#define INCLUDED_OI_EXPORTERS_ZSTDSTREAM_H 1
+
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+
+namespace oi::exporters {
+
+// An output stream which compresses everything written to it into a single
+// zstd frame on `sink`. Pass it to an exporter in place of the file stream:
+//
+//   std::ofstream file{"out.csv.zst", std::ios::binary};
+//   ZstdStream zstd{file};
+//   CSV{zstd}.print(result);
+//
+// The frame is finished by close() or on destruction.
+class ZstdStream : public std::ostream {
+ public:
+  explicit ZstdStream(std::ostream& sink, int level = 3);
+  ~ZstdStream() override;
+
+  ZstdStream(const ZstdStream&) = delete;
+  ZstdStream& operator=(const ZstdStream&) = delete;
+
+  void close();
+
+ private:
+  class Buf : public std::streambuf {
+   public:
+    Buf(std::ostream& sink, int level);
+    ~Buf() override;
+
+    bool finish();
+
+   protected:
+    int_type overflow(int_type c) override;
+    int sync() override;
+
+   private:
+    std::ostream& sink_;
+    ZSTD_CCtx_s* cctx_;
+    std::vector<char> in_;
+    std::vector<char> out_;
+    bool finished_ = false;
+
+    bool compress(bool end);
+  };
+
+  Buf buf_;
+};
+
+}  // namespace oi::exporters
+
+#endif
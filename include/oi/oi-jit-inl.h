@@ -36,6 +36,15 @@ inline std::optional<IntrospectionResult> setupAndIntrospect(
   return CodegenHandler<T, Fs...>::introspect(objectAddr);
 }
 
+template <typename T, Feature... Fs>
+inline std::optional<BatchIntrospectionResult> setupAndIntrospectBatch(
+    std::span<const T* const> objects, const GeneratorOptions& opts) {
+  if (!CodegenHandler<T, Fs...>::init(opts))
+    return std::nullopt;
+
+  return CodegenHandler<T, Fs...>::introspectBatch(objects);
+}
+
 template <typename T, Feature... Fs>
 inline std::atomic<bool>& CodegenHandler<T, Fs...>::getIsCritical() {
   static std::atomic<bool> isCritical = false;
@@ -45,47 +54,150 @@ inline std::atomic<bool>& CodegenHandler<T, Fs...>::getIsCritical() {
 template <typename T, Feature... Fs>
 inline std::atomic<void (*)(const T&, std::vector<uint8_t>&)>&
 CodegenHandler<T, Fs...>::getIntrospectionFunc() {
+  // Never set, OILibrary finds the type to introspect from the type of this
+  // function. Readers load the function of the current tier from getTier().
   static std::atomic<void (*)(const T&, std::vector<uint8_t>&)> func = nullptr;
   return func;
 }
 
 template <typename T, Feature... Fs>
-inline std::atomic<const exporters::inst::Inst*>&
-CodegenHandler<T, Fs...>::getTreeBuilderInstructions() {
-  static std::atomic<const exporters::inst::Inst*> ty = nullptr;
-  return ty;
+inline std::atomic<const typename CodegenHandler<T, Fs...>::Tier*>&
+CodegenHandler<T, Fs...>::getTier() {
+  static std::atomic<const Tier*> tier = nullptr;
+  return tier;
+}
+
+template <typename T, Feature... Fs>
+inline std::atomic<const detail::Interpreter*>&
+CodegenHandler<T, Fs...>::getInterpreter() {
+  static std::atomic<const detail::Interpreter*> interpreter = nullptr;
+  return interpreter;
+}
+
+template <typename T, Feature... Fs>
+inline std::jthread& CodegenHandler<T, Fs...>::getOptimiserThread() {
+  // Requests a stop and joins on static destruction. A compile already running
+  // can't be interrupted, but its code is never published once stopped.
+  static std::jthread optimiser;
+  return optimiser;
+}
+
+template <typename T, Feature... Fs>
+inline void CodegenHandler<T, Fs...>::publish(Tier tier) {
+  // Never freed, like the code it points to: other threads may still be using
+  // the previous tier.
+  getTier().store(new Tier{tier});
 }
 
 template <typename T, Feature... Fs>
 inline bool CodegenHandler<T, Fs...>::init(const GeneratorOptions& opts) {
-  if (getIntrospectionFunc().load() != nullptr &&
-      getTreeBuilderInstructions().load() != nullptr)
+  if (getTier().load() != nullptr)
     return true;  // already initialised
   if (getIsCritical().exchange(true))
     return false;  // other thread is initialising/has failed
 
-  auto lib =
-      OILibrary(reinterpret_cast<void*>(&getIntrospectionFunc), {Fs...}, opts);
-  auto [vfp, ty] = lib.init();
+  auto lib = std::make_shared<OILibrary>(
+      reinterpret_cast<void*>(&getIntrospectionFunc),
+      std::unordered_set<Feature>{Fs...},
+      opts);
+
+  // Compiles the final tier in the background and swaps it in
+  auto optimiseInBackground = [&lib](auto compile) {
+    getOptimiserThread() =
+        std::jthread{[lib = std::move(lib), compile](std::stop_token stop) {
+          if (stop.stop_requested())
+            return;
+          try {
+            auto [fp, bfp, ty] = compile(*lib);
+            if (stop.stop_requested())
+              return;
+            publish(Tier{reinterpret_cast<func_type>(fp),
+                         reinterpret_cast<batch_func_type>(bfp),
+                         &ty,
+                         true});
+          } catch (const std::exception&) {
+            // Keep using the first tier.
+          }
+        }};
+  };
+
+  if (opts.interpretFirst) {
+    if (auto interp = lib->interpret()) {
+      getInterpreter().store(&interp->interpreter);
+      publish(
+          Tier{&interpreted, &interpretedBatch, &interp->instructions, false});
+      optimiseInBackground([](OILibrary& l) { return l.init(); });
+      return true;
+    }
+  }
 
-  getIntrospectionFunc().store(reinterpret_cast<func_type>(vfp));
-  getTreeBuilderInstructions().store(&ty);
+  auto [vfp, bfp, ty] = lib->init();
+  publish(Tier{reinterpret_cast<func_type>(vfp),
+               reinterpret_cast<batch_func_type>(bfp),
+               &ty,
+               !opts.tieredCompilation});
+
+  if (opts.tieredCompilation)
+    optimiseInBackground([](OILibrary& l) { return l.optimise(); });
   return true;
 }
 
+template <typename T, Feature... Fs>
+inline bool CodegenHandler<T, Fs...>::waitForOptimiser() {
+  if (auto& optimiser = getOptimiserThread(); optimiser.joinable())
+    optimiser.join();
+
+  const Tier* tier = getTier().load();
+  return tier != nullptr && tier->optimised;
+}
+
+template <typename T, Feature... Fs>
+inline void CodegenHandler<T, Fs...>::interpreted(const T& objectAddr,
+                                                  std::vector<uint8_t>& v) {
+  OILibrary::introspectInterpreted(*getInterpreter().load(), &objectAddr, v);
+}
+
+template <typename T, Feature... Fs>
+inline void CodegenHandler<T, Fs...>::interpretedBatch(
+    const T* const* objects,
+    size_t n,
+    std::vector<uint8_t>& v,
+    std::vector<size_t>& offsets) {
+  OILibrary::introspectBatchInterpreted(
+      *getInterpreter().load(),
+      reinterpret_cast<const void* const*>(objects),
+      n,
+      v,
+      offsets);
+}
+
 template <typename T, Feature... Fs>
 inline IntrospectionResult CodegenHandler<T, Fs...>::introspect(
     const T& objectAddr) {
-  func_type func = getIntrospectionFunc().load();
-  const exporters::inst::Inst* ty = getTreeBuilderInstructions().load();
-
-  if (func == nullptr || ty == nullptr)
+  const Tier* tier = getTier().load();
+  if (tier == nullptr)
     throw std::logic_error("introspect(const T&) called when uninitialised");
 
   std::vector<uint8_t> buf;
   static_assert(sizeof(std::vector<uint8_t>) == 24);
-  func(objectAddr, buf);
-  return IntrospectionResult{std::move(buf), *ty};
+  tier->func(objectAddr, buf);
+  return IntrospectionResult{std::move(buf), *tier->instructions};
+}
+
+template <typename T, Feature... Fs>
+inline BatchIntrospectionResult CodegenHandler<T, Fs...>::introspectBatch(
+    std::span<const T* const> objects) {
+  const Tier* tier = getTier().load();
+  if (tier == nullptr)
+    throw std::logic_error(
+        "introspectBatch(std::span<const T* const>) called when "
+        "uninitialised");
+
+  std::vector<uint8_t> buf;
+  std::vector<size_t> offsets;
+  tier->batchFunc(objects.data(), objects.size(), buf, offsets);
+  return BatchIntrospectionResult{
+      std::move(buf), std::move(offsets), *tier->instructions};
 }
 
 }  // namespace oi
@@ -20,16 +20,20 @@
 #include <filesystem>
 #include <memory>
 #include <optional>
+#include <span>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "oi/BatchIntrospectionResult.h"
 #include "oi/exporters/inst.h"
 #include "oi/oi.h"
 
 namespace oi::detail {
+class Interpreter;
 class OILibraryImpl;
-}
+}  // namespace oi::detail
 
 namespace oi {
 
@@ -37,15 +41,65 @@ struct GeneratorOptions {
   std::vector<std::filesystem::path> configFilePaths;
   std::filesystem::path sourceFileDumpPath;
   int debugLevel = 0;
+
+  /*
+   * Compile at -O0 first and publish that function straight away, then
+   * recompile at -O3 on a background thread and swap the optimised function in
+   * once it is ready.
+   */
+  bool tieredCompilation = false;
+
+  /*
+   * Walk objects with a bytecode interpreter built into OIL while the
+   * traversal function is compiled on a background thread, so the first
+   * results need no compilation at all. Types the interpreter can't walk, such
+   * as containers, are compiled up front as usual.
+   */
+  bool interpretFirst = false;
+
+  /*
+   * Lower types the interpreter supports straight to LLVM IR and compile that,
+   * skipping the clang frontend. Types with containers still compile the
+   * generated C++.
+   */
+  bool lowerToIR = false;
 };
 
 class OILibrary {
  public:
+  struct Functions {
+    void* introspect;
+    void* introspectBatch;
+    const exporters::inst::Inst& instructions;
+  };
+
+  struct Interpreted {
+    const detail::Interpreter& interpreter;
+    const exporters::inst::Inst& instructions;
+  };
+
   OILibrary(void* atomicHome,
             std::unordered_set<Feature>,
             GeneratorOptions opts);
   ~OILibrary();
-  std::pair<void*, const exporters::inst::Inst&> init();
+  Functions init();
+  Functions optimise();
+
+  /*
+   * Generates the type graph and lowers it to interpreter bytecode without
+   * compiling anything. Returns std::nullopt if the type isn't supported by
+   * the interpreter. A later init() reuses the generated code.
+   */
+  std::optional<Interpreted> interpret();
+  static void introspectInterpreted(const detail::Interpreter& interpreter,
+                                    const void* object,
+                                    std::vector<uint8_t>& v);
+  static void introspectBatchInterpreted(
+      const detail::Interpreter& interpreter,
+      const void* const* objects,
+      size_t n,
+      std::vector<uint8_t>& v,
+      std::vector<size_t>& offsets);
 
  private:
   std::unique_ptr<detail::OILibraryImpl> pimpl_;
@@ -61,19 +115,57 @@ template <typename T, Feature... Fs>
 std::optional<IntrospectionResult> setupAndIntrospect(
     const T& objectAddr, const GeneratorOptions& opts);
 
+/*
+ * setupAndIntrospectBatch
+ *
+ * As setupAndIntrospect, but introspects many objects of the same type in one
+ * traversal sharing a single pointer set. See BatchIntrospectionResult.
+ */
+template <typename T, Feature... Fs>
+std::optional<BatchIntrospectionResult> setupAndIntrospectBatch(
+    std::span<const T* const> objects, const GeneratorOptions& opts);
+
 template <typename T, Feature... Fs>
 class CodegenHandler {
  public:
   static bool init(const GeneratorOptions& opts);
   static IntrospectionResult introspect(const T& objectAddr);
+  static BatchIntrospectionResult introspectBatch(
+      std::span<const T* const> objects);
+
+  /*
+   * Waits for a background compile started by init() with tieredCompilation
+   * or interpretFirst. Returns whether its code has replaced the first tier.
+   */
+  static bool waitForOptimiser();
 
  private:
   using func_type = void (*)(const T&, std::vector<uint8_t>&);
+  using batch_func_type = void (*)(const T* const*,
+                                   size_t,
+                                   std::vector<uint8_t>&,
+                                   std::vector<size_t>&);
+
+  // Everything a reader needs from one tier, swapped in a single store
+  struct Tier {
+    func_type func;
+    batch_func_type batchFunc;
+    const exporters::inst::Inst* instructions;
+    bool optimised;
+  };
+
+  static void publish(Tier tier);
+  static void interpreted(const T& objectAddr, std::vector<uint8_t>& v);
+  static void interpretedBatch(const T* const* objects,
+                               size_t n,
+                               std::vector<uint8_t>& v,
+                               std::vector<size_t>& offsets);
 
   static std::atomic<bool>& getIsCritical();
   static std::atomic<func_type>& getIntrospectionFunc();
-  static std::atomic<const exporters::inst::Inst*>&
-  getTreeBuilderInstructions();
+  static std::atomic<const Tier*>& getTier();
+  static std::atomic<const detail::Interpreter*>& getInterpreter();
+  static std::jthread& getOptimiserThread();
 };
 
 }  // namespace oi
@@ -33,6 +33,17 @@ struct Element {
   struct IsSetStats {
     bool is_set;
   };
+  // Only captured with the hash-table-stats feature. F14 tables probe
+  // chunks of slots rather than chaining, so their buckets are chunks.
+  struct HashTableStats {
+    size_t buckets;
+    size_t empty_buckets;
+    // Most entries in one bucket, or for F14 the most chunks probed to find
+    // a key
+    size_t longest_chain;
+    // F14 only: chunks which overflowed into the next chunk probed
+    size_t overflowed_buckets;
+  };
   struct Pointer {
     uintptr_t p;
   };
@@ -51,6 +62,11 @@ struct Element {
       std::nullopt};
   std::optional<ContainerStats> container_stats;
   std::optional<IsSetStats> is_set_stats;
+  std::optional<HashTableStats> hash_table_stats;
+  // Only captured with the allocator-size-classes feature. The heap memory of
+  // this element's own allocations, each rounded up to the allocator's size
+  // class. Its children's allocations aren't included.
+  std::optional<size_t> allocated_size;
   bool is_primitive;
 };
 
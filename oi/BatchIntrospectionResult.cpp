@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <oi/BatchIntrospectionResult.h>
+#include <oi/result/SizedResult.h>
+
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace oi {
+
+BatchIntrospectionResult::RootView::RootView(
+    std::vector<uint8_t>::const_iterator begin,
+    std::vector<uint8_t>::const_iterator end,
+    exporters::inst::Inst inst)
+    : begin_(begin), end_(end), inst_(inst) {
+}
+
+IntrospectionResult::const_iterator BatchIntrospectionResult::RootView::begin()
+    const {
+  return cbegin();
+}
+IntrospectionResult::const_iterator
+BatchIntrospectionResult::RootView::cbegin() const {
+  auto it = IntrospectionResult::const_iterator{begin_, inst_};
+  ++it;
+  return it;
+}
+IntrospectionResult::const_iterator BatchIntrospectionResult::RootView::end()
+    const {
+  return cend();
+}
+IntrospectionResult::const_iterator BatchIntrospectionResult::RootView::cend()
+    const {
+  return {end_};
+}
+
+BatchIntrospectionResult::BatchIntrospectionResult(
+    std::vector<uint8_t> buf,
+    std::vector<size_t> rootOffsets,
+    exporters::inst::Inst inst)
+    : buf_(std::move(buf)), rootOffsets_(std::move(rootOffsets)), inst_(inst) {
+}
+
+size_t BatchIntrospectionResult::size() const {
+  return rootOffsets_.size();
+}
+
+BatchIntrospectionResult::RootView BatchIntrospectionResult::operator[](
+    size_t i) const {
+  if (i >= rootOffsets_.size())
+    throw std::out_of_range("batch root index out of range");
+
+  auto begin = buf_.cbegin() + rootOffsets_[i];
+  auto end = i + 1 < rootOffsets_.size() ? buf_.cbegin() + rootOffsets_[i + 1]
+                                         : buf_.cend();
+  return {begin, end, inst_};
+}
+
+/*
+ * A pointer is expanded below the first root to reach it and recorded as not
+ * followed anywhere after that. Pointed-to data is moved from its owning root
+ * to the shared bucket once another root is seen referencing the same
+ * address. Only the outermost shared expansion is moved, as its size already
+ * includes any shared data nested inside it.
+ */
+BatchIntrospectionResult::Totals BatchIntrospectionResult::totals() const {
+  constexpr size_t kNoParent = std::numeric_limits<size_t>::max();
+
+  struct Expansion {
+    size_t root;
+    size_t bytes;
+    size_t parent;
+    bool shared;
+  };
+  struct OpenExpansion {
+    size_t depth;
+    size_t index;
+  };
+
+  Totals out;
+  out.roots.reserve(size());
+
+  std::vector<Expansion> expansions;
+  std::unordered_map<uintptr_t, size_t> expandedAt;
+  std::vector<OpenExpansion> open;
+
+  for (size_t root = 0; root < size(); ++root) {
+    open.clear();
+    bool first = true;
+    for (const auto& el : result::SizedResult{(*this)[root]}) {
+      if (first) {
+        out.roots.push_back(el.size);
+        first = false;
+      }
+
+      size_t depth = el.type_path.size();
+      while (!open.empty() && open.back().depth >= depth)
+        open.pop_back();
+
+      if (!el.pointer.has_value() || *el.pointer == 0 ||
+          !el.container_stats.has_value())
+        continue;
+
+      if (el.container_stats->length != 0) {
+        size_t parent = open.empty() ? kNoParent : open.back().index;
+        expandedAt.emplace(*el.pointer, expansions.size());
+        open.push_back({depth, expansions.size()});
+        expansions.push_back(Expansion{
+            .root = root,
+            .bytes = el.size - el.exclusive_size,
+            .parent = parent,
+            .shared = false,
+        });
+      } else if (auto it = expandedAt.find(*el.pointer);
+                 it != expandedAt.end()) {
+        auto& exp = expansions[it->second];
+        if (exp.root != root)
+          exp.shared = true;
+      }
+    }
+    if (first)
+      out.roots.push_back(0);
+  }
+
+  for (const auto& exp : expansions) {
+    if (!exp.shared)
+      continue;
+
+    bool nested = false;
+    for (size_t p = exp.parent; p != kNoParent; p = expansions[p].parent) {
+      if (expansions[p].shared) {
+        nested = true;
+        break;
+      }
+    }
+    if (nested)
+      continue;
+
+    assert(out.roots[exp.root] >= exp.bytes);
+    out.roots[exp.root] -= exp.bytes;
+    out.shared += exp.bytes;
+  }
+
+  return out;
+}
+
+}  // namespace oi
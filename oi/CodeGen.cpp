@@ -29,10 +29,12 @@
 #include "type_graph/AddChildren.h"
 #include "type_graph/AddPadding.h"
 #include "type_graph/AlignmentCalc.h"
+#include "type_graph/ClassHierarchyIndex.h"
 #include "type_graph/DrgnExporter.h"
 #include "type_graph/DrgnParser.h"
 #include "type_graph/EnforceCompatibility.h"
 #include "type_graph/Flattener.h"
+#include "type_graph/FoldEquivalentClasses.h"
 #include "type_graph/IdentifyContainers.h"
 #include "type_graph/KeyCapture.h"
 #include "type_graph/NameGen.h"
@@ -78,16 +80,14 @@ using type_graph::TypeIdentifier;
 template <typename T>
 using ref = std::reference_wrapper<T>;
 
-namespace {
-
-std::vector<std::string_view> enumerateTypeNames(Type& type) {
+std::vector<std::string_view> enumerateTypeNames(const Type& type) {
   std::vector<std::string_view> names;
-  Type* t = &type;
+  const Type* t = &type;
 
-  if (const auto* ck = dynamic_cast<CaptureKeys*>(t))
+  if (const auto* ck = dynamic_cast<const CaptureKeys*>(t))
     t = &ck->underlyingType();
 
-  while (const Typedef* td = dynamic_cast<Typedef*>(t)) {
+  while (const auto* td = dynamic_cast<const Typedef*>(t)) {
     names.emplace_back(t->inputName());
     t = &td->underlyingType();
   }
@@ -95,6 +95,8 @@ std::vector<std::string_view> enumerateTypeNames(Type& type) {
   return names;
 }
 
+namespace {
+
 void defineMacros(std::string& code) {
   if (true /* TODO: config.useDataSegment*/) {
     code += R"(
@@ -196,8 +198,6 @@ void genDecls(const TypeGraph& typeGraph, std::string& code) {
   }
 }
 
-namespace {
-
 size_t calculateExclusiveSize(const Type& t) {
   const Type* finalType = &t;
   while (const auto* td = dynamic_cast<const Typedef*>(finalType)) {
@@ -205,8 +205,9 @@ size_t calculateExclusiveSize(const Type& t) {
   }
 
   if (const auto* c = dynamic_cast<const Class*>(finalType)) {
+    const auto& members = c->members();
     return std::accumulate(
-        c->members.cbegin(), c->members.cend(), 0, [](size_t a, const auto& m) {
+        members.cbegin(), members.cend(), 0, [](size_t a, const auto& m) {
           if (m.name.starts_with(AddPadding::MemberPrefix))
             return a + m.type().size();
           return a;
@@ -215,8 +216,6 @@ size_t calculateExclusiveSize(const Type& t) {
   return finalType->size();
 }
 
-}  // namespace
-
 void genNames(const TypeGraph& typeGraph, std::string& code) {
   code += R"(
 template <typename T>
@@ -332,7 +331,7 @@ void CodeGen::genDefsThrift(const TypeGraph& typeGraph, std::string& code) {
   for (const Type& t : typeGraph.finalTypes) {
     if (const auto* c = dynamic_cast<const Class*>(&t)) {
       const Member* issetMember = nullptr;
-      for (const auto& member : c->members) {
+      for (const auto& member : c->members()) {
         if (const auto* container =
                 dynamic_cast<const Container*>(&member.type());
             container && container->containerInfo_.ctype == THRIFT_ISSET_TYPE) {
@@ -360,8 +359,8 @@ void genDefsClass(const Class& c, std::string& code) {
     code += "__attribute__((__packed__)) ";
   }
 
-  if (c.members.size() == 1 &&
-      c.members[0].name.starts_with(AddPadding::MemberPrefix)) {
+  if (c.members().size() == 1 &&
+      c.members()[0].name.starts_with(AddPadding::MemberPrefix)) {
     // Need to specify alignment manually for types which have been stubbed.
     // It would be nice to do this for all types, but our alignment information
     // is not complete, so it would result in some errors.
@@ -372,7 +371,7 @@ void genDefsClass(const Class& c, std::string& code) {
   }
 
   code += c.name() + " {\n";
-  for (const auto& mem : c.members) {
+  for (const auto& mem : c.members()) {
     code += "  " + mem.type().name() + " " + mem.name;
     if (mem.bitsize) {
       code += " : " + std::to_string(mem.bitsize);
@@ -386,10 +385,22 @@ void genDefsTypedef(const Typedef& td, std::string& code) {
   code += "using " + td.name() + " = " + td.underlyingType().name() + ";\n";
 }
 
-void genDefs(const TypeGraph& typeGraph, std::string& code) {
+// A folded class derives from its representative, so it has the same layout
+// and can reuse the representative's TypeHandler while remaining a distinct
+// type with its own name.
+void genDefsFoldedClass(const Class& c, const Class& rep, std::string& code) {
+  code += "struct " + c.name() + " : " + rep.name() + " {};\n\n";
+}
+
+void genDefs(const TypeGraph& typeGraph,
+             const FoldEquivalentClasses::Folded& folded,
+             std::string& code) {
   for (const Type& t : typeGraph.finalTypes) {
     if (const auto* c = dynamic_cast<const Class*>(&t)) {
-      genDefsClass(*c, code);
+      if (auto it = folded.find(c); it != folded.end())
+        genDefsFoldedClass(*c, *it->second, code);
+      else
+        genDefsClass(*c, code);
     } else if (const auto* td = dynamic_cast<const Typedef*>(&t)) {
       genDefsTypedef(*td, code);
     }
@@ -399,7 +410,7 @@ void genDefs(const TypeGraph& typeGraph, std::string& code) {
 void genStaticAssertsClass(const Class& c, std::string& code) {
   code += "static_assert(validate_size<" + c.name() + ", " +
           std::to_string(c.size()) + ">::value);\n";
-  for (const auto& member : c.members) {
+  for (const auto& member : c.members()) {
     if (member.bitsize > 0)
       continue;
 
@@ -417,9 +428,14 @@ void genStaticAssertsContainer(const Container& c, std::string& code) {
   code.push_back('\n');
 }
 
-void genStaticAsserts(const TypeGraph& typeGraph, std::string& code) {
+void genStaticAsserts(const TypeGraph& typeGraph,
+                      const FoldEquivalentClasses::Folded& folded,
+                      std::string& code) {
   for (const Type& t : typeGraph.finalTypes) {
     if (const auto* c = dynamic_cast<const Class*>(&t)) {
+      // Checked through the representative, which has the same layout
+      if (folded.contains(c))
+        continue;
       genStaticAssertsClass(*c, code);
     } else if (const auto* con = dynamic_cast<const Container*>(&t)) {
       genStaticAssertsContainer(*con, code);
@@ -517,8 +533,8 @@ void CodeGen::getClassSizeFuncConcrete(std::string_view funcName,
   }
 
   size_t thriftFieldIdx = 0;
-  for (size_t i = 0; i < c.members.size(); i++) {
-    const auto& member = c.members[i];
+  for (size_t i = 0; i < c.members().size(); i++) {
+    const auto& member = c.members()[i];
     if (member.name.starts_with(AddPadding::MemberPrefix))
       continue;
 
@@ -561,16 +577,22 @@ void CodeGen::getClassSizeFuncDef(const Class& c, std::string& code) {
     if (childClass == nullptr) {
       abort();  // TODO
     }
-    //      TODO:
-    //      auto fqChildName = *fullyQualifiedName(child);
-    auto fqChildName = "TODO - implement me";
+    std::optional<SymbolInfo> optVtableSym;
+    if (classHierarchy_) {
+      // The index has every vtable, so avoid rescanning the symbol table
+      optVtableSym = classHierarchy_->findVtable(childClass->fqName());
+    } else {
+      //      TODO:
+      //      auto fqChildName = *fullyQualifiedName(child);
+      auto fqChildName = "TODO - implement me";
 
-    // We must split this assignment and append because the C++ standard lacks
-    // an operator for concatenating std::string and std::string_view...
-    std::string childVtableName = "vtable for ";
-    childVtableName += fqChildName;
+      // We must split this assignment and append because the C++ standard
+      // lacks an operator for concatenating std::string and std::string_view...
+      std::string childVtableName = "vtable for ";
+      childVtableName += fqChildName;
 
-    auto optVtableSym = symbols_->locateSymbol(childVtableName, true);
+      optVtableSym = symbols_->locateSymbol(childVtableName, true);
+    }
     if (!optVtableSym) {
       //        LOG(ERROR) << "Failed to find vtable address for '" <<
       //        childVtableName; LOG(ERROR) << "Falling back to non dynamic
@@ -676,7 +698,12 @@ size_t getLastNonPaddingMemberIndex(const std::vector<Member>& members) {
 // `delegate()` form to handle each field except for the last. The last field
 // instead uses `consume()` as we must not accidentally handle the first half
 // of a pair as the last field.
-void CodeGen::genClassTraversalFunction(const Class& c, std::string& code) {
+//
+// If `definition` is given the function is only declared in the class, and
+// its out-of-line definition is appended to `definition` instead.
+void CodeGen::genClassTraversalFunction(const Class& c,
+                                        std::string& code,
+                                        std::string* definition) {
   std::string funcName = "getSizeType";
 
   code += "  static types::st::Unit<DB> ";
@@ -686,7 +713,23 @@ void CodeGen::genClassTraversalFunction(const Class& c, std::string& code) {
   code += c.name();
   code += "& t,\n      typename TypeHandler<Ctx, ";
   code += c.name();
-  code += ">::type returnArg) {\n";
+  code += ">::type returnArg)";
+  if (definition != nullptr) {
+    code += ";\n";
+
+    // The trailing return type is looked up in the class's scope, so can
+    // still name `DB`
+    *definition += "template <typename Ctx>\n";
+    *definition += "auto TypeHandler<Ctx, " + c.name() + ">::" + funcName;
+    *definition += "(\n      Ctx& ctx,\n    const ";
+    *definition += c.name();
+    *definition += "& t,\n      typename TypeHandler<Ctx, ";
+    *definition += c.name();
+    *definition += ">::type returnArg) -> types::st::Unit<DB> {\n";
+  } else {
+    code += " {\n";
+  }
+  std::string& body = definition != nullptr ? *definition : code;
 
   const Member* thriftIssetMember = nullptr;
   if (const auto it = thriftIssetMembers_.find(&c);
@@ -694,41 +737,41 @@ void CodeGen::genClassTraversalFunction(const Class& c, std::string& code) {
     thriftIssetMember = it->second;
   }
 
-  size_t emptySize = code.size();
-  size_t lastNonPaddingElement = getLastNonPaddingMemberIndex(c.members);
+  size_t emptySize = body.size();
+  size_t lastNonPaddingElement = getLastNonPaddingMemberIndex(c.members());
   size_t thriftFieldIdx = 0;
   for (size_t i = 0; i < lastNonPaddingElement + 1; i++) {
-    const auto& member = c.members[i];
+    const auto& member = c.members()[i];
     if (member.name.starts_with(AddPadding::MemberPrefix)) {
       continue;
     }
 
-    if (code.size() == emptySize) {
-      code += "    return returnArg";
+    if (body.size() == emptySize) {
+      body += "    return returnArg";
     }
 
     if (thriftIssetMember != nullptr && thriftIssetMember != &member) {
-      code += "\n      .write(getThriftIsset(t, ";
-      code += std::to_string(thriftFieldIdx++);
-      code += "))";
+      body += "\n      .write(getThriftIsset(t, ";
+      body += std::to_string(thriftFieldIdx++);
+      body += "))";
     }
 
-    code += "\n      .";
+    body += "\n      .";
     if (i == lastNonPaddingElement) {
-      code += "consume";
+      body += "consume";
     } else {
-      code += "delegate";
+      body += "delegate";
     }
-    code +=
+    body +=
         "([&ctx, &t](auto ret) { return OIInternal::getSizeType<Ctx>(ctx, t.";
-    code += member.name;
-    code += ", ret); })";
+    body += member.name;
+    body += ", ret); })";
   }
 
-  if (code.size() == emptySize) {
-    code += "    return returnArg;";
+  if (body.size() == emptySize) {
+    body += "    return returnArg;";
   }
-  code += ";\n  }\n";
+  body += ";\n  }\n";
 }
 
 // Generate the static type for the class's representation in the data buffer.
@@ -744,12 +787,12 @@ void CodeGen::genClassStaticType(const Class& c, std::string& code) {
     thriftIssetMember = it->second;
   }
 
-  size_t lastNonPaddingElement = getLastNonPaddingMemberIndex(c.members);
+  size_t lastNonPaddingElement = getLastNonPaddingMemberIndex(c.members());
   size_t pairs = 0;
 
   size_t emptySize = code.size();
   for (size_t i = 0; i < lastNonPaddingElement + 1; i++) {
-    const auto& member = c.members[i];
+    const auto& member = c.members()[i];
     if (member.name.starts_with(AddPadding::MemberPrefix)) {
       continue;
     }
@@ -796,7 +839,7 @@ void CodeGen::genClassTreeBuilderInstructions(const Class& c,
 
   code += " private:\n";
   size_t index = 0;
-  for (const auto& m : c.members) {
+  for (const auto& m : c.members()) {
     ++index;
     if (m.name.starts_with(AddPadding::MemberPrefix))
       continue;
@@ -815,15 +858,17 @@ void CodeGen::genClassTreeBuilderInstructions(const Class& c,
 
   code += " public:\n";
   size_t numFields =
-      std::count_if(c.members.cbegin(), c.members.cend(), [](const auto& m) {
-        return !m.name.starts_with(AddPadding::MemberPrefix);
-      });
+      std::count_if(c.members().cbegin(),
+                    c.members().cend(),
+                    [](const auto& m) {
+                      return !m.name.starts_with(AddPadding::MemberPrefix);
+                    });
   code += "  static constexpr std::array<inst::Field, ";
   code += std::to_string(numFields);
   code += "> fields{\n";
   index = 0;
 
-  for (const auto& m : c.members) {
+  for (const auto& m : c.members()) {
     ++index;
     if (m.name.starts_with(AddPadding::MemberPrefix))
       continue;
@@ -867,7 +912,9 @@ void CodeGen::genClassTreeBuilderInstructions(const Class& c,
       "processors{};\n";
 }
 
-void CodeGen::genClassTypeHandler(const Class& c, std::string& code) {
+void CodeGen::genClassTypeHandler(const Class& c,
+                                  std::string& code,
+                                  std::string* definition) {
   std::string helpers;
 
   if (const auto it = thriftIssetMembers_.find(&c);
@@ -901,7 +948,7 @@ void CodeGen::genClassTypeHandler(const Class& c, std::string& code) {
   genClassStaticType(c, code);
   code += ";\n";
   genClassTreeBuilderInstructions(c, code);
-  genClassTraversalFunction(c, code);
+  genClassTraversalFunction(c, code, definition);
   code += "};\n";
 }
 
@@ -1121,7 +1168,7 @@ void addCaptureKeySupport(std::string& code) {
 
 void addThriftIssetSupport(std::string& code) {
   code += R"(
-void processThriftIsset(result::Element& el, std::function<void(inst::Inst)> stack_ins, ParsedData d) {
+inline void processThriftIsset(result::Element& el, std::function<void(inst::Inst)> stack_ins, ParsedData d) {
   auto v = std::get<ParsedData::VarInt>(d.val).value;
   if (v <= 1) {
     el.is_set_stats.emplace(result::Element::IsSetStats { v == 1 });
@@ -1139,10 +1186,95 @@ struct ThriftIssetHandler {
 )";
 }
 
+void addHashTableStatsSupport(std::string& code) {
+  code += R"(
+template <typename DB>
+using HashTableStatsType = types::st::Sum<DB,
+  types::st::Unit<DB>,
+  types::st::Pair<DB, types::st::VarInt<DB>,
+    types::st::Pair<DB, types::st::VarInt<DB>,
+      types::st::Pair<DB, types::st::VarInt<DB>, types::st::VarInt<DB>>>>>;
+
+// compute() returns the OIHashTableStats, and is only called when they are
+// being captured
+template <typename DB, typename F>
+types::st::Unit<DB> writeHashTableStats(HashTableStatsType<DB> returnArg, F const& compute) {
+  if constexpr (captureHashTableStats) {
+    OIHashTableStats stats = compute();
+    return returnArg.template write<1>()
+      .write(stats.buckets)
+      .write(stats.emptyBuckets)
+      .write(stats.longestChain)
+      .write(stats.overflowedBuckets);
+  } else {
+    return returnArg.template write<0>();
+  }
+}
+
+inline void processHashTableStats(result::Element& el, ParsedData d) {
+  auto sum = std::get<ParsedData::Sum>(d.val);
+  if (sum.index == 0)
+    return;
+  auto varInt = [](ParsedData p) { return std::get<ParsedData::VarInt>(p.val).value; };
+  auto buckets = std::get<ParsedData::Pair>(sum.value().val);
+  size_t bucketCount = varInt(buckets.first());
+  auto empty = std::get<ParsedData::Pair>(buckets.second().val);
+  size_t emptyBuckets = varInt(empty.first());
+  auto longest = std::get<ParsedData::Pair>(empty.second().val);
+  size_t longestChain = varInt(longest.first());
+  el.hash_table_stats.emplace(result::Element::HashTableStats{
+    .buckets = bucketCount,
+    .empty_buckets = emptyBuckets,
+    .longest_chain = longestChain,
+    .overflowed_buckets = varInt(longest.second()),
+  });
+}
+)";
+}
+
+/*
+ * Processors round each heap allocation of a container with the target's
+ * nallocx() when it uses jemalloc. Otherwise they model glibc malloc, as
+ * SizeClasses::glibc() does for oid's tree builder.
+ */
+void addAllocatedSizeSupport(FeatureSet features, std::string& code) {
+  code += "constexpr bool captureAllocatedSize = ";
+  code += features[Feature::AllocatorSizeClasses] ? "true" : "false";
+  code += ";\n";
+  code += R"(
+// Named differently to jemalloc's and folly's declarations of nallocx() so as
+// not to conflict with them. Null unless the target defines it.
+size_t oiNallocx(size_t size, int flags) __asm__("nallocx") __attribute__((weak));
+
+inline size_t allocatedSize(size_t bytes) {
+  if (bytes == 0)
+    return 0;
+  if (oiNallocx != nullptr)
+    return oiNallocx(bytes, 0);
+
+  constexpr size_t header = sizeof(size_t);
+  constexpr size_t mmapThreshold = 128 * 1024;
+  constexpr size_t pageSize = 4096;
+  if (bytes >= mmapThreshold)
+    return (bytes + header + pageSize - 1) / pageSize * pageSize;
+  size_t chunk = (bytes + header + 15) / 16 * 16;
+  return chunk < 32 ? 32 : chunk;
+}
+
+// Adds `count` heap allocations of `bytes` each to the element
+inline void addAllocations(result::Element& el, size_t count, size_t bytes) {
+  if constexpr (captureAllocatedSize)
+    el.allocated_size = el.allocated_size.value_or(0) + count * allocatedSize(bytes);
+}
+)";
+}
+
 void addStandardTypeHandlers(TypeGraph& typeGraph,
                              FeatureSet features,
                              std::string& code) {
   addCaptureKeySupport(code);
+  addHashTableStatsSupport(code);
+  addAllocatedSizeSupport(features, code);
   if (features[Feature::CaptureThriftIsset])
     addThriftIssetSupport(code);
 
@@ -1172,10 +1304,37 @@ void addStandardTypeHandlers(TypeGraph& typeGraph,
 
 }  // namespace
 
-void CodeGen::addTypeHandlers(const TypeGraph& typeGraph, std::string& code) {
+/*
+ * With `outOfLine`, the traversal functions of class handlers are collected
+ * there in order instead of being defined in `code`.
+ */
+void CodeGen::addTypeHandlers(const TypeGraph& typeGraph,
+                              std::string& code,
+                              std::vector<HandlerDefinition>* outOfLine) {
+  // Sizes of the handlers generated for fold representatives, used to report
+  // how much code folding saved
+  std::unordered_map<const Class*, size_t> handlerSizes;
+  size_t savedBytes = 0;
+
   for (const Type& t : typeGraph.finalTypes) {
     if (const auto* c = dynamic_cast<const Class*>(&t)) {
-      genClassTypeHandler(*c, code);
+      size_t start = code.size();
+      if (auto it = foldedClasses_.find(c); it != foldedClasses_.end()) {
+        const Class& rep = *it->second;
+        code += "template <typename Ctx>\n";
+        code += "class TypeHandler<Ctx, " + c->name() + ">\n";
+        code += "    : public TypeHandler<Ctx, " + rep.name() + "> {};\n";
+        size_t repSize = handlerSizes[&rep];
+        savedBytes += repSize - std::min(repSize, code.size() - start);
+      } else if (outOfLine != nullptr) {
+        HandlerDefinition def{c->name(), ""};
+        genClassTypeHandler(*c, code, &def.code);
+        handlerSizes[c] = code.size() - start + def.code.size();
+        outOfLine->push_back(std::move(def));
+      } else {
+        genClassTypeHandler(*c, code);
+        handlerSizes[c] = code.size() - start;
+      }
     } else if (const auto* con = dynamic_cast<const Container*>(&t)) {
       genContainerTypeHandler(
           definedContainers_, con->containerInfo_, con->templateParams, code);
@@ -1191,6 +1350,12 @@ void CodeGen::addTypeHandlers(const TypeGraph& typeGraph, std::string& code) {
                               code);
     }
   }
+
+  if (!foldedClasses_.empty()) {
+    LOG(INFO) << "Folding " << foldStats_.folded << " of "
+              << foldStats_.classes << " classes saved " << savedBytes
+              << " bytes of type handlers";
+  }
 }
 
 bool CodeGen::codegenFromDrgn(struct drgn_type* drgnType,
@@ -1204,21 +1369,41 @@ bool CodeGen::codegenFromDrgn(struct drgn_type* drgnType, std::string& code) {
       drgnType, code, HashedComponent{SymbolService::getTypeName(drgnType)});
 }
 
+bool CodeGen::codegenFromDrgn(struct drgn_type* drgnType,
+                              std::vector<std::string>& units) {
+  if (!buildTypeGraph(drgnType))
+    return false;
+
+  RootFunctionName name =
+      HashedComponent{SymbolService::getTypeName(drgnType)};
+  generate(typeGraph_, units, std::span{&name, 1});
+  return true;
+}
+
 bool CodeGen::codegenFromDrgn(struct drgn_type* drgnType,
                               std::string& code,
                               RootFunctionName name) {
+  if (!buildTypeGraph(drgnType))
+    return false;
+
+  generate(typeGraph_, code, std::move(name));
+  return true;
+}
+
+bool CodeGen::buildTypeGraph(struct drgn_type* drgnType) {
   if (!registerContainers())
     return false;
 
+  // Passes read class contents from DWARF as they reach them, so parsing
+  // errors may be thrown by either step
   try {
     addDrgnRoot(drgnType, typeGraph_);
+    transform(typeGraph_);
   } catch (const type_graph::DrgnParserError& err) {
     LOG(ERROR) << "Error parsing DWARF: " << err.what();
     return false;
   }
 
-  transform(typeGraph_);
-  generate(typeGraph_, code, std::move(name));
   return true;
 }
 
@@ -1264,13 +1449,14 @@ void CodeGen::addDrgnRoot(struct drgn_type* drgnType, TypeGraph& typeGraph) {
   DrgnParserOptions options{
       .chaseRawPointers = config_.features[Feature::ChaseRawPointers],
   };
-  DrgnParser drgnParser{typeGraph, options};
+  auto& drgnParser = drgnParsers_.emplace_back(typeGraph, options);
   Type& parsedRoot = drgnParser.parse(drgnType);
   typeGraph.addRoot(parsedRoot);
 }
 
 void CodeGen::transform(TypeGraph& typeGraph) {
   type_graph::PassManager pm;
+  pm.setProfiling(config_.profilePasses);
 
   // Simplify the type graph first so there is less work for later passes
   pm.addPass(RemoveTopLevelPointer::createPass());
@@ -1286,8 +1472,9 @@ void CodeGen::transform(TypeGraph& typeGraph) {
     DrgnParserOptions options{
         .chaseRawPointers = config_.features[Feature::ChaseRawPointers],
     };
-    DrgnParser drgnParser{typeGraph, options};
-    pm.addPass(AddChildren::createPass(drgnParser, *symbols_));
+    auto& drgnParser = drgnParsers_.emplace_back(typeGraph, options);
+    pm.addPass(
+        AddChildren::createPass(drgnParser, *symbols_, classHierarchy_));
 
     // Re-run passes over newly added children
     pm.addPass(IdentifyContainers::createPass(containerInfos_));
@@ -1311,8 +1498,13 @@ void CodeGen::transform(TypeGraph& typeGraph) {
 
   pm.addPass(NameGen::createPass());
   pm.addPass(TopoSorter::createPass());
+  // Folded classes share TypeHandlers, which only exist in CodeGen v2
+  if (config_.features[Feature::TreeBuilderV2])
+    pm.addPass(FoldEquivalentClasses::createPass(foldedClasses_, foldStats_));
 
   pm.run(typeGraph);
+  if (config_.profilePasses)
+    type_graph::PassManager::printProfile(std::cerr, pm.profile());
 
   LOG(INFO) << "Sorted types:\n";
   for (Type& t : typeGraph.finalTypes) {
@@ -1323,7 +1515,37 @@ void CodeGen::transform(TypeGraph& typeGraph) {
 void CodeGen::generate(TypeGraph& typeGraph,
                        std::string& code,
                        RootFunctionName rootName) {
-  code = headers::oi_OITraceCode_cpp;
+  generate(typeGraph, code, std::span{&rootName, 1});
+}
+
+void CodeGen::generate(TypeGraph& typeGraph,
+                       std::string& code,
+                       std::span<const RootFunctionName> rootNames) {
+  std::vector<std::string> units;
+  generateUnits(typeGraph, rootNames, 1, units);
+  code = std::move(units[0]);
+}
+
+void CodeGen::generate(TypeGraph& typeGraph,
+                       std::vector<std::string>& units,
+                       std::span<const RootFunctionName> rootNames) {
+  generateUnits(typeGraph, rootNames, config_.codegenUnits, units);
+}
+
+void CodeGen::generateUnits(TypeGraph& typeGraph,
+                            std::span<const RootFunctionName> rootNames,
+                            size_t numUnits,
+                            std::vector<std::string>& units) {
+  assert(typeGraph.rootTypes().size() == rootNames.size());
+  assert(config_.features[Feature::TreeBuilderV2] ||
+         typeGraph.rootTypes().size() == 1);
+
+  // Code shared by every unit is generated first, then each unit is a copy of
+  // it followed by the unit's own definitions. Splitting relies on the class
+  // TypeHandlers, which only exist under TreeBuilder-v2.
+  bool split = numUnits > 1 && config_.features[Feature::TreeBuilderV2];
+
+  std::string code = headers::oi_OITraceCode_cpp;
   if (!config_.features[Feature::Library]) {
     FuncGen::DeclareExterns(code);
   }
@@ -1333,6 +1555,7 @@ void CodeGen::generate(TypeGraph& typeGraph,
   addIncludes(typeGraph, config_.features, code);
   defineInternalTypes(code);
   FuncGen::DefineJitLog(code, config_.features);
+  FuncGen::DefineHashTableStats(code, config_.features);
 
   if (config_.features[Feature::TreeBuilderV2]) {
     if (config_.features[Feature::Library]) {
@@ -1365,27 +1588,34 @@ void CodeGen::generate(TypeGraph& typeGraph,
    * the top-level `getSize` function to locate the probe entry point, so
    * by keeping the contents of the symbol table to a minimum, we make that
    * process faster.
+   *
+   * Split code can't do this, as the TypeHandlers instantiated in one unit are
+   * used from the others.
    */
-  code += "namespace OIInternal {\nnamespace {\n";
+  code += split ? "namespace OIInternal {\n"
+                : "namespace OIInternal {\nnamespace {\n";
   if (!config_.features[Feature::TreeBuilderV2]) {
     FuncGen::DefineEncodeData(code);
     FuncGen::DefineEncodeDataSize(code);
     FuncGen::DefineStoreData(code);
   }
   FuncGen::DeclareGetContainer(code);
+  if (config_.features[Feature::TreeBuilderV2])
+    FuncGen::DefineIntrospectContext(code);
 
   genDecls(typeGraph, code);
-  genDefs(typeGraph, code);
-  genStaticAsserts(typeGraph, code);
+  genDefs(typeGraph, foldedClasses_, code);
+  genStaticAsserts(typeGraph, foldedClasses_, code);
   if (config_.features[Feature::TreeBuilderV2]) {
     genNames(typeGraph, code);
     genExclusiveSizes(typeGraph, code);
   }
 
+  std::vector<HandlerDefinition> outOfLine;
   if (config_.features[Feature::TreeBuilderV2]) {
     FuncGen::DefineBasicTypeHandlers(code);
     addStandardTypeHandlers(typeGraph, config_.features, code);
-    addTypeHandlers(typeGraph, code);
+    addTypeHandlers(typeGraph, code, split ? &outOfLine : nullptr);
   } else {
     addStandardGetSizeFuncDecls(code);
     addGetSizeFuncDecls(typeGraph, code);
@@ -1394,43 +1624,114 @@ void CodeGen::generate(TypeGraph& typeGraph,
     addGetSizeFuncDefs(typeGraph, code);
   }
 
-  assert(typeGraph.rootTypes().size() == 1);
-  Type& rootType = typeGraph.rootTypes()[0];
-  code += "\nusing __ROOT_TYPE__ = " + rootType.name() + ";\n";
-  code += "} // namespace\n} // namespace OIInternal\n";
+  // The first root keeps the plain alias, which the legacy entry points
+  // refer to directly.
+  auto rootAlias = [](size_t i) {
+    return i == 0 ? std::string{"__ROOT_TYPE__"}
+                  : "__ROOT_TYPE_" + std::to_string(i) + "__";
+  };
+  code += "\n";
+  for (size_t i = 0; i < typeGraph.rootTypes().size(); ++i) {
+    Type& rootType = typeGraph.rootTypes()[i];
+    code += "using " + rootAlias(i) + " = " + rootType.name() + ";\n";
+  }
+  code += split ? "} // namespace OIInternal\n"
+                : "} // namespace\n} // namespace OIInternal\n";
+
+  units.clear();
+  if (split) {
+    // Each of the other units gets a contiguous run of handlers of roughly
+    // equal size. Every unit is generated, even if empty, so that the number
+    // of objects only depends on the configuration.
+    size_t numPartitions = numUnits - 1;
+    size_t total = 0;
+    for (const auto& def : outOfLine)
+      total += def.code.size();
+
+    units.emplace_back();  // the entry points, finished below
+    size_t begin = 0, done = 0;
+    for (size_t p = 0; p < numPartitions; ++p) {
+      size_t end = begin;
+      size_t target = total * (p + 1) / numPartitions;
+      while (end < outOfLine.size() &&
+             (done < target || p + 1 == numPartitions)) {
+        done += outOfLine[end++].code.size();
+      }
 
-  const auto& typeToHash = std::visit(
-      [](const auto& v) -> const std::string& {
-        using T = std::decay_t<decltype(v)>;
-        if constexpr (std::is_same_v<ExactName, T> ||
-                      std::is_same_v<HashedComponent, T>) {
-          return v.name;
-        } else {
-          static_assert(always_false_v<T>, "missing visit");
-        }
-      },
-      rootName);
+      std::string unit = code;
+      unit += "namespace OIInternal {\n";
+      for (size_t i = begin; i < end; ++i)
+        unit += outOfLine[i].code;
+      for (size_t i = begin; i < end; ++i) {
+        unit += "template class TypeHandler<IntrospectContext, ";
+        unit += outOfLine[i].className;
+        unit += ">;\n";
+      }
+      unit += "} // namespace OIInternal\n";
+      units.push_back(std::move(unit));
+      begin = end;
+    }
 
-  if (config_.features[Feature::TreeBuilderV2]) {
-    FuncGen::DefineTopLevelIntrospect(code, typeToHash);
-  } else {
-    FuncGen::DefineTopLevelGetSizeRef(code, typeToHash, config_.features);
+    code += "namespace OIInternal {\n";
+    for (const auto& def : outOfLine) {
+      code += "extern template class TypeHandler<IntrospectContext, ";
+      code += def.className;
+      code += ">;\n";
+    }
+    code += "} // namespace OIInternal\n";
   }
 
-  if (config_.features[Feature::TreeBuilderV2]) {
-    FuncGen::DefineTreeBuilderInstructions(code,
-                                           typeToHash,
-                                           calculateExclusiveSize(rootType),
-                                           enumerateTypeNames(rootType));
+  if (config_.features[Feature::TreeBuilderV2])
+    FuncGen::DefineTreeBuilderFakeContext(code);
+
+  for (size_t i = 0; i < typeGraph.rootTypes().size(); ++i) {
+    Type& rootType = typeGraph.rootTypes()[i];
+    const auto& rootName = rootNames[i];
+    std::string rootTypeName = "OIInternal::" + rootAlias(i);
+
+    const auto& typeToHash = std::visit(
+        [](const auto& v) -> const std::string& {
+          using T = std::decay_t<decltype(v)>;
+          if constexpr (std::is_same_v<ExactName, T> ||
+                        std::is_same_v<HashedComponent, T>) {
+            return v.name;
+          } else {
+            static_assert(always_false_v<T>, "missing visit");
+          }
+        },
+        rootName);
+
+    if (config_.features[Feature::TreeBuilderV2]) {
+      FuncGen::DefineTopLevelIntrospect(code, typeToHash, rootTypeName);
+      if (config_.features[Feature::Library])
+        FuncGen::DefineTopLevelIntrospectBatch(code, typeToHash, rootTypeName);
+    } else {
+      FuncGen::DefineTopLevelGetSizeRef(code, typeToHash, config_.features);
+    }
+
+    if (config_.features[Feature::TreeBuilderV2]) {
+      FuncGen::DefineTreeBuilderInstructions(code,
+                                             typeToHash,
+                                             rootTypeName,
+                                             calculateExclusiveSize(rootType),
+                                             enumerateTypeNames(rootType));
+    }
+
+    if (auto* n = std::get_if<ExactName>(&rootName))
+      FuncGen::DefineTopLevelIntrospectNamed(
+          code, typeToHash, rootTypeName, n->name);
   }
 
-  if (auto* n = std::get_if<ExactName>(&rootName))
-    FuncGen::DefineTopLevelIntrospectNamed(code, typeToHash, n->name);
+  if (units.empty())
+    units.push_back(std::move(code));
+  else
+    units[0] = std::move(code);
 
   if (VLOG_IS_ON(3)) {
     VLOG(3) << "Generated trace code:\n";
     // VLOG truncates output, so use std::cerr
-    std::cerr << code;
+    for (const auto& unit : units)
+      std::cerr << unit;
   }
 }
 
@@ -19,13 +19,17 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "ContainerInfo.h"
 #include "OICodeGen.h"
+#include "type_graph/DrgnParser.h"
+#include "type_graph/FoldEquivalentClasses.h"
 #include "type_graph/TypeGraph.h"
 
 struct drgn_type;
@@ -34,11 +38,20 @@ class SymbolService;
 }
 namespace oi::detail::type_graph {
 class Class;
+struct ClassHierarchyIndex;
 class Member;
+class Type;
 }  // namespace oi::detail::type_graph
 
 namespace oi::detail {
 
+/*
+ * The type names and exclusive size reported to TreeBuilder for a field of the
+ * given type. Shared with the Interpreter, which must report the same.
+ */
+std::vector<std::string_view> enumerateTypeNames(const type_graph::Type& type);
+size_t calculateExclusiveSize(const type_graph::Type& type);
+
 class CodeGen {
  public:
   CodeGen(const OICodeGen::Config& config);
@@ -62,32 +75,90 @@ class CodeGen {
   bool codegenFromDrgn(struct drgn_type* drgnType,
                        std::string linkageName,
                        std::string& code);
+  bool codegenFromDrgn(struct drgn_type* drgnType,
+                       std::vector<std::string>& units);
   void exportDrgnTypes(TypeHierarchy& th,
                        std::list<drgn_type>& drgnTypes,
                        drgn_type** rootType) const;
 
+  /*
+   * Use a prebuilt index to find child classes and their vtables, instead of
+   * scanning every type and symbol in the program. Must outlive this CodeGen.
+   */
+  void setClassHierarchyIndex(const type_graph::ClassHierarchyIndex& index) {
+    classHierarchy_ = &index;
+  }
+
   bool registerContainers();
   void registerContainer(std::unique_ptr<ContainerInfo> containerInfo);
   void registerContainer(const std::filesystem::path& path);
+  /*
+   * Classes added to `typeGraph` read their contents through a parser owned by
+   * this CodeGen, so must not be used after it is destroyed.
+   */
   void addDrgnRoot(struct drgn_type* drgnType,
                    type_graph::TypeGraph& typeGraph);
   void transform(type_graph::TypeGraph& typeGraph);
+
+  /*
+   * The type graph built by codegenFromDrgn(), after all passes have run.
+   */
+  const type_graph::TypeGraph& typeGraph() const {
+    return typeGraph_;
+  }
   void generate(type_graph::TypeGraph& typeGraph,
                 std::string& code,
                 RootFunctionName rootName);
+  /*
+   * Generates entry points for every root in the type graph, sharing the
+   * definitions of any types reachable from more than one root. `rootNames`
+   * holds one name per root, in the order of `typeGraph.rootTypes()`.
+   */
+  void generate(type_graph::TypeGraph& typeGraph,
+                std::string& code,
+                std::span<const RootFunctionName> rootNames);
+  /*
+   * As above, but splits the code into `Config::codegenUnits` translation
+   * units which can be compiled concurrently and relocated together. The
+   * first unit holds the entry points. Each of the others defines the
+   * traversal functions of a contiguous run of class handlers, in
+   * topological order. Only TreeBuilder-v2 code is split, otherwise a single
+   * unit is generated.
+   */
+  void generate(type_graph::TypeGraph& typeGraph,
+                std::vector<std::string>& units,
+                std::span<const RootFunctionName> rootNames);
 
  private:
+  // A class handler's traversal function, defined outside of the code shared
+  // by every translation unit
+  struct HandlerDefinition {
+    std::string className;
+    std::string code;
+  };
+
   type_graph::TypeGraph typeGraph_;
+  // Kept alive for as long as their type graphs, which read class contents
+  // through them on demand
+  std::list<type_graph::DrgnParser> drgnParsers_;
   const OICodeGen::Config& config_;
   SymbolService* symbols_ = nullptr;
+  const type_graph::ClassHierarchyIndex* classHierarchy_ = nullptr;
   std::vector<std::unique_ptr<ContainerInfo>> containerInfos_;
   std::unordered_set<const ContainerInfo*> definedContainers_;
   std::unordered_map<const type_graph::Class*, const type_graph::Member*>
       thriftIssetMembers_;
+  type_graph::FoldEquivalentClasses::Folded foldedClasses_;
+  type_graph::FoldEquivalentClasses::Stats foldStats_;
 
   bool codegenFromDrgn(struct drgn_type* drgnType,
                        std::string& code,
                        RootFunctionName name);
+  bool buildTypeGraph(struct drgn_type* drgnType);
+  void generateUnits(type_graph::TypeGraph& typeGraph,
+                     std::span<const RootFunctionName> rootNames,
+                     size_t numUnits,
+                     std::vector<std::string>& units);
 
   void genDefsThrift(const type_graph::TypeGraph& typeGraph, std::string& code);
   void addGetSizeFuncDefs(const type_graph::TypeGraph& typeGraph,
@@ -97,11 +168,16 @@ class CodeGen {
                                 const type_graph::Class& c,
                                 std::string& code) const;
   void addTypeHandlers(const type_graph::TypeGraph& typeGraph,
-                       std::string& code);
+                       std::string& code,
+                       std::vector<HandlerDefinition>* outOfLine = nullptr);
 
-  void genClassTypeHandler(const type_graph::Class& c, std::string& code);
+  void genClassTypeHandler(const type_graph::Class& c,
+                           std::string& code,
+                           std::string* definition = nullptr);
   void genClassStaticType(const type_graph::Class& c, std::string& code);
-  void genClassTraversalFunction(const type_graph::Class& c, std::string& code);
+  void genClassTraversalFunction(const type_graph::Class& c,
+                                 std::string& code,
+                                 std::string* definition = nullptr);
   void genClassTreeBuilderInstructions(const type_graph::Class& c,
                                        std::string& code);
 };
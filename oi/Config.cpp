@@ -164,6 +164,14 @@ std::optional<FeatureSet> processConfigFile(
   }
 
   if (toml::table* codegen = config["codegen"].as_table()) {
+    if (toml::node* units = codegen->get("units")) {
+      auto n = units->value<int64_t>();
+      if (!n.has_value() || *n <= 0) {
+        LOG(ERROR) << "codegen units must be a positive integer";
+        return {};
+      }
+      generatorConfig.codegenUnits = static_cast<size_t>(*n);
+    }
     if (toml::array* arr = (*codegen)["default_headers"].as_array()) {
       arr->for_each([&](auto&& el) {
         if constexpr (toml::is_string<decltype(el)>) {
@@ -234,6 +242,39 @@ std::optional<FeatureSet> processConfigFile(
     }
   }
 
+  if (toml::table* allocator = config["allocator"].as_table()) {
+    toml::node* classes = allocator->get("size_classes");
+    if (classes == nullptr) {
+      LOG(ERROR) << "Config table 'allocator' must specify 'size_classes'";
+      return {};
+    }
+    if (auto* name = classes->as_string()) {
+      if (name->get() == "jemalloc") {
+        generatorConfig.sizeClasses = SizeClasses::jemalloc();
+      } else if (name->get() == "glibc") {
+        generatorConfig.sizeClasses = SizeClasses::glibc();
+      } else {
+        LOG(ERROR) << "unrecognised allocator: " << name->get();
+        return {};
+      }
+    } else if (auto* arr = classes->as_array()) {
+      std::vector<size_t> sizes;
+      for (auto&& el : *arr) {
+        auto size = el.value<int64_t>();
+        if (!size.has_value() || *size <= 0) {
+          LOG(ERROR) << "allocator size classes must be positive integers";
+          return {};
+        }
+        sizes.push_back(static_cast<size_t>(*size));
+      }
+      generatorConfig.sizeClasses = SizeClasses{std::move(sizes)};
+    } else {
+      LOG(ERROR) << "allocator size_classes must be \"jemalloc\", \"glibc\" "
+                    "or a list of sizes";
+      return {};
+    }
+  }
+
   return enabledFeatures;
 }
 
@@ -200,6 +200,13 @@ boost::regex getMatcher(const std::string& typeName) {
 }
 }  // namespace
 
+void ContainerInfo::setMatcher() {
+  matcher_ = getMatcher(typeName);
+  // Names without regex metacharacters can be matched by comparing strings
+  matchesByTypeName_ =
+      typeName.find_first_of(".[]{}()\\*+?|^$") == std::string::npos;
+}
+
 ContainerInfo::ContainerInfo(const fs::path& path) {
   toml::table container;
   try {
@@ -226,7 +233,7 @@ ContainerInfo::ContainerInfo(const fs::path& path) {
     throw ContainerInfoError(path, "`info.type_name` is a required field");
   }
 
-  matcher_ = getMatcher(typeName);
+  setMatcher();
 
   if (std::optional<std::string> str = info["ctype"].value<std::string>()) {
     ctype = containerTypeEnumFromStr(*str);
@@ -342,6 +349,6 @@ ContainerInfo::ContainerInfo(std::string typeName_,
       ctype(ctype_),
       header(std::move(header_)),
       codegen(Codegen{
-          "// DummyDecl %1%\n", "// DummyFunc %1%\n", "// DummyFunc\n"}),
-      matcher_(getMatcher(typeName)) {
+          "// DummyDecl %1%\n", "// DummyFunc %1%\n", "// DummyFunc\n"}) {
+  setMatcher();
 }
@@ -19,6 +19,7 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "oi/ContainerTypeEnum.h"
@@ -85,9 +86,20 @@ struct ContainerInfo {
   }
 
   bool matches(std::string_view sv) const {
+    if (matchesByTypeName_)
+      return matchesTypeName(sv);
     return boost::regex_search(sv.begin(), sv.end(), matcher_);
   }
 
+  /*
+   * True if this container matches exactly `typeName` or `typeName<...>`, in
+   * which case `matches()` compares strings instead of running the regex.
+   * False for containers given a custom matcher. See ContainerMatcher.
+   */
+  bool matchesByTypeName() const {
+    return matchesByTypeName_;
+  }
+
   std::string typeName;
   std::optional<size_t> numTemplateParams;
   ContainerTypeEnum ctype = UNKNOWN_TYPE;
@@ -116,6 +128,17 @@ struct ContainerInfo {
   ContainerInfo& operator=(const ContainerInfo& other) = default;
 
   boost::regex matcher_;
+  bool matchesByTypeName_ = false;
+
+  void setMatcher();
+  // Equivalent to the regex "^typeName$|^typeName<.*>$"
+  bool matchesTypeName(std::string_view sv) const {
+    if (!sv.starts_with(typeName))
+      return false;
+    sv.remove_prefix(typeName.size());
+    return sv.empty() ||
+           (sv.size() >= 2 && sv.front() == '<' && sv.back() == '>');
+  }
 };
 
 class ContainerInfoError : public std::runtime_error {
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "oi/ContainerMatcher.h"
+
+#include <limits>
+
+namespace oi::detail {
+
+ContainerMatcher::ContainerMatcher(
+    const std::vector<std::unique_ptr<ContainerInfo>>& containers)
+    : containers_(containers) {
+  for (size_t i = 0; i < containers_.size(); ++i) {
+    const auto& info = *containers_[i];
+    // A '<' in the type name would stop it being found by lookup
+    if (info.matchesByTypeName() &&
+        info.typeName.find('<') == std::string::npos) {
+      byTypeName_.emplace(info.typeName, i);
+    } else {
+      others_.push_back(i);
+    }
+  }
+}
+
+const ContainerInfo* ContainerMatcher::match(std::string_view name) {
+  // Copying the name into the memo table costs more than the lookup alone
+  if (others_.empty())
+    return matchUncached(name);
+
+  if (auto it = cache_.find(name); it != cache_.end())
+    return it->second;
+
+  const ContainerInfo* info = matchUncached(name);
+  cache_.emplace(name, info);
+  return info;
+}
+
+const ContainerInfo* ContainerMatcher::matchUncached(
+    std::string_view name) const {
+  size_t first = std::numeric_limits<size_t>::max();
+  if (auto it = byTypeName_.find(name.substr(0, name.find('<')));
+      it != byTypeName_.end() && containers_[it->second]->matches(name)) {
+    first = it->second;
+  }
+
+  // Only containers registered earlier can take precedence over a lookup hit
+  for (size_t i : others_) {
+    if (i > first)
+      break;
+    if (containers_[i]->matches(name)) {
+      first = i;
+      break;
+    }
+  }
+
+  if (first == std::numeric_limits<size_t>::max())
+    return nullptr;
+  return containers_[first].get();
+}
+
+}  // namespace oi::detail
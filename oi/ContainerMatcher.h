@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "oi/ContainerInfo.h"
+
+namespace oi::detail {
+
+/*
+ * ContainerMatcher
+ *
+ * Finds the container a type name matches without trying every
+ * ContainerInfo's matcher in turn. Nearly all containers match their
+ * `typeName`, optionally followed by template arguments, so the part of a
+ * name before its first '<' is looked up in a table of those. Only containers
+ * with custom matchers are still tried one by one, and when there are any,
+ * results are memoised per name so each regex runs once per distinct name.
+ *
+ * The result is always the first container, in the order given, whose
+ * `matches()` accepts the name.
+ */
+class ContainerMatcher {
+ public:
+  explicit ContainerMatcher(
+      const std::vector<std::unique_ptr<ContainerInfo>>& containers);
+
+  const ContainerInfo* match(std::string_view name);
+
+ private:
+  const ContainerInfo* matchUncached(std::string_view name) const;
+
+  struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view sv) const {
+      return std::hash<std::string_view>{}(sv);
+    }
+  };
+
+  const std::vector<std::unique_ptr<ContainerInfo>>& containers_;
+  // Index of the first container matching by each type name
+  std::unordered_map<std::string_view, size_t> byTypeName_;
+  // Indexes of the containers which must be tried one by one
+  std::vector<size_t> others_;
+  std::unordered_map<std::string,
+                     const ContainerInfo*,
+                     StringHash,
+                     std::equal_to<>>
+      cache_;
+};
+
+}  // namespace oi::detail
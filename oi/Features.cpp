@@ -52,6 +52,11 @@ std::optional<std::string_view> featureHelp(Feature f) {
       return "Follow polymorphic inheritance hierarchies in the probed object.";
     case Feature::JitTiming:
       return "Instrument the JIT code with timing for performance testing.";
+    case Feature::AllocatorSizeClasses:
+      return "Also report heap sizes rounded up to the allocator's size "
+             "classes.";
+    case Feature::HashTableStats:
+      return "Capture the bucket occupancy of unordered and F14 containers.";
 
     case Feature::UnknownFeature:
       throw std::runtime_error("should not ask for help for UnknownFeature!");
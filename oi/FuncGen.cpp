@@ -156,7 +156,7 @@ void FuncGen::DefineJitLog(std::string& code, FeatureSet features) {
     code += R"(
 extern int logFile;
 
-void __jlogptr(uintptr_t ptr) {
+static void __jlogptr(uintptr_t ptr) {
   static constexpr char hexdigits[] = "0123456789abcdef";
   static constexpr size_t ptrlen = 2 * sizeof(ptr);
 
@@ -193,6 +193,57 @@ void __jlogptr(uintptr_t ptr) {
   }
 }
 
+/*
+ * Helpers for the hash table container types to measure their bucket
+ * occupancy. They are always defined so that the containers can compile out
+ * the measurement with `if constexpr (captureHashTableStats)`, which walks
+ * every bucket and so isn't free.
+ */
+void FuncGen::DefineHashTableStats(std::string& code, FeatureSet features) {
+  code += "constexpr bool captureHashTableStats = ";
+  code += features[Feature::HashTableStats] ? "true" : "false";
+  code += ";\n";
+  code += R"(
+struct OIHashTableStats {
+  size_t buckets = 0;
+  size_t emptyBuckets = 0;
+  size_t longestChain = 0;
+  size_t overflowedBuckets = 0;
+};
+
+// For tables with the std::unordered_* bucket interface
+template <typename T>
+OIHashTableStats bucketStats(const T& container) {
+  OIHashTableStats stats{.buckets = container.bucket_count()};
+  for (size_t i = 0; i < stats.buckets; i++) {
+    size_t chain = container.bucket_size(i);
+    if (chain == 0)
+      stats.emptyBuckets++;
+    else if (chain > stats.longestChain)
+      stats.longestChain = chain;
+  }
+  return stats;
+}
+
+// From a folly::F14TableStats, whose histograms are indexed by count
+template <typename F14TableStats>
+OIHashTableStats chunkStats(const F14TableStats& f14) {
+  auto countOf0 = [](const auto& histo) -> size_t {
+    return histo.empty() ? 0 : histo[0];
+  };
+  return OIHashTableStats{
+      .buckets = f14.chunkCount,
+      .emptyBuckets = countOf0(f14.chunkOccupancyHisto),
+      .longestChain = f14.keyProbeLengthHisto.empty()
+                          ? 0
+                          : f14.keyProbeLengthHisto.size() - 1,
+      .overflowedBuckets =
+          f14.chunkCount - countOf0(f14.chunkOutboundOverflowHisto),
+  };
+}
+)";
+}
+
 void FuncGen::DeclareStoreData(std::string& testCode) {
   testCode.append("void StoreData(uintptr_t data, size_t& dataSegOffset);\n");
 }
@@ -251,32 +302,46 @@ void FuncGen::DefineStoreData(std::string& testCode) {
   testCode.append(func);
 }
 
+/*
+ * DefineIntrospectContext
+ *
+ * The context the top-level introspect functions pass through every
+ * TypeHandler. It's named, rather than local to each function, so that class
+ * handlers can be explicitly instantiated for it in other translation units.
+ */
+void FuncGen::DefineIntrospectContext(std::string& code) {
+  code += R"(
+struct IntrospectContext {
+  using DataBuffer = DataBuffer::BackInserter<std::vector<uint8_t>>;
+
+  PointerHashSet<>& pointers;
+};
+)";
+}
+
 void FuncGen::DefineTopLevelIntrospect(std::string& code,
-                                       const std::string& type) {
+                                       const std::string& type,
+                                       const std::string& rootType) {
   std::string func = R"(
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunknown-attributes"
 /* RawType: %1% */
 void __attribute__((used, retain)) introspect_%2$016x(
-    const OIInternal::__ROOT_TYPE__& t,
+    const %3%& t,
     std::vector<uint8_t>& v)
 #pragma GCC diagnostic pop
 {
   v.clear();
   v.reserve(4096);
 
-  auto pointers = std::make_unique<PointerHashSet<>>();
+  auto pointers = ScratchPool<PointerHashSet<>>::acquire();
   pointers->initialize();
 
-  struct Context {
-    using DataBuffer = DataBuffer::BackInserter<std::vector<uint8_t>>;
-
-    PointerHashSet<>& pointers;
-  };
+  using Context = OIInternal::IntrospectContext;
   Context ctx{ .pointers = *pointers };
   ctx.pointers.add((uintptr_t)&t);
 
-  using ContentType = OIInternal::TypeHandler<Context, OIInternal::__ROOT_TYPE__>::type;
+  using ContentType = OIInternal::TypeHandler<Context, %3%>::type;
 
   ContentType ret{Context::DataBuffer{v}};
   OIInternal::getSizeType<Context>(ctx, t, ret);
@@ -284,11 +349,63 @@ void __attribute__((used, retain)) introspect_%2$016x(
 )";
 
   code.append(
-      (boost::format(func) % type % std::hash<std::string>{}(type)).str());
+      (boost::format(func) % type % std::hash<std::string>{}(type) % rootType)
+          .str());
+}
+
+/*
+ * DefineTopLevelIntrospectBatch
+ *
+ * Introspects many roots of the same type in one traversal. The roots share a
+ * single PointerHashSet, so data reachable from more than one root is only
+ * recorded below the first root that reaches it. The start of each root's
+ * data is recorded in `offsets`.
+ */
+void FuncGen::DefineTopLevelIntrospectBatch(std::string& code,
+                                            const std::string& type,
+                                            const std::string& rootType) {
+  std::string func = R"(
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-attributes"
+/* RawType: %1% */
+void __attribute__((used, retain)) introspect_batch_%2$016x(
+    const %3%* const* roots,
+    size_t n,
+    std::vector<uint8_t>& v,
+    std::vector<size_t>& offsets)
+#pragma GCC diagnostic pop
+{
+  v.clear();
+  v.reserve(4096);
+  offsets.clear();
+  offsets.reserve(n);
+
+  auto pointers = ScratchPool<PointerHashSet<>>::acquire();
+  pointers->initialize();
+
+  using Context = OIInternal::IntrospectContext;
+  Context ctx{ .pointers = *pointers };
+
+  using ContentType = OIInternal::TypeHandler<Context, %3%>::type;
+
+  for (size_t i = 0; i < n; ++i) {
+    offsets.push_back(v.size());
+    ctx.pointers.add((uintptr_t)roots[i]);
+
+    ContentType ret{Context::DataBuffer{v}};
+    OIInternal::getSizeType<Context>(ctx, *roots[i], ret);
+  }
+}
+)";
+
+  code.append(
+      (boost::format(func) % type % std::hash<std::string>{}(type) % rootType)
+          .str());
 }
 
 void FuncGen::DefineTopLevelIntrospectNamed(std::string& code,
                                             const std::string& type,
+                                            const std::string& rootType,
                                             const std::string& linkageName) {
   std::string typeHash =
       (boost::format("%1$016x") % std::hash<std::string>{}(type)).str();
@@ -298,7 +415,9 @@ void FuncGen::DefineTopLevelIntrospectNamed(std::string& code,
   code += " */\n";
   code += "extern \"C\" IntrospectionResult ";
   code += linkageName;
-  code += "(const OIInternal::__ROOT_TYPE__& t) {\n";
+  code += "(const ";
+  code += rootType;
+  code += "& t) {\n";
   code += "  std::vector<uint8_t> v{};\n";
   code += "  introspect_";
   code += typeHash;
@@ -363,9 +482,26 @@ void FuncGen::DefineTopLevelGetSizeRef(std::string& testCode,
   testCode.append(fmt.str());
 }
 
+/*
+ * DefineTreeBuilderFakeContext
+ *
+ * TreeBuilder instructions only need the static types of the TypeHandlers, not
+ * a working context. Shared by the instructions of every root.
+ */
+void FuncGen::DefineTreeBuilderFakeContext(std::string& code) {
+  code += R"(
+namespace {
+struct FakeContext {
+  using DataBuffer = int;
+};
+} // namespace
+)";
+}
+
 void FuncGen::DefineTreeBuilderInstructions(
     std::string& code,
     const std::string& rawType,
+    const std::string& rootType,
     size_t exclusiveSize,
     std::span<const std::string_view> typeNames) {
   std::string typeHash =
@@ -375,9 +511,6 @@ void FuncGen::DefineTreeBuilderInstructions(
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunknown-attributes"
 namespace {
-struct FakeContext {
-  using DataBuffer = int;
-};
 const std::array<std::string_view, )";
   code += std::to_string(typeNames.size());
   code += "> typeNames";
@@ -391,16 +524,19 @@ const std::array<std::string_view, )";
   code += "};\n";
   code += "const exporters::inst::Field rootInstructions";
   code += typeHash;
-  code += "{sizeof(OIInternal::__ROOT_TYPE__), ";
+  code += "{sizeof(";
+  code += rootType;
+  code += "), ";
   code += std::to_string(exclusiveSize);
   code += ", \"a0\", typeNames";
   code += typeHash;
-  code +=
-      ", OIInternal::TypeHandler<FakeContext, "
-      "OIInternal::__ROOT_TYPE__>::fields, "
-      "OIInternal::TypeHandler<FakeContext, "
-      "OIInternal::__ROOT_TYPE__>::processors, "
-      "std::is_fundamental_v<OIInternal::__ROOT_TYPE__>};\n";
+  code += ", OIInternal::TypeHandler<FakeContext, ";
+  code += rootType;
+  code += ">::fields, OIInternal::TypeHandler<FakeContext, ";
+  code += rootType;
+  code += ">::processors, std::is_fundamental_v<";
+  code += rootType;
+  code += ">};\n";
   code += "} // namespace\n";
   code +=
       "extern const exporters::inst::Inst __attribute__((used, retain)) "
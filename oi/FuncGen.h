@@ -31,6 +31,7 @@ class FuncGen {
  public:
   static void DeclareExterns(std::string& code);
   static void DefineJitLog(std::string& code, FeatureSet features);
+  static void DefineHashTableStats(std::string& code, FeatureSet features);
 
   static void DeclareStoreData(std::string& testCode);
   static void DefineStoreData(std::string& testCode);
@@ -52,18 +53,26 @@ class FuncGen {
 
   static void DeclareGetSize(std::string& testCode, const std::string& type);
 
+  static void DefineIntrospectContext(std::string& code);
   static void DefineTopLevelIntrospect(std::string& code,
-                                       const std::string& type);
+                                       const std::string& type,
+                                       const std::string& rootType);
+  static void DefineTopLevelIntrospectBatch(std::string& code,
+                                            const std::string& type,
+                                            const std::string& rootType);
   static void DefineTopLevelIntrospectNamed(std::string& code,
                                             const std::string& type,
+                                            const std::string& rootType,
                                             const std::string& linkageName);
 
   static void DefineTopLevelGetSizeRef(std::string& testCode,
                                        const std::string& rawType,
                                        FeatureSet features);
+  static void DefineTreeBuilderFakeContext(std::string& code);
   static void DefineTreeBuilderInstructions(
       std::string& testCode,
       const std::string& rawType,
+      const std::string& rootType,
       size_t exclusiveSize,
       std::span<const std::string_view> typeNames);
 
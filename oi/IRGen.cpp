@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "oi/IRGen.h"
+
+#include <glog/logging.h>
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_os_ostream.h>
+
+#include <iostream>
+#include <unordered_set>
+
+#include "oi/Interpreter.h"
+#include "oi/Metrics.h"
+
+namespace oi::detail {
+
+using llvm::BasicBlock;
+using llvm::Function;
+using llvm::FunctionType;
+using llvm::Value;
+
+namespace {
+
+/*
+ * Runtime called by the generated code. The state for one call of the
+ * generated functions is passed around as an opaque pointer.
+ */
+struct Runtime {
+  std::vector<uint8_t>& v;
+  std::vector<size_t>* offsets;
+  std::unordered_set<uintptr_t> pointers;
+};
+
+constexpr std::string_view kBegin = "oi_ir_begin";
+constexpr std::string_view kRoot = "oi_ir_root";
+constexpr std::string_view kWrite = "oi_ir_write";
+constexpr std::string_view kAddPointer = "oi_ir_add_pointer";
+constexpr std::string_view kEnd = "oi_ir_end";
+
+void* runtimeBegin(std::vector<uint8_t>* v,
+                   std::vector<size_t>* offsets,
+                   size_t n) {
+  v->clear();
+  v->reserve(4096);
+  if (offsets != nullptr) {
+    offsets->clear();
+    offsets->reserve(n);
+  }
+  return new Runtime{*v, offsets, {}};
+}
+
+void runtimeRoot(void* rt, const void* object) {
+  auto& runtime = *static_cast<Runtime*>(rt);
+  if (runtime.offsets != nullptr)
+    runtime.offsets->push_back(runtime.v.size());
+  runtime.pointers.insert(reinterpret_cast<uintptr_t>(object));
+}
+
+void runtimeWrite(void* rt, uint64_t val) {
+  auto& v = static_cast<Runtime*>(rt)->v;
+  while (val >= 0x80) {
+    v.push_back(0x80 | (val & 0x7f));
+    val >>= 7;
+  }
+  v.push_back(uint8_t(val));
+}
+
+// Returns a byte rather than a bool so the IR needn't care how the ABI
+// extends i1 return values
+uint8_t runtimeAddPointer(void* rt, uintptr_t p) {
+  auto& runtime = *static_cast<Runtime*>(rt);
+  return p != 0 && runtime.pointers.insert(p).second;
+}
+
+void runtimeEnd(void* rt) {
+  delete static_cast<Runtime*>(rt);
+}
+
+}  // namespace
+
+IRGen::IRGen(llvm::LLVMContext& ctx, const Interpreter& interpreter)
+    : ctx_(ctx), interpreter_(interpreter) {
+}
+
+const std::unordered_map<std::string, uintptr_t>& IRGen::runtimeSymbols() {
+  static const std::unordered_map<std::string, uintptr_t> symbols{
+      {std::string{kBegin}, reinterpret_cast<uintptr_t>(&runtimeBegin)},
+      {std::string{kRoot}, reinterpret_cast<uintptr_t>(&runtimeRoot)},
+      {std::string{kWrite}, reinterpret_cast<uintptr_t>(&runtimeWrite)},
+      {std::string{kAddPointer},
+       reinterpret_cast<uintptr_t>(&runtimeAddPointer)},
+      {std::string{kEnd}, reinterpret_cast<uintptr_t>(&runtimeEnd)},
+  };
+  return symbols;
+}
+
+std::unique_ptr<llvm::Module> IRGen::generate(
+    std::string_view functionName, std::string_view batchFunctionName) {
+  metrics::Tracing _("generate_ir");
+
+  auto module = std::make_unique<llvm::Module>("oil_ir", ctx_);
+  module_ = module.get();
+  declareRuntime();
+
+  // Declare every handler up front, as pointers can form cycles
+  auto* ptrTy = llvm::PointerType::get(ctx_, 0);
+  auto* handlerTy =
+      FunctionType::get(llvm::Type::getVoidTy(ctx_), {ptrTy, ptrTy}, false);
+  handlers_.clear();
+  for (size_t i = 0; i < interpreter_.handlers().size(); ++i) {
+    handlers_.push_back(Function::Create(handlerTy,
+                                         llvm::GlobalValue::InternalLinkage,
+                                         "handler_" + std::to_string(i),
+                                         *module_));
+  }
+  for (uint32_t i = 0; i < handlers_.size(); ++i)
+    genHandler(i);
+
+  genIntrospect(functionName);
+  genIntrospectBatch(batchFunctionName);
+
+  module_ = nullptr;
+  handlers_.clear();
+
+  llvm::raw_os_ostream errs{std::cerr};
+  if (llvm::verifyModule(*module, &errs)) {
+    LOG(ERROR) << "Generated IR failed verification";
+    return nullptr;
+  }
+  return module;
+}
+
+void IRGen::declareRuntime() {
+  auto* voidTy = llvm::Type::getVoidTy(ctx_);
+  auto* i8 = llvm::Type::getInt8Ty(ctx_);
+  auto* i64 = llvm::Type::getInt64Ty(ctx_);
+  auto* ptrTy = llvm::PointerType::get(ctx_, 0);
+
+  auto declare = [this](std::string_view name, FunctionType* type) {
+    return Function::Create(type,
+                            llvm::GlobalValue::ExternalLinkage,
+                            llvm::StringRef{name.data(), name.size()},
+                            *module_);
+  };
+  begin_ =
+      declare(kBegin, FunctionType::get(ptrTy, {ptrTy, ptrTy, i64}, false));
+  root_ = declare(kRoot, FunctionType::get(voidTy, {ptrTy, ptrTy}, false));
+  write_ = declare(kWrite, FunctionType::get(voidTy, {ptrTy, i64}, false));
+  addPointer_ =
+      declare(kAddPointer, FunctionType::get(i8, {ptrTy, i64}, false));
+  end_ = declare(kEnd, FunctionType::get(voidTy, {ptrTy}, false));
+}
+
+void IRGen::genHandler(uint32_t handler) {
+  using Op = Interpreter::Op;
+
+  Function* f = handlers_[handler];
+  Value* rt = f->getArg(0);
+  Value* object = f->getArg(1);
+  llvm::IRBuilder<> builder{BasicBlock::Create(ctx_, "entry", f)};
+
+  const auto& code = interpreter_.code();
+  for (size_t pc = interpreter_.handlers()[handler]; code[pc].op != Op::Return;
+       ++pc) {
+    const auto& ins = code[pc];
+    switch (ins.op) {
+      case Op::Pointer:
+        genPointer(builder, rt, object, ins.handler, ins.offset);
+        break;
+      case Op::Array:
+        genArray(builder,
+                 rt,
+                 object,
+                 ins.handler,
+                 ins.offset,
+                 ins.length,
+                 ins.stride);
+        break;
+      case Op::Return:
+        break;
+    }
+  }
+  builder.CreateRetVoid();
+}
+
+void IRGen::genPointer(llvm::IRBuilderBase& builder,
+                       Value* rt,
+                       Value* object,
+                       uint32_t handler,
+                       size_t offset) {
+  Function* f = builder.GetInsertBlock()->getParent();
+  auto* addr =
+      builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), object, offset);
+  // Members of packed structs may be unaligned
+  auto* p =
+      builder.CreateAlignedLoad(builder.getInt64Ty(), addr, llvm::Align{1});
+  builder.CreateCall(write_, {rt, p});
+  auto* added = builder.CreateCall(addPointer_, {rt, p});
+
+  auto* newBlock = BasicBlock::Create(ctx_, "pointer.new", f);
+  auto* seenBlock = BasicBlock::Create(ctx_, "pointer.seen", f);
+  auto* contBlock = BasicBlock::Create(ctx_, "pointer.cont", f);
+  builder.CreateCondBr(builder.CreateICmpNE(added, builder.getInt8(0)),
+                       newBlock,
+                       seenBlock);
+
+  builder.SetInsertPoint(newBlock);
+  builder.CreateCall(write_, {rt, builder.getInt64(1)});
+  if (handler != Interpreter::kNoHandler) {
+    auto* pointee = builder.CreateIntToPtr(p, llvm::PointerType::get(ctx_, 0));
+    builder.CreateCall(handlers_[handler], {rt, pointee});
+  }
+  builder.CreateBr(contBlock);
+
+  builder.SetInsertPoint(seenBlock);
+  builder.CreateCall(write_, {rt, builder.getInt64(0)});
+  builder.CreateBr(contBlock);
+
+  builder.SetInsertPoint(contBlock);
+}
+
+void IRGen::genArray(llvm::IRBuilderBase& builder,
+                     Value* rt,
+                     Value* object,
+                     uint32_t handler,
+                     size_t offset,
+                     size_t length,
+                     size_t stride) {
+  builder.CreateCall(write_, {rt, builder.getInt64(length)});
+  if (handler == Interpreter::kNoHandler || length == 0)
+    return;
+
+  Function* f = builder.GetInsertBlock()->getParent();
+  auto* base =
+      builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), object, offset);
+  auto* preheader = builder.GetInsertBlock();
+  auto* loopBlock = BasicBlock::Create(ctx_, "array.loop", f);
+  auto* contBlock = BasicBlock::Create(ctx_, "array.cont", f);
+  builder.CreateBr(loopBlock);
+
+  builder.SetInsertPoint(loopBlock);
+  auto* i = builder.CreatePHI(builder.getInt64Ty(), 2);
+  i->addIncoming(builder.getInt64(0), preheader);
+  auto* element =
+      builder.CreateInBoundsGEP(builder.getInt8Ty(),
+                                base,
+                                builder.CreateMul(i, builder.getInt64(stride)));
+  builder.CreateCall(handlers_[handler], {rt, element});
+  auto* next = builder.CreateAdd(i, builder.getInt64(1));
+  i->addIncoming(next, builder.GetInsertBlock());
+  builder.CreateCondBr(builder.CreateICmpULT(next, builder.getInt64(length)),
+                       loopBlock,
+                       contBlock);
+
+  builder.SetInsertPoint(contBlock);
+}
+
+/*
+ * void introspect(const T& object, std::vector<uint8_t>& v)
+ */
+void IRGen::genIntrospect(std::string_view name) {
+  auto* ptrTy = llvm::PointerType::get(ctx_, 0);
+  auto* f = Function::Create(
+      FunctionType::get(llvm::Type::getVoidTy(ctx_), {ptrTy, ptrTy}, false),
+      llvm::GlobalValue::ExternalLinkage,
+      llvm::StringRef{name.data(), name.size()},
+      *module_);
+  Value* object = f->getArg(0);
+  llvm::IRBuilder<> builder{BasicBlock::Create(ctx_, "entry", f)};
+
+  auto* rt = builder.CreateCall(begin_,
+                                {f->getArg(1),
+                                 llvm::ConstantPointerNull::get(ptrTy),
+                                 builder.getInt64(0)});
+  builder.CreateCall(root_, {rt, object});
+  if (interpreter_.rootHandler() != Interpreter::kNoHandler)
+    builder.CreateCall(handlers_[interpreter_.rootHandler()], {rt, object});
+  builder.CreateCall(end_, {rt});
+  builder.CreateRetVoid();
+}
+
+/*
+ * void introspect_batch(const T* const* objects, size_t n,
+ *                       std::vector<uint8_t>& v, std::vector<size_t>& offsets)
+ */
+void IRGen::genIntrospectBatch(std::string_view name) {
+  auto* ptrTy = llvm::PointerType::get(ctx_, 0);
+  auto* i64 = llvm::Type::getInt64Ty(ctx_);
+  auto* f = Function::Create(FunctionType::get(llvm::Type::getVoidTy(ctx_),
+                                               {ptrTy, i64, ptrTy, ptrTy},
+                                               false),
+                             llvm::GlobalValue::ExternalLinkage,
+                             llvm::StringRef{name.data(), name.size()},
+                             *module_);
+  Value* objects = f->getArg(0);
+  Value* n = f->getArg(1);
+  auto* entry = BasicBlock::Create(ctx_, "entry", f);
+  auto* loopBlock = BasicBlock::Create(ctx_, "loop", f);
+  auto* exitBlock = BasicBlock::Create(ctx_, "exit", f);
+  llvm::IRBuilder<> builder{entry};
+
+  auto* rt = builder.CreateCall(begin_, {f->getArg(2), f->getArg(3), n});
+  builder.CreateCondBr(
+      builder.CreateICmpEQ(n, builder.getInt64(0)), exitBlock, loopBlock);
+
+  builder.SetInsertPoint(loopBlock);
+  auto* i = builder.CreatePHI(i64, 2);
+  i->addIncoming(builder.getInt64(0), entry);
+  auto* object =
+      builder.CreateLoad(ptrTy, builder.CreateInBoundsGEP(ptrTy, objects, i));
+  builder.CreateCall(root_, {rt, object});
+  if (interpreter_.rootHandler() != Interpreter::kNoHandler)
+    builder.CreateCall(handlers_[interpreter_.rootHandler()], {rt, object});
+  auto* next = builder.CreateAdd(i, builder.getInt64(1));
+  i->addIncoming(next, loopBlock);
+  builder.CreateCondBr(builder.CreateICmpULT(next, n), loopBlock, exitBlock);
+
+  builder.SetInsertPoint(exitBlock);
+  builder.CreateCall(end_, {rt});
+  builder.CreateRetVoid();
+}
+
+}  // namespace oi::detail
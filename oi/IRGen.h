@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace llvm {
+class Function;
+class IRBuilderBase;
+class LLVMContext;
+class Module;
+class Value;
+}  // namespace llvm
+
+namespace oi::detail {
+
+class Interpreter;
+
+/*
+ * IRGen
+ *
+ * Lowers the Interpreter's bytecode straight to LLVM IR, which
+ * `OICompiler::compile(llvm::Module&, ...)` optimises and emits as an object
+ * file without running the clang frontend over the generated C++. The
+ * functions it defines have the signatures of the generated
+ * `introspect_<hash>` and `introspect_batch_<hash>` and write the same data,
+ * so the Interpreter's tree builder instructions describe their output.
+ *
+ * Each handler becomes a function which calls the handlers of its pointees
+ * and array elements. The bookkeeping IR can't do on its own - appending to
+ * the output vector and tracking seen pointers - is left to runtime functions
+ * in this library. Their addresses must be passed to
+ * `OICompiler::applyRelocs()` as synthetic symbols, see `runtimeSymbols()`.
+ */
+class IRGen {
+ public:
+  IRGen(llvm::LLVMContext& ctx, const Interpreter& interpreter);
+
+  /*
+   * Returns nullptr if the generated module fails verification.
+   */
+  std::unique_ptr<llvm::Module> generate(std::string_view functionName,
+                                         std::string_view batchFunctionName);
+
+  static const std::unordered_map<std::string, uintptr_t>& runtimeSymbols();
+
+ private:
+  void declareRuntime();
+  void genHandler(uint32_t handler);
+  void genPointer(llvm::IRBuilderBase& builder,
+                  llvm::Value* rt,
+                  llvm::Value* object,
+                  uint32_t handler,
+                  size_t offset);
+  void genArray(llvm::IRBuilderBase& builder,
+                llvm::Value* rt,
+                llvm::Value* object,
+                uint32_t handler,
+                size_t offset,
+                size_t length,
+                size_t stride);
+  void genIntrospect(std::string_view name);
+  void genIntrospectBatch(std::string_view name);
+
+  llvm::LLVMContext& ctx_;
+  const Interpreter& interpreter_;
+
+  // Only valid during generate()
+  llvm::Module* module_ = nullptr;
+  std::vector<llvm::Function*> handlers_;
+  llvm::Function* begin_ = nullptr;
+  llvm::Function* root_ = nullptr;
+  llvm::Function* write_ = nullptr;
+  llvm::Function* addPointer_ = nullptr;
+  llvm::Function* end_ = nullptr;
+};
+
+}  // namespace oi::detail
@@ -0,0 +1,571 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "oi/Interpreter.h"
+
+#include <glog/logging.h>
+#include <oi/exporters/ParsedData.h>
+#include <oi/result/Element.h>
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "oi/CodeGen.h"
+#include "oi/type_graph/AddPadding.h"
+#include "oi/type_graph/Types.h"
+
+namespace oi::detail {
+
+using exporters::ParsedData;
+using type_graph::AddPadding;
+using type_graph::Array;
+using type_graph::Class;
+using type_graph::Dummy;
+using type_graph::DummyAllocator;
+using type_graph::Enum;
+using type_graph::Incomplete;
+using type_graph::Pointer;
+using type_graph::Primitive;
+using type_graph::Reference;
+using type_graph::Type;
+using type_graph::Typedef;
+
+namespace inst = exporters::inst;
+namespace dy = types::dy;
+
+namespace {
+
+class UnsupportedType : public std::runtime_error {
+ public:
+  explicit UnsupportedType(const Type& type)
+      : std::runtime_error("unsupported type: " + type.name()) {
+  }
+};
+
+const Type& strip(const Type& type) {
+  const Type* t = &type;
+  while (const auto* td = dynamic_cast<const Typedef*>(t))
+    t = &td->underlyingType();
+  return *t;
+}
+
+const Type* pointeeOf(const Type& type) {
+  if (const auto* p = dynamic_cast<const Pointer*>(&type))
+    return &p->pointeeType();
+  if (const auto* r = dynamic_cast<const Reference*>(&type))
+    return &r->pointeeType();
+  return nullptr;
+}
+
+// Mirrors `oi_is_complete` in the generated code
+bool isComplete(const Type& type) {
+  const Type& t = strip(type);
+  if (dynamic_cast<const Incomplete*>(&t))
+    return false;
+  if (const auto* p = dynamic_cast<const Primitive*>(&t))
+    return p->kind() != Primitive::Kind::Void;
+  return true;
+}
+
+void writeVarInt(std::vector<uint8_t>& v, uint64_t val) {
+  while (val >= 0x80) {
+    v.push_back(0x80 | (val & 0x7f));
+    val >>= 7;
+  }
+  v.push_back(uint8_t(val));
+}
+
+/*
+ * Processors are plain function pointers, so unlike the generated ones they
+ * can't be specialised on the type they process. Instead, the child field of
+ * each pointer or array field is looked up by the address of that field's
+ * type names, which every field owns.
+ */
+struct Child {
+  const inst::Field* field;
+  size_t length;
+};
+
+std::shared_mutex& childrenMutex() {
+  static std::shared_mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<const std::string_view*, Child>& children() {
+  static std::unordered_map<const std::string_view*, Child> children;
+  return children;
+}
+
+Child lookupChild(const result::Element& el) {
+  std::shared_lock lock{childrenMutex()};
+  if (auto it = children().find(el.type_names.data()); it != children().end())
+    return it->second;
+  return {nullptr, 0};
+}
+
+void processPointer(result::Element& el,
+                    std::function<void(inst::Inst)> stack_ins,
+                    ParsedData d) {
+  el.pointer = std::get<ParsedData::VarInt>(d.val).value;
+}
+
+void processPointerContent(result::Element& el,
+                           std::function<void(inst::Inst)> stack_ins,
+                           ParsedData d) {
+  const ParsedData::Sum& sum = std::get<ParsedData::Sum>(d.val);
+
+  el.container_stats.emplace(
+      result::Element::ContainerStats{.capacity = 1, .length = 0});
+  if (sum.index == 0)
+    return;
+  el.container_stats->length = 1;
+
+  if (auto child = lookupChild(el); child.field != nullptr)
+    stack_ins(*child.field);
+}
+
+void processArray(result::Element& el,
+                  std::function<void(inst::Inst)> stack_ins,
+                  ParsedData d) {
+  auto child = lookupChild(el);
+
+  el.exclusive_size = 0;
+  el.container_stats.emplace(result::Element::ContainerStats{
+      .capacity = child.length, .length = child.length});
+
+  for (size_t i = 0; i < child.length; i++)
+    stack_ins(*child.field);
+}
+
+const dy::Unit kUnit{};
+const dy::VarInt kVarInt{};
+
+}  // namespace
+
+/*
+ * Builder
+ *
+ * Lowers a type graph to bytecode and builds the matching tree builder
+ * instructions. Both follow the TypeHandlers generated by CodeGen, which
+ * remain the reference for what is written for each type.
+ */
+class Interpreter::Builder {
+ public:
+  explicit Builder(Interpreter& interp) : interp_(interp) {
+  }
+
+  void build(const Type& root);
+
+ private:
+  struct TypeInfo {
+    dy::Dynamic type;
+    std::span<const inst::Field> fields;
+    std::span<const inst::ProcessorInst> processors;
+  };
+
+  // Pointees may be recursive, so are resolved once the rest is built
+  struct PendingChild {
+    const std::string_view* key;
+    const Type* type;
+    std::string_view name;
+    size_t length;
+  };
+  struct PendingVariant {
+    dy::Dynamic* slot;
+    const Type* type;
+  };
+
+  uint32_t handler(const Type& type);
+  void emit(const Type& type, size_t offset, std::vector<Instruction>& code);
+
+  const TypeInfo& info(const Type& type);
+  TypeInfo classInfo(const Class& c);
+  TypeInfo pointerInfo(const Type& pointee);
+  TypeInfo arrayInfo(const Array& a);
+
+  inst::Field makeField(const Type& type,
+                        size_t staticSize,
+                        size_t exclusiveSize,
+                        std::string_view name,
+                        std::vector<std::string_view> typeNames,
+                        bool isPrimitive);
+  const inst::Field& childField(const Type& type, std::string_view name);
+  std::string_view intern(std::string_view str);
+
+  Interpreter& interp_;
+  std::unordered_map<const Type*, uint32_t> handlerIds_;
+  std::unordered_map<const Type*, TypeInfo> infos_;
+  std::map<std::pair<const Type*, std::string_view>, const inst::Field*>
+      childFieldIndex_;
+  std::vector<PendingChild> pendingChildren_;
+  std::vector<PendingVariant> pendingVariants_;
+};
+
+void Interpreter::Builder::build(const Type& root) {
+  interp_.rootHandler_ = handler(root);
+
+  bool isPrimitive = dynamic_cast<const Primitive*>(&strip(root)) != nullptr;
+  auto rootField = makeField(root,
+                             root.size(),
+                             calculateExclusiveSize(root),
+                             "a0",
+                             enumerateTypeNames(root),
+                             isPrimitive);
+  interp_.instructions_ =
+      std::cref(interp_.childFields_.emplace_back(rootField));
+
+  while (!pendingChildren_.empty() || !pendingVariants_.empty()) {
+    if (!pendingVariants_.empty()) {
+      auto [slot, type] = pendingVariants_.back();
+      pendingVariants_.pop_back();
+      *slot = info(*type).type;
+      continue;
+    }
+
+    auto [key, type, name, length] = pendingChildren_.back();
+    pendingChildren_.pop_back();
+    const inst::Field& field = childField(*type, name);
+
+    std::unique_lock lock{childrenMutex()};
+    children().emplace(key, Child{&field, length});
+    interp_.childKeys_.push_back(key);
+  }
+}
+
+/*
+ * Returns the handler which walks an object of the given type, or kNoHandler
+ * if it writes nothing. Handlers are only needed for pointees and array
+ * elements: members are walked inline by their parent's handler.
+ */
+uint32_t Interpreter::Builder::handler(const Type& type) {
+  const Type& t = strip(type);
+  if (auto it = handlerIds_.find(&t); it != handlerIds_.end())
+    return it->second;
+
+  // Reserve the id first, as a pointer may lead back here
+  auto id = static_cast<uint32_t>(interp_.handlers_.size());
+  interp_.handlers_.push_back(0);
+  handlerIds_.emplace(&t, id);
+
+  std::vector<Instruction> code;
+  emit(t, 0, code);
+  if (code.empty()) {
+    // Nothing was emitted, so no other handlers were reserved after this one
+    interp_.handlers_.pop_back();
+    handlerIds_[&t] = kNoHandler;
+    return kNoHandler;
+  }
+
+  interp_.handlers_[id] = static_cast<uint32_t>(interp_.code_.size());
+  interp_.code_.insert(interp_.code_.end(), code.begin(), code.end());
+  interp_.code_.push_back(Instruction{Op::Return, kNoHandler, 0, 0, 0});
+  return id;
+}
+
+void Interpreter::Builder::emit(const Type& type,
+                                size_t offset,
+                                std::vector<Instruction>& code) {
+  const Type& t = strip(type);
+
+  if (const auto* c = dynamic_cast<const Class*>(&t)) {
+    for (const auto& member : c->members()) {
+      // Bitfields can only hold primitives and enums, which write nothing
+      if (member.name.starts_with(AddPadding::MemberPrefix) || member.bitsize)
+        continue;
+      emit(member.type(), offset + member.bitOffset / 8, code);
+    }
+  } else if (const auto* pointee = pointeeOf(t)) {
+    uint32_t h = isComplete(*pointee) ? handler(*pointee) : kNoHandler;
+    code.push_back(Instruction{Op::Pointer, h, offset, 0, 0});
+  } else if (const auto* a = dynamic_cast<const Array*>(&t)) {
+    uint32_t h = handler(a->elementType());
+    code.push_back(
+        Instruction{Op::Array, h, offset, a->len(), a->elementType().size()});
+  } else if (dynamic_cast<const Primitive*>(&t) ||
+             dynamic_cast<const Enum*>(&t) || dynamic_cast<const Dummy*>(&t) ||
+             dynamic_cast<const DummyAllocator*>(&t) ||
+             dynamic_cast<const Incomplete*>(&t)) {
+    // Handled by the default TypeHandler, which writes nothing
+  } else {
+    // Containers and CaptureKeys need their .toml handlers compiled
+    throw UnsupportedType{t};
+  }
+}
+
+const Interpreter::Builder::TypeInfo& Interpreter::Builder::info(
+    const Type& type) {
+  const Type& t = strip(type);
+  if (auto it = infos_.find(&t); it != infos_.end())
+    return it->second;
+
+  TypeInfo info{kUnit, {}, {}};
+  if (const auto* c = dynamic_cast<const Class*>(&t)) {
+    info = classInfo(*c);
+  } else if (const auto* pointee = pointeeOf(t)) {
+    info = pointerInfo(*pointee);
+  } else if (const auto* a = dynamic_cast<const Array*>(&t)) {
+    info = arrayInfo(*a);
+  }
+  return infos_.emplace(&t, info).first->second;
+}
+
+// See CodeGen::genClassStaticType and genClassTreeBuilderInstructions
+Interpreter::Builder::TypeInfo Interpreter::Builder::classInfo(
+    const Class& c) {
+  std::vector<inst::Field> fields;
+  std::vector<dy::Dynamic> types;
+  for (const auto& m : c.members()) {
+    if (m.name.starts_with(AddPadding::MemberPrefix))
+      continue;
+
+    bool isBitfield = m.bitsize != 0;
+    fields.push_back(
+        makeField(m.type(),
+                  isBitfield ? 0 : m.type().size(),
+                  isBitfield ? 0 : calculateExclusiveSize(m.type()),
+                  intern(m.inputName),
+                  enumerateTypeNames(m.type()),
+                  dynamic_cast<const Primitive*>(&m.type()) != nullptr));
+    types.push_back(info(m.type()).type);
+  }
+
+  // Pair<T0, Pair<T1, ... Tn>>
+  dy::Dynamic type = kUnit;
+  if (!types.empty()) {
+    type = types.back();
+    for (auto it = types.rbegin() + 1; it != types.rend(); ++it)
+      type = interp_.pairs_.emplace_back(*it, type);
+  }
+
+  const auto& stored = interp_.fields_.emplace_back(std::move(fields));
+  return TypeInfo{type, stored, {}};
+}
+
+// See the pointer case of the default TypeHandler in FuncGen
+Interpreter::Builder::TypeInfo Interpreter::Builder::pointerInfo(
+    const Type& pointee) {
+  auto& variants = interp_.variants_.emplace_back(
+      std::array<dy::Dynamic, 2>{kUnit, kUnit});
+  if (isComplete(pointee))
+    pendingVariants_.push_back(PendingVariant{&variants[1], &pointee});
+
+  const auto& content = interp_.sums_.emplace_back(variants);
+  const auto& type = interp_.pairs_.emplace_back(kVarInt, content);
+
+  const auto& processors =
+      interp_.processors_.emplace_back(std::vector<inst::ProcessorInst>{
+          {kVarInt, &processPointer},
+          {content, &processPointerContent},
+      });
+  return TypeInfo{type, {}, processors};
+}
+
+// See FuncGen::GetOiArrayContainerInfo
+Interpreter::Builder::TypeInfo Interpreter::Builder::arrayInfo(
+    const Array& a) {
+  const auto& type = interp_.lists_.emplace_back(info(a.elementType()).type);
+  const auto& processors =
+      interp_.processors_.emplace_back(std::vector<inst::ProcessorInst>{
+          {type, &processArray},
+      });
+  return TypeInfo{type, {}, processors};
+}
+
+inst::Field Interpreter::Builder::makeField(
+    const Type& type,
+    size_t staticSize,
+    size_t exclusiveSize,
+    std::string_view name,
+    std::vector<std::string_view> typeNames,
+    bool isPrimitive) {
+  static constexpr std::array<std::string_view, 0> kNoNames{};
+  static constexpr std::array<inst::Field, 0> kNoFields{};
+  static constexpr std::array<inst::ProcessorInst, 0> kNoProcessors{};
+
+  for (auto& typeName : typeNames)
+    typeName = intern(typeName);
+  const auto& names = interp_.typeNames_.emplace_back(std::move(typeNames));
+
+  const auto& typeInfo = info(type);
+  inst::Field field{staticSize,
+                    exclusiveSize,
+                    name,
+                    kNoNames,
+                    kNoFields,
+                    kNoProcessors,
+                    isPrimitive};
+  field.type_names = names;
+  field.fields = typeInfo.fields;
+  field.processors = typeInfo.processors;
+
+  const Type& t = strip(type);
+  if (const auto* pointee = pointeeOf(t)) {
+    if (isComplete(*pointee))
+      pendingChildren_.push_back(
+          PendingChild{names.data(), pointee, "*", 0});
+  } else if (const auto* a = dynamic_cast<const Array*>(&t)) {
+    pendingChildren_.push_back(
+        PendingChild{names.data(), &a->elementType(), "[]", a->len()});
+  }
+  return field;
+}
+
+// The field for a pointee or array element. See `make_field` in FuncGen.
+const inst::Field& Interpreter::Builder::childField(const Type& type,
+                                                    std::string_view name) {
+  auto key = std::make_pair(&type, name);
+  if (auto it = childFieldIndex_.find(key); it != childFieldIndex_.end())
+    return *it->second;
+
+  const Type& t = strip(type);
+  std::vector<std::string_view> typeNames;
+  if (!dynamic_cast<const Dummy*>(&t))
+    typeNames.push_back(t.inputName());
+
+  // Keep the names storage unique even when empty, as it's used as a key
+  typeNames.reserve(1);
+
+  const auto& field = interp_.childFields_.emplace_back(
+      makeField(type,
+                type.size(),
+                calculateExclusiveSize(type),
+                name,
+                std::move(typeNames),
+                dynamic_cast<const Primitive*>(&t) != nullptr));
+  childFieldIndex_.emplace(key, &field);
+  return field;
+}
+
+std::string_view Interpreter::Builder::intern(std::string_view str) {
+  return interp_.strings_.emplace_back(str);
+}
+
+std::unique_ptr<Interpreter> Interpreter::compile(const Type& root) {
+  std::unique_ptr<Interpreter> interp{new Interpreter};
+  try {
+    Builder{*interp}.build(root);
+  } catch (const UnsupportedType& err) {
+    LOG(INFO) << "Can't interpret " << root.name() << ": " << err.what();
+    return nullptr;
+  }
+
+  VLOG(1) << "Interpreter bytecode for " << root.name() << ": "
+          << interp->handlers_.size() << " handlers, " << interp->code_.size()
+          << " instructions";
+  return interp;
+}
+
+Interpreter::~Interpreter() {
+  std::unique_lock lock{childrenMutex()};
+  for (const auto* key : childKeys_)
+    children().erase(key);
+}
+
+void Interpreter::introspect(const void* object,
+                             std::vector<uint8_t>& v) const {
+  v.clear();
+  v.reserve(4096);
+
+  std::unordered_set<uintptr_t> pointers;
+  pointers.insert(reinterpret_cast<uintptr_t>(object));
+  run(object, v, pointers);
+}
+
+void Interpreter::introspectBatch(const void* const* objects,
+                                  size_t n,
+                                  std::vector<uint8_t>& v,
+                                  std::vector<size_t>& offsets) const {
+  v.clear();
+  v.reserve(4096);
+  offsets.clear();
+  offsets.reserve(n);
+
+  std::unordered_set<uintptr_t> pointers;
+  for (size_t i = 0; i < n; ++i) {
+    offsets.push_back(v.size());
+    pointers.insert(reinterpret_cast<uintptr_t>(objects[i]));
+    run(objects[i], v, pointers);
+  }
+}
+
+/*
+ * Walks the object with an explicit stack rather than recursing, so long
+ * chains of pointers can't overflow the caller's stack. A frame repeats its
+ * handler `remaining` times to walk the elements of an array.
+ */
+void Interpreter::run(const void* object,
+                      std::vector<uint8_t>& v,
+                      std::unordered_set<uintptr_t>& pointers) const {
+  if (rootHandler_ == kNoHandler)
+    return;
+
+  struct Frame {
+    const Instruction* start;
+    const Instruction* pc;
+    const uint8_t* base;
+    size_t remaining;
+    size_t stride;
+  };
+  std::vector<Frame> stack;
+  auto push = [this, &stack](
+                  uint32_t handler, const void* base, size_t n, size_t stride) {
+    const Instruction* start = &code_[handlers_[handler]];
+    stack.push_back(
+        Frame{start, start, static_cast<const uint8_t*>(base), n, stride});
+  };
+
+  push(rootHandler_, object, 1, 0);
+  while (!stack.empty()) {
+    Frame& frame = stack.back();
+    const Instruction& ins = *frame.pc++;
+
+    switch (ins.op) {
+      case Op::Pointer: {
+        uintptr_t p;
+        std::memcpy(&p, frame.base + ins.offset, sizeof(p));
+        writeVarInt(v, p);
+        if (p != 0 && pointers.insert(p).second) {
+          writeVarInt(v, 1);
+          if (ins.handler != kNoHandler)
+            push(ins.handler, reinterpret_cast<const void*>(p), 1, 0);
+        } else {
+          writeVarInt(v, 0);
+        }
+        break;
+      }
+      case Op::Array:
+        writeVarInt(v, ins.length);
+        if (ins.handler != kNoHandler && ins.length != 0)
+          push(ins.handler, frame.base + ins.offset, ins.length, ins.stride);
+        break;
+      case Op::Return:
+        if (--frame.remaining == 0) {
+          stack.pop_back();
+        } else {
+          frame.base += frame.stride;
+          frame.pc = frame.start;
+        }
+        break;
+    }
+  }
+}
+
+}  // namespace oi::detail
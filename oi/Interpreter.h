@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <oi/exporters/inst.h>
+#include <oi/types/dy.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace oi::detail::type_graph {
+class Type;
+}
+
+namespace oi::detail {
+
+/*
+ * Interpreter
+ *
+ * An alternative to compiling the generated traversal code: the final type
+ * graph is lowered to a compact bytecode which a precompiled interpreter runs
+ * over the object in-process. The interpreter writes exactly the bytes the
+ * compiled TypeHandlers would, so its data can be read with either its own
+ * tree builder instructions or the compiled ones.
+ *
+ * Classes, primitives, enums, pointers and arrays are supported. Containers
+ * are implemented by arbitrary C++ in their .toml definitions, so any graph
+ * containing one has to be compiled.
+ */
+class Interpreter {
+ public:
+  /*
+   * Returns nullptr if the type graph below `root` contains types which the
+   * interpreter does not support. `root` must have been through all of
+   * CodeGen's passes.
+   */
+  static std::unique_ptr<Interpreter> compile(const type_graph::Type& root);
+
+  ~Interpreter();
+  Interpreter(const Interpreter&) = delete;
+  Interpreter& operator=(const Interpreter&) = delete;
+
+  /*
+   * Equivalent to the generated `introspect_<hash>` and
+   * `introspect_batch_<hash>` functions.
+   */
+  void introspect(const void* object, std::vector<uint8_t>& v) const;
+  void introspectBatch(const void* const* objects,
+                       size_t n,
+                       std::vector<uint8_t>& v,
+                       std::vector<size_t>& offsets) const;
+
+  const exporters::inst::Inst& instructions() const {
+    return instructions_;
+  }
+
+  /*
+   * The bytecode, for backends which lower it further. See IRGen.
+   */
+  enum class Op : uint8_t {
+    Pointer,  // write the pointer, then its pointee if not seen before
+    Array,    // write the length, then each element
+    Return,
+  };
+
+  static constexpr uint32_t kNoHandler = UINT32_MAX;
+
+  struct Instruction {
+    Op op;
+    // Handler for the pointee or elements, kNoHandler if they write nothing
+    uint32_t handler;
+    // Offset of the pointer or array from the start of the handler's object
+    size_t offset;
+    size_t length;
+    size_t stride;
+  };
+
+  const std::vector<Instruction>& code() const {
+    return code_;
+  }
+  // Index into code() of each handler's first instruction
+  const std::vector<uint32_t>& handlers() const {
+    return handlers_;
+  }
+  uint32_t rootHandler() const {
+    return rootHandler_;
+  }
+
+ private:
+  class Builder;
+
+  Interpreter() = default;
+
+  void run(const void* object,
+           std::vector<uint8_t>& v,
+           std::unordered_set<uintptr_t>& pointers) const;
+
+  // Bytecode: each handler is a run of instructions ending in Return
+  std::vector<Instruction> code_;
+  std::vector<uint32_t> handlers_;
+  uint32_t rootHandler_ = kNoHandler;
+
+  // Storage for the tree builder instructions. Deques never move their
+  // elements, so the spans and references into them stay valid.
+  std::deque<std::string> strings_;
+  std::deque<std::vector<std::string_view>> typeNames_;
+  std::deque<std::vector<exporters::inst::Field>> fields_;
+  // Fields of pointees and array elements, and the root field
+  std::deque<exporters::inst::Field> childFields_;
+  std::deque<std::vector<exporters::inst::ProcessorInst>> processors_;
+  std::deque<types::dy::Pair> pairs_;
+  std::deque<types::dy::Sum> sums_;
+  std::deque<types::dy::List> lists_;
+  std::deque<std::array<types::dy::Dynamic, 2>> variants_;
+  // Keys registered with the processors, removed again on destruction
+  std::vector<const std::string_view*> childKeys_;
+  exporters::inst::Inst instructions_ = exporters::inst::PopTypePath{};
+};
+
+}  // namespace oi::detail
@@ -78,6 +78,8 @@ IntrospectionResult::const_iterator::operator++() {
                 .exclusive_size = ty.exclusive_size,
                 .container_stats = std::nullopt,
                 .is_set_stats = std::nullopt,
+                .hash_table_stats = std::nullopt,
+                .allocated_size = std::nullopt,
                 .is_primitive = ty.is_primitive,
             });
 
@@ -98,6 +98,10 @@ long Tracing::fetchRssUsage() {
     return 0;
   }
 
+  return currentRssKB();
+}
+
+long Tracing::currentRssKB() {
   std::ifstream statStream("/proc/self/stat");
 
   // Placeholders as we don't care about these at the minute. There are more
@@ -134,7 +138,8 @@ void Tracing::stop() {
                             std::move(traceName),
                             duration.count(),
                             rssBeforeBytes,
-                            rssAfterBytes});
+                            rssAfterBytes,
+                            std::move(values)});
 }
 
 void Tracing::saveTraces(const std::filesystem::path& output) {
@@ -162,6 +167,10 @@ void Tracing::saveTraces(const std::filesystem::path& output) {
       osf << ",\"rss_after_bytes\":" << span.rssAfterBytes;
     }
 
+    for (const auto& [key, value] : span.values) {
+      osf << ",\"" << key << "\":" << value;
+    }
+
     osf << "}";
   }
   osf << "]\n";
@@ -194,6 +203,9 @@ std::ostream& operator<<(std::ostream& out, const Span& span) {
   out << "  Duration: " << span.duration << " ns\n";
   out << "  RSS before: " << span.rssBeforeBytes << " bytes\n";
   out << "  RSS after: " << span.rssAfterBytes << " bytes\n";
+  for (const auto& [key, value] : span.values) {
+    out << "  " << key << ": " << value << "\n";
+  }
   return out;
 }
 
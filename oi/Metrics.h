@@ -20,6 +20,7 @@
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace oi::detail::metrics {
@@ -50,6 +51,7 @@ struct Span {
   int64_t duration;
   long rssBeforeBytes;
   long rssAfterBytes;
+  std::vector<std::pair<std::string, int64_t>> values;
 };
 
 class Tracing final {
@@ -147,6 +149,17 @@ class Tracing final {
     traceName = std::move(name);
   }
 
+  /*
+   * Attaches an extra named value to this span, e.g. the number of items
+   * processed, which is written out alongside the time and RSS metrics.
+   */
+  void addValue(std::string key, int64_t value) {
+    if (!Tracing::isEnabled()) {
+      return;
+    }
+    values.emplace_back(std::move(key), value);
+  }
+
   void stop();
 
   static TraceFlags& isEnabled() {
@@ -155,6 +168,9 @@ class Tracing final {
   static const char* outputPath();
   static void saveTraces(const std::filesystem::path&);
 
+  // Current RSS of this process in KB, regardless of the enabled metrics
+  static long currentRssKB();
+
  private:
   static uint32_t getNextIndex();
   static TimePoint fetchTime();
@@ -164,6 +180,7 @@ class Tracing final {
   std::string traceName{};
   TimePoint startTs{Tracing::fetchTime()};
   long rssBeforeBytes{Tracing::fetchRssUsage()};
+  std::vector<std::pair<std::string, int64_t>> values{};
 };
 
 std::ostream& operator<<(std::ostream&, const TraceFlags&);
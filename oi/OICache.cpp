@@ -70,6 +70,14 @@ std::optional<fs::path> OICache::getPath(const irequest& req,
 
   auto ext = extensions[static_cast<size_t>(ent)];
 
+  if (ent == Entity::ClassHierarchy) {
+    auto buildID = symbols->locateBuildID();
+    if (!buildID.has_value()) {
+      return std::nullopt;
+    }
+    return basePath / (hash(*buildID) + ext);
+  }
+
   const auto& entName = getEntName(*symbols, req, ent);
   if (!entName.has_value()) {
     return std::nullopt;
@@ -159,6 +167,7 @@ INSTANTIATE_ARCHIVE(std::unordered_map<std::string, std::shared_ptr<FuncDesc>>)
 INSTANTIATE_ARCHIVE(
     std::unordered_map<std::string, std::shared_ptr<GlobalDesc>>)
 INSTANTIATE_ARCHIVE(std::map<std::string, PaddingInfo>)
+INSTANTIATE_ARCHIVE(type_graph::ClassHierarchyIndex)
 
 #undef INSTANTIATE_ARCHIVE
 
@@ -170,6 +179,9 @@ bool OICache::upload([[maybe_unused]] const irequest& req) {
   std::vector<std::filesystem::path> files;
 
   for (size_t i = 0; i < static_cast<size_t>(OICache::Entity::MAX); i++) {
+    // Only present with polymorphic inheritance, and shared between requests
+    if (static_cast<OICache::Entity>(i) == OICache::Entity::ClassHierarchy)
+      continue;
     auto cachePath = getPath(req, static_cast<OICache::Entity>(i));
     if (!cachePath.has_value()) {
       LOG(ERROR) << "Failed to get cache path for " << req.type << ':'
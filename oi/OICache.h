@@ -52,10 +52,11 @@ class OICache {
     GlobalDescs,
     TypeHierarchy,
     PaddingInfo,
+    ClassHierarchy,  // Shared by every request against the same build ID
     MAX
   };
   static constexpr std::array<const char*, static_cast<size_t>(Entity::MAX)>
-      extensions{".cc", ".o", ".fd", ".gd", ".th", ".pd"};
+      extensions{".cc", ".o", ".fd", ".gd", ".th", ".pd", ".ch"};
 
   bool isEnabled() const {
     return !basePath.empty();
@@ -3067,6 +3067,7 @@ bool OICodeGen::generateJitCode(std::string& code) {
   code.append("} // namespace\n");
 
   FuncGen::DefineJitLog(code, config.features);
+  FuncGen::DefineHashTableStats(code, config.features);
 
   // The purpose of the anonymous namespace within `OIInternal` is that
   // anything defined within an anonymous namespace has internal-linkage,
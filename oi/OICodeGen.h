@@ -29,6 +29,7 @@ struct irequest;
 #include "oi/Features.h"
 #include "oi/FuncGen.h"
 #include "oi/PaddingHunter.h"
+#include "oi/SizeClasses.h"
 #include "oi/TypeHierarchy.h"
 
 extern "C" {
@@ -72,6 +73,14 @@ class OICodeGen {
     std::vector<std::pair<std::string, std::string>> membersToStub;
     std::vector<ContainerInfo> passThroughTypes;
     std::vector<KeyToCapture> keysToCapture;
+    // Print a table of the time and memory used by each type graph pass
+    bool profilePasses = false;
+    // Number of translation units to split the generated code into, so they
+    // can be compiled concurrently. From the config file's [codegen] table.
+    size_t codegenUnits = 1;
+    // From the config file's [allocator] table. Without it the allocator
+    // is guessed from the target's symbols.
+    std::optional<SizeClasses> sizeClasses;
 
     std::string toString() const;
     std::vector<std::string> toOptions() const;
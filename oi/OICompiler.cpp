@@ -31,15 +31,22 @@
 #include <llvm/Demangle/Demangle.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/RTDyldMemoryManager.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
 #include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
 #if LLVM_VERSION_MAJOR >= 16
 #include <llvm/TargetParser/Host.h>
 #else
 #include <llvm/Support/Host.h>
 #endif
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Memory.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/ThreadPool.h>
 #include <llvm/Support/raw_os_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
 
 #if LLVM_VERSION_MAJOR <= 15
 #include <llvm/ADT/Triple.h>
@@ -48,6 +55,7 @@
 #endif
 
 #include <array>
+#include <atomic>
 #include <boost/range/combine.hpp>
 #include <boost/scope_exit.hpp>
 
@@ -383,8 +391,9 @@ JITSymbol OIMemoryManager::findSymbol(const std::string& name) {
     return JITSymbol(sym->addr, JITSymbolFlags::Exported);
   }
 
-  if (name.compare(0, 37, "_ZN6apache6thrift18TStructDataStorage") == 0 &&
-      name.compare(name.size() - 16, 16, "13isset_indexesE") == 0) {
+  if ((name.compare(0, 37, "_ZN6apache6thrift18TStructDataStorage") == 0 &&
+       name.compare(name.size() - 16, 16, "13isset_indexesE") == 0) ||
+      name == "nallocx") {
     /*
      * Hack to make weak symbols work with MCJIT.
      *
@@ -606,7 +615,7 @@ bool OICompiler::compile(const std::string& code,
     compInv->getCodeGenOpts().RelocationModel = llvm::Reloc::Static;
   }
   compInv->getCodeGenOpts().CodeModel = "large";
-  compInv->getCodeGenOpts().OptimizationLevel = 3;
+  compInv->getCodeGenOpts().OptimizationLevel = config.optimizationLevel;
   compInv->getCodeGenOpts().NoUseJumpTables = 1;
 
   if (config.features[Feature::GenJitDebug]) {
@@ -654,6 +663,110 @@ bool OICompiler::compile(const std::string& code,
   return true;
 }
 
+bool OICompiler::compile(std::span<const Unit> units, unsigned numThreads) {
+  if (units.size() == 1)
+    return compile(units[0].code, units[0].sourcePath, units[0].objectPath);
+
+  metrics::Tracing _("compile_units");
+
+  // Each compilation has its own CompilerInstance, so they share no state
+  std::atomic<bool> ok = true;
+  llvm::ThreadPool pool{llvm::hardware_concurrency(numThreads)};
+  for (const auto& unit : units) {
+    pool.async([this, &ok, &unit]() {
+      if (!compile(unit.code, unit.sourcePath, unit.objectPath)) {
+        LOG(ERROR) << "Failed to compile " << unit.sourcePath;
+        ok = false;
+      }
+    });
+  }
+  pool.wait();
+
+  return ok;
+}
+
+bool OICompiler::compile(llvm::Module& module, const fs::path& objectPath) {
+  metrics::Tracing _("compile_ir");
+
+  auto triple = llvm::Triple::normalize(llvm::sys::getProcessTriple());
+  std::string error;
+  const auto* target = TargetRegistry::lookupTarget(triple, error);
+  if (target == nullptr) {
+    LOG(ERROR) << "Failed to look up target " << triple << ": " << error;
+    return false;
+  }
+
+  unsigned level = std::min(config.optimizationLevel, 3U);
+#if LLVM_VERSION_MAJOR >= 18
+  static constexpr std::array<CodeGenOptLevel, 4> codegenLevels{
+      CodeGenOptLevel::None,
+      CodeGenOptLevel::Less,
+      CodeGenOptLevel::Default,
+      CodeGenOptLevel::Aggressive,
+  };
+  constexpr auto objectFile = CodeGenFileType::ObjectFile;
+#else
+  static constexpr std::array<CodeGenOpt::Level, 4> codegenLevels{
+      CodeGenOpt::None,
+      CodeGenOpt::Less,
+      CodeGenOpt::Default,
+      CodeGenOpt::Aggressive,
+  };
+  constexpr auto objectFile = CGFT_ObjectFile;
+#endif
+  static const std::array<OptimizationLevel, 4> optLevels{
+      OptimizationLevel::O0,
+      OptimizationLevel::O1,
+      OptimizationLevel::O2,
+      OptimizationLevel::O3,
+  };
+
+  // Same relocation and code models as the C++ path above
+  std::unique_ptr<TargetMachine> targetMachine{target->createTargetMachine(
+      triple,
+      llvm::sys::getHostCPUName(),
+      "",
+      llvm::TargetOptions{},
+      config.usePIC ? llvm::Reloc::PIC_ : llvm::Reloc::Static,
+      llvm::CodeModel::Large,
+      codegenLevels[level])};
+  module.setTargetTriple(triple);
+  module.setDataLayout(targetMachine->createDataLayout());
+
+  LoopAnalysisManager lam;
+  FunctionAnalysisManager fam;
+  CGSCCAnalysisManager cgam;
+  ModuleAnalysisManager mam;
+  PassBuilder passBuilder{targetMachine.get()};
+  passBuilder.registerModuleAnalyses(mam);
+  passBuilder.registerCGSCCAnalyses(cgam);
+  passBuilder.registerFunctionAnalyses(fam);
+  passBuilder.registerLoopAnalyses(lam);
+  passBuilder.crossRegisterProxies(lam, fam, cgam, mam);
+
+  ModulePassManager mpm =
+      level == 0 ? passBuilder.buildO0DefaultPipeline(OptimizationLevel::O0)
+                 : passBuilder.buildPerModuleDefaultPipeline(optLevels[level]);
+  mpm.run(module, mam);
+
+  std::error_code ec;
+  raw_fd_ostream out{objectPath.string(), ec, sys::fs::OF_None};
+  if (ec) {
+    LOG(ERROR) << "Failed to open " << objectPath << ": " << ec.message();
+    return false;
+  }
+
+  legacy::PassManager codegen;
+  if (targetMachine->addPassesToEmitFile(codegen, out, nullptr, objectFile)) {
+    LOG(ERROR) << "Target " << triple << " can't emit object files";
+    return false;
+  }
+  codegen.run(module);
+  out.flush();
+
+  return true;
+}
+
 std::optional<OICompiler::RelocResult> OICompiler::applyRelocs(
     uintptr_t baseRelocAddress,
     const std::set<fs::path>& objectFiles,
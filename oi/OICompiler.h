@@ -33,6 +33,10 @@
 #include "oi/SymbolService.h"
 #include "oi/X86InstDefs.h"
 
+namespace llvm {
+class Module;
+}
+
 namespace oi::detail {
 
 namespace fs = std::filesystem;
@@ -54,6 +58,12 @@ class OICompiler {
     std::vector<fs::path> sysHeaderPaths{};
 
     bool usePIC = false;
+
+    /*
+     * Optimisation level passed to clang's code generator. Defaults to -O3,
+     * lower levels trade the speed of the generated code for compile time.
+     */
+    unsigned optimizationLevel = 3;
   };
 
   /**
@@ -139,6 +149,34 @@ class OICompiler {
    */
   bool compile(const std::string&, const fs::path&, const fs::path&);
 
+  /**
+   * A translation unit to be compiled by `compile()`.
+   */
+  struct Unit {
+    std::string code;
+    fs::path sourcePath;
+    fs::path objectPath;
+  };
+
+  /**
+   * Compile each of @param units into its own object file, running up to
+   * @param numThreads compilations at once (0 uses every core). The objects
+   * can then be relocated together by a single call to `applyRelocs()`.
+   *
+   * @return true if every unit compiled, false otherwise.
+   */
+  bool compile(std::span<const Unit>, unsigned numThreads = 0);
+
+  /**
+   * Optimise an LLVM IR @param module with the same pipeline clang would run
+   * at `Config::optimizationLevel` and write the resulting Object file to
+   * @param objectPath. Used by backends which emit IR directly rather than
+   * C++, see `IRGen`.
+   *
+   * @return true if the compilation succeeded, false otherwise.
+   */
+  bool compile(llvm::Module&, const fs::path&);
+
   /**
    * Load the @param objectFiles in memory and apply relocation at
    * @param BaseRelocAddress. Note that it doesn't copy the object files at the
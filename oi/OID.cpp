@@ -173,6 +173,33 @@ constexpr static OIOpts opts{
           "[oid_out.json]",
           "File to dump the results to, as JSON\n"
           "(in addition to the default RocksDB output)"},
+    OIOpt{'G',
+          "flame-graph",
+          required_argument,
+          "PATH",
+          "File to write memory use by type path to, as folded stacks for\n"
+          "flame graph tools"},
+    OIOpt{'H',
+          "type-histogram",
+          required_argument,
+          "PATH",
+          "File to write per-type counts, total sizes and size histograms to"},
+    OIOpt{'W',
+          "container-waste",
+          required_argument,
+          "PATH",
+          "File to write the containers with the most unused capacity to,\n"
+          "by type path and by instance"},
+    OIOpt{'R',
+          "no-rocksdb",
+          no_argument,
+          nullptr,
+          "Don't write the results to RocksDB"},
+    OIOpt{'I',
+          "rocksdb-index",
+          no_argument,
+          nullptr,
+          "Also index the RocksDB results by size, type and path, for oirq"},
     OIOpt{
         'B',
         "dump-data-segment",
@@ -186,6 +213,17 @@ constexpr static OIOpts opts{
           required_argument,
           "MODE",
           "Allows to specify a mode of operation/group of settings"},
+    OIOpt{'P',
+          "profile-passes",
+          no_argument,
+          nullptr,
+          "Print the time, RSS and node count of each type graph pass"},
+    OIOpt{'j',
+          "debug-info-jobs",
+          required_argument,
+          "<n>",
+          "Number of threads used to index debug info (default: one per "
+          "core)"},
     OIOpt{
         'f', "enable-feature", required_argument, "FEATURE", "Enable feature"},
     OIOpt{'F',
@@ -307,6 +345,7 @@ struct Config {
   bool attachToProcess = true;
   bool hardDisableDrgn = false;
   bool strict = false;
+  unsigned debugInfoJobs = 0;
 };
 
 }  // namespace Oid
@@ -345,6 +384,7 @@ static ExitStatus::ExitStatus runScript(
   }
   oid->setCustomCodeFile(oidConfig.customCodeFile);
   oid->setHardDisableDrgn(oidConfig.hardDisableDrgn);
+  oid->setDebugInfoJobs(oidConfig.debugInfoJobs);
   oid->setStrict(oidConfig.strict);
 
   VLOG(1) << "OIDebugger constructor took " << std::dec
@@ -357,6 +397,10 @@ static ExitStatus::ExitStatus runScript(
     return ExitStatus::ScriptParsingError;
   }
 
+  // Index debug info while the target is stopped and the segments are set
+  // up, unless the cache makes it unnecessary
+  oid->loadDebugInfoIfNeeded();
+
   if (oidConfig.attachToProcess && !oid->stopTarget()) {
     LOG(ERROR) << "Couldn't stop target process with PID " << oidConfig.pid;
     return ExitStatus::StopTargetError;
@@ -512,6 +556,9 @@ int main(int argc, char* argv[]) {
   std::string scriptSource;
   std::string configGenOption;
   std::optional<fs::path> jsonPath{std::nullopt};
+  std::optional<fs::path> flameGraphPath{std::nullopt};
+  std::optional<fs::path> typeHistogramPath{std::nullopt};
+  std::optional<fs::path> containerWastePath{std::nullopt};
 
   std::map<Feature, bool> features = {
       {Feature::PackStructs, true},
@@ -522,6 +569,9 @@ int main(int argc, char* argv[]) {
 
   bool logAllStructs = true;
   bool dumpDataSegment = false;
+  bool writeRocksDB = true;
+  bool writeIndexes = false;
+  bool profilePasses = false;
 
   metrics::Tracing _("main");
 
@@ -659,6 +709,9 @@ int main(int argc, char* argv[]) {
       case 'B':
         dumpDataSegment = true;
         break;
+      case 'P':
+        profilePasses = true;
+        break;
       case 's':
         scriptFile = std::string(optarg);
         break;
@@ -668,9 +721,34 @@ int main(int argc, char* argv[]) {
       case 't':
         oidConfig.timeout_s = atoi(optarg);
         break;
+      case 'j': {
+        int jobs = atoi(optarg);
+        if (jobs <= 0) {
+          LOG(ERROR) << "Invalid value specified for debug info jobs";
+          usage();
+          return ExitStatus::UsageError;
+        }
+        oidConfig.debugInfoJobs = static_cast<unsigned>(jobs);
+        break;
+      }
       case 'J':
         jsonPath = optarg != nullptr ? optarg : "oid_out.json";
         break;
+      case 'G':
+        flameGraphPath = optarg;
+        break;
+      case 'H':
+        typeHistogramPath = optarg;
+        break;
+      case 'W':
+        containerWastePath = optarg;
+        break;
+      case 'R':
+        writeRocksDB = false;
+        break;
+      case 'I':
+        writeIndexes = true;
+        break;
       case 'h':
       default:
         usage();
@@ -707,12 +785,19 @@ int main(int argc, char* argv[]) {
 
   OICodeGen::Config codeGenConfig;
   codeGenConfig.features = {};  // fill in after processing the config file
+  codeGenConfig.profilePasses = profilePasses;
 
   TreeBuilder::Config tbConfig{
       .features = {},  // fill in after processing the config file
       .logAllStructs = logAllStructs,
       .dumpDataSegment = dumpDataSegment,
       .jsonPath = jsonPath,
+      .flameGraphPath = flameGraphPath,
+      .typeHistogramPath = typeHistogramPath,
+      .containerWastePath = containerWastePath,
+      .sizeClasses = std::nullopt,  // chosen once attached to the target
+      .writeRocksDB = writeRocksDB,
+      .writeIndexes = writeIndexes,
   };
 
   auto featureSet = config::processConfigFiles(
@@ -2180,6 +2180,94 @@ bool OIDebugger::writePrologue(
       &newInsts, (void*)segConfig.textSegBase, prologueLength);
 }
 
+/*
+ * Translation units after the first are stored next to it: `<hash>.o` is
+ * followed by `<hash>.1.o` and so on.
+ */
+static fs::path unitPath(const fs::path& path, size_t unit) {
+  if (unit == 0)
+    return path;
+
+  auto p = path;
+  p.replace_filename(path.stem().string() + "." + std::to_string(unit) +
+                     path.extension().string());
+  return p;
+}
+
+// Only TreeBuilder-v2 code is split into several units
+static size_t unitCount(const OICodeGen::Config& config) {
+  return config.features[Feature::TreeBuilderV2] ? config.codegenUnits : 1;
+}
+
+/*
+ * Whether the local cache has everything compileCode() needs to skip code
+ * generation for `req`. Its descriptors must already have been loaded.
+ */
+bool OIDebugger::cachedCodeExists(const irequest& req) const {
+  auto objectPath = cache.getPath(req, OICache::Entity::Object);
+  auto typeHierarchyPath = cache.getPath(req, OICache::Entity::TypeHierarchy);
+  auto paddingInfoPath = cache.getPath(req, OICache::Entity::PaddingInfo);
+  if (!objectPath || !typeHierarchyPath || !paddingInfoPath ||
+      !fs::exists(*typeHierarchyPath) || !fs::exists(*paddingInfoPath)) {
+    return false;
+  }
+
+  for (size_t unit = 0; unit < unitCount(generatorConfig); ++unit) {
+    if (!fs::exists(unitPath(*objectPath, unit))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Start indexing debug info in the background, unless the local cache has the
+ * code for every probe and so it won't be needed at all. Once indexed, the
+ * probed functions' descriptors are created on the same thread.
+ */
+void OIDebugger::loadDebugInfoIfNeeded() {
+  // Remote artifacts are only downloaded by compileCode(), so whether they
+  // exist isn't known yet
+  if (cache.isEnabled() && cache.enableDownload) {
+    return;
+  }
+
+  bool needed = !cache.isEnabled();
+  std::vector<std::string> funcs;
+  for (const auto& preq : pdata) {
+    if (preq.type != "global") {
+      funcs.push_back(preq.func);
+    }
+
+    size_t argCount = preq.type == "global" ? 1 : preq.args.size();
+    for (size_t i = 0; i < argCount && !needed; i++) {
+      const auto& req = preq.getReqForArg(i);
+
+      // Finding the cache paths without the descriptors would need drgn
+      auto descs = req.type == "global" ? OICache::Entity::GlobalDescs
+                                        : OICache::Entity::FuncDescs;
+      auto descsPath = cache.getPath(req, descs);
+      if (!descsPath || !fs::exists(*descsPath)) {
+        needed = true;
+      } else if (req.type == "global") {
+        decltype(symbols->globalDescs) gds;
+        needed = !cache.load(req, descs, gds);
+        symbols->globalDescs.merge(std::move(gds));
+      } else {
+        decltype(symbols->funcDescs) fds;
+        needed = !cache.load(req, descs, fds);
+        symbols->funcDescs.merge(std::move(fds));
+      }
+
+      needed = needed || !cachedCodeExists(req);
+    }
+  }
+
+  if (needed) {
+    symbols->loadDebugInfoAsync(std::move(funcs));
+  }
+}
+
 /*
  * Compile the code that the OICompiler layer knows about. The result of this
  * is that the target processes text segment is populated and ready to go.
@@ -2190,6 +2278,9 @@ bool OIDebugger::compileCode() {
 
   OICompiler compiler{symbols, compilerConfig};
   std::set<fs::path> objectFiles{};
+  // Each argument is generated as its own translation units. Code generation
+  // isn't thread safe, but the units are compiled concurrently afterwards.
+  std::vector<OICompiler::Unit> units{};
 
   /*
    * Global probes don't have multiple arguments, but calling `getReqForArg(X)`
@@ -2250,9 +2341,8 @@ bool OIDebugger::compileCode() {
       return false;
     }
 
-    bool skipCodeGen = cache.isEnabled() && fs::exists(*objectPath) &&
-                       fs::exists(*typeHierarchyPath) &&
-                       fs::exists(*paddingInfoPath);
+    size_t numUnits = unitCount(generatorConfig);
+    bool skipCodeGen = cache.isEnabled() && cachedCodeExists(req);
     if (skipCodeGen) {
       std::pair<RootInfo, TypeHierarchy> th;
       skipCodeGen =
@@ -2277,11 +2367,16 @@ bool OIDebugger::compileCode() {
         return false;
       }
 
-      bool doCompile = !cache.isEnabled() || !fs::exists(*objectPath);
-      if (doCompile) {
-        if (!compiler.compile(*code, *sourcePath, *objectPath)) {
-          LOG(ERROR) << "Failed to compile code";
-          return false;
+      numUnits = code->size();
+      for (size_t unit = 0; unit < numUnits; ++unit) {
+        auto unitObjectPath = unitPath(*objectPath, unit);
+        bool doCompile = !cache.isEnabled() || !fs::exists(unitObjectPath);
+        if (doCompile) {
+          units.push_back(OICompiler::Unit{
+              .code = std::move((*code)[unit]),
+              .sourcePath = unitPath(*sourcePath, unit),
+              .objectPath = unitObjectPath,
+          });
         }
       }
     }
@@ -2300,7 +2395,13 @@ bool OIDebugger::compileCode() {
       cache.store(req, OICache::Entity::PaddingInfo, paddingInfo);
     }
 
-    objectFiles.insert(*objectPath);
+    for (size_t unit = 0; unit < numUnits; ++unit)
+      objectFiles.insert(unitPath(*objectPath, unit));
+  }
+
+  if (!compiler.compile(units)) {
+    LOG(ERROR) << "Failed to compile code";
+    return false;
   }
 
   if (traceePid) {  // we attach to a process
@@ -2851,6 +2952,23 @@ static bool dumpDataSegment(const irequest& req,
   return true;
 }
 
+/*
+ * The size classes of the target's allocator, from the config file if given.
+ * Otherwise jemalloc is recognised by its nallocx() and anything else is
+ * taken to be glibc malloc.
+ */
+SizeClasses OIDebugger::targetSizeClasses() {
+  if (generatorConfig.sizeClasses.has_value()) {
+    return *generatorConfig.sizeClasses;
+  }
+
+  auto sizeClasses = symbols->locateSymbol("nallocx").has_value()
+                         ? SizeClasses::jemalloc()
+                         : SizeClasses::glibc();
+  VLOG(1) << "Using " << sizeClasses.name() << " size classes";
+  return sizeClasses;
+}
+
 bool OIDebugger::processTargetData() {
   metrics::Tracing _("process_target_data");
 
@@ -2868,6 +2986,10 @@ bool OIDebugger::processTargetData() {
   const auto& preq = pdata.getReq();
 
   PaddingHunter paddingHunter{};
+  if (treeBuilderConfig.features[Feature::AllocatorSizeClasses] &&
+      !treeBuilderConfig.sizeClasses.has_value()) {
+    treeBuilderConfig.sizeClasses = targetSizeClasses();
+  }
   TreeBuilder typeTree(treeBuilderConfig);
 
   /*
@@ -2961,18 +3083,34 @@ bool OIDebugger::processTargetData() {
   return true;
 }
 
-std::optional<std::string> OIDebugger::generateCode(const irequest& req) {
+std::optional<std::vector<std::string>> OIDebugger::generateCode(
+    const irequest& req) {
   auto root = symbols->getRootType(req);
   if (!root.has_value()) {
     return std::nullopt;
   }
 
-  std::string code(headers::oi_OITraceCode_cpp);
+  std::vector<std::string> units{std::string(headers::oi_OITraceCode_cpp)};
 
   if (generatorConfig.features[Feature::TypeGraph]) {
     // CodeGen v2
     CodeGen codegen2{generatorConfig, *symbols};
-    codegen2.codegenFromDrgn(root->type.type, code);
+    if (generatorConfig.features[Feature::PolymorphicInheritance]) {
+      if (!classHierarchy) {
+        type_graph::ClassHierarchyIndex index;
+        if (cache.load(req, OICache::Entity::ClassHierarchy, index)) {
+          // The cached vtables are relative to modules which may now be
+          // loaded at different addresses
+          index.setLoadedModules(symbols->locateModules());
+        } else {
+          index = type_graph::ClassHierarchyIndex::build(*symbols);
+          cache.store(req, OICache::Entity::ClassHierarchy, index);
+        }
+        classHierarchy = std::move(index);
+      }
+      codegen2.setClassHierarchyIndex(*classHierarchy);
+    }
+    codegen2.codegenFromDrgn(root->type.type, units);
 
     TypeHierarchy th;
     // Make this static as a big hack to extend the fake drgn_types' lifetimes
@@ -2993,7 +3131,7 @@ std::optional<std::string> OIDebugger::generateCode(const irequest& req) {
 
     RootInfo rootInfo = *root;
     codegen->setRootType(rootInfo.type);
-    if (!codegen->generate(code)) {
+    if (!codegen->generate(units[0])) {
       LOG(ERROR) << "Failed to generate code for probe: " << req.type << ":"
                  << req.func << ":" << req.arg;
       return std::nullopt;
@@ -3007,13 +3145,16 @@ std::optional<std::string> OIDebugger::generateCode(const irequest& req) {
   }
 
   if (auto sourcePath = cache.getPath(req, OICache::Entity::Source)) {
-    std::ofstream(*sourcePath) << code;
+    for (size_t unit = 0; unit < units.size(); ++unit)
+      std::ofstream(unitPath(*sourcePath, unit)) << units[unit];
   }
 
+  // Custom code replaces all of the generated units
   if (!customCodeFile.empty()) {
     auto ifs = std::ifstream(customCodeFile);
-    code.assign(std::istreambuf_iterator<char>(ifs),
-                std::istreambuf_iterator<char>());
+    units.resize(1);
+    units[0].assign(std::istreambuf_iterator<char>(ifs),
+                    std::istreambuf_iterator<char>());
   }
 
   // Output JIT source-code after codegen has appended the necessary macros
@@ -3022,11 +3163,12 @@ std::optional<std::string> OIDebugger::generateCode(const irequest& req) {
   if (VLOG_IS_ON(3)) {
     // VLOG truncates output, so use std::cout
     VLOG(3) << "Trace code is \n";
-    std::cout << code << std::endl;
+    for (const auto& unit : units)
+      std::cout << unit << std::endl;
     VLOG(3) << "Trace code dump finished";
   }
 
-  return code;
+  return units;
 }
 
 }  // namespace oi::detail
@@ -28,6 +28,7 @@
 #include "oi/TrapInfo.h"
 #include "oi/TreeBuilder.h"
 #include "oi/X86InstDefs.h"
+#include "oi/type_graph/ClassHierarchyIndex.h"
 
 namespace oi::detail {
 
@@ -105,6 +106,10 @@ class OIDebugger {
   void setHardDisableDrgn(bool val) {
     symbols->setHardDisableDrgn(val);
   }
+  void setDebugInfoJobs(unsigned val) {
+    symbols->setDebugInfoJobs(val);
+  }
+  void loadDebugInfoIfNeeded();
   void setStrict(bool val) {
     treeBuilderConfig.strict = val;
   }
@@ -181,6 +186,9 @@ class OIDebugger {
   std::shared_ptr<SymbolService> symbols;
   OICache cache;
 
+  // Loaded or built on first use; the same for every probe of this target
+  std::optional<type_graph::ClassHierarchyIndex> classHierarchy;
+
   /*
    * Map address of valid INT3 instruction to metadata for that interrupt.
    * It MUST be an ordered map (std::map) to handle overlapping traps.
@@ -239,11 +247,15 @@ class OIDebugger {
   void dumpAlltaskStates(void);
   std::optional<std::vector<uintptr_t>> findRetLocs(FuncDesc&);
   bool contTargetThread(pid_t, unsigned long = 0) const;
+  SizeClasses targetSizeClasses();
 
   OICompiler::Config compilerConfig{};
   const OICodeGen::Config& generatorConfig;
   TreeBuilder::Config treeBuilderConfig{};
-  std::optional<std::string> generateCode(const irequest&);
+  // The translation units of the code for a request, the first has the entry
+  // point
+  std::optional<std::vector<std::string>> generateCode(const irequest&);
+  bool cachedCodeExists(const irequest&) const;
 
   std::fstream segmentConfigFile;
   std::filesystem::path segConfigFilePath;
@@ -21,10 +21,20 @@
 #include <clang/Frontend/CompilerInvocation.h>
 #include <clang/Frontend/FrontendAction.h>
 #include <clang/Sema/Sema.h>
+#include <clang/Sema/SemaConsumer.h>
 #include <clang/Tooling/Tooling.h>
 #include <glog/logging.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/VirtualFileSystem.h>
 
+#include <unistd.h>
+
+#include <atomic>
+#include <boost/format.hpp>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <range/v3/core.hpp>
 #include <range/v3/view/drop.hpp>
 #include <range/v3/view/filter.hpp>
@@ -42,6 +52,7 @@
 #include "oi/Headers.h"
 #include "oi/type_graph/ClangTypeParser.h"
 #include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/TypeGraphHasher.h"
 #include "oi/type_graph/Types.h"
 
 namespace oi::detail {
@@ -84,18 +95,140 @@ class ConsumerContext {
   }
 
   type_graph::TypeGraph typeGraph;
-  std::unordered_map<std::string, type_graph::Type*> nameToTypeMap;
+  // Ordered so the roots, and so the generated code, don't depend on which
+  // translation unit finished parsing first.
+  std::map<std::string, type_graph::Type*> nameToTypeMap;
   std::optional<bool> pic;
   const std::vector<std::unique_ptr<ContainerInfo>>& containerInfos;
   std::set<std::string_view> typesToStub;
   std::set<std::string_view> mustProcessTemplateParams;
 
- private:
-  clang::Sema* sema = nullptr;
-  friend CreateTypeGraphConsumer;
-  friend CreateTypeGraphAction;
+  // Types shared between translation units are only added to the graph once.
+  std::unordered_map<std::string, std::reference_wrapper<type_graph::Type>>
+      namedTypes;
+
+  // Translation units are parsed concurrently but the type graph is built by
+  // one of them at a time.
+  std::mutex mutex;
 };
 
+/*
+ * Parses each source file with its own ClangTool on a pool of threads, in the
+ * same way as clang's AllTUsToolExecutor. Each tool gets its own physical
+ * filesystem so that changing into a compile command's directory doesn't
+ * affect the other workers.
+ */
+int parseSources(clang::tooling::CompilationDatabase& db,
+                 const std::vector<std::string>& sourcePaths,
+                 ConsumerContext& ctx,
+                 unsigned numThreads) {
+  CreateTypeGraphActionFactory factory{ctx};
+
+  if (numThreads == 1 || sourcePaths.size() <= 1) {
+    clang::tooling::ClangTool tool{db, sourcePaths};
+    return tool.run(&factory);
+  }
+
+  std::atomic<int> ret = 0;
+  llvm::ThreadPool pool{llvm::hardware_concurrency(numThreads)};
+  for (const auto& path : sourcePaths) {
+    pool.async([&db, &factory, &ret, &path]() {
+      clang::tooling::ClangTool tool{
+          db,
+          {path},
+          std::make_shared<clang::PCHContainerOperations>(),
+          llvm::vfs::createPhysicalFileSystem()};
+      if (auto toolRet = tool.run(&factory); toolRet != 0) {
+        LOG(ERROR) << "failed to process source file: " << path;
+        ret = toolRet;
+      }
+    });
+  }
+  pool.wait();
+
+  return ret;
+}
+
+/*
+ * The cache key covers everything the generated object depends on: the
+ * structure of the type graph after all passes, the sites being generated,
+ * the enabled features, the contents of the config and container files and
+ * the oilgen binary itself, which fixes the code generator and runtime
+ * headers.
+ */
+std::string cacheKey(const ConsumerContext& ctx,
+                     const FeatureSet& features,
+                     const std::vector<fs::path>& configFilePaths,
+                     const OICodeGen::Config& generatorConfig,
+                     bool usePIC) {
+  auto readFile = [](const fs::path& path) {
+    std::ifstream file{path, std::ios::binary};
+    return std::string{std::istreambuf_iterator<char>{file}, {}};
+  };
+
+  std::string key =
+      std::to_string(type_graph::TypeGraphHasher::hash(ctx.typeGraph));
+  for (const auto& [linkageName, type] : ctx.nameToTypeMap) {
+    key += '\0';
+    key += linkageName;
+  }
+  key += '\0';
+  for (auto f : allFeatures)
+    key += features[f] ? '1' : '0';
+  key += usePIC ? '1' : '0';
+
+  for (const auto& path : configFilePaths)
+    key += std::to_string(std::hash<std::string>{}(readFile(path)));
+  for (const auto& path : generatorConfig.containerConfigPaths)
+    key += std::to_string(std::hash<std::string>{}(readFile(path)));
+
+  std::error_code ec;
+  auto self = fs::read_symlink("/proc/self/exe", ec);
+  if (!ec) {
+    key += self.string();
+    key += std::to_string(fs::file_size(self, ec));
+    key += std::to_string(
+        fs::last_write_time(self, ec).time_since_epoch().count());
+  }
+
+  return (boost::format("%1$016x") % std::hash<std::string>{}(key)).str();
+}
+
+bool reuseCachedObject(const fs::path& cachedObject,
+                       const fs::path& outputPath) {
+  std::error_code ec;
+  if (!fs::exists(cachedObject, ec))
+    return false;
+
+  fs::copy_file(
+      cachedObject, outputPath, fs::copy_options::overwrite_existing, ec);
+  if (ec) {
+    LOG(WARNING) << "failed to reuse cached object " << cachedObject << ": "
+                 << ec.message();
+    return false;
+  }
+
+  VLOG(1) << "Reused cached object " << cachedObject;
+  return true;
+}
+
+void storeCachedObject(const fs::path& cachedObject,
+                       const fs::path& outputPath) {
+  // Copy then rename so concurrent builds never see a partial object.
+  std::error_code ec;
+  fs::create_directories(cachedObject.parent_path(), ec);
+  auto tmp = cachedObject;
+  tmp += ".tmp" + std::to_string(getpid());
+  fs::copy_file(outputPath, tmp, fs::copy_options::overwrite_existing, ec);
+  if (!ec)
+    fs::rename(tmp, cachedObject, ec);
+  if (ec) {
+    LOG(WARNING) << "failed to store cached object " << cachedObject << ": "
+                 << ec.message();
+    fs::remove(tmp, ec);
+  }
+}
+
 }  // namespace
 
 int OIGenerator::generate(clang::tooling::CompilationDatabase& db,
@@ -146,23 +279,22 @@ int OIGenerator::generate(clang::tooling::CompilationDatabase& db,
   for (const auto& cInfo : generatorConfig.passThroughTypes)
     ctx.mustProcessTemplateParams.insert(cInfo.typeName);
 
-  CreateTypeGraphActionFactory factory{ctx};
-
-  clang::tooling::ClangTool tool{db, sourcePaths};
-  if (auto ret = tool.run(&factory); ret != 0) {
+  if (auto ret = parseSources(db, sourcePaths, ctx, numThreads); ret != 0)
     return ret;
-  }
-
-  if (ctx.nameToTypeMap.size() > 1)
-    throw std::logic_error(
-        "found more than one site to generate for but we can't currently "
-        "handle this case");
 
   if (ctx.nameToTypeMap.empty()) {
     LOG(ERROR) << "Nothing to generate!";
     return failIfNothingGenerated ? -1 : 0;
   }
-  const auto& linkageName = ctx.nameToTypeMap.begin()->first;
+
+  std::vector<CodeGen::RootFunctionName> rootNames;
+  rootNames.reserve(ctx.nameToTypeMap.size());
+  for (const auto& [linkageName, type] : ctx.nameToTypeMap) {
+    ctx.typeGraph.addRoot(*type);
+    rootNames.emplace_back(CodeGen::ExactName{linkageName});
+  }
+  VLOG(1) << "Generating " << rootNames.size() << " site(s) with "
+          << ctx.namedTypes.size() << " distinct named type(s)";
 
   compilerConfig.usePIC = ctx.pic.value();
   CodeGen codegen{generatorConfig};
@@ -170,33 +302,66 @@ int OIGenerator::generate(clang::tooling::CompilationDatabase& db,
     codegen.registerContainer(std::move(ptr));
   codegen.transform(ctx.typeGraph);
 
-  std::string code;
-  codegen.generate(ctx.typeGraph, code, CodeGen::ExactName{linkageName});
+  fs::path cachedObject;
+  if (!cacheDirectory.empty()) {
+    auto key = cacheKey(ctx,
+                        *features,
+                        configFilePaths,
+                        generatorConfig,
+                        compilerConfig.usePIC);
+    cachedObject = cacheDirectory / (key + ".o");
+  }
 
+  // Generating is cheap next to compiling, so a requested source dump is
+  // written even when the object then comes from the cache. The code is
+  // never split into units: the output is a single object, and the build
+  // already runs oilgen for many sites at once.
+  std::string code;
   std::string sourcePath = sourceFileDumpPath;
   if (sourceFileDumpPath.empty()) {
     // This is the path Clang acts as if it has compiled from e.g. for debug
     // information. It does not need to exist.
     sourcePath = "oil_jit.cpp";
   } else {
+    codegen.generate(ctx.typeGraph, code, rootNames);
     std::ofstream outputFile(sourcePath);
     outputFile << code;
   }
 
+  if (!cachedObject.empty() && reuseCachedObject(cachedObject, outputPath))
+    return 0;
+
+  if (code.empty())
+    codegen.generate(ctx.typeGraph, code, rootNames);
+
   OICompiler compiler{{}, compilerConfig};
-  return compiler.compile(code, sourcePath, outputPath) ? 0 : -1;
+  if (!compiler.compile(code, sourcePath, outputPath))
+    return -1;
+
+  if (!cachedObject.empty())
+    storeCachedObject(cachedObject, outputPath);
+  return 0;
 }
 
 namespace {
 
-class CreateTypeGraphConsumer : public clang::ASTConsumer {
+class CreateTypeGraphConsumer : public clang::SemaConsumer {
  private:
   ConsumerContext& ctx;
+  clang::Sema* sema = nullptr;
 
  public:
   CreateTypeGraphConsumer(ConsumerContext& ctx_) : ctx(ctx_) {
   }
 
+  void InitializeSema(clang::Sema& S) override {
+    sema = &S;
+  }
+
+  void ForgetSema() override {
+    sema = nullptr;
+  }
+
   void HandleTranslationUnit(clang::ASTContext& Context) override {
     auto* tu_decl = Context.getTranslationUnitDecl();
     auto decls = tu_decl->decls();
@@ -254,20 +419,19 @@ class CreateTypeGraphConsumer : public clang::ASTConsumer {
     type_graph::ClangTypeParserOptions opts;
     opts.typesToStub = ctx.typesToStub;
     opts.mustProcessTemplateParams = ctx.mustProcessTemplateParams;
+    opts.namedTypes = &ctx.namedTypes;
 
+    std::lock_guard lock{ctx.mutex};
     type_graph::ClangTypeParser parser{ctx.typeGraph, ctx.containerInfos, opts};
 
-    auto& Sema = *ctx.sema;
-    auto els = nameToClangTypeMap |
-               ranges::views::transform(
-                   [&parser, &Context, &Sema](
-                       auto& p) -> std::pair<std::string, type_graph::Type*> {
-                     return {p.first, &parser.parse(Context, Sema, *p.second)};
-                   });
-    ctx.nameToTypeMap.insert(els.begin(), els.end());
-
-    for (const auto& [name, type] : ctx.nameToTypeMap)
-      ctx.typeGraph.addRoot(*type);
+    for (const auto& [name, clangType] : nameToClangTypeMap) {
+      // Sites included from a header are seen by every translation unit that
+      // includes it, but only need generating once.
+      if (ctx.nameToTypeMap.contains(name))
+        continue;
+      auto& type = parser.parse(Context, *sema, *clangType);
+      ctx.nameToTypeMap.emplace(name, &type);
+    }
   }
 };
 
@@ -277,11 +441,13 @@ void CreateTypeGraphAction::ExecuteAction() {
   // Compile the output as position independent if any input is position
   // independent
   bool pic = CI.getCodeGenOpts().RelocationModel == llvm::Reloc::PIC_;
-  ctx.pic = ctx.pic.value_or(false) || pic;
+  {
+    std::lock_guard lock{ctx.mutex};
+    ctx.pic = ctx.pic.value_or(false) || pic;
+  }
 
   if (!CI.hasSema())
     CI.createSema(clang::TU_Complete, nullptr);
-  ctx.sema = &CI.getSema();
 
   clang::ASTFrontendAction::ExecuteAction();
 }
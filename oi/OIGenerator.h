@@ -52,13 +52,26 @@ class OIGenerator {
   void setClangArgs(std::vector<std::string> args_) {
     clangArgs = std::move(args_);
   }
+  // Objects are cached in this directory, keyed by the structure of the
+  // types being generated, and reused without recompiling. Empty disables
+  // the cache.
+  void setCacheDirectory(fs::path _cacheDirectory) {
+    cacheDirectory = std::move(_cacheDirectory);
+  }
+  // Number of source files to parse concurrently. 0 uses every hardware
+  // thread.
+  void setNumThreads(unsigned n) {
+    numThreads = n;
+  }
 
  private:
   std::filesystem::path outputPath;
   std::vector<std::filesystem::path> configFilePaths;
   std::filesystem::path sourceFileDumpPath;
+  std::filesystem::path cacheDirectory;
   bool failIfNothingGenerated = false;
   std::vector<std::string> clangArgs;
+  unsigned numThreads = 0;
 };
 
 }  // namespace oi::detail
@@ -13,6 +13,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "oi/Interpreter.h"
 #include "oi/OILibraryImpl.h"
 #include "oi/oi-jit.h"
 
@@ -27,8 +28,31 @@ OILibrary::OILibrary(void* atomicHole,
 OILibrary::~OILibrary() {
 }
 
-std::pair<void*, const exporters::inst::Inst&> OILibrary::init() {
+OILibrary::Functions OILibrary::init() {
   return pimpl_->init();
 }
 
+OILibrary::Functions OILibrary::optimise() {
+  return pimpl_->optimise();
+}
+
+std::optional<OILibrary::Interpreted> OILibrary::interpret() {
+  return pimpl_->interpret();
+}
+
+void OILibrary::introspectInterpreted(const detail::Interpreter& interpreter,
+                                      const void* object,
+                                      std::vector<uint8_t>& v) {
+  interpreter.introspect(object, v);
+}
+
+void OILibrary::introspectBatchInterpreted(
+    const detail::Interpreter& interpreter,
+    const void* const* objects,
+    size_t n,
+    std::vector<uint8_t>& v,
+    std::vector<size_t>& offsets) {
+  interpreter.introspectBatch(objects, n, v, offsets);
+}
+
 }  // namespace oi
@@ -16,6 +16,8 @@
 #include "OILibraryImpl.h"
 
 #include <glog/logging.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
 #include <sys/mman.h>
 
 #include <boost/core/demangle.hpp>
@@ -23,11 +25,16 @@
 #include <cerrno>
 #include <cstring>
 #include <fstream>
+#include <list>
+#include <set>
 #include <stdexcept>
+#include <unordered_map>
 
 #include "oi/Config.h"
 #include "oi/DrgnUtils.h"
 #include "oi/Headers.h"
+#include "oi/IRGen.h"
+#include "oi/Metrics.h"
 
 namespace oi::detail {
 namespace {
@@ -87,13 +94,38 @@ OILibraryImpl::OILibraryImpl(void* atomicHole,
       opts_(std::move(opts)) {
 }
 
-std::pair<void*, const exporters::inst::Inst&> OILibraryImpl::init() {
-  processConfigFile();
+OILibrary::Functions OILibraryImpl::init() {
+  if (units_.empty()) {
+    processConfigFile();
+    generateCode();
+  }
 
-  constexpr size_t TextSegSize = 1u << 22;
-  textSeg = {TextSegSize};
+  // With tiered compilation the first tier is built at -O0 to get results out
+  // as quickly as possible. `optimise()` later compiles the same code at -O3.
+  // The interpreter already serves results, so compile it properly instead.
+  unsigned optimizationLevel = opts_.tieredCompilation && !interpreted_
+                                   ? 0
+                                   : compilerConfig_.optimizationLevel;
+  return compileCode(optimizationLevel);
+}
+
+std::optional<OILibrary::Interpreted> OILibraryImpl::interpret() {
+  if (units_.empty()) {
+    processConfigFile();
+    generateCode();
+  }
+  if (interpreter_ == nullptr)
+    return std::nullopt;
 
-  return compileCode();
+  interpreted_ = true;
+  return OILibrary::Interpreted{*interpreter_, interpreter_->instructions()};
+}
+
+OILibrary::Functions OILibraryImpl::optimise() {
+  if (units_.empty())
+    throw std::logic_error("optimise() called before init()");
+
+  return compileCode(compilerConfig_.optimizationLevel);
 }
 
 void OILibraryImpl::processConfigFile() {
@@ -108,63 +140,136 @@ void OILibraryImpl::processConfigFile() {
   compilerConfig_.features = *features;
 }
 
-std::pair<void*, const exporters::inst::Inst&> OILibraryImpl::compileCode() {
+void OILibraryImpl::generateCode() {
   google::SetVLOGLevel("*", opts_.debugLevel);
+  metrics::Tracing _("oil_codegen");
 
-  auto symbols = std::make_shared<SymbolService>(getpid());
+  symbols_ = std::make_shared<SymbolService>(getpid());
 
-  auto* prog = symbols->getDrgnProgram();
+  auto* prog = symbols_->getDrgnProgram();
   CHECK(prog != nullptr) << "does this check need to exist?";
 
-  auto rootType = getTypeFromAtomicHole(symbols->getDrgnProgram(), atomicHole_);
+  auto rootType = getTypeFromAtomicHole(prog, atomicHole_);
 
-  CodeGen codegen{generatorConfig_, *symbols};
+  CodeGen codegen{generatorConfig_, *symbols_};
 
-  std::string code;
-  if (!codegen.codegenFromDrgn(rootType.type, code))
+  if (!codegen.codegenFromDrgn(rootType.type, units_))
     throw std::runtime_error("oil jit codegen failed!");
 
-  std::string sourcePath = opts_.sourceFileDumpPath;
-  if (sourcePath.empty()) {
+  // The interpreter doesn't implement Thrift isset capture. Its bytecode is
+  // also the input to the IR backend.
+  if ((opts_.interpretFirst || opts_.lowerToIR) &&
+      !generatorConfig_.features[Feature::CaptureThriftIsset]) {
+    metrics::Tracing interpreterTracing("oil_interpreter");
+    interpreter_ =
+        Interpreter::compile(codegen.typeGraph().rootTypes()[0]).release();
+  }
+
+  // Further units are dumped next to the first: `oil_jit.cpp` is followed by
+  // `oil_jit.1.cpp` and so on.
+  std::filesystem::path sourcePath = opts_.sourceFileDumpPath;
+  if (sourcePath.empty())
     sourcePath = "oil_jit.cpp";  // fake path for JIT debug info
-  } else {
-    std::ofstream outputFile(sourcePath);
-    outputFile << code;
+  sourcePaths_.clear();
+  for (size_t i = 0; i < units_.size(); ++i) {
+    auto unitPath = sourcePath;
+    if (i > 0) {
+      unitPath.replace_filename(sourcePath.stem().string() + "." +
+                                std::to_string(i) +
+                                sourcePath.extension().string());
+    }
+    sourcePaths_.push_back(unitPath.string());
+
+    if (!opts_.sourceFileDumpPath.empty()) {
+      std::ofstream outputFile(unitPath);
+      outputFile << units_[i];
+    }
   }
 
-  auto object = MemoryFile("oil_object_code");
-  OICompiler compiler{symbols, compilerConfig_};
-  if (!compiler.compile(code, sourcePath, object.path()))
-    throw std::runtime_error("oil jit compilation failed!");
+  nameHash_ =
+      (boost::format("%1$016x") %
+       std::hash<std::string>{}(SymbolService::getTypeName(rootType.type)))
+          .str();
+}
 
-  auto relocRes = compiler.applyRelocs(
-      reinterpret_cast<uint64_t>(textSeg.data().data()), {object.path()}, {});
+OILibrary::Functions OILibraryImpl::compileCode(unsigned optimizationLevel) {
+  metrics::Tracing compileTracing("oil_compile_O" +
+                                  std::to_string(optimizationLevel));
+
+  // Each tier gets its own text segment. Segments are never unmapped as
+  // other threads may still be executing the code of a previous tier.
+  constexpr size_t TextSegSize = 1u << 22;
+  LocalTextSegment textSeg{TextSegSize};
+
+  auto compilerConfig = compilerConfig_;
+  compilerConfig.optimizationLevel = optimizationLevel;
+
+  std::list<MemoryFile> objects;
+  std::set<std::filesystem::path> objectPaths;
+  auto newObject = [&]() {
+    auto path = objects.emplace_back("oil_object_code").path();
+    objectPaths.insert(path);
+    return path;
+  };
+  OICompiler compiler{symbols_, compilerConfig};
+
+  // The IR backend's functions aren't mangled and its tree builder
+  // instructions are the interpreter's
+  std::string functionSymbolPrefix = "_Z27introspect_" + nameHash_;
+  std::string batchSymbolPrefix = "_Z33introspect_batch_" + nameHash_;
+  const exporters::inst::Inst* ty = nullptr;
+  std::unordered_map<std::string, uintptr_t> syntheticSymbols;
+  if (opts_.lowerToIR && interpreter_ != nullptr) {
+    functionSymbolPrefix = "introspect_" + nameHash_;
+    batchSymbolPrefix = "introspect_batch_" + nameHash_;
+    ty = &interpreter_->instructions();
+    syntheticSymbols = IRGen::runtimeSymbols();
+
+    llvm::LLVMContext ctx;
+    auto module = IRGen{ctx, *interpreter_}.generate(functionSymbolPrefix,
+                                                     batchSymbolPrefix);
+    if (module == nullptr || !compiler.compile(*module, newObject()))
+      throw std::runtime_error("oil jit IR compilation failed!");
+  } else {
+    // The units are compiled concurrently and relocated together
+    std::vector<OICompiler::Unit> units;
+    units.reserve(units_.size());
+    for (size_t i = 0; i < units_.size(); ++i) {
+      units.push_back(OICompiler::Unit{
+          .code = units_[i],
+          .sourcePath = sourcePaths_[i],
+          .objectPath = newObject(),
+      });
+    }
+    if (!compiler.compile(units))
+      throw std::runtime_error("oil jit compilation failed!");
+  }
+
+  auto relocRes =
+      compiler.applyRelocs(reinterpret_cast<uint64_t>(textSeg.data().data()),
+                           objectPaths,
+                           syntheticSymbols);
   if (!relocRes)
     throw std::runtime_error("oil jit relocation failed!");
 
   const auto& [_, segments, jitSymbols] = *relocRes;
 
-  std::string nameHash =
-      (boost::format("%1$016x") %
-       std::hash<std::string>{}(SymbolService::getTypeName(rootType.type)))
-          .str();
-  std::string functionSymbolPrefix = "_Z27introspect_" + nameHash;
-  std::string typeSymbolName = "treeBuilderInstructions" + nameHash;
+  std::string typeSymbolName = "treeBuilderInstructions" + nameHash_;
   void* fp = nullptr;
-  const exporters::inst::Inst* ty = nullptr;
+  void* bfp = nullptr;
   for (const auto& [symName, symAddr] : jitSymbols) {
     if (fp == nullptr && symName.starts_with(functionSymbolPrefix)) {
       fp = reinterpret_cast<void*>(symAddr);
-      if (ty != nullptr)
-        break;
+    } else if (bfp == nullptr && symName.starts_with(batchSymbolPrefix)) {
+      bfp = reinterpret_cast<void*>(symAddr);
     } else if (ty == nullptr && symName == typeSymbolName) {
       ty = reinterpret_cast<const exporters::inst::Inst*>(symAddr);
-      if (fp != nullptr)
-        break;
     }
+    if (fp != nullptr && bfp != nullptr && ty != nullptr)
+      break;
   }
 
-  CHECK(fp != nullptr && ty != nullptr)
+  CHECK(fp != nullptr && bfp != nullptr && ty != nullptr)
       << "failed to find always present symbols!";
 
   for (const auto& [baseAddr, relocAddr, size] : segments)
@@ -173,7 +278,7 @@ std::pair<void*, const exporters::inst::Inst&> OILibraryImpl::compileCode() {
                 size);
 
   textSeg.release();  // don't munmap() the region containing the code
-  return {fp, *ty};
+  return {fp, bfp, *ty};
 }
 
 namespace {
@@ -18,12 +18,17 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <optional>
 #include <span>
+#include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "oi/CodeGen.h"
 #include "oi/Features.h"
+#include "oi/Interpreter.h"
 #include "oi/OICompiler.h"
 
 namespace oi::detail {
@@ -70,7 +75,9 @@ class OILibraryImpl {
   OILibraryImpl(void* atomicHole,
                 std::unordered_set<oi::Feature> fs,
                 GeneratorOptions opts);
-  std::pair<void*, const exporters::inst::Inst&> init();
+  OILibrary::Functions init();
+  OILibrary::Functions optimise();
+  std::optional<OILibrary::Interpreted> interpret();
 
  private:
   void* atomicHole_;
@@ -80,10 +87,20 @@ class OILibraryImpl {
   oi::detail::OICompiler::Config compilerConfig_{};
   oi::detail::OICodeGen::Config generatorConfig_{};
 
-  LocalTextSegment textSeg;
+  std::shared_ptr<SymbolService> symbols_;
+  // Translation units of the generated code, the first has the entry points
+  std::vector<std::string> units_;
+  std::vector<std::string> sourcePaths_;
+  std::string nameHash_;
+  // Never freed, like the text segments of compiled tiers: other threads may
+  // still be walking objects with it, or reading results described by its
+  // instructions, after newer code is swapped in.
+  const Interpreter* interpreter_ = nullptr;
+  bool interpreted_ = false;
 
   void processConfigFile();
-  std::pair<void*, const exporters::inst::Inst&> compileCode();
+  void generateCode();
+  OILibrary::Functions compileCode(unsigned optimizationLevel);
 };
 
 }  // namespace oi::detail
@@ -37,6 +37,9 @@
 constexpr int oidMagicId = 0x01DE8;
 
 #include <array>
+#include <atomic>
+#include <memory>
+#include <pthread.h>
 
 namespace {
 
@@ -47,11 +50,23 @@ constexpr std::array<T, N + 1> arrayPrependHelper(std::array<T, N> a,
                                                   T t,
                                                   std::index_sequence<I...>);
 
+}  // namespace
+
+/*
+ * The scratch state is in a named namespace, as split code passes it between
+ * units through the IntrospectContext, which then has external linkage.
+ */
+namespace OIInternal {
+
 template <size_t Size = (1 << 20) / sizeof(uintptr_t)>
 class PointerHashSet {
  private:
   // 1 MiB of pointers
   std::array<uintptr_t, Size> data;
+  // An entry is only present if it was written in the current generation, so
+  // the set can be cleared without touching `data`.
+  std::array<uint8_t, Size> generations;
+  uint8_t generation;
   size_t numEntries;
 
   /*
@@ -71,7 +86,11 @@ class PointerHashSet {
 
  public:
   void initialize() noexcept {
-    data.fill(0);
+    if (++generation == 0) {
+      // Entries from 256 generations ago would look current again
+      generations.fill(0);
+      generation = 1;
+    }
     numEntries = 0;
   }
 
@@ -88,14 +107,14 @@ class PointerHashSet {
 
     uint64_t index = twang_mix64(pointer) % data.size();
     while (true) {
-      uintptr_t entry = data[index];
-
-      if (entry == 0) {
+      if (generations[index] != generation) {
         data[index] = pointer;
+        generations[index] = generation;
         ++numEntries;
         return true;
       }
 
+      uintptr_t entry = data[index];
       if (entry == pointer || numEntries >= data.size()) {
         return false;
       }
@@ -117,7 +136,68 @@ class PointerHashSet {
   }
 };
 
-}  // namespace
+/*
+ * ScratchPool
+ *
+ * Keeps scratch state, such as a PointerHashSet, alive between calls so that
+ * it isn't allocated for every introspection. Each thread starts looking from
+ * a slot derived from its thread ID, so threads usually get back the object
+ * they last released without contending with each other. This is lock-free
+ * and avoids thread_local, which the JIT relocation code can't handle.
+ *
+ * At most `Slots` objects are kept: about 4.5 MiB of PointerHashSets by
+ * default. Objects released while every slot is full are freed, so more
+ * concurrent introspections than slots allocate their own.
+ */
+template <typename T, size_t Slots = 4>
+class ScratchPool {
+ public:
+  struct Releaser {
+    void operator()(T* p) const noexcept {
+      release(p);
+    }
+  };
+  using Ptr = std::unique_ptr<T, Releaser>;
+
+  static Ptr acquire() {
+    size_t home = homeSlot();
+    for (size_t i = 0; i < Slots; ++i) {
+      auto& slot = slots()[(home + i) % Slots];
+      if (T* p = slot.exchange(nullptr, std::memory_order_acquire))
+        return Ptr{p};
+    }
+    return Ptr{new T()};
+  }
+
+ private:
+  static void release(T* p) noexcept {
+    size_t home = homeSlot();
+    for (size_t i = 0; i < Slots; ++i) {
+      T* expected = nullptr;
+      auto& slot = slots()[(home + i) % Slots];
+      if (slot.compare_exchange_strong(
+              expected, p, std::memory_order_release, std::memory_order_relaxed))
+        return;
+    }
+    delete p;
+  }
+
+  static std::array<std::atomic<T*>, Slots>& slots() noexcept {
+    static std::array<std::atomic<T*>, Slots> s{};
+    return s;
+  }
+
+  static size_t homeSlot() noexcept {
+    // Thread IDs are widely spaced addresses, so mix them before use
+    uint64_t id = (uint64_t)pthread_self();
+    return ((id * 0x9E3779B97F4A7C15) >> 32) % Slots;
+  }
+};
+
+}  // namespace OIInternal
+
+using OIInternal::PointerHashSet;
+using OIInternal::ScratchPool;
 
 // alignas(0) is ignored according to docs so can be default
 template <unsigned int N, unsigned int align = 0, int32_t Id = 0>
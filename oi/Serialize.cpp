@@ -362,6 +362,30 @@ void serialize(Archive& ar,
 }
 
 INSTANCIATE_SERIALIZE(struct TypeHierarchy)
+
+template <class Archive>
+void serialize(Archive& ar,
+               oi::detail::type_graph::ClassHierarchyIndex::Vtable& vtable,
+               const unsigned int version) {
+  verify_version<oi::detail::type_graph::ClassHierarchyIndex::Vtable>(version);
+  ar & vtable.module;
+  ar & vtable.offset;
+  ar & vtable.size;
+}
+
+INSTANCIATE_SERIALIZE(oi::detail::type_graph::ClassHierarchyIndex::Vtable)
+
+template <class Archive>
+void serialize(Archive& ar,
+               oi::detail::type_graph::ClassHierarchyIndex& index,
+               const unsigned int version) {
+  verify_version<oi::detail::type_graph::ClassHierarchyIndex>(version);
+  ar & index.children;
+  ar & index.vtables;
+  ar & index.modules;
+}
+
+INSTANCIATE_SERIALIZE(oi::detail::type_graph::ClassHierarchyIndex)
 // INSTANCIATE_SERIALIZE(std::map<struct drgn_type *, struct drgn_type *>)
 
 }  // namespace boost::serialization
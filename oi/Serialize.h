@@ -27,6 +27,7 @@
 #include "oi/PaddingHunter.h"
 #include "oi/SymbolService.h"
 #include "oi/TypeHierarchy.h"
+#include "oi/type_graph/ClassHierarchyIndex.h"
 
 #define DEFINE_TYPE_VERSION(Type, size, version)                             \
   static_assert(                                                             \
@@ -50,6 +51,8 @@ DEFINE_TYPE_VERSION(DrgnClassMemberInfo, 64, 3)
 DEFINE_TYPE_VERSION(struct drgn_qualified_type, 16, 2)
 DEFINE_TYPE_VERSION(RootInfo, 48, 2)
 DEFINE_TYPE_VERSION(TypeHierarchy, 384, 7)
+DEFINE_TYPE_VERSION(oi::detail::type_graph::ClassHierarchyIndex::Vtable, 24, 1)
+DEFINE_TYPE_VERSION(oi::detail::type_graph::ClassHierarchyIndex, 160, 2)
 
 #undef DEFINE_TYPE_VERSION
 
@@ -72,6 +75,9 @@ DECL_SERIALIZE(RootInfo);
 DECL_SERIALIZE(DrgnClassMemberInfo);
 DECL_SERIALIZE(TypeHierarchy);
 
+DECL_SERIALIZE(oi::detail::type_graph::ClassHierarchyIndex::Vtable);
+DECL_SERIALIZE(oi::detail::type_graph::ClassHierarchyIndex);
+
 #undef DECL_SERIALIZE
 
 }  // namespace boost::serialization
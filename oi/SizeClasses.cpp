@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "oi/SizeClasses.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace oi::detail {
+namespace {
+
+constexpr size_t kPageSize = 4096;
+
+size_t roundUp(size_t bytes, size_t multiple) {
+  return (bytes + multiple - 1) / multiple * multiple;
+}
+
+size_t jemallocClass(size_t bytes) {
+  constexpr size_t kTiny = 8;
+  constexpr size_t kQuantum = 16;
+  constexpr size_t kMaxQuantumSpaced = 128;
+
+  if (bytes <= kTiny)
+    return kTiny;
+  if (bytes <= kMaxQuantumSpaced)
+    return roundUp(bytes, kQuantum);
+
+  // Four classes between each power of two and the next
+  size_t lgFloor = std::bit_width(bytes - 1) - 1;
+  return roundUp(bytes, size_t{1} << (lgFloor - 2));
+}
+
+size_t glibcChunk(size_t bytes) {
+  constexpr size_t kHeader = sizeof(size_t);
+  constexpr size_t kAlignment = 16;
+  constexpr size_t kMinChunk = 32;
+  constexpr size_t kMmapThreshold = 128 * 1024;
+
+  if (bytes >= kMmapThreshold)
+    return roundUp(bytes + kHeader, kPageSize);
+  return std::max(kMinChunk, roundUp(bytes + kHeader, kAlignment));
+}
+
+}  // namespace
+
+SizeClasses SizeClasses::jemalloc() {
+  return SizeClasses{Kind::Jemalloc};
+}
+
+SizeClasses SizeClasses::glibc() {
+  return SizeClasses{Kind::Glibc};
+}
+
+SizeClasses::SizeClasses(std::vector<size_t> classes)
+    : kind_{Kind::Table}, classes_{std::move(classes)} {
+  std::sort(classes_.begin(), classes_.end());
+}
+
+size_t SizeClasses::allocated(size_t bytes) const {
+  if (bytes == 0)
+    return 0;
+
+  switch (kind_) {
+    case Kind::Jemalloc:
+      return jemallocClass(bytes);
+    case Kind::Glibc:
+      return glibcChunk(bytes);
+    case Kind::Table:
+      break;
+  }
+  auto it = std::lower_bound(classes_.begin(), classes_.end(), bytes);
+  return it != classes_.end() ? *it : roundUp(bytes, kPageSize);
+}
+
+std::string_view SizeClasses::name() const {
+  switch (kind_) {
+    case Kind::Jemalloc:
+      return "jemalloc";
+    case Kind::Glibc:
+      return "glibc";
+    case Kind::Table:
+      break;
+  }
+  return "table";
+}
+
+}  // namespace oi::detail
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace oi::detail {
+
+/*
+ * Models how much memory an allocator really hands out for a request: the
+ * requested bytes rounded up to the allocator's size class, plus any
+ * per-allocation header.
+ */
+class SizeClasses {
+ public:
+  /*
+   * jemalloc's default classes on 64-bit targets, as returned by nallocx():
+   * 8, multiples of the 16 byte quantum up to 128, then four classes per
+   * doubling.
+   */
+  static SizeClasses jemalloc();
+  /*
+   * glibc malloc: an 8 byte chunk header, rounded up to 16 bytes with a 32
+   * byte minimum. Requests past the default mmap threshold get whole pages.
+   */
+  static SizeClasses glibc();
+  /*
+   * An explicit list of class sizes. Requests larger than the last class are
+   * rounded up to pages.
+   */
+  explicit SizeClasses(std::vector<size_t> classes);
+
+  // The bytes allocated for a request of `bytes`, 0 for no allocation
+  size_t allocated(size_t bytes) const;
+
+  std::string_view name() const;
+
+ private:
+  enum class Kind { Jemalloc, Glibc, Table };
+
+  explicit SizeClasses(Kind kind) : kind_{kind} {
+  }
+
+  Kind kind_;
+  std::vector<size_t> classes_;
+};
+
+}  // namespace oi::detail
@@ -16,13 +16,16 @@
 #include "oi/SymbolService.h"
 
 #include <glog/logging.h>
+#include <omp.h>
 
 #include <algorithm>
+#include <boost/core/demangle.hpp>
 #include <boost/scope_exit.hpp>
 #include <cassert>
 #include <cinttypes>
 #include <cstring>
 #include <fstream>
+#include <string_view>
 
 #include "oi/DrgnUtils.h"
 #include "oi/OIParser.h"
@@ -125,6 +128,11 @@ SymbolService::SymbolService(fs::path executablePath)
 }
 
 SymbolService::~SymbolService() {
+  // drgn can't be interrupted, so let an in-flight load finish
+  if (progLoad.valid()) {
+    progLoad.wait();
+  }
+
   if (dwfl != nullptr) {
     dwfl_end(dwfl);
   }
@@ -139,7 +147,6 @@ struct ModParams {
   GElf_Sym sym;
   GElf_Addr value;
   std::vector<std::pair<uint64_t, uint64_t>>& exeAddrs;
-  bool demangle;
 };
 
 /**
@@ -190,11 +197,7 @@ static int moduleCallback(Dwfl_Module* mod,
       continue;
     }
 
-    std::string symName = lookupResult;
-
-    if (m->demangle) {
-      symName = boost::core::demangle(symName.c_str());
-    }
+    std::string_view symName = lookupResult;
 
     switch
       GELF_ST_TYPE(m->sym.st_info) {
@@ -359,11 +362,14 @@ std::optional<drgn_qualified_type> SymbolService::findTypeOfAddr(
  */
 std::optional<SymbolInfo> SymbolService::locateSymbol(
     const std::string& symName, bool demangle) {
+  if (demangle) {
+    return locateDemangledSymbol(symName);
+  }
+
   ModParams m = {.symName = symName,
                  .sym = {},
                  .value = 0,
-                 .exeAddrs = executableAddrs,
-                 .demangle = demangle};
+                 .exeAddrs = executableAddrs};
 
   dwfl_getmodules(dwfl, moduleCallback, (void*)&m, 0);
 
@@ -373,6 +379,140 @@ std::optional<SymbolInfo> SymbolService::locateSymbol(
   return SymbolInfo{m.value, m.sym.st_size};
 }
 
+namespace {
+struct ModuleSymbol {
+  const char* name;
+  GElf_Sym sym;
+  GElf_Addr value;
+};
+}  // namespace
+
+/**
+ * Callback for dwfl_getmodules(). Collects every module apart from separate
+ * debuginfo files.
+ */
+static int collectModulesCallback(Dwfl_Module* mod,
+                                  void** /* userData */,
+                                  const char* name,
+                                  Dwarf_Addr /* start */,
+                                  void* arg) {
+  std::string_view modName = name;
+  if (!modName.ends_with(".debuginfo")) {
+    static_cast<std::vector<Dwfl_Module*>*>(arg)->push_back(mod);
+  }
+  return DWARF_CB_OK;
+}
+
+/*
+ * Reads the defined symbols accepted by `keep` from every module's symbol
+ * table. A Dwfl can't be used from several threads, so this is done up front
+ * and the expensive part, demangling, is then spread over threads by module.
+ */
+template <typename F>
+static std::vector<std::vector<ModuleSymbol>> readModuleSymbols(Dwfl* dwfl,
+                                                                F keep) {
+  std::vector<Dwfl_Module*> mods;
+  dwfl_getmodules(dwfl, collectModulesCallback, (void*)&mods, 0);
+
+  std::vector<std::vector<ModuleSymbol>> symbols(mods.size());
+  for (size_t m = 0; m < mods.size(); ++m) {
+    int nsym = dwfl_module_getsymtab(mods[m]);
+    for (int i = 1; i < nsym; ++i) {
+      ModuleSymbol sym{};
+      GElf_Word shndxp = 0;
+      sym.name = dwfl_module_getsym_info(
+          mods[m], i, &sym.sym, &sym.value, &shndxp, nullptr, nullptr);
+      if (sym.name == nullptr || sym.name[0] == '\0' || shndxp == SHN_UNDEF)
+        continue;
+      if (keep(sym))
+        symbols[m].push_back(sym);
+    }
+  }
+  return symbols;
+}
+
+int SymbolService::workerThreads() const {
+  return debugInfoJobs != 0 ? static_cast<int>(debugInfoJobs)
+                            : omp_get_max_threads();
+}
+
+/*
+ * As moduleCallback(), but comparing demangled names. Every symbol has to be
+ * demangled, so the modules are searched in parallel. The first match in
+ * module order is still the one returned.
+ */
+std::optional<SymbolInfo> SymbolService::locateDemangledSymbol(
+    const std::string& symName) {
+  auto modules = readModuleSymbols(dwfl, [](const ModuleSymbol& sym) {
+    switch (GELF_ST_TYPE(sym.sym.st_info)) {
+      case STT_SECTION:
+      case STT_FILE:
+      case STT_TLS:
+      case STT_NOTYPE:
+        return false;
+      default:
+        return true;
+    }
+  });
+
+  std::vector<const ModuleSymbol*> found(modules.size(), nullptr);
+#pragma omp parallel for schedule(dynamic) num_threads(workerThreads())
+  for (size_t m = 0; m < modules.size(); ++m) {
+    for (const auto& sym : modules[m]) {
+      if (boost::core::demangle(sym.name) != symName)
+        continue;
+      if (GELF_ST_TYPE(sym.sym.st_info) != STT_OBJECT &&
+          !isExecutableAddr(sym.value, executableAddrs))
+        continue;
+
+      found[m] = &sym;
+      break;
+    }
+  }
+
+  for (const auto* sym : found) {
+    if (sym != nullptr && sym->value != 0) {
+      VLOG(1) << "Symbol lookup successful for " << symName;
+      return SymbolInfo{sym->value, sym->sym.st_size};
+    }
+  }
+  return std::nullopt;
+}
+
+/*
+ * Maps fully-qualified class names to their vtables. Only `_ZTV` symbols are
+ * demangled, which is done in parallel by module.
+ */
+std::unordered_map<std::string, SymbolInfo> SymbolService::locateVtables() {
+  auto modules = readModuleSymbols(dwfl, [](const ModuleSymbol& sym) {
+    return GELF_ST_TYPE(sym.sym.st_info) == STT_OBJECT &&
+           strncmp(sym.name, "_ZTV", 4) == 0;
+  });
+
+  constexpr std::string_view vtablePrefix = "vtable for ";
+  std::vector<std::vector<std::pair<std::string, SymbolInfo>>> found(
+      modules.size());
+#pragma omp parallel for schedule(dynamic) num_threads(workerThreads())
+  for (size_t m = 0; m < modules.size(); ++m) {
+    for (const auto& sym : modules[m]) {
+      std::string demangled = boost::core::demangle(sym.name);
+      if (!demangled.starts_with(vtablePrefix))
+        continue;
+
+      found[m].emplace_back(demangled.substr(vtablePrefix.size()),
+                            SymbolInfo{sym.value, sym.sym.st_size});
+    }
+  }
+
+  // Earlier modules take precedence, as they did when scanned in order
+  std::unordered_map<std::string, SymbolInfo> vtables;
+  for (auto& moduleVtables : found) {
+    for (auto& [name, info] : moduleVtables)
+      vtables.emplace(std::move(name), info);
+  }
+  return vtables;
+}
+
 static std::string bytesToHexString(const unsigned char* bytes, int nbbytes) {
   static const char characters[] = "0123456789abcdef";
 
@@ -431,14 +571,79 @@ std::optional<std::string> SymbolService::locateBuildID() {
   return buildID;
 }
 
+/**
+ * Callback for dwfl_getmodules(). Records the build ID and address range of
+ * every module apart from separate debuginfo files.
+ */
+static int modulesCallback(Dwfl_Module* mod,
+                           void** /* userData */,
+                           const char* name,
+                           Dwarf_Addr start,
+                           void* arg) {
+  std::string_view modName = name;
+  if (modName.ends_with(".debuginfo"))
+    return DWARF_CB_OK;
+
+  // We must call dwfl_module_getelf before using dwfl_module_build_id
+  GElf_Addr bias = 0;
+  if (dwfl_module_getelf(mod, &bias) == nullptr) {
+    LOG(ERROR) << "Failed to getelf for " << name << ": " << dwfl_errmsg(-1);
+    return DWARF_CB_OK;
+  }
+
+  GElf_Addr vaddr = 0;
+  const unsigned char* bytes = nullptr;
+  int nbbytes = dwfl_module_build_id(mod, &bytes, &vaddr);
+  if (nbbytes <= 0) {
+    VLOG(1) << "Build ID not found for " << name;
+    return DWARF_CB_OK;
+  }
+
+  Dwarf_Addr end = 0;
+  dwfl_module_info(
+      mod, nullptr, nullptr, &end, nullptr, nullptr, nullptr, nullptr);
+  static_cast<std::vector<ModuleInfo>*>(arg)->push_back(
+      ModuleInfo{bytesToHexString(bytes, nbbytes), start, end});
+  return DWARF_CB_OK;
+}
+
+std::vector<ModuleInfo> SymbolService::locateModules() {
+  std::vector<ModuleInfo> modules;
+  dwfl_getmodules(dwfl, modulesCallback, (void*)&modules, 0);
+  return modules;
+}
+
 struct drgn_program* SymbolService::getDrgnProgram() {
   if (hardDisableDrgn) {
     LOG(ERROR) << "drgn is disabled, refusing to initialize";
     return nullptr;
   }
 
-  if (prog != nullptr) {
-    return prog;
+  loadDebugInfoAsync();
+  return progLoad.get();
+}
+
+void SymbolService::loadDebugInfoAsync(
+    std::vector<std::string> prefetchFuncs) {
+  if (hardDisableDrgn || progLoad.valid()) {
+    return;
+  }
+
+  progLoad = std::async(std::launch::async,
+                        [this, funcs = std::move(prefetchFuncs)] {
+                          auto* p = loadDrgnProgram();
+                          if (p != nullptr)
+                            prefetchFuncDescs(p, funcs);
+                          return p;
+                        })
+                 .share();
+}
+
+struct drgn_program* SymbolService::loadDrgnProgram() {
+  if (debugInfoJobs != 0) {
+    // drgn indexes compilation units in OpenMP parallel regions. This only
+    // sets the team size for regions started from this (loading) thread.
+    omp_set_num_threads(static_cast<int>(debugInfoJobs));
   }
 
   LOG(INFO) << "Initialising drgn. This might take a while";
@@ -455,7 +660,10 @@ struct drgn_program* SymbolService::getDrgnProgram() {
       if (auto* err = drgn_program_load_debug_info(
               prog, &executableCStr, 1, false, false)) {
         LOG(ERROR) << "Error loading debug info: " << err->message;
-        return nullptr;
+        drgn_program_destroy(prog);
+
+        prog = nullptr;
+        return prog;
       }
       break;
     }
@@ -739,6 +947,14 @@ std::shared_ptr<FuncDesc> SymbolService::findFuncDesc(const irequest& request) {
     return nullptr;
   }
 
+  if (auto it = prefetchedDescs.find(request.func);
+      it != end(prefetchedDescs)) {
+    VLOG(1) << "Found prefetched funcDesc for " << request.func;
+    auto fd = funcDescs.emplace(request.func, std::move(it->second));
+    prefetchedDescs.erase(it);
+    return fd.first->second;
+  }
+
   auto fd = createFuncDesc(drgnProg, request);
   if (!fd.has_value()) {
     LOG(ERROR) << "Failed to create FuncDesc for " << request.func;
@@ -750,6 +966,19 @@ std::shared_ptr<FuncDesc> SymbolService::findFuncDesc(const irequest& request) {
   return fd.value();
 }
 
+/*
+ * Runs on the loading thread, so must only write to `prefetchedDescs`.
+ * findFuncDesc() moves them into `funcDescs` once the load has finished.
+ */
+void SymbolService::prefetchFuncDescs(struct drgn_program* drgnProg,
+                                      const std::vector<std::string>& funcs) {
+  for (const auto& func : funcs) {
+    if (auto fd = createFuncDesc(drgnProg, irequest{"entry", func, "arg0"})) {
+      prefetchedDescs.emplace(func, std::move(*fd));
+    }
+  }
+}
+
 std::shared_ptr<GlobalDesc> SymbolService::findGlobalDesc(
     const std::string& global) {
   if (auto it = globalDescs.find(global); it != end(globalDescs)) {
@@ -757,6 +986,9 @@ std::shared_ptr<GlobalDesc> SymbolService::findGlobalDesc(
     return it->second;
   }
 
+  // The symbol table lookup doesn't need drgn, so overlap the two
+  loadDebugInfoAsync();
+
   auto sym = locateSymbol(global);
   if (!sym.has_value()) {
     LOG(ERROR) << "Failed to get address for global " << global;
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <filesystem>
+#include <future>
 #include <memory>
 #include <optional>
 #include <string>
@@ -37,6 +38,16 @@ struct SymbolInfo {
   uint64_t size;
 };
 
+/*
+ * A module of the target, identified by its build ID. The same build may be
+ * loaded at a different address on each run, e.g. under ASLR.
+ */
+struct ModuleInfo {
+  std::string buildID;
+  uint64_t start;
+  uint64_t end;
+};
+
 class SymbolService {
  public:
   SymbolService(pid_t);
@@ -45,11 +56,22 @@ class SymbolService {
   SymbolService& operator=(const SymbolService&) = delete;
   ~SymbolService();
 
+  // Blocks until debug info has been loaded, starting the load if needed
   struct drgn_program* getDrgnProgram();
+  // Starts loading debug info on a background thread, so that it overlaps
+  // with work that only needs the ELF symbol tables. The FuncDescs of
+  // `prefetchFuncs` are then created on the same thread, ready for
+  // findFuncDesc().
+  void loadDebugInfoAsync(std::vector<std::string> prefetchFuncs = {});
 
   std::optional<std::string> locateBuildID();
+  // Every module with a build ID, and where it is loaded
+  std::vector<ModuleInfo> locateModules();
   std::optional<SymbolInfo> locateSymbol(const std::string&,
                                          bool demangle = false);
+  // Maps fully-qualified class names to their vtables, in one pass over the
+  // symbol tables.
+  std::unordered_map<std::string, SymbolInfo> locateVtables();
 
   std::shared_ptr<FuncDesc> findFuncDesc(const irequest&);
   std::shared_ptr<GlobalDesc> findGlobalDesc(const std::string&);
@@ -67,18 +89,33 @@ class SymbolService {
   void setHardDisableDrgn(bool val) {
     hardDisableDrgn = val;
   }
+  // Number of threads drgn uses to index debug info, and that symbol table
+  // lookups use to demangle names. 0 means one per core.
+  void setDebugInfoJobs(unsigned val) {
+    debugInfoJobs = val;
+  }
 
  private:
   std::variant<pid_t, std::filesystem::path> target;
   struct Dwfl* dwfl{nullptr};
   struct drgn_program* prog{nullptr};
+  std::shared_future<struct drgn_program*> progLoad;
+  // Written by the loading thread before `progLoad` is ready, so only read
+  // after waiting for it
+  std::unordered_map<std::string, std::shared_ptr<FuncDesc>> prefetchedDescs;
 
   bool loadModules();
   bool loadModulesFromPid(pid_t);
   bool loadModulesFromPath(const std::filesystem::path&);
+  struct drgn_program* loadDrgnProgram();
+  int workerThreads() const;
+  std::optional<SymbolInfo> locateDemangledSymbol(const std::string&);
+  void prefetchFuncDescs(struct drgn_program*,
+                         const std::vector<std::string>& funcs);
 
   std::vector<std::pair<uint64_t, uint64_t>> executableAddrs{};
   bool hardDisableDrgn = false;
+  unsigned debugInfoJobs = 0;
 
  protected:
   SymbolService() = default;  // For unit tests
@@ -17,22 +17,30 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <boost/algorithm/string/regex.hpp>
 #include <boost/scope_exit.hpp>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <msgpack.hpp>
+#include <oi/exporters/ContainerWaste.h>
+#include <oi/exporters/FlameGraph.h>
+#include <oi/exporters/TypeHistogram.h>
 #include <stdexcept>
+#include <unordered_map>
 
 #include "oi/ContainerInfo.h"
 #include "oi/DrgnUtils.h"
 #include "oi/Metrics.h"
 #include "oi/OICodeGen.h"
 #include "oi/PaddingHunter.h"
+#include "oi/TreeBuilderIndex.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/statistics.h"
+#include "rocksdb/write_batch.h"
 
 extern "C" {
 #include <drgn.h>
@@ -52,9 +60,59 @@ enum class TrackPointerTag : uint64_t {
   followed = 1,
 };
 
+/*
+ * State for the secondary indexes, see TreeBuilderIndex.h. The stats are
+ * aggregated in memory and written once all roots are built.
+ */
+struct TreeBuilder::DBIndex {
+  // Same order as index::kFamilies
+  std::vector<rocksdb::ColumnFamilyHandle*> families;
+  std::unordered_map<std::string, index::IndexStats> typeStats;
+  std::unordered_map<std::string, index::IndexStats> pathStats;
+  uint64_t nextGroupId = 1;
+  rocksdb::WriteBatch batch;
+  std::string key;
+  msgpack::sbuffer entry;
+
+  rocksdb::ColumnFamilyHandle* family(std::string_view name) const {
+    auto it = std::ranges::find(index::kFamilies, name);
+    return families[it - std::begin(index::kFamilies)];
+  }
+
+  // The stats of a type name or path, giving it an ID when first seen
+  index::IndexStats& groupStats(
+      std::unordered_map<std::string, index::IndexStats>& allStats,
+      const std::string& group) {
+    auto [it, inserted] = allStats.try_emplace(group);
+    if (inserted) {
+      it->second.id = nextGroupId++;
+    }
+    return it->second;
+  }
+};
+
 TreeBuilder::TreeBuilder(Config c) : config{std::move(c)} {
   buffer = std::make_unique<msgpack::sbuffer>();
 
+  if (config.flameGraphPath.has_value()) {
+    flameGraphOutput = std::make_unique<std::ofstream>(*config.flameGraphPath);
+    if (!flameGraphOutput->is_open()) {
+      LOG(ERROR) << "Failed to open " << *config.flameGraphPath
+                 << " for writing";
+    }
+    flameGraph = std::make_unique<exporters::FlameGraph>(*flameGraphOutput);
+  }
+  if (config.typeHistogramPath.has_value()) {
+    typeHistogram = std::make_unique<exporters::TypeHistogram>();
+  }
+  if (config.containerWastePath.has_value()) {
+    containerWaste = std::make_unique<exporters::ContainerWaste>();
+  }
+
+  if (!config.writeRocksDB) {
+    return;
+  }
+
   auto testdbPath = "/tmp/testdb_" + std::to_string(getpid());
   if (auto status = rocksdb::DestroyDB(testdbPath, {}); !status.ok()) {
     LOG(FATAL) << "RocksDB error while destroying database: "
@@ -70,9 +128,29 @@ TreeBuilder::TreeBuilder(Config c) : config{std::move(c)} {
   options.PrepareForBulkLoad();
   options.OptimizeForSmallDb();
 
-  if (auto status = rocksdb::DB::Open(options, testdbPath, &db); !status.ok()) {
+  options.create_missing_column_families = true;
+
+  std::vector<rocksdb::ColumnFamilyDescriptor> families{
+      {rocksdb::kDefaultColumnFamilyName, options}};
+  if (config.writeIndexes) {
+    for (auto name : index::kFamilies) {
+      families.emplace_back(std::string{name}, options);
+    }
+  }
+
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+  if (auto status = rocksdb::DB::Open(
+          options, testdbPath, families, &handles, &db);
+      !status.ok()) {
     LOG(FATAL) << "RocksDB error while opening database: " << status.ToString();
   }
+
+  // The default family is accessed without its handle
+  db->DestroyColumnFamilyHandle(handles[0]);
+  if (config.writeIndexes) {
+    dbIndex = std::make_unique<DBIndex>();
+    dbIndex->families.assign(handles.begin() + 1, handles.end());
+  }
 }
 
 struct TreeBuilder::Variable {
@@ -119,6 +197,18 @@ struct TreeBuilder::Node {
     MSGPACK_DEFINE_ARRAY(length, capacity, elementStaticSize)
   };
 
+  /**
+   * Bucket occupancy of a hash table, see result::Element::HashTableStats.
+   * F14 tables count their chunks as buckets.
+   */
+  struct HashTableStats {
+    size_t buckets;
+    size_t emptyBuckets;
+    size_t longestChain;
+    size_t overflowedBuckets;
+    MSGPACK_DEFINE_ARRAY(buckets, emptyBuckets, longestChain, overflowedBuckets)
+  };
+
   /**
    * The unique identifier for this node, used as the key for this
    * node's entry in RocksDB.
@@ -153,6 +243,12 @@ struct TreeBuilder::Node {
    * container).
    */
   size_t dynamicSize{};
+  /**
+   * `dynamicSize` with each heap allocation rounded up to the allocator's
+   * size class, see `Config::sizeClasses`. Without size classes it is the
+   * same as `dynamicSize`.
+   */
+  size_t allocatedSize{};
   std::optional<size_t> paddingSavingsSize{std::nullopt};
   std::optional<uintptr_t> pointer{std::nullopt};
   std::optional<ContainerStats> containerStats{std::nullopt};
@@ -176,6 +272,17 @@ struct TreeBuilder::Node {
    */
   size_t exclusiveSize{};
 
+  /**
+   * The number of buckets of a hash table. Not serialized, it is only read
+   * by the container waste report.
+   */
+  size_t bucketCount{};
+
+  /**
+   * Only captured for hash tables with Feature::HashTableStats.
+   */
+  std::optional<HashTableStats> hashTableStats{std::nullopt};
+
   MSGPACK_DEFINE_ARRAY(id,
                        name,
                        typeName,
@@ -188,10 +295,33 @@ struct TreeBuilder::Node {
                        pointer,
                        children,
                        isset,
-                       exclusiveSize)
+                       exclusiveSize,
+                       allocatedSize,
+                       hashTableStats)
 };
 
 TreeBuilder::~TreeBuilder() {
+  if (typeHistogram) {
+    std::ofstream output{*config.typeHistogramPath};
+    if (!output.is_open()) {
+      LOG(ERROR) << "Failed to open " << *config.typeHistogramPath
+                 << " for writing";
+    }
+    typeHistogram->print(output);
+  }
+  if (containerWaste) {
+    std::ofstream output{*config.containerWastePath};
+    if (!output.is_open()) {
+      LOG(ERROR) << "Failed to open " << *config.containerWastePath
+                 << " for writing";
+    }
+    containerWaste->print(output);
+  }
+
+  if (db == nullptr) {
+    return;
+  }
+
   /* FB: Remove error IDs, Strobelight doesn't handle them yet */
   std::erase(rootIDs, ERROR_NODE_ID);
 
@@ -210,6 +340,13 @@ TreeBuilder::~TreeBuilder() {
     LOG(ERROR) << "RocksDB error while writing DBHeader: " << status.ToString();
   }
 
+  if (dbIndex) {
+    writeIndexStats();
+    for (auto* family : dbIndex->families) {
+      db->DestroyColumnFamilyHandle(family);
+    }
+  }
+
   if (auto status = db->Close(); !status.ok()) {
     LOG(ERROR) << "RocksDB error while closing database: " << status.ToString();
   }
@@ -234,6 +371,18 @@ void TreeBuilder::build(const std::vector<uint64_t>& data,
   metrics::Tracing _("build_tree");
   VLOG(1) << "Building tree...";
 
+  std::streampos jsonRootStart{};
+  if (config.jsonPath.has_value()) {
+    openJson();
+    if (!rootIDs.empty()) {
+      *jsonOutput << ',';
+    }
+    jsonRootStart = jsonOutput->tellp();
+  }
+
+  nodePath.clear();
+  flameGraphDepth = 0;
+
   {
     auto& rootID = rootIDs.emplace_back(nextNodeID++);
 
@@ -242,17 +391,34 @@ void TreeBuilder::build(const std::vector<uint64_t>& data,
     } catch (...) {
       // Mark the failure using the error node ID
       rootID = ERROR_NODE_ID;
+
+      if (jsonOutput) {
+        // Overwrite the partial tree with an empty object to maintain offsets.
+        // dumpJson() truncates whatever is left of it past the end.
+        jsonFrames.clear();
+        jsonOutput->seekp(jsonRootStart);
+        *jsonOutput << "{}";
+      }
       throw;
     }
   }
 
   VLOG(1) << "Finished building tree";
-  rocksdb::CompactRangeOptions opts;
-  rocksdb::Status s = db->CompactRange(opts, nullptr, nullptr);
-  if (!s.ok()) {
-    LOG(FATAL) << "RocksDB error while compacting: " << s.ToString();
+  if (db != nullptr) {
+    rocksdb::CompactRangeOptions opts;
+    rocksdb::Status s = db->CompactRange(opts, nullptr, nullptr);
+    if (dbIndex) {
+      for (auto* family : dbIndex->families) {
+        if (s.ok()) {
+          s = db->CompactRange(opts, family, nullptr, nullptr);
+        }
+      }
+    }
+    if (!s.ok()) {
+      LOG(FATAL) << "RocksDB error while compacting: " << s.ToString();
+    }
+    VLOG(1) << "Finished compacting db";
   }
-  VLOG(1) << "Finished compacting db";
 
   // Were all object sizes consumed?
   if (oidDataIndex != oidData->size()) {
@@ -279,28 +445,41 @@ void TreeBuilder::dumpJson() {
     return;
   }
 
-  std::ofstream output(*config.jsonPath);
-  output << '[';
-  for (auto rootID : rootIDs) {
-    if (rootID == ERROR_NODE_ID) {
-      // On error, output an empty object to maintain offsets
-      output << "{},";
-    } else {
-      JSON(rootID, output);
-      output << ',';
-    }
-  }
+  openJson();
+  *jsonOutput << "]\n";  // Text files should end with a newline per POSIX
 
-  /* Remove the trailing comma */
-  if (!rootIDs.empty()) {
-    output.seekp(-1, std::ios_base::cur);
-  }
+  auto size = static_cast<uintmax_t>(jsonOutput->tellp());
+  jsonOutput.reset();
+  jsonBuffer = {};
 
-  output << "]\n";  // Text files should end with a newline per POSIX
+  // A root that failed part way through may have left bytes past the end
+  std::error_code ec;
+  std::filesystem::resize_file(*config.jsonPath, size, ec);
+  if (ec) {
+    LOG(ERROR) << "Failed to truncate " << *config.jsonPath << ": "
+               << ec.message();
+  }
 
   VLOG(1) << "Finished writing JSON to disk";
 }
 
+void TreeBuilder::openJson() {
+  if (jsonOutput) {
+    return;
+  }
+
+  // The buffer must be installed before the file is opened to take effect
+  constexpr size_t jsonBufferSize = 1 << 20;
+  jsonBuffer.resize(jsonBufferSize);
+  jsonOutput = std::make_unique<std::ofstream>();
+  jsonOutput->rdbuf()->pubsetbuf(jsonBuffer.data(), jsonBuffer.size());
+  jsonOutput->open(*config.jsonPath);
+  if (!jsonOutput->is_open()) {
+    LOG(ERROR) << "Failed to open " << *config.jsonPath << " for writing";
+  }
+  *jsonOutput << '[';
+}
+
 void TreeBuilder::setPaddedStructs(
     std::map<std::string, PaddingInfo>* _paddedStructs) {
   this->paddedStructs = _paddedStructs;
@@ -377,6 +556,22 @@ uint64_t TreeBuilder::next() {
   return (*oidData)[oidDataIndex++];
 }
 
+uint64_t TreeBuilder::allocationSize(uint64_t bytes) const {
+  return config.sizeClasses ? config.sizeClasses->allocated(bytes) : bytes;
+}
+
+// Reads the stats saved by the hash table containers after their length
+void TreeBuilder::readHashTableStats(Node& node) {
+  if (!config.features[Feature::HashTableStats])
+    return;
+  node.hashTableStats.emplace(Node::HashTableStats{
+      .buckets = next(),
+      .emptyBuckets = next(),
+      .longestChain = next(),
+      .overflowedBuckets = next(),
+  });
+}
+
 bool TreeBuilder::isContainer(const Variable& variable) {
   if (th->containerTypeMap.contains(variable.type)) {
     return true;
@@ -439,6 +634,26 @@ TreeBuilder::Node TreeBuilder::process(NodeID id, Variable variable) {
           << "', kind: " << drgnKindStr(variable.type) << ")"
           << (variable.isStubbed ? " STUBBED" : "")
           << (th->knownDummyTypeList.contains(variable.type) ? " DUMMY" : "");
+  if (jsonOutput) {
+    jsonBeginNode(node);
+  }
+  // Pointees and typedefs' underlying types have no path component of their
+  // own, so their flame graph frames are their type names
+  auto flameGraphFrame = [&node]() -> std::string_view {
+    return node.typePath.empty() ? node.typeName : node.typePath;
+  };
+  if (flameGraph) {
+    flameGraph->enter(++flameGraphDepth, flameGraphFrame());
+  }
+
+  const size_t parentPathSize = nodePath.size();
+  if (dbIndex || containerWaste) {
+    if (parentPathSize > 0) {
+      nodePath += index::kPathSeparator;
+    }
+    nodePath += node.typePath;
+  }
+
   // Default dynamic size to 0 and calculate fallback exclusive size
   setSize(node, 0, 0);
   if (!variable.isStubbed) {
@@ -469,6 +684,8 @@ TreeBuilder::Node TreeBuilder::process(NodeID id, Variable variable) {
             setSize(node,
                     child.staticSize + child.dynamicSize,
                     child.staticSize + child.dynamicSize);
+            node.allocatedSize =
+                allocationSize(child.staticSize) + child.allocatedSize;
           }
         }
         break;
@@ -491,6 +708,7 @@ TreeBuilder::Node TreeBuilder::process(NodeID id, Variable variable) {
           node.children = {childID, childID + 1};
           setSize(
               node, child.dynamicSize, child.dynamicSize + child.staticSize);
+          node.allocatedSize = child.allocatedSize;
         }
       } break;
       case DRGN_TYPE_CLASS:
@@ -551,6 +769,7 @@ TreeBuilder::Node TreeBuilder::process(NodeID id, Variable variable) {
                                           isset,
                                           member.isStubbed});
             node.dynamicSize += child.dynamicSize;
+            node.allocatedSize += child.allocatedSize;
             memberSizes += child.dynamicSize + child.staticSize;
           }
           setSize(node, node.dynamicSize, memberSizes);
@@ -571,15 +790,131 @@ TreeBuilder::Node TreeBuilder::process(NodeID id, Variable variable) {
     }
   }
 
+  if (jsonOutput) {
+    jsonEndNode(node);
+  }
+  if (flameGraph) {
+    // Children moved the stack below this node, bring it back
+    flameGraph->enter(flameGraphDepth--, flameGraphFrame());
+    flameGraph->add(node.exclusiveSize);
+  }
+  if (typeHistogram) {
+    std::optional<result::Element::ContainerStats> containerStats;
+    if (node.containerStats.has_value()) {
+      containerStats = {.capacity = node.containerStats->capacity,
+                        .length = node.containerStats->length};
+    }
+    typeHistogram->add(node.typeName,
+                       node.staticSize + node.dynamicSize,
+                       node.exclusiveSize,
+                       containerStats ? &*containerStats : nullptr);
+  }
+
+  if (containerWaste && node.containerStats.has_value()) {
+    containerWaste->add(
+        nodePath,
+        node.typeName,
+        {.length = node.containerStats->length,
+         .capacity = node.containerStats->capacity,
+         .elementSize = node.containerStats->elementStaticSize,
+         .bucketCount = node.bucketCount});
+  }
+
+  if (db != nullptr) {
+    writeNode(node);
+  }
+  nodePath.resize(parentPathSize);
+  return node;
+}
+
+/*
+ * Write the node, and its index entries if enabled in one batch, while
+ * `nodePath` is still the node's path.
+ */
+void TreeBuilder::writeNode(const Node& node) {
   rocksdb::WriteOptions options{};
   options.disableWAL = true;
-  auto status = db->Put(options, std::to_string(node.id), serialize(node));
-  if (!status.ok()) {
+  if (dbIndex == nullptr) {
+    auto status = db->Put(options, std::to_string(node.id), serialize(node));
+    if (!status.ok()) {
+      throw std::runtime_error("RocksDB error while inserting node [" +
+                               std::to_string(node.id) +
+                               "]: " + status.ToString());
+    }
+    return;
+  }
+
+  auto& batch = dbIndex->batch;
+  auto& key = dbIndex->key;
+  batch.Clear();
+
+  if (auto status = batch.Put(std::to_string(node.id), serialize(node));
+      !status.ok()) {
+    throw std::runtime_error("RocksDB error while inserting node [" +
+                             std::to_string(node.id) +
+                             "]: " + status.ToString());
+  }
+
+  const uint64_t inclusiveSize = node.staticSize + node.dynamicSize;
+  auto& typeStats = dbIndex->groupStats(dbIndex->typeStats, node.typeName);
+  auto& pathStats = dbIndex->groupStats(dbIndex->pathStats, nodePath);
+
+  dbIndex->entry.clear();
+  msgpack::pack(dbIndex->entry,
+                index::IndexEntry{
+                    .id = node.id,
+                    .inclusiveSize = inclusiveSize,
+                    .exclusiveSize = node.exclusiveSize,
+                });
+  rocksdb::Slice entry{dbIndex->entry.data(), dbIndex->entry.size()};
+
+  auto put = [&](std::string_view family, std::optional<uint64_t> groupId) {
+    key.clear();
+    if (groupId.has_value()) {
+      index::appendBigEndian(key, *groupId);
+    }
+    index::appendSizeKey(key, inclusiveSize, node.id);
+    return batch.Put(dbIndex->family(family), key, entry);
+  };
+  for (auto status : {put(index::kBySize, std::nullopt),
+                      put(index::kByTypeName, typeStats.id),
+                      put(index::kByTypePath, pathStats.id)}) {
+    if (!status.ok()) {
+      throw std::runtime_error("RocksDB error while indexing node [" +
+                               std::to_string(node.id) +
+                               "]: " + status.ToString());
+    }
+  }
+
+  for (auto* stats : {&typeStats, &pathStats}) {
+    stats->count++;
+    stats->inclusiveSize += inclusiveSize;
+    stats->exclusiveSize += node.exclusiveSize;
+  }
+
+  if (auto status = db->Write(options, &batch); !status.ok()) {
     throw std::runtime_error("RocksDB error while inserting node [" +
                              std::to_string(node.id) +
                              "]: " + status.ToString());
   }
-  return node;
+}
+
+void TreeBuilder::writeIndexStats() {
+  rocksdb::WriteOptions options{};
+  options.disableWAL = true;
+
+  auto write = [&](std::string_view family, const auto& allStats) {
+    rocksdb::WriteBatch batch;
+    for (const auto& [key, stats] : allStats) {
+      batch.Put(dbIndex->family(family), key, serialize(stats));
+    }
+    if (auto status = db->Write(options, &batch); !status.ok()) {
+      LOG(ERROR) << "RocksDB error while writing " << family << ": "
+                 << status.ToString();
+    }
+  };
+  write(index::kTypeStats, dbIndex->typeStats);
+  write(index::kPathStats, dbIndex->pathStats);
 }
 
 void TreeBuilder::processContainer(const Variable& variable, Node& node) {
@@ -626,6 +961,9 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
    * the container).
    */
   bool contentsStoredInline = false;
+  // Whether each element is a separate allocation, rather than all of them
+  // sharing one
+  bool nodeBased = false;
 
   // Initialize, then take a reference to the underlying value for convenience
   // so that we don't have to dereference the optional every time we want to use
@@ -696,6 +1034,7 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
                    .typePath = drgnTypeToName(containerType.type) + "[]"});
 
       setSize(node, child.dynamicSize, child.dynamicSize + child.staticSize);
+      node.allocatedSize = child.allocatedSize;
       node.containerStats = child.containerStats;
       return;
     }
@@ -737,6 +1076,7 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
                      .typePath = drgnTypeToName(elementType.type) + "[]"});
 
         setSize(node, child.dynamicSize, child.dynamicSize + child.staticSize);
+        node.allocatedSize = child.allocatedSize;
       }
       return;
     }
@@ -760,6 +1100,7 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
     case LIST_TYPE:
       node.pointer = next();
       containerStats.length = containerStats.capacity = next();
+      nodeBased = true;
       break;
     case FOLLY_IOBUFQUEUE_TYPE:
       node.pointer = next();
@@ -810,6 +1151,7 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
     case CAFFE2_BLOB_TYPE:
       // This is a weird one, need to ask why we just overwite size like this
       setSize(node, next(), 0);
+      node.allocatedSize = node.dynamicSize;
       return;
     case ARRAY_TYPE:
       contentsStoredInline = true;
@@ -830,12 +1172,14 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
       // TODO: Hard to know the overhead of boost bimap. It isn't documented in
       // the boost docs. Need to look closer at the implementation.
       containerStats.length = containerStats.capacity = next();
+      nodeBased = true;
       break;
     case SET_TYPE:
     case STD_MAP_TYPE:
       // Account for node overhead
       containerStats.elementStaticSize += next();
       containerStats.length = containerStats.capacity = next();
+      nodeBased = true;
       break;
     case UNORDERED_SET_TYPE:
     case UNORDERED_MULTISET_TYPE:
@@ -843,10 +1187,13 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
     case STD_UNORDERED_MAP_TYPE: {
       // Account for node overhead
       containerStats.elementStaticSize += next();
-      size_t bucketCount = next();
+      node.bucketCount = next();
       // Both libc++ and libstdc++ define buckets as an array of raw pointers
-      setSize(node, node.dynamicSize + bucketCount * sizeof(void*), 0);
+      setSize(node, node.dynamicSize + node.bucketCount * sizeof(void*), 0);
+      node.allocatedSize += allocationSize(node.bucketCount * sizeof(void*));
       containerStats.length = containerStats.capacity = next();
+      readHashTableStats(node);
+      nodeBased = true;
     } break;
     case F14_MAP:
     case F14_SET:
@@ -856,15 +1203,22 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
       // conveniently provide a `getAllocatedMemorySize()` method which we can
       // use instead.
       contentsStoredInline = true;
-      setSize(node, node.dynamicSize + next(), 0);
+      {
+        // Counted as a single allocation, which it is for all but node maps
+        auto allocatedMemorySize = next();
+        setSize(node, node.dynamicSize + allocatedMemorySize, 0);
+        node.allocatedSize += allocationSize(allocatedMemorySize);
+      }
       containerStats.capacity = next();
       containerStats.length = next();
+      readHashTableStats(node);
       break;
     case RADIX_TREE_TYPE:
     case MULTI_SET_TYPE:
     case MULTI_MAP_TYPE:
     case BY_MULTI_QRT_TYPE:
       containerStats.length = containerStats.capacity = next();
+      nodeBased = true;
       break;
     case THRIFT_ISSET_TYPE:
     case DUMMY_TYPE:
@@ -882,6 +1236,12 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
             node.dynamicSize +
                 containerStats.elementStaticSize * containerStats.capacity,
             0);
+    node.allocatedSize +=
+        nodeBased
+            ? allocationSize(containerStats.elementStaticSize) *
+                  containerStats.capacity
+            : allocationSize(containerStats.elementStaticSize *
+                             containerStats.capacity);
   }
 
   // A cutoff value used to sanity-check our results. If a container
@@ -922,6 +1282,7 @@ void TreeBuilder::processContainer(const Variable& variable, Node& node) {
                             .name = "",
                             .typePath = drgnTypeToName(type.type) + "[]"});
       node.dynamicSize += child.dynamicSize;
+      node.allocatedSize += child.allocatedSize;
       memberSizes += child.dynamicSize + child.staticSize;
     }
   }
@@ -937,26 +1298,80 @@ std::string_view TreeBuilder::serialize(const T& data) {
   return std::string_view(buffer->data(), buffer->size());
 }
 
-void TreeBuilder::JSON(NodeID id, std::ofstream& output) {
-  std::string data;
-  auto status = db->Get(rocksdb::ReadOptions(), std::to_string(id), &data);
-  if (!status.ok()) {
-    throw std::runtime_error("RocksDB error while reading node [" +
-                             std::to_string(id) + "]: " + status.ToString());
+/*
+ * Called when `node` starts being processed. If it is the first child of its
+ * parent, the parent's head and the opening of its "members" array are
+ * written first.
+ */
+void TreeBuilder::jsonBeginNode(const Node& node) {
+  if (!jsonFrames.empty()) {
+    auto& parent = jsonFrames.back();
+    if (parent.membersOpen) {
+      *jsonOutput << ',';
+    } else {
+      jsonWriteHead(*parent.node);
+      *jsonOutput << ",\"members\":[";
+      parent.membersOpen = true;
+    }
+  }
+  jsonFrames.push_back({.node = &node, .membersOpen = false});
+}
+
+void TreeBuilder::jsonEndNode(const Node& node) {
+  if (jsonFrames.back().membersOpen) {
+    *jsonOutput << ']';
+  } else {
+    jsonWriteHead(node);
   }
+  jsonFrames.pop_back();
+
+  jsonWriteSizes(node);
+  *jsonOutput << '}';
+}
+
+/*
+ * Writes the fields which are final before a node's children are processed.
+ */
+void TreeBuilder::jsonWriteHead(const Node& node) {
+  auto& output = *jsonOutput;
+
+  // Replace all backslashes to ensure the output is valid JSON
+  auto writeSanitized = [&output](std::string_view str) {
+    for (size_t pos; (pos = str.find('\\')) != std::string_view::npos;) {
+      output.write(str.data(), pos);
+      output << ' ';
+      str.remove_prefix(pos + 1);
+    }
+    output.write(str.data(), str.size());
+  };
 
-  Node node;
-  msgpack::unpack(data.data(), data.size()).get().convert(node);
-  // Remove all backslashes to ensure the output is valid JSON
-  std::replace(node.typePath.begin(), node.typePath.end(), '\\', ' ');
-  std::replace(node.typeName.begin(), node.typeName.end(), '\\', ' ');
   output << "{";
   output << "\"name\":\"" << node.name << "\",";
-  output << "\"typePath\":\"" << node.typePath << "\",";
-  output << "\"typeName\":\"" << node.typeName << "\",";
+  output << "\"typePath\":\"";
+  writeSanitized(node.typePath);
+  output << "\",";
+  output << "\"typeName\":\"";
+  writeSanitized(node.typeName);
+  output << "\",";
   output << "\"isTypedef\":" << (node.isTypedef ? "true" : "false") << ",";
-  output << "\"staticSize\":" << node.staticSize << ",";
+  output << "\"staticSize\":" << node.staticSize;
+  if (node.isset.has_value()) {
+    output << ",";
+    output << "\"isset\":" << (*node.isset ? "true" : "false");
+  }
+}
+
+/*
+ * Writes the fields which depend on a node's children.
+ */
+void TreeBuilder::jsonWriteSizes(const Node& node) {
+  auto& output = *jsonOutput;
+
+  output << ",";
   output << "\"dynamicSize\":" << node.dynamicSize << ",";
+  if (config.sizeClasses.has_value()) {
+    output << "\"allocatedSize\":" << node.allocatedSize << ",";
+  }
   output << "\"exclusiveSize\":" << node.exclusiveSize;
   if (node.paddingSavingsSize.has_value()) {
     output << ",";
@@ -973,25 +1388,13 @@ void TreeBuilder::JSON(NodeID id, std::ofstream& output) {
     output << "\"elementStaticSize\":"
            << node.containerStats->elementStaticSize;
   }
-  if (node.isset.has_value()) {
+  if (const auto& h = node.hashTableStats; h.has_value()) {
     output << ",";
-    output << "\"isset\":" << (*node.isset ? "true" : "false");
-  }
-  if (node.children.has_value()) {
-    output << ",";
-    output << "\"members\":[";
-    auto [childIDStart, childIDEnd] = *node.children;
-    assert(childIDStart < childIDEnd);
-    // Trailing commas are disallowed in JSON, so we pull
-    // out the first iteration of the loop.
-    JSON(childIDStart, output);
-    for (auto childID = childIDStart + 1; childID < childIDEnd; childID++) {
-      output << ",";
-      JSON(childID, output);
-    }
-    output << "]";
+    output << "\"buckets\":" << h->buckets << ",";
+    output << "\"emptyBuckets\":" << h->emptyBuckets << ",";
+    output << "\"longestChain\":" << h->longestChain << ",";
+    output << "\"overflowedBuckets\":" << h->overflowedBuckets;
   }
-  output << "}";
 }
 
 }  // namespace oi::detail
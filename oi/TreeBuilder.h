@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <iosfwd>
 #include <map>
 #include <memory>
 #include <msgpack/sbuffer_decl.hpp>
@@ -24,6 +25,7 @@
 #include <vector>
 
 #include "oi/Features.h"
+#include "oi/SizeClasses.h"
 #include "oi/TypeHierarchy.h"
 
 // The rocksdb includes are extremely heavy and bloat compile times,
@@ -33,6 +35,12 @@ namespace rocksdb {
 class DB;
 }
 
+namespace oi::exporters {
+class ContainerWaste;
+class FlameGraph;
+class TypeHistogram;
+}
+
 // Forward declared, comes from PaddingInfo.h
 struct PaddingInfo;
 
@@ -47,6 +55,14 @@ class TreeBuilder {
     bool logAllStructs;
     bool dumpDataSegment;
     std::optional<std::string> jsonPath;
+    std::optional<std::string> flameGraphPath;
+    std::optional<std::string> typeHistogramPath;
+    std::optional<std::string> containerWastePath;
+    // Reports heap sizes as allocated by this allocator too
+    std::optional<SizeClasses> sizeClasses;
+    bool writeRocksDB;
+    // Also write the secondary indexes read by oirq, see TreeBuilderIndex.h
+    bool writeIndexes;
     bool strict;
   };
 
@@ -57,6 +73,7 @@ class TreeBuilder {
              const std::string&,
              struct drgn_type*,
              const TypeHierarchy&);
+  // Terminates the JSON written while building and closes the file
   void dumpJson();
   void setPaddedStructs(std::map<std::string, PaddingInfo>* paddedStructs);
   bool emptyOutput() const;
@@ -67,6 +84,7 @@ class TreeBuilder {
   struct DBHeader;
   struct Node;
   struct Variable;
+  struct DBIndex;
 
   const TypeHierarchy* th = nullptr;
   const std::vector<uint64_t>* oidData = nullptr;
@@ -75,14 +93,23 @@ class TreeBuilder {
   /*
    * The RocksDB output needs versioning so they are imported correctly in
    * Scuba. Version 1 had no concept of versioning and no header.
-   * We currently are at version 2.1:
+   * We currently are at version 6:
+   *  - Only write the secondary indexes with Config::writeIndexes, key them
+   *    by type name and path IDs, and leave node details to the nodes
+   * Changelog v5:
+   *  - Add Node::hashTableStats
+   * Changelog v4:
+   *  - Add Node::allocatedSize
+   * Changelog v3:
+   *  - Add secondary indexes in extra column families, see TreeBuilderIndex.h
+   * Changelog v2.1:
    *  - Introduce the Error ID at index 1023, but don't output it
    * Changelog v2:
    *  - Introduce the DBHeader at index 0
    *  - Introduce the versioning
    *  - Handle multiple root_ids, to import multiple objects in Scuba
    */
-  static constexpr Version VERSION = 2;
+  static constexpr Version VERSION = 6;
   static constexpr NodeID ROOT_NODE_ID = 0;
   static constexpr NodeID ERROR_NODE_ID = 1023;
   static constexpr NodeID FIRST_NODE_ID = 1024;
@@ -105,16 +132,54 @@ class TreeBuilder {
    */
   std::unique_ptr<msgpack::sbuffer> buffer;
   rocksdb::DB* db = nullptr;
+  std::unique_ptr<DBIndex> dbIndex;
+
+  /*
+   * JSON is written while the tree is built. A node's members are written
+   * before its sizes, which are only known once its children are processed.
+   * Each frame tracks whether its node's "members" array has been opened.
+   */
+  struct JsonFrame {
+    const Node* node;
+    bool membersOpen;
+  };
+  std::vector<JsonFrame> jsonFrames{};
+  std::vector<char> jsonBuffer{};
+  std::unique_ptr<std::ofstream> jsonOutput;
+
+  /*
+   * Folded stacks are written as nodes finish, once their exclusive size is
+   * known. The depth of the node being processed places it in the stack.
+   */
+  std::unique_ptr<std::ofstream> flameGraphOutput;
+  std::unique_ptr<exporters::FlameGraph> flameGraph;
+  size_t flameGraphDepth = 0;
+
+  // Per-type totals, written when the TreeBuilder is destroyed
+  std::unique_ptr<exporters::TypeHistogram> typeHistogram;
+  // Unused container capacity, written when the TreeBuilder is destroyed
+  std::unique_ptr<exporters::ContainerWaste> containerWaste;
+
+  // Type paths of the node being processed and its parents, joined with '/'
+  std::string nodePath;
 
   uint64_t getDrgnTypeSize(struct drgn_type* type);
   uint64_t next();
+  uint64_t allocationSize(uint64_t bytes) const;
+  void readHashTableStats(Node& node);
   bool isContainer(const Variable& variable);
   bool isPrimitive(struct drgn_type* type);
   Node process(NodeID id, Variable variable);
   void processContainer(const Variable& variable, Node& node);
+  void writeNode(const Node& node);
+  void writeIndexStats();
   template <class T>
   std::string_view serialize(const T&);
-  void JSON(NodeID id, std::ofstream& output);
+  void openJson();
+  void jsonBeginNode(const Node& node);
+  void jsonEndNode(const Node& node);
+  void jsonWriteHead(const Node& node);
+  void jsonWriteSizes(const Node& node);
 
   static void setSize(TreeBuilder::Node& node,
                       uint64_t dynamicSize,
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <fnmatch.h>
+
+#include <cstdint>
+#include <msgpack.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Layout of the secondary indexes TreeBuilder writes next to the nodes in its
+ * RocksDB output when asked to, shared with the tools reading them (oirq).
+ *
+ * Nodes stay in the default column family, keyed by their decimal ID. The
+ * other column families are:
+ *
+ *   by_size       ~inclusiveSize, id            -> IndexEntry
+ *   by_type_name  typeNameId, ~size, id         -> IndexEntry
+ *   by_type_path  pathId, ~size, id             -> IndexEntry
+ *   type_stats    typeName                      -> IndexStats
+ *   path_stats    path                          -> IndexStats
+ *
+ * Numbers in keys are big-endian, and sizes are inverted, so iterating a
+ * column family, or a single type name or path within one, yields the
+ * largest nodes first. A top-k query reads k entries, then the k nodes to
+ * print from the default family.
+ *
+ * `path` is the full path from the root, the typePath of each node on the way
+ * joined with '/'. Type names and paths are only written once, to their stats,
+ * which give the ID keying their nodes. The stats are summed over every node
+ * with that key, and are small enough to be scanned in full.
+ */
+namespace oi::detail::index {
+
+inline constexpr std::string_view kBySize = "by_size";
+inline constexpr std::string_view kByTypeName = "by_type_name";
+inline constexpr std::string_view kByTypePath = "by_type_path";
+inline constexpr std::string_view kTypeStats = "type_stats";
+inline constexpr std::string_view kPathStats = "path_stats";
+
+inline constexpr std::string_view kFamilies[] = {
+    kBySize, kByTypeName, kByTypePath, kTypeStats, kPathStats};
+
+inline constexpr char kPathSeparator = '/';
+
+struct IndexEntry {
+  uint64_t id;
+  uint64_t inclusiveSize;
+  uint64_t exclusiveSize;
+
+  MSGPACK_DEFINE_ARRAY(id, inclusiveSize, exclusiveSize)
+};
+
+/*
+ * Sums over every node sharing a type name or path. Nested nodes are
+ * included in their parents' inclusive size, so inclusive sums count a byte
+ * once per level of nesting. Exclusive sums count each byte once.
+ */
+struct IndexStats {
+  // Keys this type name's or path's nodes in by_type_name or by_type_path
+  uint64_t id = 0;
+  uint64_t count = 0;
+  uint64_t inclusiveSize = 0;
+  uint64_t exclusiveSize = 0;
+
+  MSGPACK_DEFINE_ARRAY(id, count, inclusiveSize, exclusiveSize)
+};
+
+inline void appendBigEndian(std::string& key, uint64_t value) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key += static_cast<char>((value >> shift) & 0xff);
+  }
+}
+
+// Appends the part of a node key which orders it by descending size
+inline void appendSizeKey(std::string& key, uint64_t size, uint64_t id) {
+  appendBigEndian(key, ~size);
+  appendBigEndian(key, id);
+}
+
+// The prefix shared by all nodes with the type name or path of this ID
+inline std::string groupPrefix(uint64_t groupId) {
+  std::string prefix;
+  appendBigEndian(prefix, groupId);
+  return prefix;
+}
+
+template <typename T, typename Slice>
+T unpack(const Slice& data) {
+  T value;
+  msgpack::unpack(data.data(), data.size()).get().convert(value);
+  return value;
+}
+
+inline bool matches(const std::optional<std::string>& glob,
+                    const std::string& str) {
+  return !glob.has_value() || fnmatch(glob->c_str(), str.c_str(), 0) == 0;
+}
+
+// The part of `glob` before its first special character
+inline std::string_view literalPrefix(std::string_view glob) {
+  return glob.substr(0, glob.find_first_of("*?[\\"));
+}
+
+/*
+ * Calls `fn(key, stats)` for every entry of a stats family matching `glob`,
+ * given an iterator over the family. Only the keys starting with the glob's
+ * literal prefix are read.
+ */
+template <typename It, typename Fn>
+void forEachStats(It& it, const std::optional<std::string>& glob, Fn&& fn) {
+  std::string_view prefix = glob ? literalPrefix(*glob) : "";
+  decltype(it.key()) prefixSlice{prefix.data(), prefix.size()};
+  for (it.Seek(prefixSlice); it.Valid() && it.key().starts_with(prefixSlice);
+       it.Next()) {
+    std::string key = it.key().ToString();
+    if (matches(glob, key))
+      fn(key, unpack<IndexStats>(it.value()));
+  }
+}
+
+/*
+ * Reads entries from an iterator over a by_* family, largest first, until
+ * `top` of them are accepted or `prefix` no longer matches.
+ */
+template <typename It, typename Filter>
+void readLargest(It& it,
+                 std::string_view prefix,
+                 size_t top,
+                 Filter&& accept,
+                 std::vector<IndexEntry>& out) {
+  decltype(it.key()) prefixSlice{prefix.data(), prefix.size()};
+  size_t found = 0;
+  for (it.Seek(prefixSlice);
+       found < top && it.Valid() && it.key().starts_with(prefixSlice);
+       it.Next()) {
+    auto entry = unpack<IndexEntry>(it.value());
+    if (accept(entry)) {
+      out.push_back(entry);
+      found++;
+    }
+  }
+}
+
+}  // namespace oi::detail::index
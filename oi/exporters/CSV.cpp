@@ -16,6 +16,7 @@
 #include <oi/exporters/CSV.h>
 
 #include <algorithm>
+#include <charconv>
 #include <ranges>
 #include <stdexcept>
 
@@ -26,92 +27,202 @@ void CSV::print(const IntrospectionResult& result) {
   return print(begin, result.cend());
 }
 
-template <typename Seq>
-std::string CSV::escapeField(const Seq& seq) {
-  std::string field;
+void CSV::setDictionary(std::ostream& dict) {
+  dict_ = &dict;
+  printHeader(kDictionaryColumns, dictBuf_);
+}
+
+void CSV::appendEscaped(std::string& buf, std::string_view field) {
+  buf += kQuote;
+  appendEscapedBody(buf, field);
+  buf += kQuote;
+}
+
+void CSV::appendEscaped(std::string& buf,
+                        std::span<const std::string_view> list) {
+  // The delimiter isn't a quote, so escaping each item escapes the whole list
+  buf += kQuote;
   size_t index = 0;
-  for (const auto item : seq) {
+  for (const auto item : list) {
     if (index++ > 0) {
-      field += kListDelimiter;
+      buf += kListDelimiter;
     }
 
-    field += item;
+    appendEscapedBody(buf, item);
   }
+  buf += kQuote;
+}
 
-  return escapeField(field);
+void CSV::appendEscapedBody(std::string& buf, std::string_view field) {
+  // Escape every instance of double quotes.
+  for (auto it = field.find(kQuote); it != std::string_view::npos;
+       it = field.find(kQuote)) {
+    buf.append(field.data(), it);
+    buf += kEscapedQuote;
+    field.remove_prefix(it + 1);
+  }
+  buf += field;
 }
 
-std::string CSV::escapeField(std::string_view field) {
-  return escapeField(std::string(field));
+void CSV::appendUnsigned(std::string& buf, uint64_t value) {
+  char digits[20];
+  auto res = std::to_chars(std::begin(digits), std::end(digits), value);
+  buf.append(digits, res.ptr);
 }
 
-std::string CSV::escapeField(std::string field) {
-  // Escape every instance of double quotes.
-  auto it = field.find(kQuote);
-  while (it != std::string::npos) {
-    field.replace(it, 1, kEscapedQuote);
-    it = field.find(kQuote, it + kEscapedQuote.size());
+size_t CSV::intern(std::string_view value, size_t parentId) {
+  key_.assign(reinterpret_cast<const char*>(&parentId), sizeof(parentId));
+  key_ += value;
+  if (auto it = dictIds_.find(key_); it != dictIds_.end()) {
+    return it->second;
+  }
+
+  size_t id = nextDictId_++;
+  dictIds_.emplace(key_, id);
+
+  appendUnsigned(dictBuf_, id);
+  dictBuf_ += kDelimiter;
+  appendUnsigned(dictBuf_, parentId);
+  dictBuf_ += kDelimiter;
+  appendEscaped(dictBuf_, value);
+  dictBuf_ += kCRLF;
+  return id;
+}
+
+size_t CSV::internPath(std::span<const std::string_view> typePath) {
+  if (typePath.empty()) {
+    return 0;
+  }
+
+  // Rows come in pre-order, so the path leading to this one is usually the
+  // path of the latest row one level up
+  const size_t depth = typePath.size();
+  size_t parentId = 0;
+  if (depth >= 2 && pathIdStack_.size() >= depth - 1) {
+    parentId = pathIdStack_[depth - 2];
+  } else {
+    // Only the first row may start below the root. Keep the IDs of the path
+    // leading to it, for later rows nearer the root.
+    pathIdStack_.clear();
+    for (size_t i = 0; i + 1 < depth; i++) {
+      parentId = intern(typePath[i], parentId);
+      pathIdStack_.push_back(parentId);
+    }
+  }
+
+  size_t id = intern(typePath.back(), parentId);
+  pathIdStack_.resize(depth);
+  pathIdStack_[depth - 1] = id;
+  return id;
+}
+
+size_t CSV::internNames(std::span<const std::string_view> typeNames) {
+  joinedNames_.clear();
+  size_t index = 0;
+  for (const auto name : typeNames) {
+    if (index++ > 0) {
+      joinedNames_ += kListDelimiter;
+    }
+
+    joinedNames_ += name;
   }
 
-  field.insert(0, kQuote);
-  field.append(kQuote);
-  return field;
+  return intern(joinedNames_, 0);
 }
 
 void CSV::print(IntrospectionResult::const_iterator& it,
                 IntrospectionResult::const_iterator end) {
-  printHeader();
+  print<IntrospectionResult::const_iterator>(it, end);
+}
+
+void CSV::beginPrint() {
+  buf_.reserve(kBufferSize);
+  printHeader(kColumns, buf_);
 
   parentIdStack_.resize(1);  // Reset to parentIdStack_ = {0}
-  for (/* it */; it != end; ++it) {
-    out_ << ++id_ << kDelimiter;
-    out_ << escapeField(it->name) << kDelimiter;
-    out_ << escapeField(it->type_path) << kDelimiter;
-    out_ << escapeField(it->type_names) << kDelimiter;
-    out_ << it->static_size << kDelimiter;
-    out_ << it->exclusive_size << kDelimiter;
-
-    if (!it->pointer.has_value()) {
-      out_ << kDelimiter;
-    } else {
-      out_ << it->pointer.value() << kDelimiter;
-    }
+  pathIdStack_.clear();
+}
 
-    if (!it->container_stats.has_value()) {
-      out_ << kDelimiter << kDelimiter;
-    } else {
-      out_ << it->container_stats->length << kDelimiter;
-      out_ << it->container_stats->capacity << kDelimiter;
-    }
+void CSV::printRow(const result::Element& el) {
+  appendUnsigned(buf_, ++id_);
+  buf_ += kDelimiter;
+  appendEscaped(buf_, el.name);
+  buf_ += kDelimiter;
+
+  if (dict_ != nullptr) {
+    appendUnsigned(buf_, internPath(el.type_path));
+    buf_ += kDelimiter;
+    appendUnsigned(buf_, internNames(el.type_names));
+    buf_ += kDelimiter;
+  } else {
+    appendEscaped(buf_, el.type_path);
+    buf_ += kDelimiter;
+    appendEscaped(buf_, el.type_names);
+    buf_ += kDelimiter;
+  }
 
-    if (!it->is_set_stats.has_value()) {
-      out_ << kDelimiter;
-    } else {
-      out_ << it->is_set_stats->is_set << kDelimiter;
-    }
+  appendUnsigned(buf_, el.static_size);
+  buf_ += kDelimiter;
+  appendUnsigned(buf_, el.exclusive_size);
+  buf_ += kDelimiter;
 
-    while (parentIdStack_.size() > it->type_path.size()) {
-      parentIdStack_.pop_back();
-    }
+  if (el.pointer.has_value()) {
+    appendUnsigned(buf_, el.pointer.value());
+  }
+  buf_ += kDelimiter;
+
+  if (!el.container_stats.has_value()) {
+    buf_ += kDelimiter;
+    buf_ += kDelimiter;
+  } else {
+    appendUnsigned(buf_, el.container_stats->length);
+    buf_ += kDelimiter;
+    appendUnsigned(buf_, el.container_stats->capacity);
+    buf_ += kDelimiter;
+  }
+
+  if (el.is_set_stats.has_value()) {
+    buf_ += el.is_set_stats->is_set ? '1' : '0';
+  }
+  buf_ += kDelimiter;
+
+  while (parentIdStack_.size() > el.type_path.size()) {
+    parentIdStack_.pop_back();
+  }
+
+  appendUnsigned(buf_, parentIdStack_.back());
+
+  parentIdStack_.push_back(id_);
 
-    out_ << parentIdStack_.back();
+  buf_ += kCRLF;
 
-    parentIdStack_.push_back(id_);
+  if (buf_.size() >= kBufferSize) {
+    flush();
+  }
+}
 
-    out_ << kCRLF;
+void CSV::flush() {
+  // Write the dictionary first, so entries precede the rows using them
+  if (dict_ != nullptr) {
+    dict_->write(dictBuf_.data(),
+                 static_cast<std::streamsize>(dictBuf_.size()));
+    dictBuf_.clear();
   }
+  out_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+  buf_.clear();
 }
 
-void CSV::printHeader() {
+void CSV::printHeader(std::span<const std::string_view> columns,
+                      std::string& buf) {
   size_t index = 0;
-  for (const auto column : kColumns) {
+  for (const auto column : columns) {
     if (index++ > 0) {
-      out_ << kDelimiter;
+      buf += kDelimiter;
     }
 
-    out_ << column;
+    buf += column;
   }
-  out_ << kCRLF;
+  buf += kCRLF;
 }
 
 }  // namespace oi::exporters
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <oi/exporters/ZstdStream.h>
+#include <zstd.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace oi::exporters {
+
+ZstdStream::ZstdStream(std::ostream& sink, int level)
+    : std::ostream(nullptr), buf_(sink, level) {
+  rdbuf(&buf_);
+}
+
+ZstdStream::~ZstdStream() {
+  close();
+}
+
+void ZstdStream::close() {
+  if (!buf_.finish())
+    setstate(std::ios::badbit);
+}
+
+ZstdStream::Buf::Buf(std::ostream& sink, int level)
+    : sink_(sink),
+      cctx_(ZSTD_createCCtx()),
+      in_(ZSTD_CStreamInSize()),
+      out_(ZSTD_CStreamOutSize()) {
+  if (cctx_ == nullptr)
+    throw std::runtime_error("failed to create zstd context");
+
+  size_t ret = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel, level);
+  if (ZSTD_isError(ret)) {
+    ZSTD_freeCCtx(cctx_);
+    throw std::runtime_error(std::string("invalid zstd level: ") +
+                             ZSTD_getErrorName(ret));
+  }
+
+  setp(in_.data(), in_.data() + in_.size());
+}
+
+ZstdStream::Buf::~Buf() {
+  ZSTD_freeCCtx(cctx_);
+}
+
+ZstdStream::Buf::int_type ZstdStream::Buf::overflow(int_type c) {
+  if (finished_ || !compress(false))
+    return traits_type::eof();
+
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int ZstdStream::Buf::sync() {
+  // Only pass on what's buffered. Flushing the zstd block on every sync
+  // would cost compression ratio for std::endl-heavy writers.
+  if (finished_)
+    return 0;
+  if (!compress(false))
+    return -1;
+  sink_.flush();
+  return sink_ ? 0 : -1;
+}
+
+bool ZstdStream::Buf::finish() {
+  if (finished_)
+    return true;
+  finished_ = true;
+  bool ok = compress(true);
+  sink_.flush();
+  return ok && sink_;
+}
+
+bool ZstdStream::Buf::compress(bool end) {
+  ZSTD_inBuffer input{pbase(), static_cast<size_t>(pptr() - pbase()), 0};
+  auto mode = end ? ZSTD_e_end : ZSTD_e_continue;
+
+  bool done = false;
+  while (!done) {
+    ZSTD_outBuffer output{out_.data(), out_.size(), 0};
+    size_t remaining = ZSTD_compressStream2(cctx_, &output, &input, mode);
+    if (ZSTD_isError(remaining))
+      return false;
+
+    sink_.write(out_.data(), static_cast<std::streamsize>(output.pos));
+    if (!sink_)
+      return false;
+
+    done = end ? remaining == 0 : input.pos == input.size;
+  }
+
+  setp(in_.data(), in_.data() + in_.size());
+  return true;
+}
+
+}  // namespace oi::exporters
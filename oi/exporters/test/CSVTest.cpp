@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <zstd.h>
+
+#include <oi/exporters/CSV.h>
+#include <oi/exporters/ZstdStream.h>
+
+#include <sstream>
+
+#include "ElementBuilder.h"
+
+using namespace oi;
+using oi::exporters::CSV;
+using oi::exporters::ZstdStream;
+using oi::exporters::test::ElementBuilder;
+
+namespace {
+
+constexpr std::string_view kHeader =
+    "id,name,typePath,typeNames,staticSize,exclusiveSize,pointer,length,"
+    "capacity,is_set,parent_id\r\n";
+constexpr std::string_view kDictionaryHeader = "id,parent_id,value\r\n";
+
+// A struct "a" with members "b" and "c", then a root "d" of the same type
+ElementBuilder tree() {
+  ElementBuilder tree;
+  tree.add({"a"}, 8, {.typeName = "Foo"})
+      .add({"a", "b"}, 4, {.typeName = "int"})
+      .add({"a", "c"},
+           24,
+           {.typeName = "std::vector<int>",
+            .stats = {{.capacity = 4, .length = 1}}})
+      .add({"d"}, 8, {.typeName = "Foo"});
+  return tree;
+}
+
+template <typename It>
+void print(CSV& csv, It it, const It& end) {
+  csv.print(it, end);
+}
+
+}  // namespace
+
+TEST(CSVTest, Rows) {
+  auto t = tree();
+  std::stringstream out;
+  CSV csv{out};
+  print(csv, t.elements.begin(), t.elements.end());
+
+  EXPECT_EQ(out.str(),
+            std::string{kHeader} +
+                "1,\"a\",\"a\",\"Foo\",8,8,,,,,0\r\n"
+                "2,\"b\",\"a;b\",\"int\",4,4,,,,,1\r\n"
+                "3,\"c\",\"a;c\",\"std::vector<int>\",24,24,,1,4,,1\r\n"
+                "4,\"d\",\"d\",\"Foo\",8,8,,,,,0\r\n");
+}
+
+TEST(CSVTest, EscapesQuotes) {
+  ElementBuilder t;
+  t.add({"say \"hi\""}, 1, {.typeName = "\"T\""});
+  std::stringstream out;
+  CSV csv{out};
+  print(csv, t.elements.begin(), t.elements.end());
+
+  EXPECT_EQ(out.str(),
+            std::string{kHeader} +
+                "1,\"say \\\"hi\\\"\",\"say \\\"hi\\\"\",\"\\\"T\\\"\","
+                "1,1,,,,,0\r\n");
+}
+
+TEST(CSVTest, Dictionary) {
+  auto t = tree();
+  std::stringstream out;
+  std::stringstream dict;
+  CSV csv{out};
+  csv.setDictionary(dict);
+  print(csv, t.elements.begin(), t.elements.end());
+
+  // "c" is found under "a" by depth, without interning "a" again
+  EXPECT_EQ(dict.str(),
+            std::string{kDictionaryHeader} +
+                "1,0,\"a\"\r\n"
+                "2,0,\"Foo\"\r\n"
+                "3,1,\"b\"\r\n"
+                "4,0,\"int\"\r\n"
+                "5,1,\"c\"\r\n"
+                "6,0,\"std::vector<int>\"\r\n"
+                "7,0,\"d\"\r\n");
+  EXPECT_EQ(out.str(),
+            std::string{kHeader} +
+                "1,\"a\",1,2,8,8,,,,,0\r\n"
+                "2,\"b\",3,4,4,4,,,,,1\r\n"
+                "3,\"c\",5,6,24,24,,1,4,,1\r\n"
+                "4,\"d\",7,2,8,8,,,,,0\r\n");
+}
+
+TEST(CSVTest, DictionaryKeepsIdsAcrossPrints) {
+  auto t = tree();
+  std::stringstream out;
+  std::stringstream dict;
+  CSV csv{out};
+  csv.setDictionary(dict);
+  print(csv, t.elements.begin(), t.elements.end());
+  dict.str("");
+  out.str("");
+
+  // Starting below the root, the path to the first row is interned from its
+  // prefix rather than from the previous rows
+  ElementBuilder sub;
+  sub.add({"a", "c"}, 24, {.typeName = "std::vector<int>"})
+      .add({"a", "c", "[]"}, 4, {.typeName = "int"});
+  print(csv, sub.elements.begin(), sub.elements.end());
+
+  EXPECT_EQ(dict.str(), "8,5,\"[]\"\r\n");
+  EXPECT_EQ(out.str(),
+            std::string{kHeader} +
+                "5,\"c\",5,6,24,24,,,,,0\r\n"
+                "6,\"[]\",8,4,4,4,,,,,5\r\n");
+}
+
+TEST(CSVTest, DictionaryFromNonRoot) {
+  ElementBuilder t;
+  t.add({"a", "b"}, 4, {.typeName = "int"})
+      .add({"a", "b", "c"}, 4, {.typeName = "int"})
+      .add({"a", "d"}, 4, {.typeName = "int"});
+  std::stringstream out;
+  std::stringstream dict;
+  CSV csv{out};
+  csv.setDictionary(dict);
+  print(csv, t.elements.begin(), t.elements.end());
+
+  // "d" has no row one level up, but shares the prefix interned for "b"
+  EXPECT_EQ(dict.str(),
+            std::string{kDictionaryHeader} +
+                "1,0,\"a\"\r\n"
+                "2,1,\"b\"\r\n"
+                "3,0,\"int\"\r\n"
+                "4,2,\"c\"\r\n"
+                "5,1,\"d\"\r\n");
+}
+
+TEST(CSVTest, DictionaryEscapesValues) {
+  std::vector<std::string_view> path{"say \"hi\""};
+  std::vector<std::string_view> names{"A", "\"B\""};
+  std::vector<result::Element> elements{result::Element{
+      .name = path.back(),
+      .type_path = path,
+      .type_names = names,
+      .static_size = 1,
+      .exclusive_size = 1,
+      .is_primitive = false,
+  }};
+  std::stringstream out;
+  std::stringstream dict;
+  CSV csv{out};
+  csv.setDictionary(dict);
+  print(csv, elements.begin(), elements.end());
+
+  EXPECT_EQ(dict.str(),
+            std::string{kDictionaryHeader} +
+                "1,0,\"say \\\"hi\\\"\"\r\n"
+                "2,0,\"A;\\\"B\\\"\"\r\n");
+}
+
+TEST(CSVTest, DictionaryBeforeRows) {
+  // With one stream for both, each flush writes the dictionary first
+  auto t = tree();
+  std::stringstream out;
+  CSV csv{out};
+  csv.setDictionary(out);
+  print(csv, t.elements.begin(), t.elements.begin() + 1);
+  print(csv, t.elements.begin() + 3, t.elements.end());
+
+  EXPECT_EQ(out.str(),
+            std::string{kDictionaryHeader} +
+                "1,0,\"a\"\r\n"
+                "2,0,\"Foo\"\r\n" + std::string{kHeader} +
+                "1,\"a\",1,2,8,8,,,,,0\r\n"
+                "3,0,\"d\"\r\n" + std::string{kHeader} +
+                "2,\"d\",3,2,8,8,,,,,0\r\n");
+}
+
+TEST(CSVTest, ZstdRoundTrip) {
+  auto t = tree();
+  std::stringstream plain;
+  {
+    CSV csv{plain};
+    print(csv, t.elements.begin(), t.elements.end());
+  }
+
+  std::stringstream compressed;
+  {
+    ZstdStream zstd{compressed};
+    CSV csv{zstd};
+    print(csv, t.elements.begin(), t.elements.end());
+    zstd.close();
+    EXPECT_TRUE(zstd.good());
+
+    // Closing again, or destroying the stream, must not add another frame
+    auto frame = compressed.str();
+    zstd.close();
+    EXPECT_TRUE(zstd.good());
+    EXPECT_EQ(compressed.str(), frame);
+  }
+
+  auto frame = compressed.str();
+  EXPECT_EQ(ZSTD_findFrameCompressedSize(frame.data(), frame.size()),
+            frame.size());
+
+  std::string decompressed(plain.str().size() + 1, '\0');
+  size_t size = ZSTD_decompress(
+      decompressed.data(), decompressed.size(), frame.data(), frame.size());
+  ASSERT_FALSE(ZSTD_isError(size)) << ZSTD_getErrorName(size);
+  decompressed.resize(size);
+  EXPECT_EQ(decompressed, plain.str());
+}
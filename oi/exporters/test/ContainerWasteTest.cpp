@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <oi/exporters/ContainerWaste.h>
+
+#include <sstream>
+
+#include "ElementBuilder.h"
+
+using namespace oi;
+using oi::exporters::ContainerWaste;
+using oi::exporters::test::ElementBuilder;
+
+TEST(ContainerWasteTest, Elements) {
+  // A vector of 2 ints with room for 8, and an empty one with room for 4.
+  // Unused capacity is counted in the vector's exclusive size, as in oil.
+  ElementBuilder tree;
+  tree.add({"a"}, 0, {.typeName = "Foo", .staticSize = 48})
+      .add({"a", "v"},
+           48,
+           {.typeName = "std::vector<int>",
+            .staticSize = 24,
+            .stats = {{.capacity = 8, .length = 2}}})
+      .add({"a", "v", "[]"}, 4, {.typeName = "int"})
+      .add({"a", "v", "[]"}, 4, {.typeName = "int"})
+      .add({"a", "w"},
+           40,
+           {.typeName = "std::vector<int>",
+            .staticSize = 24,
+            .stats = {{.capacity = 4, .length = 0}}});
+
+  ContainerWaste waste;
+  auto it = tree.elements.begin();
+  waste.add(it, tree.elements.end());
+
+  const auto* v = waste.find("a/v");
+  ASSERT_NE(v, nullptr);
+  EXPECT_EQ(v->instances, 1);
+  EXPECT_EQ(v->unusedBytes, 24);
+  EXPECT_EQ(v->typeName, "std::vector<int>");
+
+  const auto* w = waste.find("a/w");
+  ASSERT_NE(w, nullptr);
+  EXPECT_EQ(w->unusedBytes, 16);
+
+  EXPECT_EQ(waste.find("a"), nullptr);
+  EXPECT_EQ(waste.totalWasted(), 40);
+}
+
+TEST(ContainerWasteTest, HashTables) {
+  ContainerWaste waste;
+  waste.add("m",
+            "std::unordered_map<int, int>",
+            {.length = 3, .capacity = 3, .elementSize = 24, .bucketCount = 13});
+  waste.add("m",
+            "std::unordered_map<int, int>",
+            {.length = 1, .capacity = 1, .elementSize = 24, .bucketCount = 3});
+
+  const auto* m = waste.find("m");
+  ASSERT_NE(m, nullptr);
+  EXPECT_EQ(m->instances, 2);
+  EXPECT_EQ(m->unusedBytes, 0);
+  EXPECT_EQ(m->bucketBytes, 16 * sizeof(void*));
+  EXPECT_EQ(m->bucketCount, 16);
+}
+
+TEST(ContainerWasteTest, TopInstances) {
+  ContainerWaste waste;
+  waste.setTopInstances(2);
+  for (size_t capacity : {4, 64, 16, 8}) {
+    waste.add("v",
+              "std::vector<char>",
+              {.length = 0, .capacity = capacity, .elementSize = 1});
+  }
+  waste.add("s", "std::string", {.length = 1, .capacity = 1, .elementSize = 1});
+
+  auto top = waste.topInstances();
+  ASSERT_EQ(top.size(), 2);
+  EXPECT_EQ(top[0].container.capacity, 64);
+  EXPECT_EQ(top[1].container.capacity, 16);
+
+  std::stringstream out;
+  waste.print(out);
+  EXPECT_EQ(out.str(),
+            "wasted\tunused\tbuckets\tinstances\tlength\tcapacity\tload\tpath"
+            "\ttype\n"
+            "92\t92\t0\t4\t0\t92\t0.00\tv\tstd::vector<char>\n"
+            "\nwasted\tunused\tbuckets\tlength\tcapacity\telement_size\tload"
+            "\tpath\ttype\n"
+            "64\t64\t0\t0\t64\t1\t0.00\tv\tstd::vector<char>\n"
+            "16\t16\t0\t0\t16\t1\t0.00\tv\tstd::vector<char>\n");
+}
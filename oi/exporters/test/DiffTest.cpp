@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <oi/exporters/Diff.h>
+
+#include <sstream>
+
+#include "ElementBuilder.h"
+
+using namespace oi;
+using oi::exporters::Diff;
+
+namespace {
+
+using Builder = oi::exporters::test::ElementBuilder;
+
+std::string diff(const Builder& before,
+                 const Builder& after,
+                 size_t minDelta = 0) {
+  std::stringstream out;
+  Diff diff{out};
+  diff.setMinDelta(minDelta);
+  auto oldIt = before.elements.begin();
+  auto newIt = after.elements.begin();
+  diff.print(oldIt, before.elements.end(), newIt, after.elements.end());
+  return out.str();
+}
+
+}  // namespace
+
+TEST(DiffTest, Unchanged) {
+  Builder tree;
+  tree.add({"a"}, 8).add({"a", "b"}, 4);
+  EXPECT_EQ(diff(tree, tree), "");
+}
+
+TEST(DiffTest, GrownVector) {
+  Builder before;
+  before.add({"v"}, 24).add({"v", "[]"}, 4).add({"v", "[]"}, 4);
+  Builder after;
+  after.add({"v"}, 24).add({"v", "[]"}, 4).add({"v", "[]"}, 8).add(
+      {"v", "[]"}, 4);
+
+  EXPECT_EQ(diff(before, after),
+            "grown\t+4\t4\t8\tv/[1]\tT\n"
+            "added\t+4\t0\t4\tv/[2]\tT\n"
+            "grown\t+8\t32\t40\tv\tT\n");
+}
+
+TEST(DiffTest, OrderedKeys) {
+  Builder before;
+  before.add({"m"}, 48)
+      .add({"m", "[1]"}, 16, {.key = 1})
+      .add({"m", "[1]", "value"}, 4)
+      .add({"m", "[3]"}, 16, {.key = 3});
+  Builder after;
+  after.add({"m"}, 48)
+      .add({"m", "[2]"}, 16, {.key = 2})
+      .add({"m", "[3]"}, 16, {.key = 3});
+
+  EXPECT_EQ(diff(before, after),
+            "removed\t-20\t20\t0\tm/[1]\tT\n"
+            "added\t+16\t0\t16\tm/[2]\tT\n"
+            "shrunk\t-4\t84\t80\tm\tT\n");
+}
+
+TEST(DiffTest, MinDelta) {
+  Builder before;
+  before.add({"a"}, 8).add({"a", "x"}, 4).add({"a", "y"}, 100);
+  Builder after;
+  after.add({"a"}, 8).add({"a", "x"}, 5).add({"a", "y"}, 200);
+
+  EXPECT_EQ(diff(before, after, 10),
+            "grown\t+100\t100\t200\ta/y\tT\n"
+            "grown\t+101\t112\t213\ta\tT\n");
+}
+
+TEST(DiffTest, ChangedMembers) {
+  Builder before;
+  before.add({"s"}, 8).add({"s", "old"}, 4).add({"s", "same"}, 4);
+  Builder after;
+  after.add({"s"}, 8).add({"s", "new"}, 4).add({"s", "same"}, 4);
+
+  EXPECT_EQ(diff(before, after),
+            "removed\t-4\t4\t0\ts/old\tT\n"
+            "added\t+4\t0\t4\ts/new\tT\n");
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <oi/result/Element.h>
+
+#include <deque>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace oi::exporters::test {
+
+struct ElementOptions {
+  std::string_view typeName = "T";
+  // Defaults to the exclusive size
+  std::optional<size_t> staticSize;
+  std::optional<result::Element::ContainerStats> stats;
+  // Stored as the element's scalar data, like a captured key
+  std::optional<uint64_t> key;
+};
+
+// Builds a list of elements in pre-order for the exporter tests, keeping the
+// paths and type names they point into alive
+struct ElementBuilder {
+  std::deque<std::vector<std::string_view>> paths;
+  std::deque<std::vector<std::string_view>> names;
+  std::vector<result::Element> elements;
+
+  ElementBuilder& add(std::vector<std::string_view> path,
+                      size_t exclusiveSize,
+                      ElementOptions opts = {}) {
+    const auto& p = paths.emplace_back(std::move(path));
+    const auto& n = names.emplace_back(std::vector{opts.typeName});
+    auto& el = elements.emplace_back(result::Element{
+        .name = p.back(),
+        .type_path = p,
+        .type_names = n,
+        .static_size = opts.staticSize.value_or(exclusiveSize),
+        .exclusive_size = exclusiveSize,
+        .container_stats = opts.stats,
+        .is_primitive = false,
+    });
+    if (opts.key.has_value())
+      el.data = result::Element::Scalar{*opts.key};
+    return *this;
+  }
+};
+
+}  // namespace oi::exporters::test
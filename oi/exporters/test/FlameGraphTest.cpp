@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <oi/exporters/FlameGraph.h>
+
+#include <sstream>
+
+#include "ElementBuilder.h"
+
+using namespace oi;
+using oi::exporters::FlameGraph;
+
+namespace {
+
+using Builder = oi::exporters::test::ElementBuilder;
+
+std::string print(const Builder& tree,
+                  bool foldKeys = true,
+                  size_t maxStacks = 1024) {
+  std::stringstream out;
+  FlameGraph flameGraph{out};
+  flameGraph.setFoldKeys(foldKeys);
+  flameGraph.setMaxStacks(maxStacks);
+  auto it = tree.elements.begin();
+  flameGraph.print(it, tree.elements.end());
+  return out.str();
+}
+
+// A vector of two structs, each with two members
+Builder vectorOfStructs() {
+  Builder tree;
+  tree.add({"v"}, 24)
+      .add({"v", "[]"}, 0)
+      .add({"v", "[]", "a"}, 4)
+      .add({"v", "[]", "b"}, 8)
+      .add({"v", "[]"}, 0)
+      .add({"v", "[]", "a"}, 4)
+      .add({"v", "[]", "b"}, 8);
+  return tree;
+}
+
+}  // namespace
+
+TEST(FlameGraphTest, FoldsContainerElements) {
+  EXPECT_EQ(print(vectorOfStructs()),
+            "v 24\n"
+            "v;[];a 8\n"
+            "v;[];b 16\n");
+}
+
+TEST(FlameGraphTest, FoldsKeys) {
+  Builder tree;
+  tree.add({"m"}, 48)
+      .add({"m", "[abc]"}, 40)
+      .add({"m", "[def]"}, 40)
+      .add({"s;t"}, 1);
+
+  EXPECT_EQ(print(tree), "m 48\nm;[] 80\ns:t 1\n");
+  EXPECT_EQ(print(tree, false), "m 48\nm;[abc] 40\nm;[def] 40\ns:t 1\n");
+}
+
+TEST(FlameGraphTest, BoundedTable) {
+  // A full table is written out early, so paths may repeat
+  EXPECT_EQ(print(vectorOfStructs(), true, 2),
+            "v 24\n"
+            "v;[];a 4\n"
+            "v;[];b 8\n"
+            "v;[];a 4\n"
+            "v;[];b 8\n");
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <oi/exporters/Json.h>
+
+#include <sstream>
+
+using namespace oi;
+using oi::exporters::Json;
+using oi::exporters::detail::findJsonEscape;
+
+namespace {
+
+// A tree with a struct "a" containing an int member "b" and a string "c"
+struct Tree {
+  std::vector<std::string_view> pathA{"a"};
+  std::vector<std::string_view> pathB{"a", "b"};
+  std::vector<std::string_view> pathC{"a", "c"};
+  std::vector<std::string_view> namesA{"Foo"};
+  std::vector<std::string_view> namesB{"int32_t"};
+  std::vector<std::string_view> namesC{"std::string"};
+
+  std::vector<result::Element> elements() const {
+    return {
+        result::Element{
+            .name = "a",
+            .type_path = pathA,
+            .type_names = namesA,
+            .static_size = 40,
+            .exclusive_size = 4,
+            .is_primitive = false,
+        },
+        result::Element{
+            .name = "b",
+            .type_path = pathB,
+            .type_names = namesB,
+            .static_size = 4,
+            .exclusive_size = 4,
+            .data = result::Element::Scalar{123},
+            .is_primitive = true,
+        },
+        result::Element{
+            .name = "c",
+            .type_path = pathC,
+            .type_names = namesC,
+            .static_size = 32,
+            .exclusive_size = 32,
+            .data = std::string{"say \"hi\"\n"},
+            .container_stats = result::Element::ContainerStats{15, 9},
+            .is_primitive = false,
+        },
+    };
+  }
+};
+
+std::string print(const std::vector<result::Element>& elements,
+                  bool pathTable) {
+  std::stringstream out;
+  Json json{out};
+  json.setPathTable(pathTable);
+  auto it = elements.begin();
+  json.print(it, elements.end());
+  return out.str();
+}
+
+}  // namespace
+
+TEST(JsonExporterTest, FindEscape) {
+  EXPECT_EQ(findJsonEscape(""), 0);
+  EXPECT_EQ(findJsonEscape("plain"), 5);
+  EXPECT_EQ(findJsonEscape("a\"b"), 1);
+  EXPECT_EQ(findJsonEscape("ab\\"), 2);
+  EXPECT_EQ(findJsonEscape("\x01"), 0);
+  EXPECT_EQ(findJsonEscape("caf\xc3\xa9"), 5);  // UTF-8 isn't escaped
+
+  // Past the first block, and in the scalar tail
+  std::string longStr(40, 'x');
+  EXPECT_EQ(findJsonEscape(longStr), 40);
+  for (size_t i = 0; i < longStr.size(); i++) {
+    std::string s = longStr;
+    s[i] = '\t';
+    EXPECT_EQ(findJsonEscape(s), i) << "at " << i;
+  }
+}
+
+TEST(JsonExporterTest, Compact) {
+  Tree tree;
+  EXPECT_EQ(
+      print(tree.elements(), false),
+      R"([{"name":"a","typePath":["a"],"typeNames":["Foo"],"staticSize":40,)"
+      R"("exclusiveSize":4,"is_primitive":false,"members":[)"
+      R"({"name":"b","typePath":["a","b"],"typeNames":["int32_t"],)"
+      R"("staticSize":4,"exclusiveSize":4,"data":123,"is_primitive":true,)"
+      R"("members":[]},)"
+      R"({"name":"c","typePath":["a","c"],"typeNames":["std::string"],)"
+      R"("staticSize":32,"exclusiveSize":32,"data":"say \"hi\"\n",)"
+      R"("length":9,"capacity":15,"is_primitive":false,"members":[]}]}])");
+}
+
+TEST(JsonExporterTest, PathTable) {
+  Tree tree;
+  EXPECT_EQ(
+      print(tree.elements(), true),
+      R"({"tree":[{"name":"a","typePath":0,"typeNames":["Foo"],)"
+      R"("staticSize":40,"exclusiveSize":4,"is_primitive":false,"members":[)"
+      R"({"name":"b","typePath":1,"typeNames":["int32_t"],)"
+      R"("staticSize":4,"exclusiveSize":4,"data":123,"is_primitive":true,)"
+      R"("members":[]},)"
+      R"({"name":"c","typePath":2,"typeNames":["std::string"],)"
+      R"("staticSize":32,"exclusiveSize":32,"data":"say \"hi\"\n",)"
+      R"("length":9,"capacity":15,"is_primitive":false,"members":[]}]}],)"
+      R"("pathTable":[[-1,"a"],[0,"b"],[0,"c"]]})");
+}
+
+TEST(JsonExporterTest, PathTableReusesEntries) {
+  std::vector<std::string_view> pathA{"a"};
+  std::vector<std::string_view> pathElem{"a", "[]"};
+  std::vector<std::string_view> names{"int"};
+  std::vector<result::Element> elements{
+      {.name = "a", .type_path = pathA, .type_names = names},
+      {.name = "", .type_path = pathElem, .type_names = names},
+      {.name = "", .type_path = pathElem, .type_names = names},
+  };
+
+  auto out = print(elements, true);
+  EXPECT_NE(out.find(R"("pathTable":[[-1,"a"],[0,"[]"]])"), std::string::npos)
+      << out;
+}
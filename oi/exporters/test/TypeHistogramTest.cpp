@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <oi/exporters/TypeHistogram.h>
+
+#include <sstream>
+
+#include "ElementBuilder.h"
+
+using namespace oi;
+using oi::exporters::TypeHistogram;
+
+namespace {
+
+using Builder = oi::exporters::test::ElementBuilder;
+
+// Two structs, each holding a vector of ints
+Builder structsWithVectors() {
+  Builder tree;
+  tree.add({"a"}, 8, {.typeName = "Foo"})
+      .add({"a", "v"},
+           24,
+           {.typeName = "std::vector<int>",
+            .stats = {{.capacity = 4, .length = 3}}})
+      .add({"a", "v", "[]"}, 4, {.typeName = "int"})
+      .add({"a", "v", "[]"}, 4, {.typeName = "int"})
+      .add({"a", "v", "[]"}, 4, {.typeName = "int"})
+      .add({"b"}, 8, {.typeName = "Foo"})
+      .add({"b", "v"},
+           24,
+           {.typeName = "std::vector<int>",
+            .stats = {{.capacity = 0, .length = 0}}});
+  return tree;
+}
+
+}  // namespace
+
+TEST(TypeHistogramTest, Totals) {
+  auto tree = structsWithVectors();
+  TypeHistogram histogram;
+  auto it = tree.elements.begin();
+  histogram.add(it, tree.elements.end());
+
+  const auto* foo = histogram.find("Foo");
+  ASSERT_NE(foo, nullptr);
+  EXPECT_EQ(foo->count, 2);
+  EXPECT_EQ(foo->exclusiveSize, 16);
+  EXPECT_EQ(foo->inclusiveSize, 44 + 32);
+  EXPECT_EQ(foo->sizes[6], 2);  // 44 and 32 in [32, 64)
+
+  const auto* vec = histogram.find("std::vector<int>");
+  ASSERT_NE(vec, nullptr);
+  EXPECT_EQ(vec->count, 2);
+  EXPECT_EQ(vec->inclusiveSize, 36 + 24);
+  EXPECT_EQ(vec->containers, 2);
+  EXPECT_EQ(vec->length, 3);
+  EXPECT_EQ(vec->capacity, 4);
+  EXPECT_EQ(vec->lengths[0], 1);
+  EXPECT_EQ(vec->lengths[2], 1);  // 3 in [2, 4)
+  EXPECT_EQ(vec->capacities[3], 1);  // 4 in [4, 8)
+
+  const auto* i = histogram.find("int");
+  ASSERT_NE(i, nullptr);
+  EXPECT_EQ(i->count, 3);
+  EXPECT_EQ(i->inclusiveSize, 12);
+  EXPECT_EQ(histogram.find("missing"), nullptr);
+}
+
+TEST(TypeHistogramTest, Accumulates) {
+  auto tree = structsWithVectors();
+  TypeHistogram histogram;
+  for (int i = 0; i < 2; i++) {
+    auto it = tree.elements.begin();
+    histogram.add(it, tree.elements.end());
+  }
+  histogram.add("Foo", 100, 100);
+
+  EXPECT_EQ(histogram.find("Foo")->count, 5);
+  EXPECT_EQ(histogram.find("Foo")->inclusiveSize, 2 * 76 + 100);
+
+  histogram.clear();
+  EXPECT_EQ(histogram.find("Foo"), nullptr);
+}
+
+TEST(TypeHistogramTest, Print) {
+  auto tree = structsWithVectors();
+  TypeHistogram histogram;
+  auto it = tree.elements.begin();
+  histogram.add(it, tree.elements.end());
+
+  std::stringstream out;
+  histogram.print(out, TypeHistogram::SortBy::Count, 2);
+  EXPECT_EQ(out.str(),
+            "count\tinclusive\texclusive\tsizes\tlengths\tcapacities\ttype\n"
+            "3\t12\t12\t4:3\t-\t-\tint\n"
+            "2\t76\t16\t32:2\t-\t-\tFoo\n");
+}
@@ -15,8 +15,11 @@
  */
 #include "AddChildren.h"
 
+#include <glog/logging.h>
+
 #include <cassert>
 
+#include "ClassHierarchyIndex.h"
 #include "DrgnParser.h"
 #include "TypeGraph.h"
 #include "oi/DrgnUtils.h"
@@ -31,10 +34,14 @@ using ref = std::reference_wrapper<T>;
 
 namespace oi::detail::type_graph {
 
-Pass AddChildren::createPass(DrgnParser& drgnParser, SymbolService& symbols) {
-  auto fn = [&drgnParser, &symbols](TypeGraph& typeGraph, NodeTracker&) {
-    AddChildren pass(typeGraph, drgnParser);
-    pass.enumerateChildClasses(symbols);
+Pass AddChildren::createPass(DrgnParser& drgnParser,
+                             SymbolService& symbols,
+                             const ClassHierarchyIndex* index) {
+  auto fn = [&drgnParser, &symbols, index](TypeGraph& typeGraph,
+                                           NodeTracker&) {
+    AddChildren pass(typeGraph, drgnParser, symbols, index);
+    if (!index)
+      pass.enumerateChildClasses();
     for (auto& type : typeGraph.rootTypes()) {
       pass.accept(type);
     }
@@ -52,10 +59,10 @@ void AddChildren::accept(Type& type) {
 }
 
 void AddChildren::visit(Class& c) {
-  for (auto& param : c.templateParams) {
+  for (auto& param : c.templateParams()) {
     accept(param.type());
   }
-  for (auto& member : c.members) {
+  for (auto& member : c.members()) {
     accept(member.type());
   }
 
@@ -63,13 +70,12 @@ void AddChildren::visit(Class& c) {
     return;
   }
 
-  auto it = childClasses_.find(c.name());
-  if (it == childClasses_.end()) {
+  const auto* drgnChildren = findChildren(c.name());
+  if (!drgnChildren) {
     return;
   }
 
-  const auto& drgnChildren = it->second;
-  for (drgn_type* drgnChild : drgnChildren) {
+  for (drgn_type* drgnChild : *drgnChildren) {
     Type& childType = drgnParser_.parse(drgnChild);
     auto* childClass =
         dynamic_cast<Class*>(&childType);  // TODO don't use dynamic_cast
@@ -83,7 +89,7 @@ void AddChildren::visit(Class& c) {
      * name in different namespaces would have been grouped together.
      */
     bool isActuallyChild = false;
-    for (const auto& parent : childClass->parents) {
+    for (const auto& parent : childClass->parents()) {
       // TODO support parent containers?
       auto* parentClass = dynamic_cast<Class*>(&stripTypedefs(parent.type()));
       if (!parentClass)
@@ -105,6 +111,54 @@ void AddChildren::visit(Class& c) {
   }
 }
 
+/*
+ * Returns the candidate children of classes named `name`, looking them up from
+ * the index when we have one.
+ */
+const std::vector<drgn_type*>* AddChildren::findChildren(
+    const std::string& name) {
+  if (auto it = childClasses_.find(name); it != childClasses_.end())
+    return &it->second;
+
+  if (!index_ || enumeratedChildClasses_)
+    return nullptr;
+
+  auto indexIt = index_->children.find(name);
+  if (indexIt == index_->children.end())
+    return nullptr;
+
+  std::vector<drgn_type*> children;
+  if (!lookupIndexedChildren(indexIt->second, children)) {
+    // drgn can't find every type by name (e.g. some template
+    // specialisations), so fall back to the exhaustive search.
+    LOG(WARNING) << "Failed to look up indexed children of " << name
+                 << ", iterating over all types instead";
+    childClasses_.clear();
+    enumerateChildClasses();
+    return findChildren(name);
+  }
+
+  auto [it, _] = childClasses_.emplace(name, std::move(children));
+  return &it->second;
+}
+
+bool AddChildren::lookupIndexedChildren(const std::vector<std::string>& names,
+                                        std::vector<drgn_type*>& children) {
+  auto* prog = symbols_.getDrgnProgram();
+  children.reserve(names.size());
+  for (const auto& childName : names) {
+    drgn_qualified_type t{};
+    if (auto* err =
+            drgn_program_find_type(prog, childName.c_str(), nullptr, &t)) {
+      VLOG(1) << "Failed to find type '" << childName << "': " << err->message;
+      drgn_error_destroy(err);
+      return false;
+    }
+    children.push_back(t.type);
+  }
+  return true;
+}
+
 void AddChildren::recordChildren(drgn_type* type) {
   drgn_type_template_parameter* parents = drgn_type_parents(type);
 
@@ -153,7 +207,9 @@ void AddChildren::recordChildren(drgn_type* type) {
  * drgn only gives us the mapping Class -> Parents, so we must iterate over all
  * types in the program to build the reverse mapping.
  */
-void AddChildren::enumerateChildClasses(SymbolService& symbols) {
+void AddChildren::enumerateChildClasses() {
+  enumeratedChildClasses_ = true;
+
   if ((setenv("DRGN_ENABLE_TYPE_ITERATOR", "1", 1)) < 0) {
     //    LOG(ERROR)
     //        << "Could not set DRGN_ENABLE_TYPE_ITERATOR environment variable";
@@ -161,7 +217,7 @@ void AddChildren::enumerateChildClasses(SymbolService& symbols) {
   }
 
   drgn_type_iterator* typesIterator;
-  auto* prog = symbols.getDrgnProgram();
+  auto* prog = symbols_.getDrgnProgram();
   drgn_error* err = drgn_type_iterator_create(prog, &typesIterator);
   if (err) {
     //    LOG(ERROR) << "Error initialising drgn_type_iterator: " << err->code
@@ -16,6 +16,8 @@
 #pragma once
 
 #include <functional>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -30,6 +32,7 @@ class SymbolService;
 
 namespace oi::detail::type_graph {
 
+struct ClassHierarchyIndex;
 class DrgnParser;
 class TypeGraph;
 
@@ -44,14 +47,24 @@ class TypeGraph;
  *
  * This is expensive and only useful for types which make use of dynamic
  * inheritance hierarchies (e.g. polymorphism), so is not done as part of the
- * standard DrgnParser stage.
+ * standard DrgnParser stage. When a prebuilt ClassHierarchyIndex is available
+ * only the children of the classes we visit are looked up, and we only fall
+ * back to iterating over every type if one of them can't be found.
  */
 class AddChildren final : public RecursiveVisitor {
  public:
-  static Pass createPass(DrgnParser& drgnParser, SymbolService& symbols);
+  static Pass createPass(DrgnParser& drgnParser,
+                         SymbolService& symbols,
+                         const ClassHierarchyIndex* index = nullptr);
 
-  AddChildren(TypeGraph& typeGraph, DrgnParser& drgnParser)
-      : typeGraph_(typeGraph), drgnParser_(drgnParser) {
+  AddChildren(TypeGraph& typeGraph,
+              DrgnParser& drgnParser,
+              SymbolService& symbols,
+              const ClassHierarchyIndex* index)
+      : typeGraph_(typeGraph),
+        drgnParser_(drgnParser),
+        symbols_(symbols),
+        index_(index) {
   }
 
   using RecursiveVisitor::accept;
@@ -60,15 +73,21 @@ class AddChildren final : public RecursiveVisitor {
   void visit(Class& c) override;
 
  private:
-  void enumerateChildClasses(SymbolService& symbols);
+  void enumerateChildClasses();
   void enumerateClassChildren(
       struct drgn_type* type,
       std::vector<std::reference_wrapper<Class>>& children);
   void recordChildren(drgn_type* type);
+  const std::vector<drgn_type*>* findChildren(const std::string& name);
+  bool lookupIndexedChildren(const std::vector<std::string>& names,
+                             std::vector<drgn_type*>& children);
 
   std::unordered_set<Type*> visited_;
   TypeGraph& typeGraph_;
   DrgnParser& drgnParser_;
+  SymbolService& symbols_;
+  const ClassHierarchyIndex* index_;
+  bool enumeratedChildClasses_ = false;
 
   // Mapping of parent classes to child classes, using names for keys, as drgn
   // pointers returned from a type iterator will not match those returned from
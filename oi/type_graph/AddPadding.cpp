@@ -47,47 +47,47 @@ void AddPadding::accept(Type& type) {
 // CalcAlignment
 void AddPadding::visit(Class& c) {
   // AddPadding should be run after Flattener
-  assert(c.parents.empty());
+  assert(c.parents().empty());
 
-  for (auto& param : c.templateParams) {
+  for (auto& param : c.templateParams()) {
     accept(param.type());
   }
-  for (auto& member : c.members) {
+  for (auto& member : c.members()) {
     accept(member.type());
   }
 
   if (c.kind() == Class::Kind::Union) {
     // Only apply padding to the full size of the union, not between members
-    for (const auto& member : c.members) {
+    for (const auto& member : c.members()) {
       if (member.bitsize == c.size() * 8 || member.type().size() == c.size())
         return;  // Don't add padding to unions which don't need it
     }
     // This union's members aren't big enough to make up its size, so add a
     // single padding member
-    addPadding(0, c.size() * 8, c.members);
+    addPadding(0, c.size() * 8, c.members());
     return;
   }
 
   std::vector<Member> paddedMembers;
-  paddedMembers.reserve(c.members.size());
-  for (size_t i = 0; i < c.members.size(); i++) {
+  paddedMembers.reserve(c.members().size());
+  for (size_t i = 0; i < c.members().size(); i++) {
     if (i == 0) {
-      addPadding(0, c.members[0].bitOffset, paddedMembers);
+      addPadding(0, c.members()[0].bitOffset, paddedMembers);
     } else {
-      addPadding(c.members[i - 1], c.members[i].bitOffset, paddedMembers);
+      addPadding(c.members()[i - 1], c.members()[i].bitOffset, paddedMembers);
     }
 
-    paddedMembers.push_back(c.members[i]);
+    paddedMembers.push_back(c.members()[i]);
   }
 
-  if (!c.members.empty()) {
-    addPadding(c.members.back(), c.size() * 8, paddedMembers);
+  if (!c.members().empty()) {
+    addPadding(c.members().back(), c.size() * 8, paddedMembers);
   } else {
     // Pad out empty classes
     addPadding(0, c.size() * 8, paddedMembers);
   }
 
-  c.members = std::move(paddedMembers);
+  c.members() = std::move(paddedMembers);
 
   for (const auto& child : c.children) {
     accept(child);
@@ -52,7 +52,7 @@ void AlignmentCalc::visit(Class& c) {
 
   if (c.align() == 0) {
     uint64_t alignment = 1;
-    for (auto& member : c.members) {
+    for (auto& member : c.members()) {
       if (member.align == 0) {
         // If the member does not have an explicit alignment, calculate it from
         // the member's type.
@@ -77,9 +77,14 @@ void AlignmentCalc::visit(Class& c) {
 }
 
 void AlignmentCalc::visit(Container& c) {
-  RecursiveVisitor::visit(c);
+  for (const auto& param : c.templateParams) {
+    accept(param.type());
+  }
 
-  if (c.underlying()) {
+  // Containers identified from deferred classes already have their alignment,
+  // so only read the underlying class when it's needed
+  if (c.align() == 0 && c.underlying()) {
+    accept(*c.underlying());
     c.setAlign(c.underlying()->align());
   }
 }
@@ -146,6 +146,11 @@ Typedef& ClangTypeParser::enumerateTypedef(const clang::TypedefType& ty) {
 Enum& ClangTypeParser::enumerateEnum(const clang::EnumType& ty) {
   std::string fqName = clang::TypeName::getFullyQualifiedName(
       clang::QualType(&ty, 0), *ast, {ast->getLangOpts()});
+  bool shareable = ty.getDecl()->isExternallyVisible();
+  if (shareable) {
+    if (auto* known = findNamedType(ty, fqName))
+      return dynamic_cast<Enum&>(*known);
+  }
   std::string name = ty.getDecl()->getNameAsString();
   auto size = ast->getTypeSize(clang::QualType(&ty, 0)) / 8;
 
@@ -157,8 +162,14 @@ Enum& ClangTypeParser::enumerateEnum(const clang::EnumType& ty) {
     }
   }
 
-  return makeType<Enum>(
-      ty, std::move(name), std::move(fqName), size, std::move(enumeratorMap));
+  if (!shareable)
+    return makeType<Enum>(
+        ty, std::move(name), std::move(fqName), size, std::move(enumeratorMap));
+
+  auto& e = makeType<Enum>(
+      ty, std::move(name), fqName, size, std::move(enumeratorMap));
+  addNamedType(fqName, e);
+  return e;
 }
 
 Array& ClangTypeParser::enumerateArray(const clang::ConstantArrayType& ty) {
@@ -182,15 +193,22 @@ Type& ClangTypeParser::enumerateClass(const clang::RecordType& ty) {
       clang::QualType(&ty, 0), *ast, {ast->getLangOpts()});
   auto size = ast->getTypeSize(clang::QualType(&ty, 0)) / 8;
 
+  auto* decl = ty.getDecl();
+  bool shareable = decl->isExternallyVisible();
+  if (shareable) {
+    if (auto* known = findNamedType(ty, fqName))
+      return *known;
+  }
+
   if (auto* info = getContainerInfo(fqName)) {
     auto& c = makeType<Container>(ty, *info, size, nullptr);
-    enumerateClassTemplateParams(ty, c.templateParams);
+    if (shareable)
+      addNamedType(fqName, c);
+    enumerateClassTemplateParams(ty, c.templateParams());
     c.setAlign(ast->getTypeAlign(clang::QualType(&ty, 0)) / 8);
     return c;
   }
 
-  auto* decl = ty.getDecl();
-
   std::string name = decl->getNameAsString();
 
   auto kind = Class::Kind::Struct;
@@ -210,18 +228,22 @@ Type& ClangTypeParser::enumerateClass(const clang::RecordType& ty) {
                              .getAlignment()
                              .getQuantity();
     auto& c = makeType<Dummy>(ty, size, alignment, fqName);
+    if (shareable)
+      addNamedType(fqName, c);
     return c;
   }
 
-  auto& c = makeType<Class>(
-      ty, kind, std::move(name), std::move(fqName), size, virtuality);
+  auto& c =
+      makeType<Class>(ty, kind, std::move(name), fqName, size, virtuality);
+  if (shareable)
+    addNamedType(fqName, c);
   c.setAlign(ast->getTypeAlign(clang::QualType(&ty, 0)) / 8);
 
   if (options_.mustProcessTemplateParams.contains(fqnWithoutTemplateParams))
-    enumerateClassTemplateParams(ty, c.templateParams);
+    enumerateClassTemplateParams(ty, c.templateParams());
 
-  enumerateClassParents(ty, c.parents);
-  enumerateClassMembers(ty, c.members);
+  enumerateClassParents(ty, c.parents());
+  enumerateClassMembers(ty, c.members());
 
   return c;
 }
@@ -494,6 +516,25 @@ ContainerInfo* ClangTypeParser::getContainerInfo(
   return nullptr;
 }
 
+Type* ClangTypeParser::findNamedType(const clang::Type& ty,
+                                     const std::string& fqName) {
+  if (!options_.namedTypes)
+    return nullptr;
+
+  auto it = options_.namedTypes->find(fqName);
+  if (it == options_.namedTypes->end())
+    return nullptr;
+
+  VLOG(3) << "Reusing type parsed from another translation unit: " << fqName;
+  clang_types_.insert({&ty, it->second});
+  return &it->second.get();
+}
+
+void ClangTypeParser::addNamedType(const std::string& fqName, Type& type) {
+  if (options_.namedTypes)
+    options_.namedTypes->emplace(fqName, type);
+}
+
 namespace {
 
 bool requireCompleteType(clang::Sema& sema, const clang::Type& ty) {
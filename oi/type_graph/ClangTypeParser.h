@@ -17,6 +17,8 @@
 
 #include <cstdint>
 #include <functional>
+#include <set>
+#include <string>
 #include <unordered_map>
 
 #include "oi/type_graph/TypeGraph.h"
@@ -65,6 +67,14 @@ struct ClangTypeParserOptions {
   bool readEnumValues = false;
   std::set<std::string_view> typesToStub;
   std::set<std::string_view> mustProcessTemplateParams;
+
+  /*
+   * Externally visible classes and enums keyed by fully qualified name. When
+   * set, types already parsed from another translation unit are reused rather
+   * than being added to the type graph a second time.
+   */
+  std::unordered_map<std::string, std::reference_wrapper<Type>>* namedTypes =
+      nullptr;
 };
 
 /*
@@ -126,6 +136,9 @@ class ClangTypeParser {
 
   ContainerInfo* getContainerInfo(const std::string& fqName) const;
 
+  Type* findNamedType(const clang::Type&, const std::string& fqName);
+  void addNamedType(const std::string& fqName, Type&);
+
   template <typename T, typename... Args>
   T& makeType(const clang::Type& clangType, Args&&... args) {
     auto& newType = typeGraph_.makeType<T>(std::forward<Args>(args)...);
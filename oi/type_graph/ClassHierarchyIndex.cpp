@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ClassHierarchyIndex.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "oi/DrgnUtils.h"
+
+extern "C" {
+#include <drgn.h>
+}
+
+namespace oi::detail::type_graph {
+
+namespace {
+
+std::optional<std::string> lookupName(drgn_type* type) {
+  char* nameStr = nullptr;
+  size_t length = 0;
+  // As in DrgnParser, leak this error as freeing it has been seen to SEGV.
+  auto* err = drgn_type_fully_qualified_name(type, &nameStr, &length);
+  if (err != nullptr || nameStr == nullptr)
+    return std::nullopt;
+
+  std::string name = drgn_type_kind(type) == DRGN_TYPE_CLASS ? "class "
+                                                              : "struct ";
+  name.append(nameStr, length);
+  free(nameStr);
+  return name;
+}
+
+void recordChildren(drgn_type* type, ClassHierarchyIndex& index) {
+  drgn_type_template_parameter* parents = drgn_type_parents(type);
+  std::optional<std::string> childName;
+
+  for (size_t i = 0; i < drgn_type_num_parents(type); i++) {
+    drgn_qualified_type t{};
+    if (auto* err = drgn_template_parameter_type(&parents[i], &t);
+        err != nullptr) {
+      drgn_error_destroy(err);
+      continue;
+    }
+
+    drgn_type* parent = drgn_utils::underlyingType(t.type);
+    if (!drgn_utils::isSizeComplete(parent))
+      continue;
+
+    const char* parentName = drgn_type_tag(parent);
+    if (!parentName)
+      continue;
+
+    // Only name children which have a parent, which most types don't
+    if (!childName) {
+      childName = lookupName(type);
+      if (!childName)
+        return;
+    }
+    index.children[parentName].push_back(*childName);
+  }
+}
+
+}  // namespace
+
+/*
+ * drgn already indexes the program's DWARF in parallel across compilation
+ * units when it is loaded, so a single pass of its type iterator is enough.
+ * The iterator and the name lookups made for each type use the program's
+ * shared state, which drgn doesn't allow from several threads.
+ */
+ClassHierarchyIndex ClassHierarchyIndex::build(SymbolService& symbols) {
+  ClassHierarchyIndex index;
+
+  if ((setenv("DRGN_ENABLE_TYPE_ITERATOR", "1", 1)) < 0) {
+    LOG(ERROR)
+        << "Could not set DRGN_ENABLE_TYPE_ITERATOR environment variable";
+    return index;
+  }
+
+  drgn_type_iterator* typesIterator;
+  auto* prog = symbols.getDrgnProgram();
+  if (auto* err = drgn_type_iterator_create(prog, &typesIterator)) {
+    LOG(ERROR) << "Error initialising drgn_type_iterator: " << err->code
+               << ", " << err->message;
+    drgn_error_destroy(err);
+    return index;
+  }
+
+  while (true) {
+    drgn_qualified_type* t;
+    if (auto* err = drgn_type_iterator_next(typesIterator, &t)) {
+      drgn_error_destroy(err);
+      continue;
+    }
+    if (!t)
+      break;
+
+    auto kind = drgn_type_kind(t->type);
+    if (kind != DRGN_TYPE_CLASS && kind != DRGN_TYPE_STRUCT)
+      continue;
+
+    recordChildren(t->type, index);
+  }
+  drgn_type_iterator_destroy(typesIterator);
+
+  auto loaded = symbols.locateModules();
+  for (const auto& mod : loaded)
+    index.modules.push_back(mod.buildID);
+  index.setLoadedModules(loaded);
+
+  for (auto& [name, sym] : symbols.locateVtables()) {
+    auto mod = std::ranges::find_if(loaded, [&sym](const ModuleInfo& m) {
+      return sym.addr >= m.start && sym.addr < m.end;
+    });
+    if (mod == loaded.end())
+      continue;
+
+    size_t i = mod - loaded.begin();
+    index.vtables.emplace(name, Vtable{i, sym.addr - mod->start, sym.size});
+  }
+
+  VLOG(1) << "Indexed " << index.children.size() << " parent classes and "
+          << index.vtables.size() << " vtables";
+  return index;
+}
+
+void ClassHierarchyIndex::setLoadedModules(
+    const std::vector<ModuleInfo>& loaded) {
+  moduleStarts.assign(modules.size(), std::nullopt);
+  for (size_t i = 0; i < modules.size(); i++) {
+    auto mod = std::ranges::find_if(loaded, [&](const ModuleInfo& m) {
+      return m.buildID == modules[i];
+    });
+    if (mod != loaded.end())
+      moduleStarts[i] = mod->start;
+  }
+}
+
+std::optional<SymbolInfo> ClassHierarchyIndex::findVtable(
+    const std::string& className) const {
+  auto it = vtables.find(className);
+  if (it == vtables.end())
+    return std::nullopt;
+
+  const auto& vtable = it->second;
+  if (vtable.module >= moduleStarts.size() || !moduleStarts[vtable.module])
+    return std::nullopt;
+  return SymbolInfo{*moduleStarts[vtable.module] + vtable.offset, vtable.size};
+}
+
+}  // namespace oi::detail::type_graph
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "oi/SymbolService.h"
+
+namespace oi::detail::type_graph {
+
+/*
+ * ClassHierarchyIndex
+ *
+ * DWARF only stores a mapping of [child -> parent]. This holds the inverse for
+ * a whole program, along with the vtable symbol of every dynamic class. It
+ * depends only on the binary, so it can be built once per build ID and cached
+ * rather than iterating over every type in the program on each run.
+ *
+ * Modules may be loaded at a different address on each run, so vtables are
+ * stored relative to the module defining them. setLoadedModules() must be
+ * called with this run's modules before looking them up.
+ */
+struct ClassHierarchyIndex {
+  /*
+   * Unqualified parent class name -> direct children, named as they would be
+   * passed to drgn_program_find_type().
+   *
+   * Unqualified names are used as keys because computing fully-qualified names
+   * for every type in the program is too slow. Types with the same name in
+   * different namespaces are grouped together, so users must check the real
+   * parents of each child.
+   */
+  std::unordered_map<std::string, std::vector<std::string>> children;
+
+  struct Vtable {
+    size_t module;    // Index into `modules`
+    uint64_t offset;  // From the module's start address
+    uint64_t size;
+  };
+
+  // Fully-qualified class name -> vtable symbol
+  std::unordered_map<std::string, Vtable> vtables;
+  // Build IDs of the modules which may define vtables
+  std::vector<std::string> modules;
+
+  // Start address of each of `modules` in this run, if loaded. Not cached.
+  std::vector<std::optional<uint64_t>> moduleStarts;
+
+  static ClassHierarchyIndex build(SymbolService& symbols);
+
+  void setLoadedModules(const std::vector<ModuleInfo>& loaded);
+  // The vtable's address in this run, if its module is loaded
+  std::optional<SymbolInfo> findVtable(const std::string& className) const;
+};
+
+}  // namespace oi::detail::type_graph
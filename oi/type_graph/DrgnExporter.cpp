@@ -64,7 +64,7 @@ drgn_type* DrgnExporter::visit(Class& c) {
   auto* drgnType = makeDrgnType(kind, true, DRGN_NOT_PRIMITIVE_TYPE, c);
   th_.classMembersMap.insert({drgnType, {}});
 
-  for (const auto& mem : c.members) {
+  for (const auto& mem : c.members()) {
     if (mem.name.starts_with(AddPadding::MemberPrefix)) {
       continue;
     }
@@ -75,6 +75,14 @@ void warnForDrgnError(struct drgn_type* type,
 
 std::string getDrgnFullyQualifiedName(struct drgn_type* type);
 
+void enumerateClassFunctions(const void* handle,
+                             std::vector<Function>& functions);
+
+struct drgn_type* toDrgnType(const void* handle) {
+  // drgn's accessors take non-const types, but only read them
+  return static_cast<struct drgn_type*>(const_cast<void*>(handle));
+}
+
 }  // namespace
 
 Type& DrgnParser::parse(struct drgn_type* root) {
@@ -187,14 +195,50 @@ Class& DrgnParser::enumerateClass(struct drgn_type* type) {
   auto& c = makeType<Class>(
       type, kind, std::move(name), std::move(fqName), size, virtuality);
 
-  enumerateClassTemplateParams(type, c.templateParams);
-  enumerateClassParents(type, c.parents);
-  enumerateClassMembers(type, c.members);
-  enumerateClassFunctions(type, c.functions);
+  // Enumerating a class's contents parses every type they refer to, so only
+  // do it if a pass asks. Looking up each function's type is slow too.
+  c.deferContents(*this, type);
+  c.deferFunctions(&enumerateClassFunctions, type);
 
   return c;
 }
 
+void DrgnParser::loadTemplateParams(const void* handle,
+                                    std::vector<TemplateParam>& params) {
+  // Contents are read after parse() has returned, but their types still sit
+  // below a top-level type, so only chase pointers if asked to
+  depth_ = 1;
+  enumerateClassTemplateParams(toDrgnType(handle), params);
+  depth_ = 0;
+}
+
+void DrgnParser::loadParents(const void* handle,
+                             std::vector<Parent>& parents) {
+  depth_ = 1;
+  enumerateClassParents(toDrgnType(handle), parents);
+  depth_ = 0;
+}
+
+void DrgnParser::loadMembers(const void* handle,
+                             std::vector<Member>& members) {
+  depth_ = 1;
+  enumerateClassMembers(toDrgnType(handle), members);
+  depth_ = 0;
+}
+
+uint64_t DrgnParser::loadAlign(const void* handle) {
+  // drgn works this out from DWARF alone, without building type graph nodes
+  // for the class's members
+  auto* type = toDrgnType(handle);
+  drgn_qualified_type qualType{type, (enum drgn_qualifiers)(0)};
+  uint64_t align = 0;
+  if (auto* err = drgn_type_alignof(qualType, &align)) {
+    warnForDrgnError(type, "Error looking up alignment", err);
+    return 0;
+  }
+  return align;
+}
+
 void DrgnParser::enumerateClassParents(struct drgn_type* type,
                                        std::vector<Parent>& parents) {
   assert(parents.empty());
@@ -390,30 +434,6 @@ void DrgnParser::enumerateClassTemplateParams(
   }
 }
 
-void DrgnParser::enumerateClassFunctions(struct drgn_type* type,
-                                         std::vector<Function>& functions) {
-  assert(functions.empty());
-  size_t num_functions = drgn_type_num_functions(type);
-  functions.reserve(num_functions);
-
-  drgn_type_member_function* drgn_functions = drgn_type_functions(type);
-  for (size_t i = 0; i < num_functions; i++) {
-    drgn_qualified_type t{};
-    if (auto* err = drgn_member_function_type(&drgn_functions[i], &t)) {
-      warnForDrgnError(
-          type,
-          "Error looking up member function (" + std::to_string(i) + ")",
-          err);
-      continue;
-    }
-
-    auto virtuality = drgn_type_virtuality(t.type);
-    std::string name = drgn_type_tag(t.type);
-    Function f(name, virtuality);
-    functions.push_back(f);
-  }
-}
-
 Enum& DrgnParser::enumerateEnum(struct drgn_type* type) {
   std::string fqName = getDrgnFullyQualifiedName(type);
 
@@ -542,6 +562,30 @@ std::string getDrgnFullyQualifiedName(drgn_type* type) {
   return {};
 }
 
+void enumerateClassFunctions(const void* handle,
+                             std::vector<Function>& functions) {
+  auto* type = toDrgnType(handle);
+  size_t num_functions = drgn_type_num_functions(type);
+  functions.reserve(functions.size() + num_functions);
+
+  drgn_type_member_function* drgn_functions = drgn_type_functions(type);
+  for (size_t i = 0; i < num_functions; i++) {
+    drgn_qualified_type t{};
+    if (auto* err = drgn_member_function_type(&drgn_functions[i], &t)) {
+      warnForDrgnError(
+          type,
+          "Error looking up member function (" + std::to_string(i) + ")",
+          err);
+      continue;
+    }
+
+    auto virtuality = drgn_type_virtuality(t.type);
+    std::string name = drgn_type_tag(t.type);
+    Function f(name, virtuality);
+    functions.push_back(f);
+  }
+}
+
 }  // namespace
 
 }  // namespace oi::detail::type_graph
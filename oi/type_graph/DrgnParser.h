@@ -49,14 +49,24 @@ struct DrgnParserOptions {
  * passes clean up the type graph, e.g. flattening parents and identifying
  * containers.
  */
-class DrgnParser {
+class DrgnParser : private Class::ContentsLoader {
  public:
   DrgnParser(TypeGraph& typeGraph, DrgnParserOptions options)
       : typeGraph_(typeGraph), options_(options) {
   }
+  /*
+   * Class contents are read as passes ask for them, so the parser must outlive
+   * every use of the classes it creates.
+   */
   Type& parse(struct drgn_type* root);
 
  private:
+  void loadTemplateParams(const void* handle,
+                          std::vector<TemplateParam>& params) override;
+  void loadParents(const void* handle, std::vector<Parent>& parents) override;
+  void loadMembers(const void* handle, std::vector<Member>& members) override;
+  uint64_t loadAlign(const void* handle) override;
+
   Type& enumerateType(struct drgn_type* type);
   Class& enumerateClass(struct drgn_type* type);
   Enum& enumerateEnum(struct drgn_type* type);
@@ -75,8 +85,6 @@ class DrgnParser {
                              std::vector<Parent>& parents);
   void enumerateClassMembers(struct drgn_type* type,
                              std::vector<Member>& members);
-  void enumerateClassFunctions(struct drgn_type* type,
-                               std::vector<Function>& functions);
 
   template <typename T, typename... Args>
   T& makeType(struct drgn_type* drgnType, Args&&... args) {
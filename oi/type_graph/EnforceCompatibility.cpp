@@ -56,23 +56,23 @@ bool isTypeToStub(const Class& c) {
 
 void EnforceCompatibility::visit(Class& c) {
   if (isTypeToStub(c)) {
-    c.members.clear();
+    c.members().clear();
   }
 
-  for (auto& param : c.templateParams) {
+  for (auto& param : c.templateParams()) {
     accept(param.type());
   }
-  for (auto& parent : c.parents) {
+  for (auto& parent : c.parents()) {
     accept(parent.type());
   }
-  for (auto& member : c.members) {
+  for (auto& member : c.members()) {
     accept(member.type());
   }
   for (auto& child : c.children) {
     accept(child);
   }
 
-  std::erase_if(c.members, [](Member member) {
+  std::erase_if(c.members(), [](Member member) {
     // CodeGen v1 replaces parent containers with padding
     if (member.name.starts_with(Flattener::ParentPrefix))
       return true;
@@ -43,8 +43,8 @@ void flattenParent(const Parent& parent,
                    std::vector<Member>& flattenedMembers) {
   Type& parentType = stripTypedefs(parent.type());
   if (auto* parentClass = dynamic_cast<Class*>(&parentType)) {
-    for (size_t i = 0; i < parentClass->members.size(); i++) {
-      const auto& member = parentClass->members[i];
+    for (size_t i = 0; i < parentClass->members().size(); i++) {
+      const auto& member = parentClass->members()[i];
       flattenedMembers.push_back(member);
       flattenedMembers.back().bitOffset += parent.bitOffset;
       if (i == 0) {
@@ -76,36 +76,36 @@ void fixAllocatorParams(Class& alloc) {
     return;
   }
 
-  if (!alloc.templateParams.empty()) {
+  if (!alloc.templateParams().empty()) {
     // The DWARF looks ok
     return;
   }
 
-  if (alloc.parents.empty()) {
+  if (alloc.parents().empty()) {
     // Nothing we can do
     return;
   }
 
-  Type& parent = stripTypedefs(alloc.parents[0].type());
+  Type& parent = stripTypedefs(alloc.parents()[0].type());
   Class* parentClass = dynamic_cast<Class*>(&parent);
   if (!parentClass) {
     // Not handled
     return;
   }
 
-  if (parentClass->templateParams.empty()) {
+  if (parentClass->templateParams().empty()) {
     // Nothing we can do
     return;
   }
 
-  if (parentClass->templateParams[0].value) {
+  if (parentClass->templateParams()[0].value) {
     // Nothing we can do
     return;
   }
 
-  Type& allocParam = parentClass->templateParams[0].type();
+  Type& allocParam = parentClass->templateParams()[0].type();
   Type& typeToAllocate = stripTypedefs(allocParam);
-  alloc.templateParams.push_back(TemplateParam{typeToAllocate});
+  alloc.templateParams().push_back(TemplateParam{typeToAllocate});
 }
 }  // namespace
 
@@ -135,23 +135,21 @@ void Flattener::visit(Class& c) {
   //    TODO comment about virtual inheritance
 
   // Flatten types referenced by template params, parents and members
-  for (const auto& param : c.templateParams) {
+  for (const auto& param : c.templateParams()) {
     accept(param.type());
   }
-  for (const auto& parent : c.parents) {
+  for (const auto& parent : c.parents()) {
     accept(parent.type());
   }
-  for (const auto& member : c.members) {
+  for (const auto& member : c.members()) {
     accept(member.type());
   }
 
   // Pull in functions from flattened parents
-  for (const auto& parent : c.parents) {
+  for (const auto& parent : c.parents()) {
     Type& parentType = stripTypedefs(parent.type());
     if (Class* parentClass = dynamic_cast<Class*>(&parentType)) {
-      c.functions.insert(c.functions.end(),
-                         parentClass->functions.begin(),
-                         parentClass->functions.end());
+      c.addFunctionsFrom(*parentClass);
     }
   }
 
@@ -160,35 +158,35 @@ void Flattener::visit(Class& c) {
 
   std::size_t member_idx = 0;
   std::size_t parent_idx = 0;
-  while (member_idx < c.members.size() && parent_idx < c.parents.size()) {
-    auto member_offset = c.members[member_idx].bitOffset;
-    auto parent_offset = c.parents[parent_idx].bitOffset;
+  while (member_idx < c.members().size() && parent_idx < c.parents().size()) {
+    auto member_offset = c.members()[member_idx].bitOffset;
+    auto parent_offset = c.parents()[parent_idx].bitOffset;
     if (member_offset < parent_offset) {
       // Add our own member
-      const auto& member = c.members[member_idx++];
+      const auto& member = c.members()[member_idx++];
       flattenedMembers.push_back(member);
     } else {
       // Add parent's members
       // If member_offset == parent_offset then the parent is empty. Also take
       // this path.
-      const auto& parent = c.parents[parent_idx++];
+      const auto& parent = c.parents()[parent_idx++];
       flattenParent(parent, flattenedMembers);
     }
   }
-  while (member_idx < c.members.size()) {
-    const auto& member = c.members[member_idx++];
+  while (member_idx < c.members().size()) {
+    const auto& member = c.members()[member_idx++];
     flattenedMembers.push_back(member);
   }
-  while (parent_idx < c.parents.size()) {
-    const auto& parent = c.parents[parent_idx++];
+  while (parent_idx < c.parents().size()) {
+    const auto& parent = c.parents()[parent_idx++];
     flattenParent(parent, flattenedMembers);
   }
 
   // Perform fixups for bad DWARF
   fixAllocatorParams(c);
 
-  c.parents.clear();
-  c.members = std::move(flattenedMembers);
+  c.parents().clear();
+  c.members() = std::move(flattenedMembers);
 
   // Flatten types referenced by children.
   // This must be run after flattening the current class in order to respect
@@ -205,4 +203,15 @@ void Flattener::visit(Class& c) {
   }
 }
 
+void Flattener::visit(Container& c) {
+  for (const auto& param : c.templateParams) {
+    accept(param.type());
+  }
+
+  // The underlying class is only flattened so AlignmentCalc can calculate the
+  // container's alignment from it. Don't read it if that's already known.
+  if (c.align() == 0)
+    accept(c.underlying());
+}
+
 }  // namespace oi::detail::type_graph
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "FoldEquivalentClasses.h"
+
+#include <glog/logging.h>
+
+#include <string_view>
+
+#include "TypeGraph.h"
+
+template <typename T>
+using ref = std::reference_wrapper<T>;
+
+namespace oi::detail::type_graph {
+
+Pass FoldEquivalentClasses::createPass(Folded& folded, Stats& stats) {
+  auto fn = [&folded, &stats](TypeGraph& typeGraph, NodeTracker&) {
+    folded.clear();
+    stats = Stats{};
+    FoldEquivalentClasses pass{folded, stats};
+    pass.fold(typeGraph.finalTypes);
+    LOG(INFO) << "Folded " << stats.folded << " of " << stats.classes
+              << " classes (" << stats.foldedMembers << " members)";
+  };
+
+  return Pass("FoldEquivalentClasses", fn);
+}
+
+void FoldEquivalentClasses::fold(const std::vector<ref<Type>>& types) {
+  // finalTypes is topologically sorted, so every class held by value in a
+  // class's members has already been folded by the time we reach it.
+  for (const Type& t : types) {
+    const auto* c = dynamic_cast<const Class*>(&t);
+    if (!c)
+      continue;
+
+    stats_.classes++;
+    if (!foldable(*c))
+      continue;
+
+    auto& candidates = representatives_[hash(*c)];
+    bool found = false;
+    for (const Class* rep : candidates) {
+      if (equivalent(*rep, *c)) {
+        folded_.emplace(c, rep);
+        stats_.folded++;
+        stats_.foldedMembers += c->members().size();
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+      candidates.push_back(c);
+  }
+}
+
+/*
+ * A folded class is generated as an empty struct deriving from its
+ * representative, which unions can't do. Inheritance, dynamic dispatch and
+ * Thrift isset capture all generate class-specific code, so skip those too.
+ */
+bool FoldEquivalentClasses::foldable(const Class& c) {
+  if (c.kind() == Class::Kind::Union)
+    return false;
+  if (!c.parents().empty() || !c.children.empty() || c.virtuality() != 0)
+    return false;
+  for (const auto& member : c.members()) {
+    if (member.name == "__isset")
+      return false;
+  }
+  return true;
+}
+
+const Type& FoldEquivalentClasses::canonical(const Type& type) const {
+  if (const auto* c = dynamic_cast<const Class*>(&type)) {
+    if (auto it = folded_.find(c); it != folded_.end())
+      return *it->second;
+  }
+  return type;
+}
+
+uint64_t FoldEquivalentClasses::hash(const Class& c) const {
+  uint64_t h = 0xcbf29ce484222325;
+  auto mix = [&h](uint64_t value) {
+    h ^= value;
+    h *= 0x100000001b3;
+  };
+
+  mix(static_cast<uint64_t>(c.kind()));
+  mix(c.size());
+  mix(c.align());
+  mix(c.packed());
+  mix(c.members().size());
+  for (const auto& member : c.members()) {
+    mix(std::hash<std::string_view>{}(member.name));
+    mix(member.bitOffset);
+    mix(member.bitsize);
+    mix(reinterpret_cast<uintptr_t>(&canonical(member.type())));
+  }
+  return h;
+}
+
+/*
+ * Members must agree on everything that ends up in the generated handler,
+ * including the input names reported for their types. Member types must be
+ * the same node, or classes which have already been folded together.
+ */
+bool FoldEquivalentClasses::equivalent(const Class& a, const Class& b) const {
+  if (a.kind() != b.kind() || a.size() != b.size() || a.align() != b.align() ||
+      a.packed() != b.packed() || a.members().size() != b.members().size())
+    return false;
+
+  for (size_t i = 0; i < a.members().size(); i++) {
+    const auto& ma = a.members()[i];
+    const auto& mb = b.members()[i];
+    if (ma.name != mb.name || ma.inputName != mb.inputName ||
+        ma.bitOffset != mb.bitOffset || ma.bitsize != mb.bitsize ||
+        ma.align != mb.align)
+      return false;
+    if (&canonical(ma.type()) != &canonical(mb.type()) ||
+        ma.type().inputName() != mb.type().inputName())
+      return false;
+  }
+  return true;
+}
+
+}  // namespace oi::detail::type_graph
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "PassManager.h"
+#include "Types.h"
+
+namespace oi::detail::type_graph {
+
+/*
+ * FoldEquivalentClasses
+ *
+ * Hash-conses the classes in a type graph's finalTypes. Two classes are
+ * equivalent when their generated definitions and type handlers would only
+ * differ in the class names, e.g. the same struct declared in two namespaces.
+ * Every class is mapped to the first equivalent class before it in
+ * finalTypes, so code generation can share one handler between them while
+ * each class keeps its own name.
+ *
+ * The graph itself is not modified. Must be run after TopoSorter.
+ */
+class FoldEquivalentClasses {
+ public:
+  using Folded = std::unordered_map<const Class*, const Class*>;
+
+  struct Stats {
+    size_t classes = 0;
+    size_t folded = 0;
+    size_t foldedMembers = 0;
+  };
+
+  static Pass createPass(Folded& folded, Stats& stats);
+
+  FoldEquivalentClasses(Folded& folded, Stats& stats)
+      : folded_(folded), stats_(stats) {
+  }
+
+  void fold(const std::vector<std::reference_wrapper<Type>>& types);
+
+ private:
+  static bool foldable(const Class& c);
+  const Type& canonical(const Type& type) const;
+  uint64_t hash(const Class& c) const;
+  bool equivalent(const Class& a, const Class& b) const;
+
+  Folded& folded_;
+  Stats& stats_;
+  std::unordered_map<uint64_t, std::vector<const Class*>> representatives_;
+};
+
+}  // namespace oi::detail::type_graph
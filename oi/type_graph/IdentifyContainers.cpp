@@ -37,7 +37,7 @@ IdentifyContainers::IdentifyContainers(
     const std::vector<std::unique_ptr<ContainerInfo>>& containers)
     : tracker_(typeGraph.size()),
       typeGraph_(typeGraph),
-      containers_(containers) {
+      matcher_(containers) {
 }
 
 Type& IdentifyContainers::mutate(Type& type) {
@@ -50,14 +50,12 @@ Type& IdentifyContainers::mutate(Type& type) {
 }
 
 Type& IdentifyContainers::visit(Class& c) {
-  for (const auto& containerInfo : containers_) {
-    if (!containerInfo->matches(c.fqName())) {
-      continue;
-    }
-
+  if (const ContainerInfo* containerInfo = matcher_.match(c.fqName())) {
     auto& container =
         typeGraph_.makeType<Container>(*containerInfo, c.size(), &c);
-    container.templateParams = c.templateParams;
+    container.templateParams = c.templateParams();
+    // Avoids reading the class's members just to calculate its alignment
+    container.setAlign(c.sourceAlign());
 
     tracker_.set(c, &container);
     visit(container);
@@ -24,6 +24,7 @@
 #include "Types.h"
 #include "Visitor.h"
 #include "oi/ContainerInfo.h"
+#include "oi/ContainerMatcher.h"
 
 namespace oi::detail::type_graph {
 
@@ -53,7 +54,7 @@ class IdentifyContainers : public RecursiveMutator {
  private:
   ResultTracker<Type*> tracker_;
   TypeGraph& typeGraph_;
-  const std::vector<std::unique_ptr<ContainerInfo>>& containers_;
+  ContainerMatcher matcher_;
 };
 
 }  // namespace oi::detail::type_graph
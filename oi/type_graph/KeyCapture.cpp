@@ -66,7 +66,7 @@ void KeyCapture::visit(Class& c) {
       continue;
     if (!keyToCapture.member.has_value())
       continue;
-    for (auto& member : c.members) {
+    for (auto& member : c.members()) {
       if (member.name != *keyToCapture.member)
         continue;
 
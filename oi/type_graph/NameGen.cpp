@@ -76,27 +76,28 @@ void NameGen::visit(Class& c) {
   c.setName(name);
 
   // Deduplicate member names. Duplicates may be present after flattening.
-  for (size_t i = 0; i < c.members.size(); i++) {
-    if (c.members[i].name.empty())
-      c.members[i].name = AnonPrefix;
+  auto& members = c.members();
+  for (size_t i = 0; i < members.size(); i++) {
+    if (members[i].name.empty())
+      members[i].name = AnonPrefix;
 
-    c.members[i].name += "_" + std::to_string(i);
+    members[i].name += "_" + std::to_string(i);
 
-    if (c.members[i].inputName.empty())
-      c.members[i].inputName = c.members[i].name;
+    if (members[i].inputName.empty())
+      members[i].inputName = members[i].name;
 
     // GCC includes dots in vptr member names, e.g. "_vptr.MyClass"
     // These aren't valid in C++, so we must replace them
-    std::replace(c.members[i].name.begin(), c.members[i].name.end(), '.', '$');
+    std::replace(members[i].name.begin(), members[i].name.end(), '.', '$');
   }
 
-  for (const auto& param : c.templateParams) {
+  for (const auto& param : c.templateParams()) {
     accept(param.type());
   }
-  for (const auto& parent : c.parents) {
+  for (const auto& parent : c.parents()) {
     accept(parent.type());
   }
-  for (const auto& member : c.members) {
+  for (const auto& member : c.members()) {
     accept(member.type());
   }
   for (const auto& child : c.children) {
@@ -17,12 +17,16 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 
 #include "NodeTracker.h"
 #include "Printer.h"
 #include "TypeGraph.h"
+#include "Visitor.h"
+#include "oi/Metrics.h"
 
 template <typename T>
 using ref = std::reference_wrapper<T>;
@@ -30,7 +34,7 @@ using ref = std::reference_wrapper<T>;
 namespace oi::detail::type_graph {
 
 void Pass::run(TypeGraph& typeGraph, NodeTrackerHolder tracker) {
-  fn_(typeGraph, tracker.get(typeGraph.size()));
+  fn_(typeGraph, tracker.get(typeGraph.numNodeIds()));
 }
 
 void PassManager::addPass(Pass p) {
@@ -42,7 +46,8 @@ void print(const TypeGraph& typeGraph, NodeTrackerHolder tracker) {
   if (!VLOG_IS_ON(1))
     return;
   std::stringstream out;
-  Printer printer{out, tracker.get(typeGraph.size()), typeGraph.size()};
+  Printer printer{
+      out, tracker.get(typeGraph.numNodeIds()), typeGraph.numNodeIds()};
   for (const auto& type : typeGraph.rootTypes()) {
     printer.print(type);
   }
@@ -50,12 +55,47 @@ void print(const TypeGraph& typeGraph, NodeTrackerHolder tracker) {
   // Long strings will be truncated by glog, use std::cerr instead
   std::cerr << "\n" << out.str();
 }
+
+/*
+ * Counts the distinct nodes reachable from the roots. TypeGraph::size() only
+ * counts allocations, so it can't show a pass removing nodes.
+ */
+class NodeCounter : public RecursiveVisitor {
+ public:
+  explicit NodeCounter(NodeTracker& tracker) : tracker_(tracker) {
+  }
+
+  using RecursiveVisitor::accept;
+
+  void accept(Type& type) override {
+    if (type.id() < 0 || tracker_.visit(type))
+      return;
+    count_++;
+    type.accept(*this);
+  }
+
+  size_t count() const {
+    return count_;
+  }
+
+ private:
+  NodeTracker& tracker_;
+  size_t count_ = 0;
+};
+
+size_t countNodes(TypeGraph& typeGraph, NodeTrackerHolder tracker) {
+  NodeCounter counter{tracker.get(typeGraph.numNodeIds())};
+  for (Type& type : typeGraph.rootTypes())
+    counter.accept(type);
+  return counter.count();
+}
 }  // namespace
 
 const std::string separator = "----------------";
 
 void PassManager::run(TypeGraph& typeGraph) {
   NodeTracker tracker;
+  profile_.clear();
 
   VLOG(1) << separator;
   VLOG(1) << "Parsed Type Graph:";
@@ -67,11 +107,60 @@ void PassManager::run(TypeGraph& typeGraph) {
     auto& pass = passes_[i];
     LOG(INFO) << "Running pass (" << i + 1 << "/" << passes_.size()
               << "): " << pass.name();
-    pass.run(typeGraph, tracker);
+
+    // Measuring costs two /proc reads and two graph walks per pass
+    if (!profiling_ && !metrics::Tracing::isEnabled()) {
+      pass.run(typeGraph, tracker);
+    } else {
+      metrics::Tracing span{"pass_" + pass.name()};
+      PassProfile stats;
+      stats.name = pass.name();
+      stats.nodesBefore = countNodes(typeGraph, tracker);
+      stats.rssBeforeKB = metrics::Tracing::currentRssKB();
+      auto start = std::chrono::steady_clock::now();
+
+      pass.run(typeGraph, tracker);
+
+      stats.duration = std::chrono::steady_clock::now() - start;
+      stats.rssAfterKB = metrics::Tracing::currentRssKB();
+      stats.nodesAfter = countNodes(typeGraph, tracker);
+      span.addValue("nodes_before", static_cast<int64_t>(stats.nodesBefore));
+      span.addValue("nodes_after", static_cast<int64_t>(stats.nodesAfter));
+      span.stop();
+      if (profiling_)
+        profile_.push_back(std::move(stats));
+    }
+
     VLOG(1) << separator;
     print(typeGraph, tracker);
     VLOG(1) << separator;
   }
 }
 
+void PassManager::printProfile(std::ostream& out,
+                               const std::vector<PassProfile>& profile) {
+  size_t nameWidth = 4;
+  for (const auto& stats : profile)
+    nameWidth = std::max(nameWidth, stats.name.size());
+
+  out << std::left << std::setw(nameWidth) << "Pass" << std::right
+      << std::setw(12) << "Time (ms)" << std::setw(16) << "RSS delta (KB)"
+      << std::setw(14) << "Nodes before" << std::setw(14) << "Nodes after"
+      << "\n";
+
+  std::chrono::nanoseconds total{0};
+  for (const auto& stats : profile) {
+    total += stats.duration;
+    out << std::left << std::setw(nameWidth) << stats.name << std::right
+        << std::setw(12) << std::fixed << std::setprecision(3)
+        << std::chrono::duration<double, std::milli>(stats.duration).count()
+        << std::setw(16) << stats.rssAfterKB - stats.rssBeforeKB
+        << std::setw(14) << stats.nodesBefore << std::setw(14)
+        << stats.nodesAfter << "\n";
+  }
+  out << std::left << std::setw(nameWidth) << "Total" << std::right
+      << std::setw(12) << std::fixed << std::setprecision(3)
+      << std::chrono::duration<double, std::milli>(total).count() << "\n";
+}
+
 }  // namespace oi::detail::type_graph
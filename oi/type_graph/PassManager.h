@@ -15,7 +15,9 @@
  */
 #pragma once
 
+#include <chrono>
 #include <functional>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -48,6 +50,24 @@ class Pass {
   PassFn fn_;
 };
 
+/*
+ * PassProfile
+ *
+ * Resources used by a single run of a pass. The same figures are recorded in
+ * a metrics::Tracing span named "pass_<name>" when metrics are enabled.
+ *
+ * Node counts are of the distinct nodes reachable from the roots, so passes
+ * which remove nodes show a drop. Enums and primitives aren't counted.
+ */
+struct PassProfile {
+  std::string name;
+  std::chrono::nanoseconds duration;
+  long rssBeforeKB;
+  long rssAfterKB;
+  size_t nodesBefore;
+  size_t nodesAfter;
+};
+
 /*
  * PassManager
  *
@@ -58,8 +78,24 @@ class PassManager {
   void addPass(Pass p);
   void run(TypeGraph& typeGraph);
 
+  // Profiling walks the graph twice per pass, so it is off by default
+  void setProfiling(bool profiling) {
+    profiling_ = profiling;
+  }
+
+  // Profiles of the passes run by the last call to run(), in order. Empty
+  // unless profiling is on.
+  const std::vector<PassProfile>& profile() const {
+    return profile_;
+  }
+
+  static void printProfile(std::ostream& out,
+                           const std::vector<PassProfile>& profile);
+
  private:
   std::vector<Pass> passes_;
+  std::vector<PassProfile> profile_;
+  bool profiling_ = false;
 };
 
 }  // namespace oi::detail::type_graph
@@ -74,16 +74,16 @@ void Printer::visit(const Class& c) {
     out_ << ", packed";
   }
   out_ << ")" << std::endl;
-  for (const auto& param : c.templateParams) {
+  for (const auto& param : c.templateParams()) {
     print_param(param);
   }
-  for (const auto& parent : c.parents) {
+  for (const auto& parent : c.parents()) {
     print_parent(parent);
   }
-  for (const auto& member : c.members) {
+  for (const auto& member : c.members()) {
     print_member(member);
   }
-  for (const auto& function : c.functions) {
+  for (const auto& function : c.functions()) {
     print_function(function);
   }
   for (auto& child : c.children) {
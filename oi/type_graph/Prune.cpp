@@ -41,18 +41,20 @@ void Prune::accept(Type& type) {
 void Prune::visit(Class& c) {
   RecursiveVisitor::visit(c);
 
-  c.templateParams.clear();
-  c.parents.clear();
-  c.functions.clear();
+  c.templateParams().clear();
+  c.parents().clear();
+  c.clearFunctions();
 
   // Should we bother with this shrinking? It saves memory but costs CPU
-  c.templateParams.shrink_to_fit();
-  c.parents.shrink_to_fit();
-  c.functions.shrink_to_fit();
+  c.templateParams().shrink_to_fit();
+  c.parents().shrink_to_fit();
 }
 
 void Prune::visit(Container& c) {
-  RecursiveVisitor::visit(c);
+  // The underlying class is dropped, so don't read it
+  for (const auto& param : c.templateParams) {
+    accept(param.type());
+  }
 
   c.setUnderlying(nullptr);
 }
@@ -44,23 +44,23 @@ void RemoveMembers::visit(Class& c) {
   if (c.kind() == Class::Kind::Union) {
     // In general, we can't tell which member is active in a union, so it is not
     // safe to try and measure any of them.
-    c.members.clear();
+    c.members().clear();
   }
 
-  for (const auto& param : c.templateParams) {
+  for (const auto& param : c.templateParams()) {
     accept(param.type());
   }
-  for (const auto& parent : c.parents) {
+  for (const auto& parent : c.parents()) {
     accept(parent.type());
   }
-  for (const auto& mem : c.members) {
+  for (const auto& mem : c.members()) {
     accept(mem.type());
   }
   for (const auto& child : c.children) {
     accept(child);
   }
 
-  std::erase_if(c.members, [this, &c](Member member) {
+  std::erase_if(c.members(), [this, &c](Member member) {
     if (ignoreMember(c.inputName(), member.name))
       return true;
     if (dynamic_cast<Incomplete*>(&member.type()))
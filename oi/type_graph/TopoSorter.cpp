@@ -55,13 +55,13 @@ void TopoSorter::accept(Type& type) {
 }
 
 void TopoSorter::visit(Class& c) {
-  for (const auto& parent : c.parents) {
+  for (const auto& parent : c.parents()) {
     accept(parent.type());
   }
-  for (const auto& mem : c.members) {
+  for (const auto& mem : c.members()) {
     accept(mem.type());
   }
-  for (const auto& param : c.templateParams) {
+  for (const auto& param : c.templateParams()) {
     accept(param.type());
   }
   sortedTypes_.push_back(c);
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace oi::detail::type_graph {
+
+/*
+ * TypeArena
+ *
+ * Bump allocator for nodes of a single type. Nodes are constructed in place in
+ * fixed-size chunks so that nodes of the same kind sit next to each other in
+ * memory and are never moved once created. Every node is destroyed along with
+ * the arena.
+ */
+template <typename T>
+class TypeArena {
+ public:
+  TypeArena() = default;
+  TypeArena(const TypeArena&) = delete;
+  TypeArena& operator=(const TypeArena&) = delete;
+
+  TypeArena(TypeArena&& other) noexcept
+      : chunks_(std::move(other.chunks_)), used_(other.used_) {
+    other.chunks_.clear();
+    other.used_ = kChunkSize;
+  }
+
+  TypeArena& operator=(TypeArena&& other) noexcept {
+    if (this != &other) {
+      clear();
+      chunks_ = std::move(other.chunks_);
+      used_ = other.used_;
+      other.chunks_.clear();
+      other.used_ = kChunkSize;
+    }
+    return *this;
+  }
+
+  ~TypeArena() {
+    clear();
+  }
+
+  template <typename... Args>
+  T& make(Args&&... args) {
+    if (used_ == kChunkSize) {
+      // Default-initialise: there is no need to zero the chunk
+      chunks_.push_back(std::unique_ptr<Chunk>(new Chunk));
+      used_ = 0;
+    }
+    void* slot = &chunks_.back()->slots[used_];
+    T* node = ::new (slot) T(std::forward<Args>(args)...);
+    used_++;
+    return *node;
+  }
+
+  size_t size() const noexcept {
+    return chunks_.empty() ? 0 : (chunks_.size() - 1) * kChunkSize + used_;
+  }
+
+ private:
+  // Aim for roughly 16KiB chunks, but always fit a reasonable number of nodes
+  static constexpr size_t kChunkSize =
+      std::max<size_t>(16, 16384 / sizeof(T));
+
+  struct Chunk {
+    struct alignas(T) Slot {
+      std::byte bytes[sizeof(T)];
+    };
+    Slot slots[kChunkSize];
+  };
+
+  void clear() noexcept {
+    for (size_t i = 0; i < chunks_.size(); i++) {
+      size_t n = i + 1 == chunks_.size() ? used_ : kChunkSize;
+      for (size_t j = 0; j < n; j++)
+        std::launder(reinterpret_cast<T*>(&chunks_[i]->slots[j]))->~T();
+    }
+    chunks_.clear();
+    used_ = kChunkSize;
+  }
+
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  // Nodes constructed in the last chunk. Starts "full" to force allocation.
+  size_t used_ = kChunkSize;
+};
+
+}  // namespace oi::detail::type_graph
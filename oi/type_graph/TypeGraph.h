@@ -16,9 +16,10 @@
 #pragma once
 
 #include <functional>
-#include <memory>
+#include <tuple>
 #include <vector>
 
+#include "TypeArena.h"
 #include "Types.h"
 
 namespace oi::detail::type_graph {
@@ -31,7 +32,15 @@ namespace oi::detail::type_graph {
 class TypeGraph {
  public:
   size_t size() const noexcept {
-    return types_.size();
+    return size_;
+  }
+
+  /*
+   * NodeIds are handed out densely from zero, so this is the size needed for
+   * side tables indexed by NodeId, e.g. NodeTracker and ResultTracker.
+   */
+  size_t numNodeIds() const noexcept {
+    return static_cast<size_t>(next_id_);
   }
 
   // TODO provide iterator instead of direct vector access?
@@ -56,10 +65,8 @@ class TypeGraph {
   T& makeType(NodeId id, Args&&... args) {
     static_assert(T::has_node_id, "Unnecessary node ID provided");
     next_id_ = std::max(next_id_, id + 1);
-    auto type_unique_ptr = std::make_unique<T>(id, std::forward<Args>(args)...);
-    auto type_raw_ptr = type_unique_ptr.get();
-    types_.push_back(std::move(type_unique_ptr));
-    return *type_raw_ptr;
+    size_++;
+    return arena<T>().make(id, std::forward<Args>(args)...);
   }
 
   template <typename T, typename... Args>
@@ -71,10 +78,8 @@ class TypeGraph {
       return makeType<T>(next_id_++, std::forward<Args>(args)...);
     } else {
       // No Node ID
-      auto type_unique_ptr = std::make_unique<T>(std::forward<Args>(args)...);
-      auto type_raw_ptr = type_unique_ptr.get();
-      types_.push_back(std::move(type_unique_ptr));
-      return *type_raw_ptr;
+      size_++;
+      return arena<T>().make(std::forward<Args>(args)...);
     }
   }
 
@@ -82,9 +87,27 @@ class TypeGraph {
   std::vector<std::reference_wrapper<Type>> finalTypes;
 
  private:
+  template <typename T>
+  TypeArena<T>& arena() {
+    return std::get<TypeArena<T>>(arenas_);
+  }
+
   std::vector<std::reference_wrapper<Type>> rootTypes_;
-  // Store all type objects in vectors for ownership. Order is not significant.
-  std::vector<std::unique_ptr<Type>> types_;
+  // Type objects are owned by one arena per node kind. Primitives are
+  // singletons and so don't need one.
+  std::tuple<TypeArena<Incomplete>,
+             TypeArena<Class>,
+             TypeArena<Container>,
+             TypeArena<Enum>,
+             TypeArena<Array>,
+             TypeArena<Typedef>,
+             TypeArena<Pointer>,
+             TypeArena<Reference>,
+             TypeArena<Dummy>,
+             TypeArena<DummyAllocator>,
+             TypeArena<CaptureKeys>>
+      arenas_;
+  size_t size_ = 0;
   NodeId next_id_ = 0;
 };
 
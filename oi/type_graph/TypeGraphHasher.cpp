@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "TypeGraphHasher.h"
+
+#include "oi/ContainerInfo.h"
+#include "TypeGraph.h"
+
+namespace oi::detail::type_graph {
+
+uint64_t TypeGraphHasher::hash(const TypeGraph& typeGraph) {
+  TypeGraphHasher hasher;
+  for (const Type& root : typeGraph.rootTypes()) {
+    hasher.mix("root");
+    hasher.hash(root);
+  }
+  return hasher.value();
+}
+
+void TypeGraphHasher::hash(const Type& type) {
+  auto [it, inserted] = seen_.emplace(&type, seen_.size());
+  if (!inserted) {
+    mix("ref");
+    mix(it->second);
+    return;
+  }
+  type.accept(*this);
+}
+
+void TypeGraphHasher::visit(const Incomplete& i) {
+  mixCommon("Incomplete", i);
+  if (auto underlyingType = i.underlyingType())
+    hash(underlyingType.value().get());
+}
+
+void TypeGraphHasher::visit(const Class& c) {
+  mixCommon("Class", c);
+  mix(static_cast<uint64_t>(c.kind()));
+  mix(static_cast<uint64_t>(c.virtuality()));
+  mix(c.packed());
+
+  mix(c.templateParams().size());
+  for (const auto& param : c.templateParams())
+    mixParam(param);
+
+  mix(c.parents().size());
+  for (const auto& parent : c.parents()) {
+    mix(parent.bitOffset);
+    hash(parent.type());
+  }
+
+  mix(c.members().size());
+  for (const auto& member : c.members()) {
+    mix(member.name);
+    mix(member.inputName);
+    mix(member.bitOffset);
+    mix(member.bitsize);
+    mix(member.align);
+    hash(member.type());
+  }
+
+  const auto& functions = c.functions();
+  mix(functions.size());
+  for (const auto& function : functions) {
+    mix(function.name);
+    mix(static_cast<uint64_t>(function.virtuality));
+  }
+
+  mix(c.children.size());
+  for (const Type& child : c.children)
+    hash(child);
+}
+
+void TypeGraphHasher::visit(const Container& c) {
+  mixCommon("Container", c);
+  mix(c.containerName());
+  mix(c.templateParams.size());
+  for (const auto& param : c.templateParams)
+    mixParam(param);
+  mix(c.underlying() != nullptr);
+  if (c.underlying())
+    hash(*c.underlying());
+}
+
+void TypeGraphHasher::visit(const Primitive& p) {
+  mixCommon("Primitive", p);
+  mix(static_cast<uint64_t>(p.kind()));
+}
+
+void TypeGraphHasher::visit(const Enum& e) {
+  mixCommon("Enum", e);
+  mix(e.enumerators().size());
+  for (const auto& [val, name] : e.enumerators()) {
+    mix(static_cast<uint64_t>(val));
+    mix(name);
+  }
+}
+
+void TypeGraphHasher::visit(const Array& a) {
+  mixCommon("Array", a);
+  mix(a.len());
+  hash(a.elementType());
+}
+
+void TypeGraphHasher::visit(const Typedef& td) {
+  mixCommon("Typedef", td);
+  hash(td.underlyingType());
+}
+
+void TypeGraphHasher::visit(const Pointer& p) {
+  mixCommon("Pointer", p);
+  hash(p.pointeeType());
+}
+
+void TypeGraphHasher::visit(const Reference& r) {
+  mixCommon("Reference", r);
+  hash(r.pointeeType());
+}
+
+void TypeGraphHasher::visit(const Dummy& d) {
+  mixCommon("Dummy", d);
+}
+
+void TypeGraphHasher::visit(const DummyAllocator& d) {
+  mixCommon("DummyAllocator", d);
+  hash(d.allocType());
+}
+
+void TypeGraphHasher::visit(const CaptureKeys& d) {
+  mixCommon("CaptureKeys", d);
+  mix(d.containerInfo().typeName);
+  hash(d.underlyingType());
+}
+
+void TypeGraphHasher::mix(uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    hash_ ^= (value >> (i * 8)) & 0xff;
+    hash_ *= 0x100000001b3;
+  }
+}
+
+void TypeGraphHasher::mix(std::string_view str) {
+  mix(str.size());
+  for (unsigned char c : str) {
+    hash_ ^= c;
+    hash_ *= 0x100000001b3;
+  }
+}
+
+void TypeGraphHasher::mixCommon(std::string_view kind, const Type& type) {
+  mix(kind);
+  mix(type.name());
+  mix(type.inputName());
+  mix(type.size());
+  mix(type.align());
+}
+
+void TypeGraphHasher::mixParam(const TemplateParam& param) {
+  mix(param.qualifiers[Qualifier::Const]);
+  mix(param.value.has_value());
+  if (param.value)
+    mix(*param.value);
+  hash(param.type());
+}
+
+}  // namespace oi::detail::type_graph
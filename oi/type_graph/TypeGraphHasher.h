@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "Types.h"
+#include "Visitor.h"
+
+namespace oi::detail::type_graph {
+
+class TypeGraph;
+
+/*
+ * TypeGraphHasher
+ *
+ * Computes a structural hash of everything reachable from a type graph's
+ * roots: names, sizes, alignment, members, parents, template parameters and
+ * container kinds. Node IDs are not hashed, so graphs built in a different
+ * order hash the same. Back-references are hashed by the order in which
+ * their target was first reached.
+ *
+ * The hash is FNV-1a, so it is stable across runs and builds.
+ */
+class TypeGraphHasher : public ConstVisitor {
+ public:
+  static uint64_t hash(const TypeGraph& typeGraph);
+
+  void hash(const Type& type);
+  uint64_t value() const {
+    return hash_;
+  }
+
+  void visit(const Incomplete& i) override;
+  void visit(const Class& c) override;
+  void visit(const Container& c) override;
+  void visit(const Primitive& p) override;
+  void visit(const Enum& e) override;
+  void visit(const Array& a) override;
+  void visit(const Typedef& td) override;
+  void visit(const Pointer& p) override;
+  void visit(const Reference& r) override;
+  void visit(const Dummy& d) override;
+  void visit(const DummyAllocator& d) override;
+  void visit(const CaptureKeys& d) override;
+
+ private:
+  void mix(uint64_t value);
+  void mix(std::string_view str);
+  void mixCommon(std::string_view kind, const Type& type);
+  void mixParam(const TemplateParam& param);
+
+  uint64_t hash_ = 0xcbf29ce484222325;
+  std::unordered_map<const Type*, uint64_t> seen_;
+};
+
+}  // namespace oi::detail::type_graph
@@ -39,7 +39,7 @@ bool TypeIdentifier::isAllocator(Type& t) {
 
   // Maybe add more checks for an allocator.
   // For now, just test for the presence of an "allocate" function
-  for (const auto& func : c->functions) {
+  for (const auto& func : c->functions()) {
     if (func.name == "allocate") {
       return true;
     }
@@ -81,7 +81,7 @@ void TypeIdentifier::visit(Container& c) {
           } else {
             dummy = &typeGraph_.makeType<Container>(
                 info, param.type().size(), paramClass);
-            dummy->templateParams = paramClass->templateParams;
+            dummy->templateParams = paramClass->templateParams();
             passThroughTypeDummys_.insert(it,
                                           {paramClass->id(), std::ref(*dummy)});
           }
@@ -108,7 +108,7 @@ void TypeIdentifier::visit(Container& c) {
       if (isAllocator(param.type())) {
         auto* allocator = dynamic_cast<Class*>(
             &param.type());  // TODO please don't do this...
-        Type& typeToAllocate = allocator->templateParams.at(0).type();
+        Type& typeToAllocate = allocator->templateParams().at(0).type();
         auto& dummy = typeGraph_.makeType<DummyAllocator>(
             typeToAllocate, size, param.type().align(), allocator->name());
         c.templateParams[i] = dummy;
@@ -125,7 +125,7 @@ bool Class::isDynamic() const {
     return true;
   }
 
-  for (const auto& func : functions) {
+  for (const auto& func : functions()) {
     if (func.virtuality != 0 /*DW_VIRTUALITY_none*/) {
       // Virtual function
       return true;
@@ -36,6 +36,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -368,14 +369,137 @@ class Class : public Type {
 
   bool isDynamic() const;
 
-  std::vector<TemplateParam> templateParams;
-  std::vector<Parent> parents;  // Sorted by offset
-  std::vector<Member> members;  // Sorted by offset
-  std::vector<Function> functions;
+  /*
+   * Member functions are expensive to read from debug info and few passes
+   * need them, so parsers may defer reading them until functions() is first
+   * called. Deferred functions are appended after any already present.
+   */
+  using FunctionLoader = void (*)(const void* handle,
+                                  std::vector<Function>& functions);
+
+  std::vector<Function>& functions() {
+    loadFunctions();
+    return functions_;
+  }
+  const std::vector<Function>& functions() const {
+    loadFunctions();
+    return functions_;
+  }
+  void deferFunctions(FunctionLoader loader, const void* handle) {
+    pendingFunctions_.emplace_back(loader, handle);
+  }
+  // Adds other's functions, leaving any deferred ones unread
+  void addFunctionsFrom(const Class& other) {
+    functions_.insert(
+        functions_.end(), other.functions_.begin(), other.functions_.end());
+    pendingFunctions_.insert(pendingFunctions_.end(),
+                             other.pendingFunctions_.begin(),
+                             other.pendingFunctions_.end());
+  }
+  // Discards all functions, without reading deferred ones
+  void clearFunctions() {
+    functions_ = {};
+    pendingFunctions_ = {};
+  }
+
+  /*
+   * Template parameters, parents and members pull in every type they refer
+   * to, so parsers may defer them too. Each is read the first time it is
+   * accessed, meaning a class which is replaced, e.g. by a container, never
+   * reads the parts nothing looks at. The loader must outlive the class.
+   */
+  class ContentsLoader {
+   public:
+    virtual ~ContentsLoader() = default;
+    virtual void loadTemplateParams(const void* handle,
+                                    std::vector<TemplateParam>& params) = 0;
+    virtual void loadParents(const void* handle,
+                             std::vector<Parent>& parents) = 0;
+    virtual void loadMembers(const void* handle,
+                             std::vector<Member>& members) = 0;
+    // The alignment recorded by the source, or 0 if unknown
+    virtual uint64_t loadAlign(const void* handle) = 0;
+  };
+
+  void deferContents(ContentsLoader& loader, const void* handle) {
+    contentsLoader_ = &loader;
+    contentsHandle_ = handle;
+    pendingTemplateParams_ = pendingParents_ = pendingMembers_ = true;
+  }
+
+  /*
+   * The alignment of a deferred class as recorded by its parser's source,
+   * read without loading its members. 0 if unknown, in which case it must be
+   * calculated from the members.
+   */
+  uint64_t sourceAlign() const {
+    if (contentsLoader_ == nullptr)
+      return 0;
+    return contentsLoader_->loadAlign(contentsHandle_);
+  }
+
+  std::vector<TemplateParam>& templateParams() {
+    loadTemplateParams();
+    return templateParams_;
+  }
+  const std::vector<TemplateParam>& templateParams() const {
+    loadTemplateParams();
+    return templateParams_;
+  }
+  // Sorted by offset
+  std::vector<Parent>& parents() {
+    loadParents();
+    return parents_;
+  }
+  const std::vector<Parent>& parents() const {
+    loadParents();
+    return parents_;
+  }
+  // Sorted by offset
+  std::vector<Member>& members() {
+    loadMembers();
+    return members_;
+  }
+  const std::vector<Member>& members() const {
+    loadMembers();
+    return members_;
+  }
+
   std::vector<std::reference_wrapper<Class>>
       children;  // Only for dynamic classes
 
  private:
+  void loadFunctions() const {
+    for (auto [loader, handle] : pendingFunctions_)
+      loader(handle, functions_);
+    pendingFunctions_.clear();
+  }
+  void loadTemplateParams() const {
+    if (std::exchange(pendingTemplateParams_, false))
+      contentsLoader_->loadTemplateParams(contentsHandle_, templateParams_);
+  }
+  void loadParents() const {
+    if (std::exchange(pendingParents_, false))
+      contentsLoader_->loadParents(contentsHandle_, parents_);
+  }
+  void loadMembers() const {
+    if (std::exchange(pendingMembers_, false))
+      contentsLoader_->loadMembers(contentsHandle_, members_);
+  }
+
+  mutable std::vector<Function> functions_;
+  mutable std::vector<std::pair<FunctionLoader, const void*>>
+      pendingFunctions_;
+
+  mutable std::vector<TemplateParam> templateParams_;
+  mutable std::vector<Parent> parents_;
+  mutable std::vector<Member> members_;
+  ContentsLoader* contentsLoader_ = nullptr;
+  const void* contentsHandle_ = nullptr;
+  mutable bool pendingTemplateParams_ = false;
+  mutable bool pendingParents_ = false;
+  mutable bool pendingMembers_ = false;
+
   std::string name_;
   std::string inputName_;
   size_t size_;
@@ -76,13 +76,13 @@ class RecursiveVisitor : public Visitor<void> {
   virtual void visit(Incomplete&) {
   }
   virtual void visit(Class& c) {
-    for (const auto& param : c.templateParams) {
+    for (const auto& param : c.templateParams()) {
       accept(param.type());
     }
-    for (const auto& parent : c.parents) {
+    for (const auto& parent : c.parents()) {
       accept(parent.type());
     }
-    for (const auto& mem : c.members) {
+    for (const auto& mem : c.members()) {
       accept(mem.type());
     }
     for (const auto& child : c.children) {
@@ -139,13 +139,13 @@ class RecursiveMutator : public Visitor<Type&> {
     return i;
   }
   virtual Type& visit(Class& c) {
-    for (auto& param : c.templateParams) {
+    for (auto& param : c.templateParams()) {
       param.setType(mutate(param.type()));
     }
-    for (auto& parent : c.parents) {
+    for (auto& parent : c.parents()) {
       parent.setType(mutate(parent.type()));
     }
-    for (auto& mem : c.members) {
+    for (auto& mem : c.members()) {
       mem.setType(mutate(mem.type()));
     }
     for (auto& child : c.children) {
@@ -175,6 +175,14 @@ NodeId getId(std::string_view str, size_t* idLen = nullptr) {
   return id;
 }
 
+// Classes may read their template params lazily, so only expose an accessor
+std::vector<TemplateParam>& templateParams(Class& c) {
+  return c.templateParams();
+}
+std::vector<TemplateParam>& templateParams(Container& c) {
+  return c.templateParams;
+}
+
 }  // namespace
 
 void TypeGraphParser::parse(std::string_view input) {
@@ -348,7 +356,7 @@ void TypeGraphParser::parseParams(T& c,
       param.qualifiers[qual] = true;
     }
 
-    c.templateParams.push_back(param);
+    templateParams(c).push_back(param);
   }
   // No more params for us - put back the line we just read
   input = origInput;
@@ -370,7 +378,7 @@ void TypeGraphParser::parseParents(Class& c,
     auto offset = parseNumericAttribute(line, "Parent", "offset: ");
     Type& type = parseType(input, rootIndent + 2);
 
-    c.parents.emplace_back(type, offset * 8);
+    c.parents().emplace_back(type, offset * 8);
   }
   // No more parents for us - put back the line we just read
   input = origInput;
@@ -402,7 +410,7 @@ void TypeGraphParser::parseMembers(Class& c,
     if (bitsize)
       member.bitsize = static_cast<uint64_t>(*bitsize);
 
-    c.members.push_back(member);
+    c.members().push_back(member);
   }
   // No more members for us - put back the line we just read
   input = origInput;
@@ -425,7 +433,7 @@ void TypeGraphParser::parseFunctions(Class& c,
 
     Function func{std::string{name}};
 
-    c.functions.push_back(func);
+    c.functions().push_back(func);
   }
   // No more functions for us - put back the line we just read
   input = origInput;
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Times container identification over a synthetic corpus of type names, the
+ * way IdentifyContainers does it: every name against every container from the
+ * given directory of .toml definitions. Not run as part of ctest.
+ *
+ *   bench_container_matcher types/ [numNames] [iterations]
+ *
+ * Compares a regex search per container, ContainerInfo::matches() per
+ * container and a single ContainerMatcher lookup.
+ */
+#include <boost/regex.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "oi/ContainerInfo.h"
+#include "oi/ContainerMatcher.h"
+
+using oi::detail::ContainerMatcher;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ * Roughly the mix seen in large programs: most classes aren't containers, many
+ * are templates, and names repeat as the same instantiations are reached from
+ * different places.
+ */
+std::vector<std::string> buildCorpus(
+    const std::vector<std::unique_ptr<ContainerInfo>>& containers,
+    size_t numNames) {
+  std::mt19937_64 rng{42};
+  const std::vector<std::string> namespaces = {
+      "",        "facebook::", "folly::detail::", "std::",
+      "ns::a::", "ns::b::c::", "apache::thrift::",
+  };
+  const std::vector<std::string> args = {
+      "int",
+      "std::__cxx11::basic_string<char, std::char_traits<char>, "
+      "std::allocator<char> >",
+      "unsigned long",
+      "std::pair<int const, double>",
+      "facebook::Widget*",
+  };
+
+  std::vector<std::string> names;
+  names.reserve(numNames);
+  while (names.size() < numNames) {
+    std::string name;
+    auto r = rng() % 10;
+    if (r < 3 && !containers.empty()) {
+      // A container instantiation
+      name = containers[rng() % containers.size()]->typeName + "<" +
+             args[rng() % args.size()] + ", " + args[rng() % args.size()] +
+             " >";
+    } else if (r < 6) {
+      // A class template which isn't a container
+      name = namespaces[rng() % namespaces.size()] + "Templ" +
+             std::to_string(rng() % 500) + "<" + args[rng() % args.size()] +
+             ">";
+    } else {
+      name = namespaces[rng() % namespaces.size()] + "Class" +
+             std::to_string(rng() % 5000);
+    }
+
+    // Repeat some names, as the same instantiations show up many times
+    size_t repeats = 1 + rng() % 4;
+    for (size_t i = 0; i < repeats && names.size() < numNames; i++)
+      names.push_back(name);
+  }
+  std::shuffle(names.begin(), names.end(), rng);
+  return names;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0]
+              << " types_dir [numNames] [iterations]\n";
+    return 1;
+  }
+  size_t numNames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+  size_t iterations = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5;
+
+  std::vector<std::unique_ptr<ContainerInfo>> containers;
+  for (const auto& entry : std::filesystem::directory_iterator(argv[1])) {
+    if (entry.path().extension() == ".toml")
+      containers.push_back(std::make_unique<ContainerInfo>(entry.path()));
+  }
+  std::sort(containers.begin(),
+            containers.end(),
+            [](const auto& a, const auto& b) { return *a < *b; });
+
+  // What ContainerInfo::matches() ran for every container before
+  std::vector<boost::regex> regexes;
+  for (const auto& info : containers) {
+    regexes.emplace_back(
+        "^" + info->typeName + "$|^" + info->typeName + "<.*>$",
+        boost::regex_constants::extended);
+  }
+
+  auto corpus = buildCorpus(containers, numNames);
+
+  auto timeMs = [](auto fn) {
+    auto start = Clock::now();
+    size_t matched = fn();
+    double ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+    return std::make_pair(ms, matched);
+  };
+
+  std::map<std::string, std::vector<double>> timings;
+  std::map<std::string, size_t> matches;
+  std::vector<std::string> order = {"regex", "matches", "matcher"};
+  for (size_t it = 0; it < iterations; it++) {
+    auto [regexMs, regexMatched] = timeMs([&] {
+      size_t matched = 0;
+      for (const auto& name : corpus) {
+        for (const auto& re : regexes) {
+          if (boost::regex_search(name.begin(), name.end(), re)) {
+            matched++;
+            break;
+          }
+        }
+      }
+      return matched;
+    });
+    timings["regex"].push_back(regexMs);
+    matches["regex"] = regexMatched;
+
+    auto [matchesMs, matchesMatched] = timeMs([&] {
+      size_t matched = 0;
+      for (const auto& name : corpus) {
+        for (const auto& info : containers) {
+          if (info->matches(name)) {
+            matched++;
+            break;
+          }
+        }
+      }
+      return matched;
+    });
+    timings["matches"].push_back(matchesMs);
+    matches["matches"] = matchesMatched;
+
+    // A fresh matcher each time, so its memo table starts out empty
+    auto [matcherMs, matcherMatched] = timeMs([&] {
+      ContainerMatcher matcher{containers};
+      size_t matched = 0;
+      for (const auto& name : corpus) {
+        if (matcher.match(name) != nullptr)
+          matched++;
+      }
+      return matched;
+    });
+    timings["matcher"].push_back(matcherMs);
+    matches["matcher"] = matcherMatched;
+  }
+
+  std::cout << "containers: " << containers.size()
+            << ", names: " << corpus.size() << "\n";
+  std::cout << std::left << std::setw(16) << "method" << std::right
+            << std::setw(12) << "median ms" << std::setw(12) << "min ms"
+            << std::setw(12) << "matched" << "\n";
+  for (const auto& name : order) {
+    auto& samples = timings[name];
+    std::sort(samples.begin(), samples.end());
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(2) << std::setw(12)
+              << samples[samples.size() / 2] << std::setw(12) << samples[0]
+              << std::setw(12) << matches[name] << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Compares the time to compile a synthetic type's traversal function through
+ * clang, from the generated C++, against lowering it straight to LLVM IR with
+ * IRGen. Both paths run the same LLVM optimisation and object emission, so
+ * the difference is the cost of the clang frontend. Not run as part of ctest.
+ *
+ *   bench_ir_compile config.toml [numClasses] [iterations] [optLevel]
+ *
+ * The config file provides the header paths the generated C++ needs, as for
+ * oid and OIL.
+ */
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "oi/CodeGen.h"
+#include "oi/Config.h"
+#include "oi/IRGen.h"
+#include "oi/Interpreter.h"
+#include "oi/OICompiler.h"
+#include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/Types.h"
+
+using namespace oi::detail;
+using namespace oi::detail::type_graph;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ * A chain of classes, each with an int, a pointer to the previous class and an
+ * array of pointers to the one before that. Each class gets its own handler on
+ * both paths.
+ */
+Class& buildGraph(TypeGraph& typeGraph, size_t numClasses) {
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  std::vector<Class*> classes;
+  for (size_t i = 0; i < numClasses; i++) {
+    auto name = "C" + std::to_string(i);
+    auto& c = typeGraph.makeType<Class>(Class::Kind::Struct, name, name, 32);
+    c.members().push_back(Member{myint, "a", 0});
+    if (i > 0) {
+      auto& ptr = typeGraph.makeType<Pointer>(*classes[i - 1]);
+      c.members().push_back(Member{ptr, "p", 64});
+    }
+    if (i > 1) {
+      auto& ptr = typeGraph.makeType<Pointer>(*classes[i - 2]);
+      auto& arr = typeGraph.makeType<Array>(ptr, 2);
+      c.members().push_back(Member{arr, "arr", 128});
+    }
+    classes.push_back(&c);
+  }
+  typeGraph.addRoot(*classes.back());
+  return *classes.back();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0]
+              << " config.toml [numClasses] [iterations] [optLevel]\n";
+    return 1;
+  }
+  std::vector<std::filesystem::path> configFiles{argv[1]};
+  size_t numClasses = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+  size_t iterations = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5;
+
+  // The same features OIL requests
+  std::map<Feature, bool> features{
+      {Feature::TypeGraph, true},      {Feature::TreeBuilderV2, true},
+      {Feature::Library, true},        {Feature::PackStructs, true},
+      {Feature::PruneTypeGraph, true},
+  };
+  OICompiler::Config compilerConfig;
+  OICodeGen::Config generatorConfig;
+  auto featureSet = config::processConfigFiles(
+      configFiles, features, compilerConfig, generatorConfig);
+  if (!featureSet) {
+    std::cerr << "failed to process " << argv[1] << "\n";
+    return 1;
+  }
+  compilerConfig.features = *featureSet;
+  generatorConfig.features = *featureSet;
+  if (argc > 4)
+    compilerConfig.optimizationLevel = std::strtoul(argv[4], nullptr, 10);
+
+  TypeGraph typeGraph;
+  auto& root = buildGraph(typeGraph, numClasses);
+  CodeGen codegen{generatorConfig};
+  codegen.transform(typeGraph);
+  std::string code;
+  codegen.generate(typeGraph, code, CodeGen::ExactName{"introspect_bench"});
+
+  auto interpreter = Interpreter::compile(root);
+  if (interpreter == nullptr) {
+    std::cerr << "the interpreter can't lower the synthetic type\n";
+    return 1;
+  }
+
+  // Compilation doesn't need symbols, only relocation does
+  OICompiler compiler{nullptr, compilerConfig};
+  auto objectPath = std::filesystem::temp_directory_path() / "bench_ir.o";
+
+  auto timeMs = [](auto fn) {
+    auto start = Clock::now();
+    if (!fn()) {
+      std::cerr << "compilation failed\n";
+      std::exit(1);
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+  };
+
+  std::map<std::string, std::vector<double>> timings;
+  std::vector<std::string> order = {"clang", "ir_generate", "ir_compile"};
+  for (size_t it = 0; it < iterations; it++) {
+    timings["clang"].push_back(timeMs(
+        [&] { return compiler.compile(code, "bench_ir.cpp", objectPath); }));
+
+    llvm::LLVMContext ctx;
+    std::unique_ptr<llvm::Module> module;
+    timings["ir_generate"].push_back(timeMs([&] {
+      module = IRGen{ctx, *interpreter}.generate("introspect_bench",
+                                                 "introspect_batch_bench");
+      return module != nullptr;
+    }));
+    timings["ir_compile"].push_back(
+        timeMs([&] { return compiler.compile(*module, objectPath); }));
+  }
+  std::filesystem::remove(objectPath);
+
+  std::cout << "classes: " << numClasses
+            << ", generated C++: " << code.size() << " bytes\n";
+  std::cout << std::left << std::setw(16) << "phase" << std::right
+            << std::setw(12) << "median ms" << std::setw(12) << "min ms"
+            << "\n";
+  for (const auto& name : order) {
+    auto& samples = timings[name];
+    std::sort(samples.begin(), samples.end());
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(2) << std::setw(12)
+              << samples[samples.size() / 2] << std::setw(12) << samples[0]
+              << "\n";
+  }
+  return 0;
+}
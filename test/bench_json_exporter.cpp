@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Times oi::exporters::Json over a synthetic tree of introspection results.
+ * Not run as part of ctest.
+ *
+ *   bench_json_exporter [numElements] [iterations]
+ *
+ * Compares the previous field-by-field std::ostream exporter with the
+ * buffered one, with and without the path table. Output goes to a stream
+ * which only counts bytes, so disk speed doesn't factor in.
+ */
+#include <oi/exporters/Json.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace oi;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class CountingBuf : public std::streambuf {
+ public:
+  size_t count = 0;
+
+ protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    count += static_cast<size_t>(n);
+    return n;
+  }
+  int_type overflow(int_type c) override {
+    count++;
+    return c;
+  }
+};
+
+/*
+ * The exporter as it was before buffering: every token goes through
+ * std::ostream and strings aren't escaped.
+ */
+class OstreamJson {
+ public:
+  OstreamJson(std::ostream& out) : out_(out) {
+  }
+
+  template <typename It>
+  void print(It& it, const It& end) {
+    const auto depth = it->type_path.size();
+    out_ << '[';
+    bool first = true;
+    while (it != end && it->type_path.size() >= depth) {
+      if (!std::exchange(first, false))
+        out_ << ',';
+      out_ << '{';
+      const auto& el = *it;
+      out_ << "\"name\":\"" << el.name << "\",";
+      printList("typePath", el.type_path);
+      printList("typeNames", el.type_names);
+      out_ << "\"staticSize\":" << el.static_size << ',';
+      out_ << "\"exclusiveSize\":" << el.exclusive_size << ',';
+      if (const auto* s = std::get_if<result::Element::Scalar>(&el.data))
+        out_ << "\"data\":" << s->n << ',';
+      if (el.container_stats.has_value()) {
+        out_ << "\"length\":" << el.container_stats->length << ',';
+        out_ << "\"capacity\":" << el.container_stats->capacity << ',';
+      }
+      out_ << "\"is_primitive\":" << (el.is_primitive ? "true" : "false")
+           << ',';
+      out_ << "\"members\":";
+      if (++it != end && it->type_path.size() > depth)
+        print(it, end);
+      else
+        out_ << "[]";
+      out_ << '}';
+    }
+    out_ << ']';
+  }
+
+ private:
+  template <typename Rng>
+  void printList(std::string_view name, const Rng& range) {
+    out_ << '"' << name << "\":[";
+    bool first = true;
+    for (const auto& el : range) {
+      if (!std::exchange(first, false))
+        out_ << ',';
+      out_ << '"' << el << '"';
+    }
+    out_ << "],";
+  }
+
+  std::ostream& out_;
+};
+
+/*
+ * Roughly the shape of a large result: a vector of structs, whose members are
+ * scalars, nested structs or vectors of structs, with long template type
+ * names. As in real results, the same type paths repeat many times.
+ */
+struct Corpus {
+  struct Member {
+    std::string_view name;
+    int structType;  // -1 for a scalar
+    bool isVector;
+  };
+  struct StructType {
+    std::string_view name;
+    std::vector<Member> members;
+  };
+
+  std::mt19937_64 rng{42};
+  std::vector<StructType> types;
+  std::deque<std::vector<std::string_view>> paths;
+  std::deque<std::vector<std::string_view>> names;
+  std::deque<std::string> strings;
+  std::vector<result::Element> elements;
+  size_t numElements = 0;
+
+  std::string_view intern(std::string s) {
+    return strings.emplace_back(std::move(s));
+  }
+
+  void build(size_t n) {
+    numElements = n;
+
+    // Types only contain types with a higher index, so there's no recursion
+    const int numTypes = 30;
+    for (int i = 0; i < numTypes; i++) {
+      auto& type = types.emplace_back();
+      type.name = intern("ns::detail::Widget" + std::to_string(i) +
+                         "<std::basic_string<char, std::char_traits<char>, "
+                         "std::allocator<char> > >");
+      int numMembers = 2 + static_cast<int>(rng() % 5);
+      for (int m = 0; m < numMembers; m++) {
+        int structType = -1;
+        if (i + 1 < numTypes && rng() % 3 == 0)
+          structType = i + 1 + static_cast<int>(rng() % (numTypes - i - 1));
+        type.members.push_back({intern("member_" + std::to_string(m)),
+                                structType,
+                                structType != -1 && rng() % 2 == 0});
+      }
+    }
+
+    std::vector<std::string_view> path = {intern("root")};
+    std::string_view vectorName = intern("std::vector<ns::detail::Widget0>");
+    add(path, vectorName, false);
+    path.push_back(intern("[]"));
+    while (elements.size() < numElements)
+      addStruct(path, 0);
+  }
+
+  void addStruct(std::vector<std::string_view>& path, int typeIndex) {
+    const auto& type = types[typeIndex];
+    add(path, type.name, false);
+    for (const auto& member : type.members) {
+      if (elements.size() >= numElements)
+        return;
+      path.push_back(member.name);
+      if (member.structType == -1) {
+        add(path, "uint64_t", true);
+      } else if (!member.isVector) {
+        addStruct(path, member.structType);
+      } else {
+        add(path, types[member.structType].name, false);
+        path.push_back("[]");
+        for (size_t i = rng() % 4; i > 0; i--)
+          addStruct(path, member.structType);
+        path.pop_back();
+      }
+      path.pop_back();
+    }
+  }
+
+  void add(const std::vector<std::string_view>& path,
+           std::string_view typeName,
+           bool isScalar) {
+    const auto& p = paths.emplace_back(path);
+    const auto& n = names.emplace_back(std::vector{typeName});
+    auto& el = elements.emplace_back(result::Element{
+        .name = path.back(),
+        .type_path = p,
+        .type_names = n,
+        .static_size = 24,
+        .exclusive_size = 8,
+        .is_primitive = isScalar,
+    });
+    if (isScalar)
+      el.data = result::Element::Scalar{elements.size()};
+    else
+      el.container_stats = result::Element::ContainerStats{16, 12};
+  }
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t numElements =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2'000'000;
+  size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+  Corpus corpus;
+  corpus.build(numElements);
+  const auto& elements = corpus.elements;
+
+  auto timeMs = [](auto fn) {
+    CountingBuf buf;
+    std::ostream out{&buf};
+    auto start = Clock::now();
+    fn(out);
+    double ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count();
+    return std::make_pair(ms, buf.count);
+  };
+
+  std::map<std::string, std::vector<double>> timings;
+  std::map<std::string, size_t> bytes;
+  std::vector<std::string> order = {"ostream", "buffered", "path-table"};
+  for (size_t i = 0; i < iterations; i++) {
+    auto [ostreamMs, ostreamBytes] = timeMs([&](std::ostream& out) {
+      OstreamJson json{out};
+      auto it = elements.begin();
+      json.print(it, elements.end());
+    });
+    timings["ostream"].push_back(ostreamMs);
+    bytes["ostream"] = ostreamBytes;
+
+    auto [bufferedMs, bufferedBytes] = timeMs([&](std::ostream& out) {
+      exporters::Json json{out};
+      auto it = elements.begin();
+      json.print(it, elements.end());
+    });
+    timings["buffered"].push_back(bufferedMs);
+    bytes["buffered"] = bufferedBytes;
+
+    auto [tableMs, tableBytes] = timeMs([&](std::ostream& out) {
+      exporters::Json json{out};
+      json.setPathTable(true);
+      auto it = elements.begin();
+      json.print(it, elements.end());
+    });
+    timings["path-table"].push_back(tableMs);
+    bytes["path-table"] = tableBytes;
+  }
+
+  std::cout << "elements: " << elements.size() << "\n";
+  std::cout << std::left << std::setw(16) << "method" << std::right
+            << std::setw(12) << "median ms" << std::setw(12) << "min ms"
+            << std::setw(12) << "MB" << std::setw(12) << "MB/s" << "\n";
+  for (const auto& name : order) {
+    auto& samples = timings[name];
+    std::sort(samples.begin(), samples.end());
+    double median = samples[samples.size() / 2];
+    double mb = static_cast<double>(bytes[name]) / 1e6;
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(2) << std::setw(12) << median
+              << std::setw(12) << samples[0] << std::setw(12) << mb
+              << std::setw(12) << mb / (median / 1000) << "\n";
+  }
+
+  return 0;
+}
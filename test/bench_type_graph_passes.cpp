@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Times the construction of a large synthetic type graph and the
+ * container-independent passes run over it. Not run as part of ctest.
+ *
+ *   bench_type_graph_passes [numClasses] [iterations]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "oi/type_graph/AddPadding.h"
+#include "oi/type_graph/AlignmentCalc.h"
+#include "oi/type_graph/Flattener.h"
+#include "oi/type_graph/NameGen.h"
+#include "oi/type_graph/NodeTracker.h"
+#include "oi/type_graph/PassManager.h"
+#include "oi/type_graph/TopoSorter.h"
+#include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/TypeGraphHasher.h"
+#include "oi/type_graph/Types.h"
+
+using namespace oi::detail::type_graph;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ * Every class gets an int, a typedef'd int, a pointer to a random earlier
+ * class and an array of a random earlier class. One in four classes derives
+ * from one of a small set of parent-less base classes.
+ */
+void buildGraph(TypeGraph& typeGraph, size_t numClasses) {
+  std::mt19937_64 rng{42};
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto& mytypedef = typeGraph.makeType<Typedef>("MyInt", myint);
+
+  constexpr size_t kNumBases = 16;
+  std::vector<Class*> classes;
+  classes.reserve(numClasses);
+  for (size_t i = 0; i < numClasses; i++) {
+    bool isBase = i < kNumBases;
+    size_t parentSize = isBase || i % 4 != 0 ? 0 : 8;
+    auto& c = typeGraph.makeType<Class>(
+        Class::Kind::Struct, "C" + std::to_string(i), parentSize + 32);
+
+    uint64_t offset = 0;
+    if (parentSize != 0) {
+      c.parents().push_back(Parent{*classes[rng() % kNumBases], 0});
+      offset += parentSize * 8;
+    }
+    c.members().push_back(Member{myint, "a", offset});
+    c.members().push_back(Member{mytypedef, "b", offset + 32});
+    if (i != 0) {
+      auto& ptr = typeGraph.makeType<Pointer>(*classes[rng() % i]);
+      c.members().push_back(Member{ptr, "p", offset + 64});
+      auto& elem = *classes[rng() % std::min(i, kNumBases)];
+      auto& arr = typeGraph.makeType<Array>(elem, 2);
+      c.members().push_back(Member{arr, "arr", offset + 128});
+    }
+    classes.push_back(&c);
+    typeGraph.addRoot(c);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t numClasses = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+  std::vector<Pass> passes = {
+      Flattener::createPass(), AlignmentCalc::createPass(),
+      AddPadding::createPass(), NameGen::createPass(),
+      TopoSorter::createPass(),
+  };
+
+  std::map<std::string, std::vector<double>> timings;
+  std::vector<std::string> order = {"build"};
+  for (auto& pass : passes)
+    order.push_back(pass.name());
+  order.push_back("hash");
+  order.push_back("destroy");
+
+  auto timeMs = [](auto fn) {
+    auto start = Clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+  };
+
+  for (size_t it = 0; it < iterations; it++) {
+    auto typeGraph = std::make_unique<TypeGraph>();
+    NodeTracker tracker;
+    timings["build"].push_back(
+        timeMs([&] { buildGraph(*typeGraph, numClasses); }));
+    for (auto& pass : passes) {
+      timings[pass.name()].push_back(
+          timeMs([&] { pass.run(*typeGraph, tracker); }));
+    }
+    timings["hash"].push_back(
+        timeMs([&] { (void)TypeGraphHasher::hash(*typeGraph); }));
+    if (it == 0)
+      std::cout << "nodes: " << typeGraph->size() << "\n";
+    timings["destroy"].push_back(timeMs([&] { typeGraph.reset(); }));
+  }
+
+  std::cout << std::left << std::setw(16) << "phase" << std::right
+            << std::setw(12) << "median ms" << std::setw(12) << "min ms"
+            << "\n";
+  for (const auto& name : order) {
+    auto& samples = timings[name];
+    std::sort(samples.begin(), samples.end());
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::fixed << std::setprecision(2) << std::setw(12)
+              << samples[samples.size() / 2] << std::setw(12) << samples[0]
+              << "\n";
+  }
+  return 0;
+}
@@ -33,8 +33,10 @@ def add_headers(f, custom_headers, thrift_headers):
         """
 #include <boost/current_function.hpp>
 #include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <sstream>
 #include <thread>
 #include <tuple>
 
@@ -135,19 +137,41 @@ def add_test_setup(f, config):
             )
         )
 
+        tiered = case.get("tiered_compilation", False)
         oil_func_body = (
             f"    oi::GeneratorOptions opts{{\n"
             f"      .configFilePaths = configFiles,\n"
             f'      .sourceFileDumpPath = "oil_jit_code.cpp",\n'
             f"      .debugLevel = 3,\n"
+            f"      .tieredCompilation = {'true' if tiered else 'false'},\n"
             f"    }};\n\n"
         )
 
         oil_func_body += "    auto pr = oi::exporters::Json(std::cout);\n"
         oil_func_body += "    pr.setPretty(true);\n"
         for i in range(len(case["param_types"])):
-            oil_func_body += f"    auto ret{i} = oi::result::SizedResult(*oi::setupAndIntrospect(a{i}, opts));\n"
-            oil_func_body += f"    pr.print(ret{i});\n"
+            if not tiered:
+                oil_func_body += f"    auto ret{i} = oi::result::SizedResult(*oi::setupAndIntrospect(a{i}, opts));\n"
+                oil_func_body += f"    pr.print(ret{i});\n"
+                continue
+
+            # Introspect with the first tier and again once the optimised tier
+            # is installed. Both must give the same results.
+            oil_func_body += (
+                f"    std::ostringstream first{i};\n"
+                f"    oi::exporters::Json(first{i}).print(oi::result::SizedResult(*oi::setupAndIntrospect(a{i}, opts)));\n"
+                f"    if (!oi::CodegenHandler<std::remove_cvref_t<decltype(a{i})>>::waitForOptimiser()) {{\n"
+                f'      std::cerr << "optimised tier was not installed" << std::endl;\n'
+                f"      std::exit(1);\n"
+                f"    }}\n"
+                f"    std::ostringstream optimised{i};\n"
+                f"    oi::exporters::Json(optimised{i}).print(oi::result::SizedResult(*oi::setupAndIntrospect(a{i}, opts)));\n"
+                f"    if (first{i}.str() != optimised{i}.str()) {{\n"
+                f'      std::cerr << "results differ between tiers" << std::endl;\n'
+                f"      std::exit(1);\n"
+                f"    }}\n"
+                f"    std::cout << optimised{i}.str() << std::endl;\n"
+            )
 
         f.write(
             define_traceable_func(
@@ -1,7 +1,9 @@
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "oi/SymbolService.h"
 #include "oi/type_graph/AddChildren.h"
+#include "oi/type_graph/ClassHierarchyIndex.h"
 #include "oi/type_graph/NodeTracker.h"
 #include "oi/type_graph/Printer.h"
 #include "oi/type_graph/TypeGraph.h"
@@ -178,3 +180,46 @@ TEST_F(AddChildrenTest, InheritancePolymorphic) {
                  Function: myfunc (virtual)
 )");
 }
+
+TEST_F(AddChildrenTest, ClassHierarchyIndex) {
+  auto index = ClassHierarchyIndex::build(*symbols_);
+
+  auto it = index.children.find("A");
+  ASSERT_NE(it, index.children.end());
+  EXPECT_THAT(it->second,
+              testing::Contains("class ns_inheritance_polymorphic::B"));
+  EXPECT_TRUE(index.vtables.contains("ns_inheritance_polymorphic::B"));
+}
+
+TEST_F(AddChildrenTest, ClassHierarchyIndexAtDifferentLoadOffset) {
+  auto built = ClassHierarchyIndex::build(*symbols_);
+  auto expected =
+      symbols_->locateSymbol("vtable for ns_inheritance_polymorphic::C", true);
+  ASSERT_TRUE(expected.has_value());
+  auto vtable = built.findVtable("ns_inheritance_polymorphic::C");
+  ASSERT_TRUE(vtable.has_value());
+  EXPECT_EQ(vtable->addr, expected->addr);
+
+  // As if loaded from the cache into a run with the modules moved
+  constexpr uint64_t shift = 0x10000;
+  ClassHierarchyIndex cached;
+  cached.children = built.children;
+  cached.vtables = built.vtables;
+  cached.modules = built.modules;
+  auto modules = symbols_->locateModules();
+  for (auto& mod : modules) {
+    mod.start += shift;
+    mod.end += shift;
+  }
+  cached.setLoadedModules(modules);
+  vtable = cached.findVtable("ns_inheritance_polymorphic::C");
+  ASSERT_TRUE(vtable.has_value());
+  EXPECT_EQ(vtable->addr, expected->addr + shift);
+  EXPECT_EQ(vtable->size, expected->size);
+
+  // A different build of the module mustn't give a stale address
+  for (auto& mod : modules)
+    mod.buildID = "0000";
+  cached.setLoadedModules(modules);
+  EXPECT_FALSE(cached.findVtable("ns_inheritance_polymorphic::C").has_value());
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <oi/BatchIntrospectionResult.h>
+
+using namespace oi;
+using namespace oi::exporters;
+
+namespace {
+
+// Instructions for `struct S { int* p; };` with pointer chasing enabled.
+constexpr types::dy::Unit unitType{};
+constexpr types::dy::VarInt varIntType{};
+constexpr std::array<types::dy::Dynamic, 2> sumVariants{unitType, unitType};
+constexpr types::dy::Sum sumType{sumVariants};
+
+constexpr std::array<std::string_view, 1> intNames{"int"};
+constexpr std::array<std::string_view, 1> ptrNames{"int*"};
+constexpr std::array<std::string_view, 1> rootNames{"S"};
+constexpr std::array<inst::Field, 0> noFields{};
+constexpr std::array<inst::ProcessorInst, 0> noProcessors{};
+
+constexpr inst::Field intField{
+    sizeof(int), "*", intNames, noFields, noProcessors, true};
+
+void processPointer(result::Element& el,
+                    std::function<void(inst::Inst)>,
+                    ParsedData d) {
+  el.pointer = std::get<ParsedData::VarInt>(d.val).value;
+}
+
+void processPointerContent(result::Element& el,
+                           std::function<void(inst::Inst)> stack_ins,
+                           ParsedData d) {
+  auto sum = std::get<ParsedData::Sum>(d.val);
+  el.container_stats.emplace(
+      result::Element::ContainerStats{.capacity = 1, .length = sum.index});
+  if (sum.index == 1)
+    stack_ins(intField);
+}
+
+const std::array<inst::ProcessorInst, 2> ptrProcessors{
+    inst::ProcessorInst{varIntType, &processPointer},
+    inst::ProcessorInst{sumType, &processPointerContent},
+};
+const inst::Field ptrField{
+    sizeof(int*), "p", ptrNames, noFields, ptrProcessors, false};
+const std::array<inst::Field, 1> rootFields{ptrField};
+const inst::Field rootField{
+    sizeof(int*), 0, "a0", rootNames, rootFields, noProcessors, false};
+
+}  // namespace
+
+TEST(BatchIntrospectionResult, IteratesEachRoot) {
+  // ASSIGN
+  // Roots 0 and 1 point at 0x1000, root 2 points at 0x2000.
+  std::vector<uint8_t> buf{0x80, 0x20, 1, 0x80, 0x20, 0, 0x80, 0x40, 1};
+  BatchIntrospectionResult res{buf, {0, 3, 6}, inst::Inst{rootField}};
+
+  // ACT
+  std::vector<size_t> counts;
+  for (size_t i = 0; i < res.size(); ++i) {
+    size_t count = 0;
+    for ([[maybe_unused]] const auto& el : res[i])
+      ++count;
+    counts.push_back(count);
+  }
+
+  // ASSERT
+  EXPECT_EQ(counts, (std::vector<size_t>{3, 2, 3}));
+}
+
+TEST(BatchIntrospectionResult, SharedPointeesMoveToSharedBucket) {
+  // ASSIGN
+  std::vector<uint8_t> buf{0x80, 0x20, 1, 0x80, 0x20, 0, 0x80, 0x40, 1};
+  BatchIntrospectionResult res{buf, {0, 3, 6}, inst::Inst{rootField}};
+
+  // ACT
+  auto totals = res.totals();
+
+  // ASSERT
+  EXPECT_EQ(totals.roots, (std::vector<size_t>{8, 8, 12}));
+  EXPECT_EQ(totals.shared, 4);
+}
+
+TEST(BatchIntrospectionResult, OutOfRange) {
+  // ASSIGN
+  BatchIntrospectionResult res{{}, {}, inst::Inst{rootField}};
+
+  // ACT / ASSERT
+  EXPECT_EQ(res.size(), 0);
+  EXPECT_THROW(res[0], std::out_of_range);
+}
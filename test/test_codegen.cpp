@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
 #include <functional>
+#include <optional>
+#include <span>
 #include <sstream>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -202,6 +205,72 @@ TEST(CodeGenTest, ContainerAlignment) {
 )");
 }
 
+TEST(CodeGenTest, ContainerImplementationNotRead) {
+  // Counts the parts of a deferred class which are read
+  struct Loader : Class::ContentsLoader {
+    TypeGraph& typeGraph;
+    int templateParams = 0;
+    int parents = 0;
+    int members = 0;
+
+    Loader(TypeGraph& typeGraph) : typeGraph(typeGraph) {
+    }
+
+    void loadTemplateParams(const void*,
+                            std::vector<TemplateParam>& params) override {
+      templateParams++;
+      params.push_back(
+          TemplateParam{typeGraph.makeType<Primitive>(Primitive::Kind::Int32)});
+    }
+    void loadParents(const void*, std::vector<Parent>& parents) override {
+      this->parents++;
+      auto& base = typeGraph.makeType<Class>(Class::Kind::Struct, "Base", 24);
+      parents.push_back(Parent{base, 0});
+    }
+    void loadMembers(const void*, std::vector<Member>& members) override {
+      this->members++;
+      auto& impl = typeGraph.makeType<Class>(Class::Kind::Struct, "Impl", 24);
+      members.push_back(Member{impl, "__impl__", 0});
+    }
+    uint64_t loadAlign(const void*) override {
+      return 8;
+    }
+  };
+
+  TypeGraph typeGraph;
+  Loader loader{typeGraph};
+  auto& myclass = typeGraph.makeType<Class>(Class::Kind::Class, "MyClass", 24);
+  auto& vec = typeGraph.makeType<Class>(Class::Kind::Class, "std::vector", 24);
+  vec.deferContents(loader, nullptr);
+  myclass.members().push_back(Member{vec, "container", 0});
+  typeGraph.addRoot(myclass);
+
+  OICodeGen::Config config;
+  config.features[Feature::PruneTypeGraph] = true;
+  config.features[Feature::TreeBuilderV2] = true;
+  MockSymbolService symbols;
+  CodeGen codegen{config, symbols};
+  for (auto& info : getContainerInfos()) {
+    codegen.registerContainer(std::move(info));
+  }
+  codegen.transform(typeGraph);
+
+  // The container only needs the template params, and takes its alignment
+  // from the source rather than from the implementation's members
+  check(typeGraph,
+        R"(
+[0] Class: MyClass_0 [MyClass] (size: 24, align: 8)
+      Member: container_0 [container] (offset: 0, align: 8)
+[2]     Container: std::vector<int32_t> (size: 24, align: 8)
+          Param
+            Primitive: int32_t
+)",
+        "after transform");
+  EXPECT_EQ(loader.templateParams, 1);
+  EXPECT_EQ(loader.parents, 0);
+  EXPECT_EQ(loader.members, 0);
+}
+
 TEST(CodeGenTest, InheritFromContainer) {
   testTransform(R"(
 [0] Class: MyClass (size: 24)
@@ -248,3 +317,84 @@ TEST(CodeGenTest, InheritFromContainerCompat) {
           Primitive: int8_t
 )");
 }
+
+TEST(CodeGenTest, SplitTypeHandlers) {
+  OICodeGen::Config config;
+  config.features[Feature::TreeBuilderV2] = true;
+  config.features[Feature::Library] = true;
+  config.codegenUnits = 3;
+
+  TypeGraph typeGraph;
+  TypeGraphParser parser{typeGraph};
+  parser.parse(R"(
+[0] Class: ClassA (size: 8)
+      Member: b (offset: 0)
+[1]     Class: ClassB (size: 4)
+          Member: c (offset: 0)
+[2]         Class: ClassC (size: 4)
+              Member: x (offset: 0)
+                Primitive: int32_t
+)");
+
+  MockSymbolService symbols;
+  CodeGen codegen{config, symbols};
+  codegen.transform(typeGraph);
+  std::vector<std::string> units;
+  CodeGen::RootFunctionName name = CodeGen::HashedComponent{"ClassA"};
+  codegen.generate(typeGraph, units, std::span{&name, 1});
+
+  ASSERT_EQ(units.size(), 3);
+  EXPECT_NE(units[0].find("introspect_batch_"), std::string::npos);
+  EXPECT_EQ(units[1].find("introspect_"), std::string::npos);
+  EXPECT_EQ(units[2].find("introspect_"), std::string::npos);
+
+  // Each handler is instantiated by exactly one other unit, partitioned in
+  // topological order, and only declared by the entry point's unit
+  auto unitOf = [&](std::string_view cls) {
+    std::string inst = "\ntemplate class TypeHandler<IntrospectContext, ";
+    inst += cls;
+    std::string ext = "extern template class TypeHandler<IntrospectContext, ";
+    ext += cls;
+    EXPECT_NE(units[0].find(ext), std::string::npos) << cls;
+
+    std::optional<size_t> found;
+    for (size_t i = 1; i < units.size(); ++i) {
+      if (units[i].find(inst) == std::string::npos)
+        continue;
+      EXPECT_FALSE(found.has_value()) << cls;
+      found = i;
+    }
+    EXPECT_TRUE(found.has_value()) << cls;
+    return found.value_or(0);
+  };
+  size_t a = unitOf("ClassA_");
+  size_t b = unitOf("ClassB_");
+  size_t c = unitOf("ClassC_");
+  EXPECT_LE(c, b);
+  EXPECT_LE(b, a);
+}
+
+TEST(CodeGenTest, SingleUnitByDefault) {
+  OICodeGen::Config config;
+  config.features[Feature::TreeBuilderV2] = true;
+
+  TypeGraph typeGraph;
+  TypeGraphParser parser{typeGraph};
+  parser.parse(R"(
+[0] Class: ClassA (size: 4)
+      Member: x (offset: 0)
+        Primitive: int32_t
+)");
+
+  MockSymbolService symbols;
+  CodeGen codegen{config, symbols};
+  codegen.transform(typeGraph);
+  std::vector<std::string> units;
+  CodeGen::RootFunctionName name = CodeGen::HashedComponent{"ClassA"};
+  codegen.generate(typeGraph, units, std::span{&name, 1});
+
+  ASSERT_EQ(units.size(), 1);
+  EXPECT_EQ(units[0].find("extern template"), std::string::npos);
+  EXPECT_NE(units[0].find("namespace OIInternal {\nnamespace {\n"),
+            std::string::npos);
+}
@@ -1,13 +1,25 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest-death-test.h>
 #include <gtest/gtest.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
 #include <sys/mman.h>
 
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
-
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "oi/CodeGen.h"
+#include "oi/Config.h"
+#include "oi/IRGen.h"
+#include "oi/Interpreter.h"
 #include "oi/OICompiler.h"
+#include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/Types.h"
 
 using namespace oi::detail;
 
@@ -171,6 +183,215 @@ TEST(CompilerTest, CompileAndRelocateMultipleObjs) {
   munmap(relocSlab, relocSlabSize);
 }
 
+namespace {
+struct Node {
+  int32_t value;
+  Node* next;
+};
+}  // namespace
+
+TEST(CompilerTest, CompileAndRelocateIR) {
+  using namespace oi::detail::type_graph;
+  TypeGraph typeGraph;
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto& node = typeGraph.makeType<Class>(
+      Class::Kind::Struct, "Node_0", "Node", sizeof(Node));
+  auto& ptr = typeGraph.makeType<Pointer>(node);
+  node.members().push_back(Member{myint, "value", offsetof(Node, value) * 8});
+  node.members().push_back(Member{ptr, "next", offsetof(Node, next) * 8});
+
+  auto interpreter = Interpreter::compile(node);
+  ASSERT_NE(interpreter, nullptr);
+
+  llvm::LLVMContext ctx;
+  auto module = IRGen{ctx, *interpreter}.generate("introspect_node",
+                                                  "introspect_batch_node");
+  ASSERT_NE(module, nullptr);
+
+  auto tmpdir = fs::temp_directory_path() / "test-XXXXXX";
+  EXPECT_NE(mkdtemp(const_cast<char*>(tmpdir.c_str())), nullptr);
+  auto objectPath = tmpdir / "obj.o";
+
+  OICompiler compiler{std::make_shared<SymbolService>(getpid()), {}};
+  EXPECT_TRUE(compiler.compile(*module, objectPath));
+
+  const size_t relocSlabSize = 1 << 16;
+  void* relocSlab = mmap(nullptr,
+                         relocSlabSize,
+                         PROT_READ | PROT_WRITE | PROT_EXEC,
+                         MAP_ANONYMOUS | MAP_PRIVATE,
+                         -1,
+                         0);
+  EXPECT_NE(relocSlab, nullptr);
+
+  auto relocResult = compiler.applyRelocs(
+      (uintptr_t)relocSlab, {objectPath}, IRGen::runtimeSymbols());
+  ASSERT_TRUE(relocResult.has_value());
+  auto& [_, segs, jitSymbols] = relocResult.value();
+  for (const auto& [Base, Reloc, Size] : segs)
+    std::memcpy((void*)Reloc, (void*)Base, Size);
+
+  Node n1{1, nullptr};
+  Node n2{2, &n1};
+  n1.next = &n2;
+
+  // The compiled function must write exactly what the interpreter does
+  using introspectFunc = void (*)(const Node&, std::vector<uint8_t>&);
+  std::vector<uint8_t> compiled;
+  std::vector<uint8_t> interpreted;
+  ((introspectFunc)jitSymbols.at("introspect_node"))(n1, compiled);
+  interpreter->introspect(&n1, interpreted);
+  EXPECT_EQ(compiled, interpreted);
+
+  using batchFunc = void (*)(const Node* const*,
+                             size_t,
+                             std::vector<uint8_t>&,
+                             std::vector<size_t>&);
+  const Node* roots[] = {&n1, &n2};
+  std::vector<size_t> compiledOffsets;
+  std::vector<size_t> interpretedOffsets;
+  ((batchFunc)jitSymbols.at("introspect_batch_node"))(
+      roots, 2, compiled, compiledOffsets);
+  interpreter->introspectBatch(
+      (const void* const*)roots, 2, interpreted, interpretedOffsets);
+  EXPECT_EQ(compiled, interpreted);
+  EXPECT_EQ(compiledOffsets, interpretedOffsets);
+
+  munmap(relocSlab, relocSlabSize);
+}
+
+namespace {
+struct Inner {
+  int32_t x;
+  int32_t y;
+};
+struct Outer {
+  Inner a;
+  Inner b;
+  int64_t c;
+};
+
+// The results of generating, compiling and running the code for Outer
+struct SplitResults {
+  std::vector<uint8_t> single;
+  std::vector<uint8_t> batch;
+  std::vector<size_t> offsets;
+};
+
+SplitResults introspectOuter(size_t codegenUnits,
+                             const Outer* const* roots,
+                             size_t n) {
+  using namespace oi::detail::type_graph;
+  TypeGraph typeGraph;
+  auto& i32 = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto& i64 = typeGraph.makeType<Primitive>(Primitive::Kind::Int64);
+  auto& inner = typeGraph.makeType<Class>(
+      Class::Kind::Struct, "Inner_0", "Inner", sizeof(Inner));
+  inner.members().push_back(Member{i32, "x", offsetof(Inner, x) * 8});
+  inner.members().push_back(Member{i32, "y", offsetof(Inner, y) * 8});
+  auto& outer = typeGraph.makeType<Class>(
+      Class::Kind::Struct, "Outer_0", "Outer", sizeof(Outer));
+  outer.members().push_back(Member{inner, "a", offsetof(Outer, a) * 8});
+  outer.members().push_back(Member{inner, "b", offsetof(Outer, b) * 8});
+  outer.members().push_back(Member{i64, "c", offsetof(Outer, c) * 8});
+  typeGraph.addRoot(outer);
+
+  auto symbols = std::make_shared<SymbolService>(getpid());
+  OICompiler::Config compilerConfig;
+  OICodeGen::Config generatorConfig;
+  std::array<fs::path, 1> configFiles{CONFIG_FILE_PATH};
+  auto features = config::processConfigFiles(
+      configFiles,
+      {{Feature::TreeBuilderV2, true}, {Feature::Library, true}},
+      compilerConfig,
+      generatorConfig);
+  EXPECT_TRUE(features.has_value());
+  generatorConfig.features = features.value_or(FeatureSet{});
+  compilerConfig.features = generatorConfig.features;
+  generatorConfig.codegenUnits = codegenUnits;
+
+  CodeGen codegen{generatorConfig, *symbols};
+  codegen.transform(typeGraph);
+  std::vector<std::string> units;
+  CodeGen::RootFunctionName name = CodeGen::HashedComponent{"Outer"};
+  codegen.generate(typeGraph, units, std::span{&name, 1});
+  EXPECT_EQ(units.size(), codegenUnits);
+
+  auto tmpdir = fs::temp_directory_path() / "test-XXXXXX";
+  EXPECT_NE(mkdtemp(const_cast<char*>(tmpdir.c_str())), nullptr);
+  std::vector<OICompiler::Unit> compileUnits;
+  std::set<fs::path> objectPaths;
+  for (size_t i = 0; i < units.size(); ++i) {
+    auto& unit = compileUnits.emplace_back(OICompiler::Unit{
+        .code = units[i],
+        .sourcePath = tmpdir / ("src" + std::to_string(i) + ".cpp"),
+        .objectPath = tmpdir / ("obj" + std::to_string(i) + ".o"),
+    });
+    objectPaths.insert(unit.objectPath);
+  }
+
+  OICompiler compiler{symbols, compilerConfig};
+  EXPECT_TRUE(compiler.compile(compileUnits));
+
+  const size_t relocSlabSize = 1 << 22;
+  void* relocSlab = mmap(nullptr,
+                         relocSlabSize,
+                         PROT_READ | PROT_WRITE | PROT_EXEC,
+                         MAP_ANONYMOUS | MAP_PRIVATE,
+                         -1,
+                         0);
+  EXPECT_NE(relocSlab, MAP_FAILED);
+
+  SplitResults results;
+  auto relocResult =
+      compiler.applyRelocs((uintptr_t)relocSlab, objectPaths, {});
+  EXPECT_TRUE(relocResult.has_value());
+  if (!relocResult.has_value())
+    return results;
+  auto& [_, segs, jitSymbols] = relocResult.value();
+  for (const auto& [Base, Reloc, Size] : segs)
+    std::memcpy((void*)Reloc, (void*)Base, Size);
+
+  // The entry points are mangled, and only the first unit defines them
+  using introspectFunc = void (*)(const Outer&, std::vector<uint8_t>&);
+  using batchFunc = void (*)(const Outer* const*,
+                             size_t,
+                             std::vector<uint8_t>&,
+                             std::vector<size_t>&);
+  introspectFunc single = nullptr;
+  batchFunc batch = nullptr;
+  for (const auto& [symName, symAddr] : jitSymbols) {
+    if (symName.starts_with("_Z27introspect_"))
+      single = (introspectFunc)symAddr;
+    else if (symName.starts_with("_Z33introspect_batch_"))
+      batch = (batchFunc)symAddr;
+  }
+  EXPECT_NE(single, nullptr);
+  EXPECT_NE(batch, nullptr);
+  if (single != nullptr && batch != nullptr) {
+    single(*roots[0], results.single);
+    batch(roots, n, results.batch, results.offsets);
+  }
+
+  // Not unmapped: the JIT code's scratch pool holds on to its pointer sets
+  return results;
+}
+}  // namespace
+
+TEST(CompilerTest, CompileAndRelocateSplitUnits) {
+  Outer o1{{1, 2}, {3, 4}, 5};
+  Outer o2{{6, 7}, {8, 9}, 10};
+  const Outer* roots[] = {&o1, &o2};
+
+  // Code split over several units must link and behave as a single unit does
+  auto whole = introspectOuter(1, roots, 2);
+  auto split = introspectOuter(3, roots, 2);
+  ASSERT_FALSE(whole.single.empty());
+  EXPECT_EQ(split.single, whole.single);
+  EXPECT_EQ(split.batch, whole.batch);
+  EXPECT_EQ(split.offsets, whole.offsets);
+}
+
 TEST(CompilerTest, LocateOpcodes) {
   const std::array retInsts = {
       std::array{0xC2_b}, /* Return from near procedure, with immediate value */
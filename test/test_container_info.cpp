@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <vector>
+
 #include "oi/ContainerInfo.h"
+#include "oi/ContainerMatcher.h"
+
+using oi::detail::ContainerMatcher;
 
 TEST(ContainerInfoTest, matcher) {
   ContainerInfo info{"std::vector", SEQ_TYPE, "vector"};
@@ -19,3 +25,48 @@ TEST(ContainerInfoTest, matcher) {
   // Uh-oh, here's a case that I don't think regexes are powerful enough to
   // match: EXPECT_FALSE(info.matches("std::vector<int>::subtype<bool>"));
 }
+
+TEST(ContainerMatcherTest, MatchesLikeContainerInfo) {
+  std::vector<std::unique_ptr<ContainerInfo>> containers;
+  containers.push_back(
+      std::make_unique<ContainerInfo>("std::vector", SEQ_TYPE, "vector"));
+  containers.push_back(
+      std::make_unique<ContainerInfo>("std::map", STD_MAP_TYPE, "map"));
+  ContainerMatcher matcher{containers};
+
+  for (const char* name : {
+           "std::vector<int>",
+           "std::vector",
+           "std::map<int, std::vector<int>>",
+           "std::vector_other<int>",
+           "std::vector<int>::value_type",
+           "std::list<std::vector<int>>",
+           "std::map",
+           "map<int, int>",
+       }) {
+    const ContainerInfo* expected = nullptr;
+    for (const auto& info : containers) {
+      if (info->matches(name)) {
+        expected = info.get();
+        break;
+      }
+    }
+    EXPECT_EQ(matcher.match(name), expected) << name;
+    // Memoised
+    EXPECT_EQ(matcher.match(name), expected) << name;
+  }
+}
+
+TEST(ContainerMatcherTest, FirstMatchWins) {
+  std::vector<std::unique_ptr<ContainerInfo>> containers;
+  // Regex metacharacters in the name force it to be tried one by one
+  containers.push_back(
+      std::make_unique<ContainerInfo>("std::vec.or", SEQ_TYPE, "vector"));
+  containers.push_back(
+      std::make_unique<ContainerInfo>("std::vector", SEQ_TYPE, "vector"));
+  ContainerMatcher matcher{containers};
+
+  EXPECT_EQ(matcher.match("std::vector<int>"), containers[0].get());
+  EXPECT_EQ(matcher.match("std::vecXor<int>"), containers[0].get());
+  EXPECT_EQ(matcher.match("std::list<int>"), nullptr);
+}
@@ -505,15 +505,15 @@ TEST(FlattenerTest, Pointer) {
   auto myint = Primitive{Primitive::Kind::Int32};
 
   auto classB = Class{3, Class::Kind::Class, "ClassB", 4};
-  classB.members.push_back(Member{myint, "b", 0});
+  classB.members().push_back(Member{myint, "b", 0});
 
   auto classA = Class{2, Class::Kind::Class, "ClassA", 8};
-  classA.parents.push_back(Parent{classB, 0});
-  classA.members.push_back(Member{myint, "a", 4 * 8});
+  classA.parents().push_back(Parent{classB, 0});
+  classA.members().push_back(Member{myint, "a", 4 * 8});
 
   auto ptrA = Pointer{1, classA};
   auto classC = Class{0, Class::Kind::Class, "ClassC", 8};
-  classC.members.push_back(Member{ptrA, "a", 0});
+  classC.members().push_back(Member{ptrA, "a", 0});
 
   test(Flattener::createPass(),
        R"(
@@ -550,8 +550,8 @@ TEST(FlattenerTest, PointerCycle) {
   auto classA = Class{0, Class::Kind::Class, "ClassA", 69};
   auto classB = Class{1, Class::Kind::Class, "ClassB", 69};
   auto ptrA = Pointer{2, classA};
-  classA.members.push_back(Member{classB, "b", 0});
-  classB.members.push_back(Member{ptrA, "a", 0});
+  classA.members().push_back(Member{classB, "b", 0});
+  classB.members().push_back(Member{ptrA, "a", 0});
 
   test(Flattener::createPass(),
        R"(
@@ -614,12 +614,12 @@ TEST(FlattenerTest, Functions) {
   auto classB = Class{1, Class::Kind::Class, "ClassB", 0};
   auto classC = Class{2, Class::Kind::Class, "ClassC", 0};
 
-  classA.parents.push_back(Parent{classB, 0});
-  classB.parents.push_back(Parent{classC, 0});
+  classA.parents().push_back(Parent{classB, 0});
+  classB.parents().push_back(Parent{classC, 0});
 
-  classA.functions.push_back(Function{"funcA"});
-  classB.functions.push_back(Function{"funcB"});
-  classC.functions.push_back(Function{"funcC"});
+  classA.functions().push_back(Function{"funcA"});
+  classB.functions().push_back(Function{"funcB"});
+  classC.functions().push_back(Function{"funcC"});
 
   test(Flattener::createPass(),
        R"(
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "oi/type_graph/FoldEquivalentClasses.h"
+#include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/Types.h"
+
+using namespace oi::detail::type_graph;
+
+namespace {
+FoldEquivalentClasses::Folded fold(
+    const std::vector<std::reference_wrapper<Type>>& types,
+    FoldEquivalentClasses::Stats& stats) {
+  FoldEquivalentClasses::Folded folded;
+  FoldEquivalentClasses pass{folded, stats};
+  pass.fold(types);
+  return folded;
+}
+
+Class& makePoint(TypeGraph& typeGraph, const std::string& inputName) {
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto& c = typeGraph.makeType<Class>(
+      Class::Kind::Struct, inputName + "_0", inputName, 8);
+  c.members().push_back(Member{myint, "x", 0});
+  c.members().push_back(Member{myint, "y", 32});
+  return c;
+}
+}  // namespace
+
+TEST(FoldEquivalentClassesTest, FoldsIdenticalLayouts) {
+  TypeGraph typeGraph;
+  auto& a = makePoint(typeGraph, "ns1::Point");
+  auto& b = makePoint(typeGraph, "ns2::Point");
+  auto& c = makePoint(typeGraph, "ns3::Point");
+
+  FoldEquivalentClasses::Stats stats;
+  auto folded = fold({a, b, c}, stats);
+
+  ASSERT_EQ(folded.size(), 2);
+  EXPECT_EQ(folded.at(&b), &a);
+  EXPECT_EQ(folded.at(&c), &a);
+  EXPECT_EQ(stats.classes, 3);
+  EXPECT_EQ(stats.folded, 2);
+  EXPECT_EQ(stats.foldedMembers, 4);
+}
+
+TEST(FoldEquivalentClassesTest, DifferentMemberNames) {
+  TypeGraph typeGraph;
+  auto& a = makePoint(typeGraph, "ns1::Point");
+  auto& b = makePoint(typeGraph, "ns2::Point");
+  b.members()[1].name = "z";
+
+  FoldEquivalentClasses::Stats stats;
+  EXPECT_TRUE(fold({a, b}, stats).empty());
+}
+
+TEST(FoldEquivalentClassesTest, Unions) {
+  TypeGraph typeGraph;
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto& a = typeGraph.makeType<Class>(Class::Kind::Union, "U1", 4);
+  a.members().push_back(Member{myint, "x", 0});
+  auto& b = typeGraph.makeType<Class>(Class::Kind::Union, "U2", 4);
+  b.members().push_back(Member{myint, "x", 0});
+
+  FoldEquivalentClasses::Stats stats;
+  EXPECT_TRUE(fold({a, b}, stats).empty());
+}
+
+TEST(FoldEquivalentClassesTest, NestedMembers) {
+  TypeGraph typeGraph;
+  // The inner classes fold, but the outer classes report different names for
+  // their members' types, so must keep their own handlers
+  auto& innerA = makePoint(typeGraph, "ns1::Point");
+  auto& innerB = makePoint(typeGraph, "ns2::Point");
+  auto& innerC = makePoint(typeGraph, "ns1::Point");
+  auto& outerA = typeGraph.makeType<Class>(Class::Kind::Struct, "OuterA", 8);
+  outerA.members().push_back(Member{innerA, "p", 0});
+  auto& outerB = typeGraph.makeType<Class>(Class::Kind::Struct, "OuterB", 8);
+  outerB.members().push_back(Member{innerB, "p", 0});
+  auto& outerC = typeGraph.makeType<Class>(Class::Kind::Struct, "OuterC", 8);
+  outerC.members().push_back(Member{innerC, "p", 0});
+
+  FoldEquivalentClasses::Stats stats;
+  auto folded = fold({innerA, innerB, innerC, outerA, outerB, outerC}, stats);
+
+  EXPECT_EQ(folded.at(&innerB), &innerA);
+  EXPECT_EQ(folded.at(&innerC), &innerA);
+  EXPECT_FALSE(folded.contains(&outerB));
+  EXPECT_EQ(folded.at(&outerC), &outerA);
+}
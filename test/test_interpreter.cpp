@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <oi/IntrospectionResult.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "oi/Interpreter.h"
+#include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/Types.h"
+#include "test/type_graph_utils.h"
+
+using namespace oi::detail;
+using namespace oi::detail::type_graph;
+
+namespace {
+struct Node {
+  int32_t value;
+  Node* next;
+  int32_t arr[3];
+};
+
+// Node, as it would be left by CodeGen's passes
+Class& makeNode(TypeGraph& typeGraph) {
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto& node = typeGraph.makeType<Class>(
+      Class::Kind::Struct, "Node_0", "Node", sizeof(Node));
+  auto& ptr = typeGraph.makeType<Pointer>(node);
+  ptr.setInputName("Node*");
+  auto& arr = typeGraph.makeType<Array>(myint, 3);
+  arr.setInputName("int32_t[3]");
+
+  node.members().push_back(Member{myint, "value", offsetof(Node, value) * 8});
+  node.members().push_back(Member{ptr, "next", offsetof(Node, next) * 8});
+  node.members().push_back(Member{arr, "arr", offsetof(Node, arr) * 8});
+  return node;
+}
+
+void writeVarInt(std::vector<uint8_t>& v, uint64_t val) {
+  while (val >= 0x80) {
+    v.push_back(0x80 | (val & 0x7f));
+    val >>= 7;
+  }
+  v.push_back(uint8_t(val));
+}
+}  // namespace
+
+TEST(InterpreterTest, Cycle) {
+  TypeGraph typeGraph;
+  auto interp = Interpreter::compile(makeNode(typeGraph));
+  ASSERT_NE(interp, nullptr);
+
+  Node n1{1, nullptr, {}};
+  Node n2{2, &n1, {}};
+  n1.next = &n2;
+
+  std::vector<uint8_t> data;
+  interp->introspect(&n1, data);
+
+  std::vector<uint8_t> expected;
+  writeVarInt(expected, reinterpret_cast<uintptr_t>(&n2));
+  writeVarInt(expected, 1);  // n2 is new
+  writeVarInt(expected, reinterpret_cast<uintptr_t>(&n1));
+  writeVarInt(expected, 0);  // n1 has been seen
+  writeVarInt(expected, 3);  // n2.arr
+  writeVarInt(expected, 3);  // n1.arr
+  EXPECT_EQ(data, expected);
+
+  oi::IntrospectionResult result{std::move(data), interp->instructions()};
+  std::vector<std::string> names;
+  for (const auto& el : result)
+    names.emplace_back(el.name);
+  std::vector<std::string> expectedNames{
+      "a0",  "value", "next", "*",  "value", "next", "arr", "[]",
+      "[]",  "[]",    "arr",  "[]", "[]",    "[]",
+  };
+  EXPECT_EQ(names, expectedNames);
+
+  auto it = result.begin();
+  EXPECT_EQ(it->type_names[0], "Node");
+  EXPECT_EQ(it->static_size, sizeof(Node));
+  ++it;
+  ++it;
+  EXPECT_EQ(it->pointer, reinterpret_cast<uintptr_t>(&n2));
+  EXPECT_EQ(it->container_stats->length, 1);
+  ++it;
+  EXPECT_EQ(it->type_path.size(), 3);
+  ++it;
+  ++it;
+  EXPECT_EQ(it->pointer, reinterpret_cast<uintptr_t>(&n1));
+  EXPECT_EQ(it->container_stats->length, 0);
+  ++it;
+  EXPECT_EQ(it->container_stats->capacity, 3);
+  EXPECT_EQ(it->exclusive_size, 0);
+}
+
+TEST(InterpreterTest, Batch) {
+  TypeGraph typeGraph;
+  auto interp = Interpreter::compile(makeNode(typeGraph));
+  ASSERT_NE(interp, nullptr);
+
+  // The second root's pointee was already seen below the first
+  Node shared{0, nullptr, {}};
+  Node a{1, &shared, {}};
+  Node b{2, &shared, {}};
+  const void* roots[] = {&a, &b};
+
+  std::vector<uint8_t> data;
+  std::vector<size_t> offsets;
+  interp->introspectBatch(roots, 2, data, offsets);
+
+  std::vector<uint8_t> expected;
+  writeVarInt(expected, reinterpret_cast<uintptr_t>(&shared));
+  writeVarInt(expected, 1);
+  writeVarInt(expected, 0);  // shared.next
+  writeVarInt(expected, 0);
+  writeVarInt(expected, 3);  // shared.arr
+  writeVarInt(expected, 3);  // a.arr
+  size_t second = expected.size();
+  writeVarInt(expected, reinterpret_cast<uintptr_t>(&shared));
+  writeVarInt(expected, 0);
+  writeVarInt(expected, 3);  // b.arr
+
+  EXPECT_EQ(data, expected);
+  EXPECT_EQ(offsets, (std::vector<size_t>{0, second}));
+}
+
+TEST(InterpreterTest, IncompletePointee) {
+  TypeGraph typeGraph;
+  auto& incomplete = typeGraph.makeType<Incomplete>("Opaque");
+  auto& ptr = typeGraph.makeType<Pointer>(incomplete);
+  auto& c = typeGraph.makeType<Class>(Class::Kind::Struct, "Holder", 8);
+  c.members().push_back(Member{ptr, "p", 0});
+
+  auto interp = Interpreter::compile(c);
+  ASSERT_NE(interp, nullptr);
+
+  int opaque = 0;
+  void* holder = &opaque;
+  std::vector<uint8_t> data;
+  interp->introspect(&holder, data);
+
+  std::vector<uint8_t> expected;
+  writeVarInt(expected, reinterpret_cast<uintptr_t>(&opaque));
+  writeVarInt(expected, 1);
+  EXPECT_EQ(data, expected);
+
+  oi::IntrospectionResult result{std::move(data), interp->instructions()};
+  size_t elements = 0;
+  for (auto it = result.begin(); it != result.end(); ++it)
+    elements++;
+  EXPECT_EQ(elements, 2);
+}
+
+TEST(InterpreterTest, ContainersUnsupported) {
+  TypeGraph typeGraph;
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto vec = getVector();
+  vec.templateParams.push_back(TemplateParam{myint});
+  auto& c = typeGraph.makeType<Class>(Class::Kind::Struct, "Holder", 24);
+  c.members().push_back(Member{vec, "v", 0});
+
+  EXPECT_EQ(Interpreter::compile(c), nullptr);
+}
@@ -10,8 +10,8 @@ TEST(NameGenTest, ClassParams) {
   auto myparam1 = Class{0, Class::Kind::Struct, "MyParam", 13};
   auto myparam2 = Class{1, Class::Kind::Struct, "MyParam", 13};
   auto myclass = Class{2, Class::Kind::Struct, "MyClass<MyParam, MyParam>", 13};
-  myclass.templateParams.push_back(myparam1);
-  myclass.templateParams.push_back(myparam2);
+  myclass.templateParams().push_back(myparam1);
+  myclass.templateParams().push_back(myparam2);
 
   NameGen nameGen;
   nameGen.generateNames({myclass});
@@ -29,7 +29,7 @@ TEST(NameGenTest, ClassContainerParam) {
   myparam.templateParams.push_back(myint);
 
   auto myclass = Class{0, Class::Kind::Struct, "MyClass", 13};
-  myclass.templateParams.push_back(myparam);
+  myclass.templateParams().push_back(myparam);
 
   NameGen nameGen;
   nameGen.generateNames({myclass});
@@ -44,8 +44,8 @@ TEST(NameGenTest, ClassParents) {
   auto myparent1 = Class{0, Class::Kind::Struct, "MyParent", 13};
   auto myparent2 = Class{1, Class::Kind::Struct, "MyParent", 13};
   auto myclass = Class{2, Class::Kind::Struct, "MyClass", 13};
-  myclass.parents.push_back(Parent{myparent1, 0});
-  myclass.parents.push_back(Parent{myparent2, 0});
+  myclass.parents().push_back(Parent{myparent1, 0});
+  myclass.parents().push_back(Parent{myparent2, 0});
 
   NameGen nameGen;
   nameGen.generateNames({myclass});
@@ -65,21 +65,21 @@ TEST(NameGenTest, ClassMembers) {
   auto myclass = Class{2, Class::Kind::Struct, "MyClass", 13};
 
   // A class may end up with members sharing a name after flattening
-  myclass.members.push_back(Member{mymember1, "mem", 0});
-  myclass.members.push_back(Member{mymember2, "mem", 0});
+  myclass.members().push_back(Member{mymember1, "mem", 0});
+  myclass.members().push_back(Member{mymember2, "mem", 0});
 
   NameGen nameGen;
   nameGen.generateNames({myclass});
 
   EXPECT_EQ(myclass.name(), "MyClass_0");
-  EXPECT_EQ(myclass.members[0].name, "mem_0");
-  EXPECT_EQ(myclass.members[1].name, "mem_1");
+  EXPECT_EQ(myclass.members()[0].name, "mem_0");
+  EXPECT_EQ(myclass.members()[1].name, "mem_1");
   EXPECT_EQ(mymember1.name(), "MyMember_1");
   EXPECT_EQ(mymember2.name(), "MyMember_2");
 
   EXPECT_EQ(myclass.inputName(), "MyClass");
-  EXPECT_EQ(myclass.members[0].inputName, "mem");
-  EXPECT_EQ(myclass.members[1].inputName, "mem");
+  EXPECT_EQ(myclass.members()[0].inputName, "mem");
+  EXPECT_EQ(myclass.members()[1].inputName, "mem");
   EXPECT_EQ(mymember1.inputName(), "MyMember");
   EXPECT_EQ(mymember2.inputName(), "MyMember");
 }
@@ -88,16 +88,16 @@ TEST(NameGenTest, ClassMemberInvalidChar) {
   auto myclass = Class{2, Class::Kind::Struct, "MyClass", 13};
 
   auto myint = Primitive{Primitive::Kind::Int32};
-  myclass.members.push_back(Member{myint, "mem.Nope", 0});
+  myclass.members().push_back(Member{myint, "mem.Nope", 0});
 
   NameGen nameGen;
   nameGen.generateNames({myclass});
 
   EXPECT_EQ(myclass.name(), "MyClass_0");
-  EXPECT_EQ(myclass.members[0].name, "mem$Nope_0");
+  EXPECT_EQ(myclass.members()[0].name, "mem$Nope_0");
 
   EXPECT_EQ(myclass.inputName(), "MyClass");
-  EXPECT_EQ(myclass.members[0].inputName, "mem.Nope");
+  EXPECT_EQ(myclass.members()[0].inputName, "mem.Nope");
 }
 
 TEST(NameGenTest, ClassChildren) {
@@ -428,8 +428,8 @@ TEST(NameGenTest, Cycle) {
   auto classA = Class{0, Class::Kind::Class, "ClassA", 69};
   auto classB = Class{1, Class::Kind::Class, "ClassB", 69};
   auto ptrA = Pointer{2, classA};
-  classA.members.push_back(Member{classB, "b", 0});
-  classB.members.push_back(Member{ptrA, "a", 0});
+  classA.members().push_back(Member{classB, "b", 0});
+  classB.members().push_back(Member{ptrA, "a", 0});
 
   NameGen nameGen;
   nameGen.generateNames({classA});
@@ -444,7 +444,7 @@ TEST(NameGenTest, Cycle) {
 TEST(NameGenTest, ContainerCycle) {
   auto container = getVector();
   auto myclass = Class{0, Class::Kind::Class, "MyClass", 69};
-  myclass.members.push_back(Member{container, "c", 0});
+  myclass.members().push_back(Member{container, "c", 0});
   container.templateParams.push_back(TemplateParam{myclass});
 
   NameGen nameGen;
@@ -483,8 +483,8 @@ TEST(NameGenTest, AnonymousMembers) {
   auto myunion1 = Class{1, Class::Kind::Union, "", 4};
   auto myunion2 = Class{2, Class::Kind::Union, "", 4};
 
-  myclass.members.push_back(Member{myunion1, "", 0});
-  myclass.members.push_back(Member{myunion2, "", 4});
+  myclass.members().push_back(Member{myunion1, "", 0});
+  myclass.members().push_back(Member{myunion2, "", 4});
 
   NameGen nameGen;
   nameGen.generateNames({myclass, myunion1, myunion2});
@@ -492,14 +492,14 @@ TEST(NameGenTest, AnonymousMembers) {
   EXPECT_EQ(myclass.name(), "C_0");
   EXPECT_EQ(myunion1.name(), "__oi_anon_1");
   EXPECT_EQ(myunion2.name(), "__oi_anon_2");
-  EXPECT_EQ(myclass.members[0].name, "__oi_anon_0");
-  EXPECT_EQ(myclass.members[1].name, "__oi_anon_1");
+  EXPECT_EQ(myclass.members()[0].name, "__oi_anon_0");
+  EXPECT_EQ(myclass.members()[1].name, "__oi_anon_1");
 
   EXPECT_EQ(myclass.inputName(), "C");
   EXPECT_EQ(myunion1.inputName(), "__oi_anon_1");
   EXPECT_EQ(myunion2.inputName(), "__oi_anon_2");
-  EXPECT_EQ(myclass.members[0].inputName, "__oi_anon_0");
-  EXPECT_EQ(myclass.members[1].inputName, "__oi_anon_1");
+  EXPECT_EQ(myclass.members()[0].inputName, "__oi_anon_0");
+  EXPECT_EQ(myclass.members()[1].inputName, "__oi_anon_1");
 }
 
 TEST(NameGenTest, IncompleteTypes) {
@@ -0,0 +1,144 @@
+#include <clang/Tooling/CompilationDatabase.h>
+#include <gtest/gtest.h>
+#include <llvm/Object/ObjectFile.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "oi/Config.h"
+#include "oi/OIGenerator.h"
+
+using namespace oi::detail;
+
+namespace fs = std::filesystem;
+
+namespace {
+void writeFile(const fs::path& path, std::string_view contents) {
+  std::ofstream file{path};
+  file << contents;
+}
+
+std::string readFile(const fs::path& path) {
+  std::ifstream file{path};
+  return std::string{std::istreambuf_iterator<char>{file}, {}};
+}
+
+size_t countOf(std::string_view haystack, std::string_view needle) {
+  size_t count = 0;
+  for (size_t pos = haystack.find(needle); pos != std::string_view::npos;
+       pos = haystack.find(needle, pos + needle.size()))
+    ++count;
+  return count;
+}
+}  // namespace
+
+TEST(OIGeneratorTest, MultipleSitesSharingAType) {
+  auto tmpdir = fs::temp_directory_path() / "test-XXXXXX";
+  ASSERT_NE(mkdtemp(const_cast<char*>(tmpdir.c_str())), nullptr);
+
+  writeFile(tmpdir / "shared.h", R"(
+#include <cstdint>
+struct Shared {
+  int32_t a;
+  int64_t b;
+};
+)");
+  writeFile(tmpdir / "first.cpp", R"(
+#include <oi/oi.h>
+#include "shared.h"
+struct First {
+  Shared s;
+  int32_t x;
+};
+oi::IntrospectionResult first(const First& f) {
+  return oi::introspect(f);
+}
+)");
+  writeFile(tmpdir / "second.cpp", R"(
+#include <oi/oi.h>
+#include "shared.h"
+struct Second {
+  Shared s;
+  double y;
+};
+oi::IntrospectionResult second(const Second& s) {
+  return oi::introspect(s);
+}
+)");
+
+  // Parse the sources with the same headers as the generated code
+  std::vector<fs::path> configFiles{CONFIG_FILE_PATH};
+  OICompiler::Config compilerConfig;
+  OICodeGen::Config generatorConfig;
+  ASSERT_TRUE(config::processConfigFiles(
+                  configFiles, {}, compilerConfig, generatorConfig)
+                  .has_value());
+  std::vector<std::string> args{
+      "-std=c++20",
+      "-DOIL_AOT_COMPILATION=1",
+      "-I" + fs::path{OI_INCLUDE_DIR}.string(),
+  };
+  for (const auto& path : compilerConfig.sysHeaderPaths)
+    args.push_back("-isystem" + path.string());
+  clang::tooling::FixedCompilationDatabase db{tmpdir.string(), args};
+
+  auto outputPath = tmpdir / "oil.o";
+  auto sourcePath = tmpdir / "oil.cpp";
+  OIGenerator oigen;
+  oigen.setConfigFilePaths(configFiles);
+  oigen.setOutputPath(outputPath);
+  oigen.setSourceFileDumpPath(sourcePath);
+  oigen.setFailIfNothingGenerated(true);
+  oigen.setNumThreads(2);
+  ASSERT_EQ(oigen.generate(db,
+                           {(tmpdir / "first.cpp").string(),
+                            (tmpdir / "second.cpp").string()}),
+            0);
+
+  // Both sites are generated into a single object
+  size_t objects = 0;
+  for (const auto& entry : fs::directory_iterator{tmpdir})
+    objects += entry.path().extension() == ".o";
+  EXPECT_EQ(objects, 1);
+
+  // Shared is parsed from both translation units but is a single type, with a
+  // single handler
+  auto code = readFile(sourcePath);
+  std::set<std::string> sharedNames;
+  std::regex sharedName{"\\bShared_[0-9]+\\b"};
+  for (auto it = std::sregex_iterator{code.begin(), code.end(), sharedName};
+       it != std::sregex_iterator{};
+       ++it)
+    sharedNames.insert(it->str());
+  ASSERT_EQ(sharedNames.size(), 1);
+  EXPECT_EQ(countOf(code, "class TypeHandler<Ctx, " + *sharedNames.begin() +
+                              "> {"),
+            1);
+
+  // The object defines the entry points of both sites
+  auto object = llvm::object::ObjectFile::createObjectFile(outputPath.string());
+  ASSERT_TRUE(static_cast<bool>(object)) << toString(object.takeError());
+  std::set<std::string> entryPoints;
+  for (const auto& sym : object->getBinary()->symbols()) {
+    auto flags = sym.getFlags();
+    auto name = sym.getName();
+    if (!flags || !name) {
+      llvm::consumeError(flags.takeError());
+      llvm::consumeError(name.takeError());
+      continue;
+    }
+    if (*flags & llvm::object::SymbolRef::SF_Undefined)
+      continue;
+    std::string str = name->str();
+    if (str.starts_with("_ZN2oi14introspectImplI5First"))
+      entryPoints.insert("First");
+    else if (str.starts_with("_ZN2oi14introspectImplI6Second"))
+      entryPoints.insert("Second");
+  }
+  EXPECT_EQ(entryPoints, (std::set<std::string>{"First", "Second"}));
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "oi/type_graph/PassManager.h"
+#include "oi/type_graph/RemoveMembers.h"
+#include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/Types.h"
+#include "test/TypeGraphParser.h"
+
+using namespace type_graph;
+
+namespace {
+void parse(TypeGraph& typeGraph, std::string_view input) {
+  input.remove_prefix(1);  // Remove initial '\n'
+  TypeGraphParser parser{typeGraph};
+  parser.parse(input);
+}
+}  // namespace
+
+TEST(PassManagerTest, ProfileCountsRemovedNodes) {
+  TypeGraph typeGraph;
+  parse(typeGraph, R"(
+[0] Class: ClassA (size: 12)
+      Member: a (offset: 0)
+[1]     Class: ClassB (size: 4)
+      Member: b (offset: 4)
+[2]     Class: ClassC (size: 4)
+      Member: c (offset: 8)
+        Primitive: int32_t
+)");
+
+  PassManager pm;
+  pm.setProfiling(true);
+  pm.addPass(RemoveMembers::createPass({{"ClassA", "b"}}));
+  pm.run(typeGraph);
+
+  ASSERT_EQ(pm.profile().size(), 1);
+  const auto& stats = pm.profile()[0];
+  EXPECT_EQ(stats.name, "RemoveMembers");
+  EXPECT_EQ(stats.nodesBefore, 3);
+  EXPECT_EQ(stats.nodesAfter, 2);
+}
+
+TEST(PassManagerTest, NoProfileByDefault) {
+  TypeGraph typeGraph;
+  parse(typeGraph, R"(
+[0] Class: ClassA (size: 4)
+      Member: a (offset: 0)
+        Primitive: int32_t
+)");
+
+  PassManager pm;
+  pm.addPass(RemoveMembers::createPass({}));
+  pm.run(typeGraph);
+
+  EXPECT_TRUE(pm.profile().empty());
+}
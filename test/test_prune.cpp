@@ -1,9 +1,15 @@
 #include <gtest/gtest.h>
 
+#include "oi/type_graph/NodeTracker.h"
 #include "oi/type_graph/Prune.h"
+#include "oi/type_graph/TypeGraph.h"
 #include "test/type_graph_utils.h"
 
+using type_graph::Class;
+using type_graph::Function;
+using type_graph::NodeTracker;
 using type_graph::Prune;
+using type_graph::TypeGraph;
 
 TEST(PruneTest, PruneClass) {
   test(Prune::createPass(),
@@ -93,3 +99,22 @@ TEST(PruneTest, PruneContainer) {
         Primitive: int32_t
 )");
 }
+
+TEST(PruneTest, DeferredFunctionsNotRead) {
+  static bool loaded = false;
+  auto loader = [](const void*, std::vector<Function>& functions) {
+    loaded = true;
+    functions.push_back(Function{"foo"});
+  };
+
+  TypeGraph typeGraph;
+  auto& c = typeGraph.makeType<Class>(Class::Kind::Class, "MyClass", 8);
+  c.deferFunctions(loader, nullptr);
+  typeGraph.addRoot(c);
+
+  NodeTracker tracker;
+  Prune::createPass().run(typeGraph, tracker);
+
+  EXPECT_FALSE(loaded);
+  EXPECT_TRUE(c.functions().empty());
+}
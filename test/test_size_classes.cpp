@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "oi/SizeClasses.h"
+
+using oi::detail::SizeClasses;
+
+TEST(SizeClassesTest, Jemalloc) {
+  auto classes = SizeClasses::jemalloc();
+  EXPECT_EQ(classes.allocated(0), 0);
+  EXPECT_EQ(classes.allocated(1), 8);
+  EXPECT_EQ(classes.allocated(9), 16);
+  EXPECT_EQ(classes.allocated(100), 112);
+  EXPECT_EQ(classes.allocated(128), 128);
+  EXPECT_EQ(classes.allocated(129), 160);
+  EXPECT_EQ(classes.allocated(257), 320);
+  EXPECT_EQ(classes.allocated(4096), 4096);
+  EXPECT_EQ(classes.allocated(4097), 5120);
+  EXPECT_EQ(classes.allocated(1 << 20), 1 << 20);
+}
+
+TEST(SizeClassesTest, Glibc) {
+  auto classes = SizeClasses::glibc();
+  EXPECT_EQ(classes.allocated(0), 0);
+  EXPECT_EQ(classes.allocated(1), 32);
+  EXPECT_EQ(classes.allocated(24), 32);
+  EXPECT_EQ(classes.allocated(25), 48);
+  EXPECT_EQ(classes.allocated(1000), 1008);
+  EXPECT_EQ(classes.allocated(128 * 1024), 128 * 1024 + 4096);
+}
+
+TEST(SizeClassesTest, Table) {
+  SizeClasses classes{{64, 16, 256}};
+  EXPECT_EQ(classes.name(), "table");
+  EXPECT_EQ(classes.allocated(1), 16);
+  EXPECT_EQ(classes.allocated(17), 64);
+  EXPECT_EQ(classes.allocated(256), 256);
+  EXPECT_EQ(classes.allocated(257), 4096);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "oi/OIParser.h"
+#include "oi/SymbolService.h"
+
+using namespace oi::detail;
+
+namespace {
+const std::string kFunc = "oid_test_case_simple_struct";
+const std::string kVtable = "ns_inheritance_polymorphic::C";
+}  // namespace
+
+TEST(SymbolServiceTest, PrefetchedFuncDesc) {
+  SymbolService prefetched{TARGET_EXE_PATH};
+  prefetched.loadDebugInfoAsync({kFunc});
+  auto fd = prefetched.findFuncDesc({"entry", kFunc, "arg0"});
+  ASSERT_NE(fd, nullptr);
+  EXPECT_EQ(prefetched.funcDescs.at(kFunc), fd);
+
+  SymbolService lazy{TARGET_EXE_PATH};
+  auto expected = lazy.findFuncDesc({"entry", kFunc, "arg0"});
+  ASSERT_NE(expected, nullptr);
+  EXPECT_EQ(fd->symName, expected->symName);
+  EXPECT_EQ(fd->arguments.size(), expected->arguments.size());
+  EXPECT_EQ(fd->ranges.size(), expected->ranges.size());
+}
+
+TEST(SymbolServiceTest, PrefetchUnknownFunc) {
+  SymbolService symbols{TARGET_EXE_PATH};
+  symbols.loadDebugInfoAsync({"oid_test_case_does_not_exist"});
+  EXPECT_EQ(symbols.findFuncDesc({"entry", "oid_test_case_does_not_exist",
+                                  "arg0"}),
+            nullptr);
+  EXPECT_NE(symbols.findFuncDesc({"entry", kFunc, "arg0"}), nullptr);
+}
+
+TEST(SymbolServiceTest, LocateDemangledSymbol) {
+  for (unsigned jobs : {1u, 2u}) {
+    SymbolService symbols{TARGET_EXE_PATH};
+    symbols.setDebugInfoJobs(jobs);
+
+    auto mangled = symbols.locateSymbol("main");
+    auto demangled = symbols.locateSymbol("main", true);
+    ASSERT_TRUE(mangled.has_value());
+    ASSERT_TRUE(demangled.has_value());
+    EXPECT_EQ(mangled->addr, demangled->addr);
+    EXPECT_EQ(mangled->size, demangled->size);
+
+    EXPECT_FALSE(symbols.locateSymbol("not_a_symbol", true).has_value());
+  }
+}
+
+TEST(SymbolServiceTest, LocateVtables) {
+  for (unsigned jobs : {1u, 2u}) {
+    SymbolService symbols{TARGET_EXE_PATH};
+    symbols.setDebugInfoJobs(jobs);
+
+    auto vtables = symbols.locateVtables();
+    auto it = vtables.find(kVtable);
+    ASSERT_NE(it, vtables.end());
+
+    auto sym = symbols.locateSymbol("vtable for " + kVtable, true);
+    ASSERT_TRUE(sym.has_value());
+    EXPECT_EQ(it->second.addr, sym->addr);
+    EXPECT_EQ(it->second.size, sym->size);
+  }
+}
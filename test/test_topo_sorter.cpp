@@ -60,8 +60,8 @@ TEST(TopoSorterTest, ClassMembers) {
   auto mystruct = Class{0, Class::Kind::Struct, "MyStruct", 13};
   auto myenum = Enum{"MyEnum", 4};
   auto myclass = Class{1, Class::Kind::Class, "MyClass", 69};
-  myclass.members.push_back(Member{mystruct, "n", 0});
-  myclass.members.push_back(Member{myenum, "e", 4});
+  myclass.members().push_back(Member{mystruct, "n", 0});
+  myclass.members().push_back(Member{myenum, "e", 4});
 
   test({myclass}, R"(
 MyStruct
@@ -73,7 +73,7 @@ MyClass
 TEST(TopoSorterTest, Parents) {
   auto myparent = Class{0, Class::Kind::Struct, "MyParent", 13};
   auto myclass = Class{1, Class::Kind::Class, "MyClass", 69};
-  myclass.parents.push_back(Parent{myparent, 0});
+  myclass.parents().push_back(Parent{myparent, 0});
 
   test({myclass}, R"(
 MyParent
@@ -84,7 +84,7 @@ MyClass
 TEST(TopoSorterTest, TemplateParams) {
   auto myparam = Class{0, Class::Kind::Struct, "MyParam", 13};
   auto myclass = Class{1, Class::Kind::Class, "MyClass", 69};
-  myclass.templateParams.push_back(TemplateParam{myparam});
+  myclass.templateParams().push_back(TemplateParam{myparam});
 
   test({myclass}, R"(
 MyParam
@@ -95,7 +95,7 @@ MyClass
 TEST(TopoSorterTest, TemplateParamValue) {
   auto myclass = Class{1, Class::Kind::Class, "MyClass", 69};
   auto myint = Primitive{Primitive::Kind::Int32};
-  myclass.templateParams.push_back(TemplateParam{myint, "123"});
+  myclass.templateParams().push_back(TemplateParam{myint, "123"});
 
   test({myclass}, R"(
 int32_t
@@ -106,10 +106,10 @@ MyClass
 TEST(TopoSorterTest, Children) {
   auto mymember = Class{0, Class::Kind::Struct, "MyMember", 13};
   auto mychild = Class{1, Class::Kind::Struct, "MyChild", 13};
-  mychild.members.push_back(Member{mymember, "mymember", 0});
+  mychild.members().push_back(Member{mymember, "mymember", 0});
 
   auto myclass = Class{2, Class::Kind::Class, "MyClass", 69};
-  mychild.parents.push_back(Parent{myclass, 0});
+  mychild.parents().push_back(Parent{myclass, 0});
   myclass.children.push_back(mychild);
 
   std::vector<std::vector<ref<Type>>> inputs = {
@@ -140,11 +140,11 @@ TEST(TopoSorterTest, ChildrenCycle) {
   auto classA = Class{1, Class::Kind::Struct, "ClassA", 5};
   auto mychild = Class{2, Class::Kind::Struct, "MyChild", 13};
 
-  mychild.parents.push_back(Parent{myparent, 0});
+  mychild.parents().push_back(Parent{myparent, 0});
   myparent.children.push_back(mychild);
 
-  mychild.members.push_back(Member{classA, "a", 0});
-  classA.members.push_back(Member{myparent, "p", 0});
+  mychild.members().push_back(Member{classA, "a", 0});
+  classA.members().push_back(Member{myparent, "p", 0});
 
   std::vector<std::vector<ref<Type>>> inputs = {
       {myparent},
@@ -233,7 +233,7 @@ TEST(TopoSorterTest, Pointers) {
   auto mypointer = Pointer{1, classA};
 
   auto myclass = Class{2, Class::Kind::Class, "MyClass", 69};
-  myclass.members.push_back(Member{mypointer, "ptr", 0});
+  myclass.members().push_back(Member{mypointer, "ptr", 0});
 
   test({myclass}, R"(
 ClassA*
@@ -248,7 +248,7 @@ TEST(TopoSorterTest, References) {
   auto myreference = Reference{1, classA};
 
   auto myclass = Class{2, Class::Kind::Class, "MyClass", 69};
-  myclass.members.push_back(Member{myreference, "ref", 0});
+  myclass.members().push_back(Member{myreference, "ref", 0});
 
   test({myclass}, R"(
 ClassA*
@@ -261,8 +261,8 @@ TEST(TopoSorterTest, PointerCycle) {
   auto classA = Class{0, Class::Kind::Class, "ClassA", 69};
   auto classB = Class{1, Class::Kind::Class, "ClassB", 69};
   auto ptrA = Pointer{2, classA};
-  classA.members.push_back(Member{classB, "b", 0});
-  classB.members.push_back(Member{ptrA, "a", 0});
+  classA.members().push_back(Member{classB, "b", 0});
+  classB.members().push_back(Member{ptrA, "a", 0});
 
   std::vector<std::vector<ref<Type>>> inputs = {
       {classA},
@@ -288,7 +288,7 @@ TEST(TopoSorterTest, PointerToTypedef) {
   auto mypointer = Pointer{1, aliasA};
 
   auto myclass = Class{2, Class::Kind::Class, "MyClass", 69};
-  myclass.members.push_back(Member{mypointer, "ptrToTypedef", 0});
+  myclass.members().push_back(Member{mypointer, "ptrToTypedef", 0});
 
   test({myclass}, R"(
 ClassA
@@ -302,8 +302,8 @@ TEST(TopoSorterTest, TwoDeep) {
   auto myunion = Class{0, Class::Kind::Union, "MyUnion", 7};
   auto mystruct = Class{1, Class::Kind::Struct, "MyStruct", 13};
   auto myclass = Class{2, Class::Kind::Class, "MyClass", 69};
-  myclass.members.push_back(Member{mystruct, "mystruct", 0});
-  mystruct.members.push_back(Member{myunion, "myunion", 0});
+  myclass.members().push_back(Member{mystruct, "mystruct", 0});
+  mystruct.members().push_back(Member{myunion, "myunion", 0});
 
   test({myclass}, R"(
 MyUnion
@@ -316,9 +316,9 @@ TEST(TopoSorterTest, MultiplePaths) {
   auto myunion = Class{0, Class::Kind::Union, "MyUnion", 7};
   auto mystruct = Class{1, Class::Kind::Struct, "MyStruct", 13};
   auto myclass = Class{2, Class::Kind::Class, "MyClass", 69};
-  myclass.members.push_back(Member{mystruct, "mystruct", 0});
-  myclass.members.push_back(Member{myunion, "myunion1", 0});
-  mystruct.members.push_back(Member{myunion, "myunion2", 0});
+  myclass.members().push_back(Member{mystruct, "mystruct", 0});
+  myclass.members().push_back(Member{myunion, "myunion1", 0});
+  mystruct.members().push_back(Member{myunion, "myunion2", 0});
 
   test({myclass}, R"(
 MyUnion
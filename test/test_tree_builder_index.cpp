@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+
+#include "oi/TreeBuilderIndex.h"
+#include "rocksdb/slice.h"
+
+using namespace oi::detail::index;
+
+namespace {
+
+template <typename T>
+std::string pack(const T& value) {
+  msgpack::sbuffer buf;
+  msgpack::pack(buf, value);
+  return std::string{buf.data(), buf.size()};
+}
+
+std::string nodeKey(std::optional<uint64_t> group, uint64_t size, uint64_t id) {
+  std::string key = group ? groupPrefix(*group) : "";
+  appendSizeKey(key, size, id);
+  return key;
+}
+
+// A sorted column family in memory, recording how much the scans look at
+class Family {
+ public:
+  void put(std::string key, std::string value) {
+    map_.emplace(std::move(key), std::move(value));
+  }
+
+  void Seek(const rocksdb::Slice& target) {
+    it_ = map_.lower_bound(target.ToString());
+    visit();
+  }
+  bool Valid() const {
+    return it_ != map_.end();
+  }
+  void Next() {
+    ++it_;
+    visit();
+  }
+  rocksdb::Slice key() const {
+    return it_->first;
+  }
+  rocksdb::Slice value() {
+    reads++;
+    return it_->second;
+  }
+
+  // Keys iterated over, and values read
+  std::vector<std::string> seen;
+  size_t reads = 0;
+
+ private:
+  std::map<std::string, std::string> map_;
+  std::map<std::string, std::string>::const_iterator it_ = map_.end();
+
+  void visit() {
+    if (Valid())
+      seen.push_back(it_->first);
+  }
+};
+
+std::vector<uint64_t> ids(const std::vector<IndexEntry>& entries) {
+  std::vector<uint64_t> ids;
+  for (const auto& entry : entries)
+    ids.push_back(entry.id);
+  return ids;
+}
+
+}  // namespace
+
+TEST(TreeBuilderIndexTest, SizeKeysOrderLargestFirst) {
+  std::vector<std::string> keys{
+      nodeKey(std::nullopt, 10, 5),
+      nodeKey(std::nullopt, 100, 7),
+      nodeKey(std::nullopt, 0, 1),
+      nodeKey(std::nullopt, 100, 3),
+      nodeKey(std::nullopt, uint64_t{1} << 40, 9),
+  };
+  std::sort(keys.begin(), keys.end());
+
+  EXPECT_EQ(keys,
+            (std::vector<std::string>{
+                nodeKey(std::nullopt, uint64_t{1} << 40, 9),
+                nodeKey(std::nullopt, 100, 3),
+                nodeKey(std::nullopt, 100, 7),
+                nodeKey(std::nullopt, 10, 5),
+                nodeKey(std::nullopt, 0, 1),
+            }));
+}
+
+TEST(TreeBuilderIndexTest, GroupPrefix) {
+  EXPECT_EQ(groupPrefix(1), std::string("\0\0\0\0\0\0\0\1", 8));
+  EXPECT_EQ(groupPrefix(0x0102), std::string("\0\0\0\0\0\0\1\2", 8));
+
+  // Groups stay together in ID order, each ordered by size
+  std::vector<std::string> keys{
+      nodeKey(256, 1000, 1),
+      nodeKey(2, 1, 2),
+      nodeKey(2, 50, 3),
+      nodeKey(1, 5, 4),
+  };
+  std::sort(keys.begin(), keys.end());
+  EXPECT_EQ(keys,
+            (std::vector<std::string>{
+                nodeKey(1, 5, 4),
+                nodeKey(2, 50, 3),
+                nodeKey(2, 1, 2),
+                nodeKey(256, 1000, 1),
+            }));
+}
+
+TEST(TreeBuilderIndexTest, LiteralPrefix) {
+  EXPECT_EQ(literalPrefix("ns::Foo"), "ns::Foo");
+  EXPECT_EQ(literalPrefix("ns::*"), "ns::");
+  EXPECT_EQ(literalPrefix("a?c"), "a");
+  EXPECT_EQ(literalPrefix("[ab]*"), "");
+  EXPECT_EQ(literalPrefix("a\\*"), "a");
+}
+
+TEST(TreeBuilderIndexTest, ForEachStatsScansPrefix) {
+  Family stats;
+  for (auto key : {"a/b", "ns::A", "ns::Abc", "ns::B", "other::A"})
+    stats.put(key, pack(IndexStats{.id = 1, .count = 2}));
+
+  std::vector<std::string> found;
+  forEachStats(stats,
+               std::optional<std::string>{"ns::A*"},
+               [&](const std::string& key, const IndexStats& s) {
+                 EXPECT_EQ(s.count, 2);
+                 found.push_back(key);
+               });
+  EXPECT_EQ(found, (std::vector<std::string>{"ns::A", "ns::Abc"}));
+  // Stops at the first key past the literal prefix
+  EXPECT_EQ(stats.seen,
+            (std::vector<std::string>{"ns::A", "ns::Abc", "ns::B"}));
+  EXPECT_EQ(stats.reads, 2);
+
+  // Globs match within the prefix, and no glob matches everything
+  found.clear();
+  forEachStats(stats,
+               std::optional<std::string>{"ns::?"},
+               [&](const std::string& key, const IndexStats&) {
+                 found.push_back(key);
+               });
+  EXPECT_EQ(found, (std::vector<std::string>{"ns::A", "ns::B"}));
+
+  found.clear();
+  forEachStats(stats, std::nullopt, [&](const std::string& key, auto) {
+    found.push_back(key);
+  });
+  EXPECT_EQ(found.size(), 5);
+}
+
+TEST(TreeBuilderIndexTest, ReadLargest) {
+  Family byType;
+  auto put = [&](uint64_t group, uint64_t size, uint64_t id) {
+    byType.put(nodeKey(group, size, id),
+               pack(IndexEntry{
+                   .id = id, .inclusiveSize = size, .exclusiveSize = size}));
+  };
+  put(1, 5, 10);
+  put(1, 50, 11);
+  put(1, 20, 12);
+  put(2, 100, 13);
+
+  auto acceptAll = [](const IndexEntry&) { return true; };
+  std::vector<IndexEntry> entries;
+  readLargest(byType, groupPrefix(1), 2, acceptAll, entries);
+  EXPECT_EQ(ids(entries), (std::vector<uint64_t>{11, 12}));
+  EXPECT_EQ(entries[0].inclusiveSize, 50);
+  // Only the top entries are read
+  EXPECT_EQ(byType.reads, 2);
+
+  // Rejected entries don't count towards the top, and the scan stops at the
+  // end of the group
+  entries.clear();
+  byType.seen.clear();
+  byType.reads = 0;
+  readLargest(
+      byType,
+      groupPrefix(1),
+      10,
+      [](const IndexEntry& entry) { return entry.id != 11; },
+      entries);
+  EXPECT_EQ(ids(entries), (std::vector<uint64_t>{12, 10}));
+  EXPECT_EQ(byType.reads, 3);
+  EXPECT_EQ(byType.seen.back(), nodeKey(2, 100, 13));
+
+  entries.clear();
+  readLargest(byType, groupPrefix(3), 10, acceptAll, entries);
+  EXPECT_TRUE(entries.empty());
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include "oi/type_graph/TypeGraph.h"
+#include "oi/type_graph/TypeGraphHasher.h"
+#include "oi/type_graph/Types.h"
+
+using namespace oi::detail::type_graph;
+
+namespace {
+uint64_t hashStruct(NodeId structId,
+                    NodeId ptrId,
+                    uint64_t memberOffset,
+                    bool addSecondRoot) {
+  TypeGraph typeGraph;
+  auto& myint = typeGraph.makeType<Primitive>(Primitive::Kind::Int32);
+  auto& mystruct =
+      typeGraph.makeType<Class>(structId, Class::Kind::Struct, "MyStruct", 16);
+  auto& ptr = typeGraph.makeType<Pointer>(ptrId, mystruct);
+  mystruct.members().push_back(Member{myint, "n", 0});
+  mystruct.members().push_back(Member{ptr, "next", memberOffset});
+
+  typeGraph.addRoot(mystruct);
+  if (addSecondRoot)
+    typeGraph.addRoot(myint);
+  return TypeGraphHasher::hash(typeGraph);
+}
+}  // namespace
+
+TEST(TypeGraphHasherTest, IgnoresNodeIds) {
+  EXPECT_EQ(hashStruct(0, 1, 64, false), hashStruct(7, 3, 64, false));
+}
+
+TEST(TypeGraphHasherTest, LayoutChange) {
+  EXPECT_NE(hashStruct(0, 1, 64, false), hashStruct(0, 1, 32, false));
+}
+
+TEST(TypeGraphHasherTest, RootsChange) {
+  EXPECT_NE(hashStruct(0, 1, 64, false), hashStruct(0, 1, 64, true));
+}
@@ -52,6 +52,17 @@ static llvm::cl::opt<std::string> DumpJit(
     llvm::cl::desc(R"(Write the generated code to a file.)"),
     llvm::cl::init("jit.cpp"),
     llvm::cl::cat(OilgenCategory));
+static llvm::cl::opt<std::string> CacheDir(
+    "cache-dir",
+    llvm::cl::desc(R"(Reuse objects generated for unchanged types from this )"
+                   R"(directory.)"),
+    llvm::cl::cat(OilgenCategory));
+static llvm::cl::opt<unsigned> Jobs(
+    "jobs",
+    llvm::cl::desc(R"(Number of source files to parse concurrently. 0 uses )"
+                   R"(every hardware thread.)"),
+    llvm::cl::init(0),
+    llvm::cl::cat(OilgenCategory));
 
 int main(int argc, const char* argv[]) {
   google::InitGoogleLogging(argv[0]);
@@ -87,6 +98,9 @@ int main(int argc, const char* argv[]) {
     oigen.setSourceFileDumpPath(DumpJit.getValue());
 
   oigen.setOutputPath(OutputFile.getValue());
+  oigen.setNumThreads(Jobs.getValue());
+  if (CacheDir.getNumOccurrences())
+    oigen.setCacheDirectory(CacheDir.getValue());
 
   oigen.setFailIfNothingGenerated(true);
   return oigen.generate(compilations, options.getSourcePathList());
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <oi/exporters/Diff.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <msgpack.hpp>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "oi/OIOpts.h"
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+
+namespace fs = std::filesystem;
+
+using oi::exporters::Diff;
+using oi::exporters::DiffNode;
+
+constexpr static OIOpts opts{
+    OIOpt{'h', "help", no_argument, nullptr, "Print this message and exit"},
+    OIOpt{'m',
+          "min-delta",
+          required_argument,
+          "BYTES",
+          "Only print nodes whose size changed by at least BYTES"},
+};
+
+static void usage(std::ostream& out) {
+  out << "Compare two RocksDB outputs of oid for the same object, e.g. taken\n";
+  out << "some time apart, and print the nodes which were added, removed or\n";
+  out << "changed size, children first.\n";
+  out << "\nusage: oird [opts...] [--] <old_db_dir> <new_db_dir>\n";
+  out << "\noutput: kind, delta, old size, new size, path, type name\n";
+  out << opts << std::endl;
+}
+
+template <typename... Args>
+[[noreturn]] static void fatal_error(Args&&... args) {
+  std::cerr << "error: ";
+  (std::cerr << ... << args);
+  std::cerr << "\n\n";
+
+  usage(std::cerr);
+  exit(EXIT_FAILURE);
+}
+
+namespace {
+
+using NodeID = uint64_t;
+
+// Field indexes in TreeBuilder's serialized DBHeader and Node
+constexpr size_t kHeaderRootIDs = 1;
+constexpr size_t kNodeName = 1;
+constexpr size_t kNodeTypeName = 2;
+constexpr size_t kNodeChildren = 10;
+constexpr size_t kNodeExclusiveSize = 12;
+
+constexpr NodeID ROOT_NODE_ID = 0;
+
+/*
+ * Walks the nodes of a TreeBuilder database in pre-order, holding one range
+ * of child IDs per level.
+ */
+class NodeCursor {
+ public:
+  explicit NodeCursor(const fs::path& dbpath) {
+    rocksdb::Options options{};
+    options.create_if_missing = false;
+
+    std::vector<std::string> familyNames;
+    if (auto status = rocksdb::DB::ListColumnFamilies(
+            options, dbpath.string(), &familyNames);
+        !status.ok()) {
+      familyNames = {rocksdb::kDefaultColumnFamilyName};
+    }
+    std::vector<rocksdb::ColumnFamilyDescriptor> families;
+    for (auto& name : familyNames)
+      families.emplace_back(name, options);
+
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
+    rocksdb::DB* db = nullptr;
+    if (auto status = rocksdb::DB::OpenForReadOnly(
+            options, dbpath.string(), families, &handles, &db);
+        !status.ok()) {
+      std::cerr << "Failed to open DB '" << dbpath.string()
+                << "': " << status.ToString() << "\n";
+      exit(EXIT_FAILURE);
+    }
+    db_.reset(db);
+    for (auto* handle : handles)
+      db_->DestroyColumnFamilyHandle(handle);
+
+    auto header = get(ROOT_NODE_ID);
+    if (!header.has_value()) {
+      std::cerr << "DB '" << dbpath.string() << "' has no header\n";
+      exit(EXIT_FAILURE);
+    }
+    header->get().via.array.ptr[kHeaderRootIDs].convert(rootIDs_);
+  }
+
+  ~NodeCursor() {
+    db_->Close();
+  }
+
+  const DiffNode* peek() {
+    if (!loaded_ && !load())
+      return nullptr;
+    return &node_;
+  }
+
+  void advance() {
+    if (children_.has_value() && children_->first < children_->second)
+      stack_.push_back(*children_);
+    loaded_ = false;
+  }
+
+ private:
+  std::unique_ptr<rocksdb::DB> db_;
+  std::vector<NodeID> rootIDs_;
+  size_t nextRoot_ = 0;
+  // The remaining children of each ancestor of the next node
+  std::vector<std::pair<NodeID, NodeID>> stack_;
+
+  bool loaded_ = false;
+  DiffNode node_{};
+  std::string name_;
+  std::string typeName_;
+  std::optional<std::pair<NodeID, NodeID>> children_;
+
+  std::optional<msgpack::object_handle> get(NodeID id) {
+    std::string data;
+    if (auto status =
+            db_->Get(rocksdb::ReadOptions(), std::to_string(id), &data);
+        !status.ok()) {
+      return std::nullopt;
+    }
+    return msgpack::unpack(data.data(), data.size());
+  }
+
+  bool load() {
+    while (!stack_.empty() && stack_.back().first == stack_.back().second)
+      stack_.pop_back();
+
+    NodeID id;
+    if (!stack_.empty())
+      id = stack_.back().first++;
+    else if (nextRoot_ < rootIDs_.size())
+      id = rootIDs_[nextRoot_++];
+    else
+      return false;
+
+    // The stack holds the node's ancestors, so roots are at depth 1
+    const size_t depth = stack_.size() + 1;
+
+    auto handle = get(id);
+    if (!handle.has_value()) {
+      std::cerr << "Missing node " << id << "\n";
+      exit(EXIT_FAILURE);
+    }
+    const auto& fields = handle->get().via.array;
+    fields.ptr[kNodeName].convert(name_);
+    fields.ptr[kNodeTypeName].convert(typeName_);
+    fields.ptr[kNodeChildren].convert(children_);
+
+    node_ = DiffNode{
+        .depth = depth,
+        .name = name_,
+        .typeName = typeName_,
+        .key = std::monostate{},
+        .exclusiveSize = fields.ptr[kNodeExclusiveSize].as<size_t>(),
+    };
+    loaded_ = true;
+    return true;
+  }
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t minDelta = 0;
+
+  int c = '\0';
+  while ((c = getopt_long(
+              argc, argv, opts.shortOpts(), opts.longOpts(), nullptr)) != -1) {
+    switch (c) {
+      case 'h':
+        usage(std::cout);
+        exit(EXIT_SUCCESS);
+
+      case 'm': {
+        char* end = nullptr;
+        minDelta = std::strtoul(optarg, &end, 10);
+        if (*end != '\0')
+          fatal_error("invalid number of bytes: ", optarg);
+        break;
+      }
+
+      case ':':
+        fatal_error("missing option argument");
+      case '?':
+        fatal_error("invalid option");
+      default:
+        fatal_error("invalid option");
+    }
+  }
+
+  if (argc - optind < 2)
+    fatal_error("missing arguments");
+  else if (argc - optind > 2)
+    fatal_error("too many arguments");
+
+  NodeCursor oldCursor{argv[optind]};
+  NodeCursor newCursor{argv[optind + 1]};
+
+  Diff diff{std::cout};
+  diff.setMinDelta(minDelta);
+  diff.print(oldCursor, newCursor);
+
+  std::cerr << "Total: " << diff.oldTotal() << " -> " << diff.newTotal()
+            << " bytes\n";
+  return 0;
+}
@@ -80,6 +80,14 @@ struct Node {
     MSGPACK_DEFINE_ARRAY(length, capacity, elementStaticSize)
   };
 
+  struct HashTableStats {
+    size_t buckets;
+    size_t emptyBuckets;
+    size_t longestChain;
+    size_t overflowedBuckets;
+    MSGPACK_DEFINE_ARRAY(buckets, emptyBuckets, longestChain, overflowedBuckets)
+  };
+
   /**
    * The unique identifier for this node, used as the key for this
    * node's entry in RocksDB.
@@ -137,6 +145,19 @@ struct Node {
    */
   size_t exclusiveSize{};
 
+  /**
+   * `dynamicSize` rounded up to the allocator's size classes. Absent before
+   * version 4, and the same as `dynamicSize` unless oid was run with
+   * allocator-size-classes.
+   */
+  size_t allocatedSize{};
+
+  /**
+   * Bucket occupancy of hash tables. Absent before version 5, and unless oid
+   * was run with hash-table-stats.
+   */
+  std::optional<HashTableStats> hashTableStats{std::nullopt};
+
   MSGPACK_DEFINE_ARRAY(id,
                        name,
                        typeName,
@@ -149,7 +170,9 @@ struct Node {
                        pointer,
                        children,
                        isset,
-                       exclusiveSize)
+                       exclusiveSize,
+                       allocatedSize,
+                       hashTableStats)
 };
 
 std::ostream& operator<<(std::ostream& os, const Node& node) {
@@ -160,6 +183,7 @@ std::ostream& operator<<(std::ostream& os, const Node& node) {
   os << "  Is typedef node: " << node.isTypedef << "\n";
   os << "  Static size: " << node.staticSize << "\n";
   os << "  Dynamic size: " << node.dynamicSize << "\n";
+  os << "  Allocated size: " << node.allocatedSize << "\n";
   os << "  Padding savings: "
      << (node.paddingSavingsSize ? *node.paddingSavingsSize : -1) << "\n";
   if (node.containerStats) {
@@ -171,6 +195,14 @@ std::ostream& operator<<(std::ostream& os, const Node& node) {
   } else {
     os << "  Container stats not available\n";
   }
+  if (node.hashTableStats) {
+    const auto& stats = *node.hashTableStats;
+    os << "  Hash table stats:\n";
+    os << "    Buckets: " << stats.buckets << "\n";
+    os << "    Empty buckets: " << stats.emptyBuckets << "\n";
+    os << "    Longest chain: " << stats.longestChain << "\n";
+    os << "    Overflowed buckets: " << stats.overflowedBuckets << "\n";
+  }
   if (node.pointer.has_value()) {
     os << "  Pointer: " << reinterpret_cast<void*>(node.pointer.value())
        << "\n";
@@ -222,10 +254,24 @@ int main(int argc, const char** argv) {
   };
   auto db = std::unique_ptr<rocksdb::DB, decltype(close_db)>{nullptr};
 
+  // Since v3 the database may hold index column families next to the nodes,
+  // which must all be opened even though only the nodes are read.
+  std::vector<std::string> familyNames;
+  if (auto status = rocksdb::DB::ListColumnFamilies(
+          options, dbpath.string(), &familyNames);
+      !status.ok()) {
+    familyNames = {rocksdb::kDefaultColumnFamilyName};
+  }
+  std::vector<rocksdb::ColumnFamilyDescriptor> families;
+  for (auto& name : familyNames)
+    families.emplace_back(name, options);
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+
   {  // Open the database, then safely store its pointer in a unique_ptr for
      // lifetime management.
     rocksdb::DB* _db = nullptr;
-    if (auto status = rocksdb::DB::Open(options, dbpath.string(), &_db);
+    if (auto status = rocksdb::DB::Open(
+            options, dbpath.string(), families, &handles, &_db);
         !status.ok()) {
       fprintf(stderr,
               "Failed to open DB '%s' with error %s\n",
@@ -235,6 +281,8 @@ int main(int argc, const char** argv) {
     }
     db.reset(_db);
   }
+  for (auto* handle : handles)
+    db->DestroyColumnFamilyHandle(handle);
 
   // Iterate over the given ranges...
   for (const auto& range : ranges) {
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <msgpack.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "oi/OIOpts.h"
+#include "oi/TreeBuilderIndex.h"
+#include "rocksdb/db.h"
+#include "rocksdb/options.h"
+
+namespace fs = std::filesystem;
+
+using namespace oi::detail::index;
+
+constexpr static OIOpts opts{
+    OIOpt{'h', "help", no_argument, nullptr, "Print this message and exit"},
+    OIOpt{'k',
+          "top",
+          required_argument,
+          "N",
+          "Number of results to print (default: 20)"},
+    OIOpt{'t',
+          "type",
+          required_argument,
+          "GLOB",
+          "Only consider type names matching GLOB"},
+    OIOpt{'p',
+          "path",
+          required_argument,
+          "GLOB",
+          "Only consider paths matching GLOB. A path is the typePath of each\n"
+          "node from the root, joined with '/'"},
+    OIOpt{'s',
+          "sort",
+          required_argument,
+          "KEY",
+          "Sort types and paths by 'exclusive' (default), 'inclusive' or\n"
+          "'count'"},
+};
+
+static void usage(std::ostream& out) {
+  out << "Query the indexes in the RocksDB output of oid, written with\n";
+  out << "--rocksdb-index (v6 and later).\n";
+  out << "\nusage: oirq [opts...] [--] <db_dir> <query>\n";
+  out << "\nqueries:\n";
+  out << "  nodes  the largest nodes by inclusive size. Their full paths are\n";
+  out << "         only printed with --path, otherwise their typePath.\n";
+  out << "  types  the type names with the largest total size\n";
+  out << "  paths  the paths with the largest total size\n";
+  out << "\nInclusive totals count nested nodes once per level of nesting,\n";
+  out << "exclusive totals count each byte once.\n";
+  out << opts << std::endl;
+}
+
+template <typename... Args>
+[[noreturn]] static void fatal_error(Args&&... args) {
+  std::cerr << "error: ";
+  (std::cerr << ... << args);
+  std::cerr << "\n\n";
+
+  usage(std::cerr);
+  exit(EXIT_FAILURE);
+}
+
+namespace {
+
+struct Query {
+  size_t top = 20;
+  std::optional<std::string> typeGlob;
+  std::optional<std::string> pathGlob;
+  enum class Sort { Exclusive, Inclusive, Count } sort = Sort::Exclusive;
+};
+
+class IndexReader {
+ public:
+  explicit IndexReader(const fs::path& dbpath) {
+    rocksdb::Options options{};
+    options.create_if_missing = false;
+
+    std::vector<rocksdb::ColumnFamilyDescriptor> families{
+        {rocksdb::kDefaultColumnFamilyName, options}};
+    for (auto name : kFamilies)
+      families.emplace_back(std::string{name}, options);
+
+    rocksdb::DB* db = nullptr;
+    if (auto status = rocksdb::DB::OpenForReadOnly(
+            options, dbpath.string(), families, &handles_, &db);
+        !status.ok()) {
+      std::cerr << "Failed to open the indexes of DB '" << dbpath.string()
+                << "': " << status.ToString() << "\n";
+      exit(EXIT_FAILURE);
+    }
+    db_.reset(db);
+  }
+
+  ~IndexReader() {
+    for (auto* handle : handles_)
+      db_->DestroyColumnFamilyHandle(handle);
+    db_->Close();
+  }
+
+  // The fields of a node to print, see TreeBuilder::Node for the layout
+  struct Node {
+    std::string typeName;
+    std::string typePath;
+  };
+
+  std::optional<Node> readNode(uint64_t id) {
+    std::string value;
+    if (!db_->Get(rocksdb::ReadOptions{}, std::to_string(id), &value).ok())
+      return std::nullopt;
+
+    auto handle = msgpack::unpack(value.data(), value.size());
+    const auto& obj = handle.get();
+    if (obj.type != msgpack::type::ARRAY || obj.via.array.size < 4)
+      return std::nullopt;
+    const auto* fields = obj.via.array.ptr;
+    return Node{
+        .typeName = fields[2].as<std::string>(),
+        .typePath = fields[3].as<std::string>(),
+    };
+  }
+
+  std::unique_ptr<rocksdb::Iterator> iterate(std::string_view family) {
+    auto it = std::ranges::find(kFamilies, family);
+    // handles_[0] is the default family
+    auto* handle = handles_[1 + (it - std::begin(kFamilies))];
+    return std::unique_ptr<rocksdb::Iterator>{
+        db_->NewIterator(rocksdb::ReadOptions{}, handle)};
+  }
+
+ private:
+  std::unique_ptr<rocksdb::DB> db_;
+  std::vector<rocksdb::ColumnFamilyHandle*> handles_;
+};
+
+// A node to print, with its full path when the query found it by path
+struct Result {
+  IndexEntry entry;
+  std::string path;
+};
+
+void printNodes(IndexReader& reader, std::vector<Result>& results, size_t top) {
+  auto larger = [](const Result& a, const Result& b) {
+    return std::tie(b.entry.inclusiveSize, a.entry.id) <
+           std::tie(a.entry.inclusiveSize, b.entry.id);
+  };
+  size_t n = std::min(top, results.size());
+  std::partial_sort(
+      results.begin(), results.begin() + n, results.end(), larger);
+
+  std::cout << std::setw(16) << "inclusive" << std::setw(16) << "exclusive"
+            << std::setw(12) << "id"
+            << "  type  path\n";
+  for (size_t i = 0; i < n; i++) {
+    const auto& [entry, path] = results[i];
+    auto node = reader.readNode(entry.id);
+    std::cout << std::setw(16) << entry.inclusiveSize << std::setw(16)
+              << entry.exclusiveSize << std::setw(12) << entry.id << "  "
+              << (node ? node->typeName : "?") << "  "
+              << (!path.empty() ? path : node ? node->typePath : "?") << "\n";
+  }
+}
+
+/*
+ * Without filters the answer is the start of by_size. With a filter, the
+ * matching type names or paths are found in their stats, and the largest
+ * nodes of each are merged. A path filter is preferred as paths are the
+ * more selective key; the type filter is then checked on each node read.
+ */
+void queryNodes(IndexReader& reader, const Query& query) {
+  std::vector<Result> results;
+  std::vector<IndexEntry> entries;
+  auto acceptAll = [](const IndexEntry&) { return true; };
+  auto collect = [&](std::string path = {}) {
+    for (auto& entry : entries)
+      results.push_back({entry, path});
+    entries.clear();
+  };
+
+  if (!query.typeGlob && !query.pathGlob) {
+    auto it = reader.iterate(kBySize);
+    readLargest(*it, "", query.top, acceptAll, entries);
+    collect();
+  } else if (query.pathGlob) {
+    auto it = reader.iterate(kByTypePath);
+    auto acceptType = [&](const IndexEntry& entry) {
+      if (!query.typeGlob)
+        return true;
+      auto node = reader.readNode(entry.id);
+      return node && matches(query.typeGlob, node->typeName);
+    };
+    auto stats = reader.iterate(kPathStats);
+    forEachStats(*stats,
+                 query.pathGlob,
+                 [&](const std::string& path, const IndexStats& pathStats) {
+                   readLargest(*it,
+                               groupPrefix(pathStats.id),
+                               query.top,
+                               acceptType,
+                               entries);
+                   collect(path);
+                 });
+  } else {
+    auto it = reader.iterate(kByTypeName);
+    auto stats = reader.iterate(kTypeStats);
+    forEachStats(*stats,
+                 query.typeGlob,
+                 [&](const std::string&, const IndexStats& typeStats) {
+                   readLargest(*it,
+                               groupPrefix(typeStats.id),
+                               query.top,
+                               acceptAll,
+                               entries);
+                   collect();
+                 });
+  }
+
+  printNodes(reader, results, query.top);
+}
+
+void queryStats(IndexReader& reader,
+                std::string_view family,
+                const std::optional<std::string>& glob,
+                const Query& query) {
+  std::vector<std::pair<std::string, IndexStats>> groups;
+  auto it = reader.iterate(family);
+  forEachStats(
+      *it, glob, [&](const std::string& key, const IndexStats& stats) {
+        groups.emplace_back(key, stats);
+      });
+
+  auto sortKey = [&](const IndexStats& stats) {
+    switch (query.sort) {
+      case Query::Sort::Inclusive:
+        return stats.inclusiveSize;
+      case Query::Sort::Count:
+        return stats.count;
+      case Query::Sort::Exclusive:
+        break;
+    }
+    return stats.exclusiveSize;
+  };
+  size_t n = std::min(query.top, groups.size());
+  std::partial_sort(
+      groups.begin(),
+      groups.begin() + n,
+      groups.end(),
+      [&](const auto& a, const auto& b) {
+        return sortKey(a.second) > sortKey(b.second) ||
+               (sortKey(a.second) == sortKey(b.second) && a.first < b.first);
+      });
+
+  std::cout << std::setw(12) << "count" << std::setw(16) << "inclusive"
+            << std::setw(16) << "exclusive"
+            << "  " << (family == kTypeStats ? "type" : "path") << "\n";
+  for (size_t i = 0; i < n; i++) {
+    const auto& [key, stats] = groups[i];
+    std::cout << std::setw(12) << stats.count << std::setw(16)
+              << stats.inclusiveSize << std::setw(16) << stats.exclusiveSize
+              << "  " << key << "\n";
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Query query;
+
+  int c = '\0';
+  while ((c = getopt_long(
+              argc, argv, opts.shortOpts(), opts.longOpts(), nullptr)) != -1) {
+    switch (c) {
+      case 'h':
+        usage(std::cout);
+        exit(EXIT_SUCCESS);
+
+      case 'k': {
+        char* end = nullptr;
+        query.top = std::strtoul(optarg, &end, 10);
+        if (*end != '\0' || query.top == 0)
+          fatal_error("invalid number of results: ", optarg);
+        break;
+      }
+      case 't':
+        query.typeGlob = optarg;
+        break;
+      case 'p':
+        query.pathGlob = optarg;
+        break;
+      case 's':
+        if (std::string_view{optarg} == "exclusive")
+          query.sort = Query::Sort::Exclusive;
+        else if (std::string_view{optarg} == "inclusive")
+          query.sort = Query::Sort::Inclusive;
+        else if (std::string_view{optarg} == "count")
+          query.sort = Query::Sort::Count;
+        else
+          fatal_error("invalid sort key: ", optarg);
+        break;
+
+      case ':':
+        fatal_error("missing option argument");
+      case '?':
+        fatal_error("invalid option");
+      default:
+        fatal_error("invalid option");
+    }
+  }
+
+  if (argc - optind < 2)
+    fatal_error("missing arguments");
+  else if (argc - optind > 2)
+    fatal_error("too many arguments");
+
+  fs::path dbpath{argv[optind]};
+  std::string_view kind{argv[optind + 1]};
+  if (!fs::is_directory(dbpath))
+    fatal_error("not a directory: ", dbpath.string());
+
+  IndexReader reader{dbpath};
+  if (kind == "nodes") {
+    queryNodes(reader, query);
+  } else if (kind == "types") {
+    if (query.pathGlob)
+      fatal_error("--path can't filter types, type totals aren't per path");
+    queryStats(reader, kTypeStats, query.typeGlob, query);
+  } else if (kind == "paths") {
+    if (query.typeGlob)
+      fatal_error("--type can't filter paths, path totals aren't per type");
+    queryStats(reader, kPathStats, query.pathGlob, query);
+  } else {
+    fatal_error("unknown query: ", kind);
+  }
+
+  return 0;
+}
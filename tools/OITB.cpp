@@ -137,6 +137,16 @@ operator<<(std::ostream& out, TreeBuilder::Config tbc) {
   out << "\n  genPaddingStats = " << tbc.features[Feature::GenPaddingStats];
   out << "\n  dumpDataSegment = " << tbc.dumpDataSegment;
   out << "\n  jsonPath = " << (tbc.jsonPath ? *tbc.jsonPath : "NONE");
+  out << "\n  flameGraphPath = "
+      << (tbc.flameGraphPath ? *tbc.flameGraphPath : "NONE");
+  out << "\n  typeHistogramPath = "
+      << (tbc.typeHistogramPath ? *tbc.typeHistogramPath : "NONE");
+  out << "\n  containerWastePath = "
+      << (tbc.containerWastePath ? *tbc.containerWastePath : "NONE");
+  out << "\n  sizeClasses = "
+      << (tbc.sizeClasses ? tbc.sizeClasses->name() : "NONE");
+  out << "\n  writeRocksDB = " << tbc.writeRocksDB;
+  out << "\n  writeIndexes = " << tbc.writeIndexes;
   out << "\n]\n";
   return out;
 }
@@ -154,6 +164,12 @@ int main(int argc, char* argv[]) {
       .logAllStructs = true,
       .dumpDataSegment = false,
       .jsonPath = std::nullopt,
+      .flameGraphPath = std::nullopt,
+      .typeHistogramPath = std::nullopt,
+      .containerWastePath = std::nullopt,
+      .sizeClasses = std::nullopt,
+      .writeRocksDB = true,
+      .writeIndexes = false,
   };
 
   int c = '\0';